@@ -0,0 +1,86 @@
+#include "frame_time_histogram.h"
+#include <algorithm>
+#include <assert.h>
+
+namespace app
+{
+
+FrameTimeHistogram::FrameTimeHistogram(double bucketWidth, int bucketCount)
+	: d_bucketWidth(bucketWidth)
+	, d_buckets(bucketCount, 0)
+{
+	assert(bucketWidth > 0.0 && bucketCount > 0);
+}
+
+void FrameTimeHistogram::add(double seconds)
+{
+	size_t bucket = std::min(d_buckets.size() - 1, (size_t)std::max(0.0, seconds / d_bucketWidth));
+	d_buckets[bucket]++;
+
+	d_min = d_count == 0 ? seconds : std::min(d_min, seconds);
+	d_max = d_count == 0 ? seconds : std::max(d_max, seconds);
+	d_sum += seconds;
+	d_count++;
+}
+
+void FrameTimeHistogram::reset()
+{
+	std::fill(d_buckets.begin(), d_buckets.end(), 0);
+	d_count = 0;
+	d_sum = 0.0;
+	d_min = 0.0;
+	d_max = 0.0;
+}
+
+uint64_t FrameTimeHistogram::count() const
+{
+	return d_count;
+}
+
+double FrameTimeHistogram::mean() const
+{
+	return d_count == 0 ? 0.0 : d_sum / d_count;
+}
+
+double FrameTimeHistogram::min() const
+{
+	return d_min;
+}
+
+double FrameTimeHistogram::max() const
+{
+	return d_max;
+}
+
+double FrameTimeHistogram::percentile(double fraction) const
+{
+	if (d_count == 0)
+	{
+		return 0.0;
+	}
+
+	uint64_t rank = std::max<uint64_t>(1, (uint64_t)(fraction * d_count + 0.5));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < d_buckets.size(); ++i)
+	{
+		seen += d_buckets[i];
+		if (seen >= rank)
+		{
+			// the overflow bucket has no upper edge
+			return i + 1 == d_buckets.size() ? d_max : std::min(d_max, (i + 1) * d_bucketWidth);
+		}
+	}
+	return d_max;
+}
+
+double FrameTimeHistogram::bucketWidth() const
+{
+	return d_bucketWidth;
+}
+
+const std::vector<uint64_t>& FrameTimeHistogram::buckets() const
+{
+	return d_buckets;
+}
+
+} // end namespace app
\ No newline at end of file
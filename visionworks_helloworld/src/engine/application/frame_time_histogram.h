@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace app
+{
+
+// Histogram of frame times in fixed-width buckets, the last bucket gathers the times past the range.
+// Adding a time is constant and allocation free, so it can run every frame.
+class FrameTimeHistogram
+{
+public:
+	// 0.25 ms buckets up to 50 ms by default
+	explicit FrameTimeHistogram(double bucketWidth = 0.00025, int bucketCount = 200);
+
+	void add(double seconds);
+	void reset();
+
+	uint64_t count() const;
+	double mean() const;
+	double min() const;
+	double max() const;
+	// Time below which the given fraction (0..1) of the frames are, to the width of a bucket
+	double percentile(double fraction) const;
+
+	double bucketWidth() const;
+	const std::vector<uint64_t>& buckets() const;
+
+private:
+	double d_bucketWidth;
+	std::vector<uint64_t> d_buckets;
+	uint64_t d_count = 0;
+	double d_sum = 0.0;
+	double d_min = 0.0;
+	double d_max = 0.0;
+};
+
+} // end namespace app
\ No newline at end of file
@@ -1,13 +1,62 @@
 #include "graphics_app.h"
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <thread>
 
 #include "../graphics/vulkan_buffer.h"
 #include "../graphics/vulkan_texture.h"
+#include "../graphics/image_writer.h"
 
 
 namespace app
 {
 
+namespace
+{
+
+// Merge policy of the SDL events: the consecutive motions of one mouse in one window become one motion
+// with the latest position and buttons and the sum of the relative moves. The other events are kept.
+bool mergeMouseMotion(SDL_Event& pending, const SDL_Event& next)
+{
+	if (pending.type != SDL_MOUSEMOTION || next.type != SDL_MOUSEMOTION ||
+		pending.motion.windowID != next.motion.windowID || pending.motion.which != next.motion.which)
+	{
+		return false;
+	}
+
+	Sint32 xrel = pending.motion.xrel + next.motion.xrel;
+	Sint32 yrel = pending.motion.yrel + next.motion.yrel;
+	pending.motion = next.motion;
+	pending.motion.xrel = xrel;
+	pending.motion.yrel = yrel;
+
+	return true;
+}
+
+typedef std::chrono::steady_clock LoopClock;
+
+// Sleep most of the wait, the OS timers are coarse, and yield the rest of it
+void waitUntil(LoopClock::time_point deadline)
+{
+	const auto margin = std::chrono::milliseconds(2);
+
+	if (LoopClock::now() + margin < deadline)
+	{
+		std::this_thread::sleep_until(deadline - margin);
+	}
+	while (LoopClock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+}
+
+} // end anonymous namespace
 
 VulkanGraphicsAppBase::VulkanGraphicsAppBase()
 {
@@ -25,39 +74,186 @@ VulkanGraphicsAppBase::~VulkanGraphicsAppBase()
 
 int VulkanGraphicsAppBase::exec()
 {
-	if (!graphics::VulkanContext::initialize())
+	readArgs();
+
+	if (!graphics::VulkanContext::initialize(d_headless.enabled))
 	{
 		return EXIT_FAILURE;
 	}
 
 	SDL_Event ev;
 	d_dispath->add_event<SDL_Event>();
+	d_dispath->coalesce<SDL_Event>(mergeMouseMotion);
 
-	auto window = graphics::VulkanContext::createWindow(WINDOW_DEFAULT_TITLE, WINDOW_DEFAULT_WIDTH, WINDOW_DEFAULT_HEIGHT);
+	if (d_headless.enabled)
+	{
+		d_context = graphics::VulkanContext::createHeadless(vk::Extent2D(d_headless.width, d_headless.height), 3,
+															vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute, d_headless.gpu);
+	}
+	else
+	{
+		auto window = graphics::VulkanContext::createWindow(WINDOW_DEFAULT_TITLE, WINDOW_DEFAULT_WIDTH, WINDOW_DEFAULT_HEIGHT);
+		d_context = graphics::VulkanContext::create(window);
+	}
+
+	if (!d_context)
+	{
+		graphics::VulkanContext::shutdown();
+		return EXIT_FAILURE;
+	}
 
-	d_context = graphics::VulkanContext::create(window);
+	bool capturing = d_headless.enabled && !d_headless.captureDirectory.empty();
+	if (capturing)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(d_headless.captureDirectory, error);
+	}
+
+	// Frames rendered, and the one read back last (headless) which is written after the next one is submitted,
+	// so that the copy of a frame overlaps the rendering of the next
+	uint64_t frameNumber = 0;
+	bool capturePending = false;
+	uint32_t pendingImage = 0;
+	uint64_t pendingFrame = 0;
 
 	d_isRunning = init();
 
+	auto previousStart = LoopClock::now();
+	bool firstFrame = true;
+	// Simulation time not run yet by update()
+	double accumulator = 0.0;
+
 	while (d_isRunning)
 	{
-		while (SDL_PollEvent(&ev))
+		auto frameStart = LoopClock::now();
+		double frameTime = std::chrono::duration<double>(frameStart - previousStart).count();
+		previousStart = frameStart;
+
+		if (!firstFrame)
+		{
+			d_frameTimes.add(frameTime);
+		}
+		firstFrame = false;
+
+		d_profiler.beginFrame(frameNumber);
+
+		{
+			PROFILE_SCOPE(&d_profiler, "events");
+
+			while (SDL_PollEvent(&ev))
+			{
+				d_dispath->fold(ev);
+
+				if (ev.type == SDL_QUIT)
+				{
+					d_isRunning = false;
+					break;
+				}
+			}
+
+			// The mouse motions of the frame are folded into one event, delivered with the other SDL events
+			// before the frame since the GUI must see them. The events posted by the app are delivered here,
+			// unless a worker delivers them.
+			d_dispath->flush();
+			d_dispath->pump();
+		}
+
+		// The simulation runs by fixed steps, as many as the elapsed time holds, and the frame draws the
+		// state between the last two steps, so the update rate doesn't follow the frame rate
+		double alpha = 1.0;
+		const double step = d_loopSettings.fixedTimestep;
+		if (step > 0.0)
+		{
+			PROFILE_SCOPE(&d_profiler, "update");
+			accumulator += frameTime;
+
+			int updates = 0;
+			while (accumulator >= step && updates < d_loopSettings.maxUpdatesPerFrame)
+			{
+				update(step);
+				accumulator -= step;
+				++updates;
+			}
+
+			// Too far behind (slow frames, a breakpoint): the backlog is dropped
+			if (accumulator >= step)
+			{
+				accumulator = std::fmod(accumulator, step);
+			}
+
+			alpha = accumulator / step;
+		}
+		else
+		{
+			PROFILE_SCOPE(&d_profiler, "update");
+			update(frameTime);
+		}
+
+		bool capture = capturing && frameNumber % std::max(1u, d_headless.captureInterval) == 0;
+		if (capture)
+		{
+			d_context->swapChain->requestReadback();
+		}
+
+		{
+			PROFILE_SCOPE(&d_profiler, "render");
+			render(alpha);
+		}
+
+		if (d_headless.enabled)
 		{
-			d_dispath->trigger(ev);
+			if (capturePending)
+			{
+				PROFILE_SCOPE(&d_profiler, "capture");
+				writeCapture(pendingImage, pendingFrame);
+				capturePending = false;
+			}
+
+			// The app may not have presented this frame
+			if (capture && d_context->swapChain->lastReadbackImage() >= 0)
+			{
+				capturePending = true;
+				pendingImage = (uint32_t)d_context->swapChain->lastReadbackImage();
+				pendingFrame = frameNumber;
+			}
 
-			if (ev.type == SDL_QUIT)
+			if (d_headless.frameCount > 0 && frameNumber + 1 >= d_headless.frameCount)
 			{
 				d_isRunning = false;
-				break;
 			}
 		}
 
-		update();
-		render();
+		double period = framePeriod();
+		if (period > 0.0)
+		{
+			PROFILE_SCOPE(&d_profiler, "pacing");
+			waitUntil(frameStart + std::chrono::duration_cast<LoopClock::duration>(std::chrono::duration<double>(period)));
+		}
+
+		d_profiler.endFrame();
+		++frameNumber;
+	}
+
+	if (capturePending)
+	{
+		writeCapture(pendingImage, pendingFrame);
 	}
 
 	vk::Device(*d_context->device).waitIdle();
 
+	if (d_headless.enabled)
+	{
+		// For the batch jobs and the performance CI
+		std::cout << "frames: " << frameNumber << ", frame time (ms) mean " << 1000.0 * d_frameTimes.mean()
+			<< ", p50 " << 1000.0 * d_frameTimes.percentile(0.5) << ", p99 " << 1000.0 * d_frameTimes.percentile(0.99)
+			<< ", max " << 1000.0 * d_frameTimes.max() << "\n";
+	}
+
+	if (!d_traceFile.empty() && !d_profiler.writeChromeTrace(d_traceFile))
+	{
+		std::cerr << "unable to write the trace " << d_traceFile << ".\n";
+	}
+
 	cleanup();
 	d_dispath->cleanup();
 
@@ -71,6 +267,151 @@ void VulkanGraphicsAppBase::quitApp()
 	d_isRunning = false;
 }
 
+LoopSettings& VulkanGraphicsAppBase::loopSettings()
+{
+	return d_loopSettings;
+}
+
+const FrameTimeHistogram& VulkanGraphicsAppBase::frameTimes() const
+{
+	return d_frameTimes;
+}
+
+void VulkanGraphicsAppBase::resetFrameTimes()
+{
+	d_frameTimes.reset();
+}
+
+profiling::FrameProfiler* VulkanGraphicsAppBase::profiler()
+{
+	return &d_profiler;
+}
+
+HeadlessSettings& VulkanGraphicsAppBase::headlessSettings()
+{
+	return d_headless;
+}
+
+bool VulkanGraphicsAppBase::isHeadless() const
+{
+	return d_headless.enabled;
+}
+
+double VulkanGraphicsAppBase::framePeriod() const
+{
+	if (d_loopSettings.paceToDisplay && d_context && d_context->window)
+	{
+		SDL_DisplayMode mode;
+		int display = SDL_GetWindowDisplayIndex((SDL_Window*)d_context->window->intenalPointer());
+		if (display >= 0 && SDL_GetCurrentDisplayMode(display, &mode) == 0 && mode.refresh_rate > 0)
+		{
+			return 1.0 / mode.refresh_rate;
+		}
+	}
+
+	return d_loopSettings.targetFps > 0.0 ? 1.0 / d_loopSettings.targetFps : 0.0;
+}
+
+void VulkanGraphicsAppBase::readArgs()
+{
+	auto value = [](const std::string& argument, const std::string& option, std::string& out) {
+		if (argument.compare(0, option.size(), option) != 0)
+		{
+			return false;
+		}
+		out = argument.substr(option.size());
+		return true;
+	};
+
+	for (int i = 1; i < nArgs(); ++i)
+	{
+		std::string v;
+
+		if (arg(i) == "--headless")
+		{
+			d_headless.enabled = true;
+		}
+		else if (value(arg(i), "--frames=", v))
+		{
+			d_headless.frameCount = std::strtoull(v.c_str(), nullptr, 10);
+		}
+		else if (value(arg(i), "--size=", v))
+		{
+			unsigned width = 0, height = 0;
+			if (std::sscanf(v.c_str(), "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+			{
+				d_headless.width = width;
+				d_headless.height = height;
+			}
+		}
+		else if (value(arg(i), "--gpu=", v))
+		{
+			d_headless.gpu = std::atoi(v.c_str());
+		}
+		else if (value(arg(i), "--capture=", v))
+		{
+			d_headless.captureDirectory = v;
+		}
+		else if (value(arg(i), "--capture-format=", v))
+		{
+			d_headless.captureFormat = v == "raw" ? CaptureFormat::RAW : CaptureFormat::PNG;
+		}
+		else if (value(arg(i), "--capture-interval=", v))
+		{
+			d_headless.captureInterval = (uint32_t)std::strtoul(v.c_str(), nullptr, 10);
+		}
+		else if (value(arg(i), "--trace=", v))
+		{
+			d_traceFile = v;
+			d_profiler.setEnabled(true);
+		}
+	}
+}
+
+void VulkanGraphicsAppBase::writeCapture(uint32_t imageIndex, uint64_t frameNumber)
+{
+	auto swapChain = d_context->swapChain;
+	if (!swapChain->readFrame(imageIndex, d_capturePixels))
+	{
+		std::cerr << "unable to read back frame " << frameNumber << ".\n";
+		return;
+	}
+
+	auto width = swapChain->actualExtent.width;
+	auto height = swapChain->actualExtent.height;
+	auto format = swapChain->surfaceFormat.format;
+
+	char name[128];
+	bool written = false;
+
+	if (d_headless.captureFormat == CaptureFormat::RAW)
+	{
+		std::snprintf(name, sizeof(name), "frame_%06llu_%ux%u_%s.raw", (unsigned long long)frameNumber, width, height,
+					  vk::to_string(format).c_str());
+		written = graphics::ImageWriter::writeRaw((std::filesystem::path(d_headless.captureDirectory) / name).string(),
+												  d_capturePixels.data(), d_capturePixels.size());
+	}
+	else
+	{
+		if (format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb)
+		{
+			for (size_t i = 0; i + 3 < d_capturePixels.size(); i += 4)
+			{
+				std::swap(d_capturePixels[i], d_capturePixels[i + 2]);
+			}
+		}
+
+		std::snprintf(name, sizeof(name), "frame_%06llu.png", (unsigned long long)frameNumber);
+		written = graphics::ImageWriter::writePNG((std::filesystem::path(d_headless.captureDirectory) / name).string(),
+												  d_capturePixels.data(), width, height);
+	}
+
+	if (!written)
+	{
+		std::cerr << "unable to write " << name << " in " << d_headless.captureDirectory << ".\n";
+	}
+}
+
 std::shared_ptr<graphics::VulkanContext> VulkanGraphicsAppBase::vulkanContext()
 {
 	return d_context;
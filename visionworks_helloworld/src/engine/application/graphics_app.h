@@ -1,13 +1,56 @@
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
 #include "app_base.h"
+#include "frame_time_histogram.h"
 #include "../event/safe_event.h"
+#include "../profiling/frame_profiler.h"
 
 #include "../graphics/vulkan_context.h"
 
 namespace app
 {
 
+// Timing of the main loop
+struct LoopSettings
+{
+	// Duration of the simulation step of update() in seconds, 0 to update once per frame with the frame time
+	double fixedTimestep = 1.0 / 60.0;
+	// Updates run in one frame at most, past it the simulation slows down instead of spiralling
+	int maxUpdatesPerFrame = 8;
+	// Frames per second the loop waits for, 0 for no pacing (the present mode may still wait for vsync)
+	double targetFps = 0.0;
+	// Pace to the refresh rate of the display of the window, over targetFps
+	bool paceToDisplay = false;
+};
+
+enum class CaptureFormat
+{
+	PNG,
+	// the bytes read back, in the format of the images
+	RAW
+};
+
+// Run without window nor display, e.g. on servers and CI: the frames are rendered into offscreen images.
+// Set by the command line (--headless, --frames=N, --size=WxH, --gpu=N, --capture=DIR, --capture-format=png|raw,
+// --capture-interval=N) or by the constructor of the app
+struct HeadlessSettings
+{
+	bool enabled = false;
+	uint32_t width = WINDOW_DEFAULT_WIDTH;
+	uint32_t height = WINDOW_DEFAULT_HEIGHT;
+	// Frames rendered before the app quits, 0 to run until quitApp()
+	uint64_t frameCount = 0;
+	// Index of the physical device, the software ICD (e.g. lavapipe) is often the only one
+	int gpu = 0;
+	// Directory the frames are written to (frame_000000.png, ...), empty for none
+	std::string captureDirectory;
+	CaptureFormat captureFormat = CaptureFormat::PNG;
+	// Every how many frames one is written
+	uint32_t captureInterval = 1;
+};
+
 class VulkanGraphicsAppBase : public app::AppBase
 {
 public:
@@ -21,18 +64,45 @@ public:
 protected:
 
 	virtual bool init() = 0;
-	virtual void update() = 0;
-	virtual void render() = 0;
+	// Advance the simulation by dt seconds, the fixed timestep unless it is 0
+	virtual void update(double dt) = 0;
+	// Draw the state interpolated between the last two updates: alpha is the fraction of the timestep
+	// elapsed since the last one, in [0, 1), 1 without fixed timestep
+	virtual void render(double alpha) = 0;
 	virtual void cleanup() = 0;
 
 	void quitApp();
+	// Can be changed at any time, e.g. in init()
+	LoopSettings& loopSettings();
+	// Time between the starts of the frames
+	const FrameTimeHistogram& frameTimes() const;
+	void resetFrameTimes();
+	// Timings of the frames, disabled unless --trace=FILE is given (the Chrome trace of the last frames is then
+	// written on exit); the loop times "events", "update", "render" and "pacing"
+	profiling::FrameProfiler* profiler();
+	// Read by exec() before the context is created
+	HeadlessSettings& headlessSettings();
+	bool isHeadless() const;
+
 	std::shared_ptr<graphics::VulkanContext> vulkanContext();
 	std::shared_ptr<se::dispatcher> dispatcher();
 
 private:
 	bool d_isRunning = false;
+	LoopSettings d_loopSettings;
+	FrameTimeHistogram d_frameTimes;
 	std::shared_ptr<graphics::VulkanContext> d_context;
 	std::shared_ptr<se::dispatcher> d_dispath;
+	HeadlessSettings d_headless;
+	std::vector<uint8_t> d_capturePixels;
+	profiling::FrameProfiler d_profiler;
+	std::string d_traceFile;
+
+	// Seconds per frame of the pacing, 0 for none
+	double framePeriod() const;
+	void readArgs();
+	// Write the image read back for the frame
+	void writeCapture(uint32_t imageIndex, uint64_t frameNumber);
 };
 
 
@@ -0,0 +1,349 @@
+// micro-benchmarks of the event dispatcher: lookup, any_event, listener counts,
+// publisher threads and writer contention.
+// standalone program, the event_benchmark project of the solution, or e.g:
+//   g++ -std=c++17 -O2 -I.. event_benchmark.cpp ../dispatcher.cpp -o event_benchmark -pthread
+//   ./event_benchmark [--quick]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../safe_event.h"
+
+// gcc sees the malloc of the operator new below and warns about every delete
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// count the allocations of the program
+static std::atomic<std::size_t> allocations(0);
+
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size)) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+template<int N>
+struct bench_event {
+    int value;
+};
+
+// keep a value alive so the measured loop is not optimized out
+volatile std::size_t sink;
+
+// the sink of the listeners of the threaded benchmarks, one per thread so
+// the listeners don't write to a shared cache line
+thread_local std::size_t thread_sink;
+
+// divides the iterations of the sweeps with --quick
+std::size_t scale = 1;
+
+// average nanoseconds of one call of fn over iterations calls
+template<typename F>
+double ns_per_op(std::size_t iterations, F &&fn) {
+    // warm up the caches and the lazily created statics
+    for (std::size_t i = 0; i < iterations / 10; ++i) { fn(i); }
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) { fn(i); }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+// register the events 0..N-1 so the lookups run in a table of N events
+template<int ...I>
+void add_events(se::dispatcher &d, std::unordered_map<std::type_index, const void*> &hashed,
+                std::vector<const void*> &dense, std::integer_sequence<int, I...>) {
+    int unused[] = { (d.add_event<bench_event<I>>(), 0)... };
+    (void)unused;
+
+    int unused_hashed[] = { (hashed.emplace(std::type_index(typeid(bench_event<I>)), &d), 0)... };
+    (void)unused_hashed;
+
+    int unused_dense[] = { (dense.resize(std::max(dense.size(), se::type_id<bench_event<I>>() + 1)),
+                            dense[se::type_id<bench_event<I>>()] = &d, 0)... };
+    (void)unused_dense;
+}
+
+// the lookup of the producer of an event: type_index hashing, as before the
+// dense type ids, against an index in a vector
+void bench_lookup() {
+    const std::size_t iterations = 20000000;
+
+    se::dispatcher d;
+    std::unordered_map<std::type_index, const void*> hashed;
+    std::vector<const void*> dense;
+    add_events(d, hashed, dense, std::make_integer_sequence<int, 64>());
+
+    double hashed_ns = ns_per_op(iterations, [&hashed](std::size_t) {
+        sink = sink + (hashed.find(std::type_index(typeid(bench_event<37>))) != hashed.end());
+    });
+
+    double dense_ns = ns_per_op(iterations, [&dense](std::size_t) {
+        auto id = se::type_id<bench_event<37>>();
+        sink = sink + (id < dense.size() && dense[id] != nullptr);
+    });
+
+    std::printf("lookup among 64 events    type_index hash %6.2f ns   dense id %6.2f ns\n", hashed_ns, dense_ns);
+}
+
+// whole trigger, with and without listeners
+void bench_trigger() {
+    const std::size_t iterations = 10000000;
+
+    se::dispatcher d;
+    std::unordered_map<std::type_index, const void*> hashed;
+    std::vector<const void*> dense;
+    add_events(d, hashed, dense, std::make_integer_sequence<int, 64>());
+
+    double unknown_ns = ns_per_op(iterations, [&d](std::size_t i) {
+        sink = sink + d.trigger(bench_event<100>{ (int)i });
+    });
+
+    double none_ns = ns_per_op(iterations, [&d](std::size_t i) {
+        sink = sink + d.trigger(bench_event<37>{ (int)i });
+    });
+
+    d.listen(std::function<void(const bench_event<37>&)>([](const bench_event<37> &ev) {
+        sink = sink + ev.value;
+    }));
+
+    double one_ns = ns_per_op(iterations, [&d](std::size_t i) {
+        sink = sink + d.trigger(bench_event<37>{ (int)i });
+    });
+
+    std::printf("trigger                   unregistered %6.2f ns   no listener %6.2f ns   1 listener %6.2f ns\n",
+                unknown_ns, none_ns, one_ns);
+}
+
+// the any_event given to listen_any: a boxed copy checked with dynamic_cast, as
+// before the type erased view, against the view
+struct boxed_base {
+    virtual ~boxed_base() {}
+};
+
+template<typename T>
+struct boxed: public boxed_base {
+    const T &val;
+    boxed(const T &val) : val(val) {}
+};
+
+void bench_any() {
+    const std::size_t iterations = 10000000;
+
+    double boxed_ns = 0.0;
+    double boxed_allocs = 0.0;
+    {
+        bench_event<37> ev = { 1 };
+        std::size_t before = allocations.load();
+        boxed_ns = ns_per_op(iterations, [&ev](std::size_t) {
+            std::unique_ptr<boxed_base> any = std::make_unique<boxed<bench_event<37>>>(ev);
+            auto real = dynamic_cast<boxed<bench_event<37>>*>(any.get());
+            sink = sink + (real != nullptr ? real->val.value : 0);
+        });
+        boxed_allocs = (double)(allocations.load() - before) / (iterations + iterations / 10);
+    }
+
+    se::dispatcher d;
+    d.add_event<bench_event<37>>();
+    d.listen_any([](const se::any_event &ev) {
+        if (se::is<bench_event<37>>(ev)) {
+            sink = sink + se::into<bench_event<37>>(ev).value;
+        }
+    });
+
+    std::size_t before = allocations.load();
+    double view_ns = ns_per_op(iterations, [&d](std::size_t i) {
+        sink = sink + d.trigger(bench_event<37>{ (int)i });
+    });
+    double view_allocs = (double)(allocations.load() - before) / (iterations + iterations / 10);
+
+    std::printf("any_event                 boxed copy %6.2f ns %4.2f allocs   trigger to listen_any %6.2f ns %4.2f allocs\n",
+                boxed_ns, boxed_allocs, view_ns, view_allocs);
+}
+
+// listeners of bench_event<0>, typed or of all events
+void add_listeners(se::dispatcher &d, std::size_t count, bool any) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (any) {
+            d.listen_any([](const se::any_event &ev) {
+                if (se::is<bench_event<0>>(ev)) {
+                    thread_sink += se::into<bench_event<0>>(ev).value;
+                }
+            });
+        } else {
+            d.listen(std::function<void(const bench_event<0>&)>([](const bench_event<0> &ev) {
+                thread_sink += ev.value;
+            }));
+        }
+    }
+}
+
+// cost of a trigger on one thread for 1 to 1000 listeners
+void bench_listeners() {
+    std::printf("\nlisteners   path    ns/event   ns/listener   allocs/event\n");
+
+    const std::size_t counts[] = { 1, 10, 100, 1000 };
+    for (bool any : { false, true }) {
+        for (std::size_t count : counts) {
+            se::dispatcher d;
+            d.add_event<bench_event<0>>();
+            add_listeners(d, count, any);
+
+            std::size_t iterations = std::max<std::size_t>(20000000 / count / scale, 1000);
+
+            std::size_t before = allocations.load();
+            double ns = ns_per_op(iterations, [&d](std::size_t i) {
+                d.trigger(bench_event<0>{ (int)i });
+            });
+            double allocs = (double)(allocations.load() - before) / (iterations + iterations / 10);
+
+            std::printf("%9zu   %-5s %10.1f %13.2f %14.2f\n", count, any ? "any" : "typed", ns, ns / count, allocs);
+        }
+    }
+}
+
+// run fn(thread, i) events_per_thread times on each of threads threads, started
+// together; return the wall time in nanoseconds
+template<typename F>
+double run_threads(std::size_t threads, std::size_t events_per_thread, F &&fn) {
+    std::atomic<std::size_t> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> pool;
+
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            ready++;
+            while (!go.load()) { std::this_thread::yield(); }
+            for (std::size_t i = 0; i < events_per_thread; ++i) { fn(t, i); }
+            sink = sink + thread_sink;
+        });
+    }
+
+    while (ready.load() != threads) { std::this_thread::yield(); }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto &th : pool) { th.join(); }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// 1 to 32 threads triggering at once an event with 10 listeners
+void bench_publishers() {
+    std::printf("\nthreads   path    ns/event   events/s (all threads)   allocs/event   write lock wait\n");
+
+    const std::size_t thread_counts[] = { 1, 2, 4, 8, 16, 32 };
+    for (bool any : { false, true }) {
+        for (std::size_t threads : thread_counts) {
+            se::dispatcher d;
+            d.add_event<bench_event<0>>();
+            add_listeners(d, 10, any);
+
+            std::size_t events_per_thread = 2000000 / threads / scale;
+            std::size_t total = events_per_thread * threads;
+
+            std::size_t before = allocations.load();
+            double wall = run_threads(threads, events_per_thread, [&d](std::size_t, std::size_t i) {
+                d.trigger(bench_event<0>{ (int)i });
+            });
+            double allocs = (double)(allocations.load() - before) / total;
+
+            std::printf("%7zu   %-5s %10.1f %24.3g %14.2f %14.0f ns\n", threads, any ? "any" : "typed",
+                        wall / total, total / wall * 1e9, allocs, (double)d.write_lock_stats().wait_ns);
+        }
+    }
+}
+
+// publishers triggering while writers subscribe and unsubscribe listeners:
+// the publishers never wait, the writers wait for each other
+void bench_contention() {
+    std::printf("\npublishers   writers   ns/event   ns/write   write locks   contended   lock wait/write\n");
+
+    const std::size_t configs[][2] = { { 1, 1 }, { 4, 1 }, { 4, 4 }, { 16, 4 }, { 32, 8 } };
+    for (const auto &config : configs) {
+        std::size_t publishers = config[0];
+        std::size_t writers = config[1];
+
+        se::dispatcher d;
+        d.add_event<bench_event<0>>();
+        add_listeners(d, 10, false);
+
+        std::size_t events_per_thread = 1000000 / publishers / scale;
+        std::size_t writes_per_thread = 20000 / writers / scale;
+
+        std::vector<std::thread> writer_pool;
+        std::atomic<std::uint64_t> write_ns(0);
+
+        for (std::size_t w = 0; w < writers; ++w) {
+            writer_pool.emplace_back([&]() {
+                auto start = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < writes_per_thread; ++i) {
+                    auto sub = d.subscribe<bench_event<0>>([](const bench_event<0> &ev) {
+                        thread_sink += ev.value;
+                        return se::propagation::proceed;
+                    });
+                }
+                auto end = std::chrono::steady_clock::now();
+                write_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            });
+        }
+
+        double wall = run_threads(publishers, events_per_thread, [&d](std::size_t, std::size_t i) {
+            d.trigger(bench_event<0>{ (int)i });
+        });
+        for (auto &th : writer_pool) { th.join(); }
+
+        auto stats = d.write_lock_stats();
+        // a subscription locks twice, to add and to remove the listener
+        std::size_t writes = writes_per_thread * writers * 2;
+
+        std::printf("%10zu %9zu %10.1f %10.1f %13zu %11zu %14.1f ns\n", publishers, writers,
+                    wall / (events_per_thread * publishers), (double)write_ns.load() / writes,
+                    stats.acquisitions, stats.contended, (double)stats.wait_ns / writes);
+    }
+}
+
+}
+
+int
+main(int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "--quick") {
+        scale = 10;
+    }
+
+    std::printf("hardware threads: %u\n\n", std::thread::hardware_concurrency());
+
+    bench_lookup();
+    bench_trigger();
+    bench_any();
+    bench_listeners();
+    bench_publishers();
+    bench_contention();
+    return 0;
+}
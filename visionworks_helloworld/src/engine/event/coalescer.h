@@ -0,0 +1,82 @@
+#ifndef SE_COALESCER
+#define SE_COALESCER
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace se {
+
+// merge policy keeping the latest event
+template<typename E>
+bool last_wins(E &pending, const E &next) {
+    pending = next;
+    return true;
+}
+
+// folds the consecutive events of one type which can be merged into a single
+// pending event, delivered by flush; e.g the mouse motions of a frame become one
+// motion with the latest position and the sum of the deltas.
+// the merge function merges next into pending and returns true, or returns false
+// if the two can't be merged (pending is then delivered at once and next becomes
+// the pending event, so the order of the events is kept).
+// fold and flush must be called from one thread at a time.
+template<typename E>
+class coalescer {
+
+private:
+
+    std::function<bool(E&, const E&)> merge;
+    std::optional<E> pending;
+
+    // read from any thread
+    std::atomic<std::size_t> folded_count;
+
+public:
+
+    explicit coalescer(std::function<bool(E&, const E&)> merge)
+    : merge(std::move(merge)), folded_count(0)
+    {}
+
+    // number of events merged into another one instead of being delivered
+    std::size_t folded() const
+    { return this->folded_count.load(std::memory_order_relaxed); }
+
+    template<typename F>
+    void fold(const E &ev, F &&deliver) {
+        if (!this->pending) {
+            this->pending.emplace(ev);
+            return;
+        }
+
+        if (this->merge(*this->pending, ev)) {
+            this->folded_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // the pending event leaves before deliver, which may fold again
+        E out = std::move(*this->pending);
+        this->pending.emplace(ev);
+        deliver(static_cast<const E&>(out));
+    }
+
+    // deliver the pending event, false if there is none
+    template<typename F>
+    bool flush(F &&deliver) {
+        if (!this->pending) {
+            return false;
+        }
+
+        E out = std::move(*this->pending);
+        this->pending.reset();
+        deliver(static_cast<const E&>(out));
+        return true;
+    }
+
+};
+
+}
+
+#endif
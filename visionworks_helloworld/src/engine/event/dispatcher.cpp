@@ -24,12 +24,99 @@
 
 namespace se {
 
-dispatcher::dispatcher() {}
+dispatcher::dispatcher()
+: subscriptions(std::make_shared<subscriptions_state>()),
+  worker_stop(false), worker_waiting(false), posted(false)
+{}
 
-dispatcher::~dispatcher() {}
+// the subscriptions still alive can't reach the listeners anymore, a
+// listener may be removed by one of them on another thread meanwhile
+dispatcher::~dispatcher() {
+    this->subscriptions->close();
+    this->stop_worker();
+}
 
 void
-dispatcher::cleanup()
-{ this->all_events_listeners.clear(); }
+dispatcher::cleanup() {
+    write_lock lock(*this);
+    this->all_events_listeners.clear(this->readers);
+}
+
+std::size_t
+dispatcher::flush() {
+    rcu_domain::read_guard guard(this->readers);
+
+    std::size_t count = 0;
+    for (const auto &f : this->flushes.read()) {
+        count += f() ? 1 : 0;
+    }
+    return count;
+}
+
+std::size_t
+dispatcher::pump(std::size_t max_per_type) {
+    std::unique_lock<std::mutex> lock(this->pump_mtx, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return 0;
+    }
+
+    rcu_domain::read_guard guard(this->readers);
+
+    std::size_t count = 0;
+    for (const auto &p : this->pumps.read()) {
+        count += p(max_per_type);
+    }
+    return count;
+}
+
+void
+dispatcher::start_worker(std::size_t max_per_type) {
+    if (this->worker.joinable()) {
+        return;
+    }
+
+    this->worker_stop.store(false);
+    this->worker = std::thread([this, max_per_type]() { this->run_worker(max_per_type); });
+}
+
+void
+dispatcher::stop_worker() {
+    if (!this->worker.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->worker_mtx);
+        this->worker_stop.store(true);
+    }
+    this->worker_cv.notify_one();
+    this->worker.join();
+}
+
+void
+dispatcher::wake_worker() {
+    // a worker which is not waiting yet sees posted before it waits
+    this->posted.store(true);
+    if (this->worker_waiting.load()) {
+        std::lock_guard<std::mutex> lock(this->worker_mtx);
+        this->worker_cv.notify_one();
+    }
+}
+
+void
+dispatcher::run_worker(std::size_t max_per_type) {
+    while (!this->worker_stop.load()) {
+        if (this->pump(max_per_type) != 0) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->worker_mtx);
+        this->worker_waiting.store(true);
+        if (!this->posted.exchange(false) && !this->worker_stop.load()) {
+            this->worker_cv.wait(lock);
+        }
+        this->worker_waiting.store(false);
+    }
+}
 
 }
\ No newline at end of file
@@ -29,8 +29,17 @@
 #include <vector>
 #include <iostream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
 
 #include "event.h"
+#include "coalescer.h"
+#include "event_queue.h"
+#include "listener_table.h"
+#include "profiled_mutex.h"
+#include "rcu.h"
 #include "typed_map.h"
 
 namespace se {
@@ -38,24 +47,47 @@ namespace se {
 // internal event listener storage
 template<typename E>
 struct event_producer {
-    // the listeners
-    std::vector<std::function<void(const E&)>> _listeners;
+    typedef typename listener_table<E>::handle listener_handle;
+
+    // the listeners, sorted by priority
+    listener_table<E> _listeners;
+
+    // the posted events, created by the first post or by add_queue, never
+    // replaced once set
+    std::atomic<event_queue<E>*> queue;
+
+    // the merge policy of the folded events, set by coalesce, never replaced
+    // once set
+    std::atomic<coalescer<E>*> coalescing;
+
+    event_producer()
+    : queue(nullptr), coalescing(nullptr)
+    {}
+
+    ~event_producer() {
+        delete this->queue.load();
+        delete this->coalescing.load();
+    }
 
     // dispatch the event to the listeners
-    void dispatch(const E &ev) {
-        for (auto l : this->_listeners) {
-            l(ev);
-        }
+    // must be called inside a read section of the domain of the listeners
+    void dispatch(const E &ev) const {
+        this->_listeners.dispatch(ev);
+    }
+
+    // add a new listener to the internal table of listener for this event
+    // the writers of the producer must be serialized
+    listener_handle add_listener(std::function<propagation(const E&)> fn, int priority, rcu_domain &readers) {
+        return this->_listeners.add(std::move(fn), priority, readers);
     }
 
-    // add a new listener to the internal vector of listener for this event
-    void add_listener(std::function<void(const E&)> fn) {
-        this->_listeners.push_back(fn);
+    bool remove_listener(listener_handle h, rcu_domain &readers) {
+        return this->_listeners.remove(h, readers);
     }
 
-    // get the listeners list
-    const std::vector<std::function<void(const E&)>> listeners() const {
-        return this->_listeners;
+    // get the number of listeners
+    std::size_t listeners() const {
+        return this->_listeners.size();
     }
 };
 
@@ -63,22 +95,202 @@ class dispatcher {
 
 private:
 
+    // indexed by the type_id of the producer
+    typedef std::vector<const void*> producer_table;
+    // deliver at most the given number of the posted events of one type
+    typedef std::vector<std::function<std::size_t(std::size_t)>> pump_list;
+    // deliver the pending folded event of one type
+    typedef std::vector<std::function<bool()>> flush_list;
+
+    // readers of the snapshots below, i.e every trigger in progress
+    rcu_domain readers;
+
     // list of listeners for all events
-    std::vector<std::function<void(const any_event&)>> all_events_listeners;
+    listener_table<any_event> all_events_listeners;
+
+    // the producer of every registered event, an immutable snapshot of the
+    // producers map which is replaced when an event is added
+    rcu_ptr<producer_table> producers_snapshot;
 
     // typed_map containing the events producers
     // this ensure that only one producer exist for a given event
     se::typed_map producers;
 
-    // allow us to use the event in an asynchronous way
-    std::mutex access_mtx;
+    // serialize the changes of the listeners and of the events,
+    // trigger never takes it so publishers never wait for each other or for a
+    // listener being added
+    profiled_mutex write_mtx;
+
+    // write_mtx for a writer. once it is released the replaced snapshots are
+    // reclaimed, outside the lock: a listener writing from a trigger may be
+    // waiting for it, and the readers must be able to leave
+    class write_lock {
+
+    private:
+
+        dispatcher &owner;
+
+    public:
+
+        explicit write_lock(dispatcher &owner)
+        : owner(owner)
+        { this->owner.write_mtx.lock(); }
+
+        ~write_lock() {
+            this->owner.write_mtx.unlock();
+            this->owner.readers.reclaim();
+        }
+
+        write_lock(const write_lock&) = delete;
+        write_lock& operator=(const write_lock&) = delete;
+    };
+
+    // shared with the subscriptions, so the one reset after the dispatcher is
+    // gone does nothing. the destructor closes it, and waits for the
+    // subscriptions being reset on other threads
+    class subscriptions_state {
+
+    private:
+
+        std::mutex mtx;
+        std::condition_variable done;
+        bool open;
+        std::size_t cancelling;
+
+    public:
+
+        subscriptions_state()
+        : open(true), cancelling(0)
+        {}
+
+        // run the removal of a listener, unless the dispatcher is closed
+        template<typename F>
+        void cancel(F &&remove) {
+            {
+                std::lock_guard<std::mutex> lock(this->mtx);
+                if (!this->open) { return; }
+                this->cancelling++;
+            }
+
+            struct finished {
+                subscriptions_state &state;
+                ~finished() {
+                    std::lock_guard<std::mutex> lock(this->state.mtx);
+                    if (--this->state.cancelling == 0) { this->state.done.notify_all(); }
+                }
+            } f = { *this };
+
+            remove();
+        }
+
+        void close() {
+            std::unique_lock<std::mutex> lock(this->mtx);
+            this->open = false;
+            this->done.wait(lock, [this]() { return this->cancelling == 0; });
+        }
+    };
+
+    std::shared_ptr<subscriptions_state> subscriptions;
+
+    // one entry per event queue, in the order the queues were created
+    rcu_ptr<pump_list> pumps;
+
+    // one entry per coalesced event, in the order of the coalesce calls
+    rcu_ptr<flush_list> flushes;
+
+    // held by the thread delivering the posted events
+    std::mutex pump_mtx;
+
+    // worker thread mode, see start_worker
+    std::thread worker;
+    std::mutex worker_mtx;
+    std::condition_variable worker_cv;
+    std::atomic<bool> worker_stop;
+    std::atomic<bool> worker_waiting;
+    // set by post, so the worker doesn't wait while an event is queued
+    std::atomic<bool> posted;
+
+    // the producer of E, created if needed; write_mtx must be held
+    template<typename E>
+    event_producer<E> *producer() {
+        if (!this->producers.exist<event_producer<E>>()) {
+            this->producers.add<event_producer<E>>();
+
+            auto id = type_id<event_producer<E>>();
+            auto next = this->producers_snapshot.copy();
+            if (id >= next->size()) { next->resize(id + 1, nullptr); }
+            (*next)[id] = this->producers.get<event_producer<E>>();
+            this->producers_snapshot.update(std::move(next), this->readers);
+        }
+
+        return this->producers.get<event_producer<E>>();
+    }
+
+    // the producer of E, nullptr if E is not registered
+    // must be called inside a read section of readers
+    template<typename E>
+    const event_producer<E> *find_producer() const {
+        const auto &table = this->producers_snapshot.read();
+        auto id = type_id<event_producer<E>>();
+
+        if (id >= table.size()) {
+            return nullptr;
+        }
+        return static_cast<const event_producer<E>*>(table[id]);
+    }
+
+    // the queue of E, created if needed; write_mtx must be held
+    template<typename E>
+    event_queue<E> *queue(std::size_t capacity, overflow_policy policy) {
+        auto p = this->producer<E>();
+        auto q = p->queue.load();
+
+        if (q == nullptr) {
+            q = new event_queue<E>(capacity, policy);
+            p->queue.store(q);
+
+            auto next = this->pumps.copy();
+            next->push_back([this, p, q](std::size_t max) {
+                return q->drain(max, [this, p](const E &ev) { this->deliver(*p, ev); });
+            });
+            this->pumps.update(std::move(next), this->readers);
+        }
+
+        return q;
+    }
+
+    // notify the listeners of E and of all events
+    // must be called inside a read section of readers
+    template<typename E>
+    void deliver(const event_producer<E> &p, const E &ev) {
+        // notify listener of the given event
+        p.dispatch(ev);
+
+        // notify listeners of all events, they see the events stopped by a
+        // listener of E too
+        this->all_events_listeners.dispatch(any_event(ev));
+    }
+
+    void wake_worker();
+
+    void run_worker(std::size_t max_per_type);
 
 public:
 
+    // capacity of the queues created by post
+    static const std::size_t default_queue_capacity = 1024;
+
+    // events of one type delivered by a pump before the next type
+    static const std::size_t default_pump_batch = 256;
+
     dispatcher();
 
     ~dispatcher();
 
+    // the writers (add_event, listen, subscribe, ...) may wait for the triggers in
+    // progress on other threads when many replaced snapshots are pending, so they
+    // must not be called while holding a lock which a listener takes
+
     // register an event inside the event dispatcher
     // this function muse be called before the first call of trigger and add_listener
     // for an event, otherwise the event is not known by the event_dispatcher
@@ -90,13 +302,13 @@ public:
     // and return true, on error false is returned.
     template<typename E>
     bool add_event() {
-        std::lock_guard<std::mutex> lock(this->access_mtx);
+        write_lock lock(*this);
 
         if (this->producers.exist<event_producer<E>>()) {
             return false;
         }
 
-        this->producers.add<event_producer<E>>();
+        this->producer<E>();
         return true;
     }
 
@@ -105,53 +317,233 @@ public:
     // event, e.g for an event `custom_event`, the parameter of add_listener
     // should be of type std::function<void(const custom_event&)>
     // if the event exist true true is return, false otherwise
+    // the triggers in progress keep notifying the previous listeners
     template<typename E>
     bool listen(std::function<void(const E&)> fn) {
-        std::lock_guard<std::mutex> lock(this->access_mtx);
+        write_lock lock(*this);
 
-        if (!this->producers.exist<event_producer<E>>()) {
-            this->add_event<E>();
-        }
-
-        this->producers.get<event_producer<E>>()->add_listener(fn);
+        this->producer<E>()->add_listener([fn](const E &ev) {
+            fn(ev);
+            return propagation::proceed;
+        }, 0, this->readers);
 
         return true;
     }
 
     bool listen_any(std::function<void(const any_event&)> fn) {
-        std::lock_guard<std::mutex> lock(this->access_mtx);
+        write_lock lock(*this);
 
-        this->all_events_listeners.push_back(fn);
+        this->all_events_listeners.add([fn](const any_event &ev) {
+            fn(ev);
+            return propagation::proceed;
+        }, 0, this->readers);
 
         return true;
     }
 
+    // add a listener to an event, removed when the returned subscription is
+    // reset or destroyed.
+    // the listeners are called from the highest priority to the lowest (in the
+    // order of subscription for the same priority, the listeners added by
+    // listen have the priority 0); a listener returning propagation::stop hides
+    // the event from the next listeners of E, not from the listeners of all
+    // events.
+    // a listener can subscribe and unsubscribe from inside a trigger.
+    // a subscription may outlive the dispatcher, resetting it then does nothing
+    template<typename E>
+    subscription subscribe(std::function<propagation(const E&)> fn, int priority = 0) {
+        write_lock lock(*this);
+
+        auto p = this->producer<E>();
+        auto h = p->add_listener(std::move(fn), priority, this->readers);
+
+        auto state = this->subscriptions;
+        return subscription([this, state, p, h]() {
+            state->cancel([this, p, h]() {
+                write_lock lock(*this);
+                p->remove_listener(h, this->readers);
+            });
+        });
+    }
+
+    // add a listener of all events, like subscribe; propagation::stop hides the
+    // event from the next listeners of all events
+    subscription subscribe_any(std::function<propagation(const any_event&)> fn, int priority = 0) {
+        write_lock lock(*this);
+
+        auto h = this->all_events_listeners.add(std::move(fn), priority, this->readers);
+
+        auto state = this->subscriptions;
+        return subscription([this, state, h]() {
+            state->cancel([this, h]() {
+                write_lock lock(*this);
+                this->all_events_listeners.remove(h, this->readers);
+            });
+        });
+    }
+
     // trigger a new event
     // the event must be previously registered with `add_event`
     // the function check if the event is register the event is
     // dispatched to the producer<E> and true is returned, otherwise
     // false is returned
+    // trigger takes no lock: it reads the current snapshots of the producers
+    // and of the listeners, so it can be called from several threads at once,
+    // and from a listener
     template<typename E>
     bool trigger(const E &ev) {
-        std::lock_guard<std::mutex> lock(this->access_mtx);
+        rcu_domain::read_guard guard(this->readers);
 
-        if (!this->producers.exist<event_producer<E>>()) {
+        auto p = this->find_producer<E>();
+
+        if (p == nullptr) {
             return false;
         }
 
-        // notify listener of the given event
-        this->producers.get<event_producer<E>>()->dispatch(ev);
+        this->deliver(*p, ev);
+        return true;
+    }
+
+    // give E a queue of capacity events (rounded up to a power of two) and the
+    // policy applied when a post finds it full.
+    // must be called before the first post of E to change the default queue
+    // (default_queue_capacity, drop_oldest); false if E has a queue already
+    template<typename E>
+    bool add_queue(std::size_t capacity, overflow_policy policy) {
+        write_lock lock(*this);
 
-        // notify listeners of all events
-        if (!this->all_events_listeners.empty()) {
-            auto any_ev = any_event(ev);
-            for (auto al : this->all_events_listeners) {
-                al(any_ev);
+        if (this->producer<E>()->queue.load() != nullptr) {
+            return false;
+        }
+
+        this->queue<E>(capacity, policy);
+        return true;
+    }
+
+    // queue a new event, the listeners are notified later by pump or by the
+    // worker thread, on their thread.
+    // the event must be previously registered with `add_event`, otherwise
+    // false is returned.
+    // post takes no lock, except the first time for an event without a queue
+    template<typename E>
+    bool post(E ev) {
+        event_queue<E> *q = nullptr;
+
+        {
+            rcu_domain::read_guard guard(this->readers);
+
+            auto p = this->find_producer<E>();
+
+            if (p == nullptr) {
+                return false;
             }
+
+            q = p->queue.load();
+        }
+
+        if (q == nullptr) {
+            write_lock lock(*this);
+            q = this->queue<E>(default_queue_capacity, overflow_policy::drop_oldest);
+        }
+
+        q->post(std::move(ev));
+        this->wake_worker();
+        return true;
+    }
+
+    // fold the consecutive events of E with merge (e.g se::last_wins<E>, or a
+    // function adding the deltas of two events) and deliver at most one merged
+    // event per run of mergeable events, see coalescer.
+    // false if E has a merge policy already
+    template<typename E>
+    bool coalesce(std::function<bool(E&, const E&)> merge) {
+        write_lock lock(*this);
+
+        auto p = this->producer<E>();
+
+        if (p->coalescing.load() != nullptr) {
+            return false;
+        }
+
+        auto c = new coalescer<E>(std::move(merge));
+        p->coalescing.store(c);
+
+        auto next = this->flushes.copy();
+        next->push_back([this, p, c]() {
+            return c->flush([this, p](const E &ev) { this->deliver(*p, ev); });
+        });
+        this->flushes.update(std::move(next), this->readers);
+
+        return true;
+    }
+
+    // give an event to the merge policy of E, the merged event is delivered by
+    // flush, or before the next event which can't be merged with it.
+    // an event without merge policy is triggered at once.
+    // the event must be previously registered with `add_event`, otherwise
+    // false is returned.
+    // fold and flush must be called from one thread, e.g the platform event loop
+    template<typename E>
+    bool fold(const E &ev) {
+        rcu_domain::read_guard guard(this->readers);
+
+        auto p = this->find_producer<E>();
+
+        if (p == nullptr) {
+            return false;
+        }
+
+        auto c = p->coalescing.load();
+        if (c == nullptr) {
+            this->deliver(*p, ev);
+        } else {
+            c->fold(ev, [this, p](const E &merged) { this->deliver(*p, merged); });
         }
         return true;
     }
 
+    // deliver the pending merged events, once per frame; returns their number
+    std::size_t flush();
+
+    // number of events of E merged into another one by fold
+    template<typename E>
+    std::size_t folded() {
+        std::lock_guard<profiled_mutex> lock(this->write_mtx);
+
+        auto p = this->producers.get<event_producer<E>>();
+        auto c = p != nullptr ? p->coalescing.load() : nullptr;
+        return c != nullptr ? c->folded() : 0;
+    }
+
+    // number of posted events of E discarded by the overflow policy
+    template<typename E>
+    std::size_t dropped() {
+        std::lock_guard<profiled_mutex> lock(this->write_mtx);
+
+        auto p = this->producers.get<event_producer<E>>();
+        auto q = p != nullptr ? p->queue.load() : nullptr;
+        return q != nullptr ? q->dropped() : 0;
+    }
+
+    // deliver the posted events on the calling thread, at most max_per_type
+    // events of each type, oldest first, and return the number delivered.
+    // returns 0 at once if another thread (e.g the worker) is pumping.
+    // must not be called from a listener.
+    std::size_t pump(std::size_t max_per_type = default_pump_batch);
+
+    // deliver the posted events on a worker thread which sleeps while the
+    // queues are empty, until stop_worker; the listeners of the posted events
+    // are then called on the worker
+    void start_worker(std::size_t max_per_type = default_pump_batch);
+
+    // stop the worker thread, the events still queued are kept for pump
+    void stop_worker();
+
+    // how often the writers (add_event, listen, subscribe, ...) waited for each
+    // other; the publishers take no lock
+    lock_stats write_lock_stats() const
+    { return this->write_mtx.stats(); }
+
     // cleanup all listeners before exit
     void cleanup();
 
@@ -24,66 +24,46 @@
 #define SE_EVENT
 
 #include <typeinfo>
-#include <iostream>
-#include <memory>
+#include <type_traits>
+#include <cstddef>
 
-namespace se {
-
-struct base_any {
-
-    virtual ~base_any() {}
-    virtual const std::type_info& get_typeinfo() =0;
-
-};
-
-template<typename T>
-struct real_any: public base_any {
-
-private:
-
-    const T &val;
-    const std::type_info& self;
+#include "type_id.h"
 
-public:
-
-    real_any(const T &val)
-    : val(val), self(typeid(T))
-    {}
-
-    const std::type_info& get_typeinfo()
-    { return self; };
-
-    const T& get()
-    { return this->val; }
-
-};
+namespace se {
 
+// type erased view of an event, given to the listeners of all events.
+// it only points to the event, so building it allocates nothing, and the type
+// checks compare the dense type ids. it is valid during the call of the
+// listener only, an event kept for later must be copied with into.
 struct any_event {
 
 private:
 
-    std::unique_ptr<base_any> base;
+    const void *ptr;
+    std::size_t id;
+    const std::type_info *info;
 
 public:
 
-    any_event() {}
+    any_event()
+    : ptr(nullptr), id(static_cast<std::size_t>(-1)), info(&typeid(void))
+    {}
 
-    template<typename T> any_event(const T &val)
-    : base(std::make_unique<real_any<T>>(val))
+    template<typename T, typename = typename std::enable_if<!std::is_same<T, any_event>::value>::type>
+    any_event(const T &val)
+    : ptr(&val), id(type_id<T>()), info(&typeid(T))
     {}
 
-    const std::type_info& get_typeinfo()
-    { return this->base->get_typeinfo(); };
+    const std::type_info& get_typeinfo() const
+    { return *this->info; };
 
     template<typename T> bool is() const
-    { return this->base->get_typeinfo() == typeid(T); }
+    { return this->id == type_id<typename std::decay<T>::type>(); }
 
     template<typename T>
     const T& into() const {
         if (!this->is<T>()) { throw std::bad_cast(); }
-        auto ptr = dynamic_cast<real_any<T>*>(this->base.get());
-        if (ptr == nullptr) { throw std::bad_cast(); }
-        return ptr->get();
+        return *static_cast<const T*>(this->ptr);
     }
 };
 
@@ -99,4 +79,4 @@ bool is(const any_event& ev) {
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,265 @@
+#ifndef SE_EVENT_QUEUE
+#define SE_EVENT_QUEUE
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace se {
+
+// what a post does when the queue of the event is full
+enum class overflow_policy {
+    // the oldest queued event is discarded to make room
+    drop_oldest,
+    // the post waits until the consumer makes room, it must not be called by
+    // the thread which pumps the queue
+    block,
+    // the event is kept aside and replaced by the next ones until the consumer
+    // takes it, so only the latest of the events over the capacity is delivered
+    coalesce
+};
+
+// bounded ring of events, lock free.
+// any thread can push, one consumer pops; the producers also pop when they drop
+// the oldest event, so the ring is safe with several poppers.
+// the capacity is rounded up to a power of two.
+template<typename T>
+class bounded_ring {
+
+private:
+
+    struct cell {
+        std::atomic<std::size_t> seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    std::unique_ptr<cell[]> cells;
+    std::size_t mask;
+
+    // the producers and the consumer each own a cache line
+    alignas(64) std::atomic<std::size_t> push_pos;
+    alignas(64) std::atomic<std::size_t> pop_pos;
+
+    static std::size_t round_capacity(std::size_t capacity) {
+        std::size_t c = 2;
+        while (c < capacity) { c <<= 1; }
+        return c;
+    }
+
+public:
+
+    explicit bounded_ring(std::size_t capacity)
+    : cells(new cell[round_capacity(capacity)]), mask(round_capacity(capacity) - 1),
+      push_pos(0), pop_pos(0) {
+        for (std::size_t i = 0; i <= this->mask; ++i) {
+            this->cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~bounded_ring() {
+        while (this->drop()) {}
+    }
+
+    bounded_ring(const bounded_ring&) = delete;
+    bounded_ring& operator=(const bounded_ring&) = delete;
+
+    std::size_t capacity() const
+    { return this->mask + 1; }
+
+    // move value into the ring, false if the ring is full (value is untouched then)
+    bool push(T &value) {
+        std::size_t pos = this->push_pos.load(std::memory_order_relaxed);
+        cell *c;
+
+        for (;;) {
+            c = &this->cells[pos & this->mask];
+            std::size_t seq = c->seq.load(std::memory_order_acquire);
+            std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)pos;
+
+            if (diff == 0) {
+                if (this->push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = this->push_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&c->storage) T(std::move(value));
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // call fn with the oldest value, which is destroyed after it, false if the ring is empty
+    template<typename F>
+    bool pop(F &&fn) {
+        std::size_t pos;
+        cell *c = this->claim(pos);
+        if (c == nullptr) { return false; }
+
+        // release the cell even if fn throws
+        struct release {
+            cell *c;
+            std::size_t seq;
+            ~release() {
+                reinterpret_cast<T*>(&this->c->storage)->~T();
+                this->c->seq.store(this->seq, std::memory_order_release);
+            }
+        } r = { c, pos + this->mask + 1 };
+
+        fn(*reinterpret_cast<T*>(&c->storage));
+        return true;
+    }
+
+    // discard the oldest value, false if the ring is empty
+    bool drop() {
+        std::size_t pos;
+        cell *c = this->claim(pos);
+        if (c == nullptr) { return false; }
+
+        reinterpret_cast<T*>(&c->storage)->~T();
+        c->seq.store(pos + this->mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+
+    // reserve the oldest cell for a pop
+    cell *claim(std::size_t &pos) {
+        pos = this->pop_pos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell *c = &this->cells[pos & this->mask];
+            std::size_t seq = c->seq.load(std::memory_order_acquire);
+            std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)(pos + 1);
+
+            if (diff == 0) {
+                if (this->pop_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return c;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = this->pop_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+};
+
+// the posted events of one type waiting to be delivered
+template<typename E>
+class event_queue {
+
+private:
+
+    bounded_ring<E> ring;
+    overflow_policy policy;
+
+    // events discarded by drop_oldest or replaced by coalesce
+    std::atomic<std::size_t> dropped_count;
+
+    // coalesce: the latest event which did not fit in the ring, newer than
+    // every event of the ring; guarded by overflow_lock
+    std::atomic_flag overflow_lock = ATOMIC_FLAG_INIT;
+    std::atomic<bool> overflow_pending;
+    std::unique_ptr<E> overflow;
+
+    void lock_overflow() {
+        while (this->overflow_lock.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock_overflow()
+    { this->overflow_lock.clear(std::memory_order_release); }
+
+    // keep ev as the overflow event, replacing the previous one
+    void coalesce(E &ev) {
+        this->lock_overflow();
+        if (this->overflow) {
+            *this->overflow = std::move(ev);
+            this->dropped_count.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            this->overflow = std::make_unique<E>(std::move(ev));
+        }
+        this->overflow_pending.store(true);
+        this->unlock_overflow();
+    }
+
+public:
+
+    event_queue(std::size_t capacity, overflow_policy policy)
+    : ring(capacity), policy(policy), dropped_count(0), overflow_pending(false)
+    {}
+
+    std::size_t capacity() const
+    { return this->ring.capacity(); }
+
+    // number of posted events which will never be delivered
+    std::size_t dropped() const
+    { return this->dropped_count.load(std::memory_order_relaxed); }
+
+    // queue an event, applying the overflow policy if the queue is full
+    void post(E ev) {
+        if (this->policy == overflow_policy::coalesce && this->overflow_pending.load()) {
+            // keep the order: the events can't go to the ring until the consumer
+            // took the overflow event
+            this->coalesce(ev);
+            return;
+        }
+
+        while (!this->ring.push(ev)) {
+            switch (this->policy) {
+            case overflow_policy::drop_oldest:
+                if (this->ring.drop()) {
+                    this->dropped_count.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            case overflow_policy::block:
+                std::this_thread::yield();
+                break;
+            case overflow_policy::coalesce:
+                this->coalesce(ev);
+                return;
+            }
+        }
+    }
+
+    // hand at most max events to deliver, oldest first, and return their number.
+    // only one thread may drain the queue at a time.
+    template<typename F>
+    std::size_t drain(std::size_t max, F &&deliver) {
+        std::size_t count = 0;
+
+        while (count < max && this->ring.pop([&deliver](E &ev) { deliver(static_cast<const E&>(ev)); })) {
+            ++count;
+        }
+
+        if (count < max && this->overflow_pending.load()) {
+            this->lock_overflow();
+            std::unique_ptr<E> ev = std::move(this->overflow);
+            this->overflow_pending.store(false);
+            this->unlock_overflow();
+
+            if (ev) {
+                deliver(static_cast<const E&>(*ev));
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+};
+
+}
+
+#endif
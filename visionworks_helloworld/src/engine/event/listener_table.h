@@ -0,0 +1,217 @@
+#ifndef SE_LISTENER_TABLE
+#define SE_LISTENER_TABLE
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rcu.h"
+
+namespace se {
+
+// returned by a listener to let the event reach the next listeners, or not
+enum class propagation {
+    proceed,
+    stop
+};
+
+// owns a listener: the listener is removed when the subscription is reset or
+// destroyed. it does nothing once the dispatcher is destroyed.
+class subscription {
+
+private:
+
+    std::function<void()> cancel;
+
+public:
+
+    subscription() {}
+
+    explicit subscription(std::function<void()> cancel)
+    : cancel(std::move(cancel))
+    {}
+
+    subscription(subscription &&other)
+    : cancel(std::move(other.cancel))
+    { other.cancel = nullptr; }
+
+    subscription& operator=(subscription &&other) {
+        if (this != &other) {
+            this->reset();
+            this->cancel = std::move(other.cancel);
+            other.cancel = nullptr;
+        }
+        return *this;
+    }
+
+    subscription(const subscription&) = delete;
+    subscription& operator=(const subscription&) = delete;
+
+    ~subscription()
+    { this->reset(); }
+
+    // remove the listener, the triggers in progress on other threads may still
+    // call it once
+    void reset() {
+        if (this->cancel) {
+            auto c = std::move(this->cancel);
+            this->cancel = nullptr;
+            c();
+        }
+    }
+
+    // true while the subscription owns a listener
+    explicit operator bool() const
+    { return static_cast<bool>(this->cancel); }
+
+};
+
+// the listeners of an event, ordered by priority.
+// the readers dispatch on an immutable array of the listeners, contiguous and
+// sorted, replaced by the writers. a listener is known by its slot in a slot map
+// and by the generation of the slot: removing it only bumps the generation,
+// which the dispatch compares before calling a listener, and frees the slot.
+// the array drops the removed listeners when a listener is added, or once they
+// outnumber the others, so a removal is constant time (amortized).
+// the writers must be serialized by the owner.
+template<typename A>
+class listener_table {
+
+public:
+
+    typedef std::function<propagation(const A&)> listener;
+
+    // where a listener is, to remove it
+    struct handle {
+        std::size_t slot;
+        std::uint32_t generation;
+    };
+
+private:
+
+    struct entry {
+        listener fn;
+        int priority;
+        std::size_t slot;
+        // the generation of the slot while the listener is in the table
+        const std::atomic<std::uint32_t> *slot_generation;
+        std::uint32_t generation;
+
+        bool alive() const
+        { return this->slot_generation->load(std::memory_order_acquire) == this->generation; }
+    };
+
+    typedef std::vector<entry> entry_list;
+
+    rcu_ptr<entry_list> entries;
+
+    // never shrinks and its elements never move, the entries point to them
+    std::deque<std::atomic<std::uint32_t>> slots;
+    std::vector<std::size_t> free_slots;
+
+    std::size_t live_count;
+    std::size_t dead_count;
+
+    // copy of the entries without the removed listeners
+    std::unique_ptr<entry_list> compacted() const {
+        auto next = std::make_unique<entry_list>();
+        next->reserve(this->live_count + 1);
+
+        for (const auto &e : this->entries.read()) {
+            if (e.alive()) { next->push_back(e); }
+        }
+        return next;
+    }
+
+public:
+
+    listener_table()
+    : live_count(0), dead_count(0)
+    {}
+
+    listener_table(const listener_table&) = delete;
+    listener_table& operator=(const listener_table&) = delete;
+
+    // call the listeners, highest priority first, until one of them stops the
+    // propagation; return false if it was stopped
+    // must be called inside a read section of the domain of the writers
+    bool dispatch(const A &ev) const {
+        for (const auto &e : this->entries.read()) {
+            if (e.alive() && e.fn(ev) == propagation::stop) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // number of listeners, for the writers
+    std::size_t size() const
+    { return this->live_count; }
+
+    // add a listener after the ones of the same priority
+    handle add(listener fn, int priority, rcu_domain &readers) {
+        std::size_t slot;
+        if (!this->free_slots.empty()) {
+            slot = this->free_slots.back();
+            this->free_slots.pop_back();
+        } else {
+            slot = this->slots.size();
+            this->slots.emplace_back(0);
+        }
+
+        entry e = { std::move(fn), priority, slot, &this->slots[slot], this->slots[slot].load() };
+
+        auto next = this->compacted();
+        auto pos = std::upper_bound(next->begin(), next->end(), priority,
+                                    [](int p, const entry &other) { return p > other.priority; });
+        next->insert(pos, std::move(e));
+
+        this->entries.update(std::move(next), readers);
+        this->live_count++;
+        this->dead_count = 0;
+
+        return handle{ slot, this->slots[slot].load() };
+    }
+
+    // remove a listener, false if it was removed already
+    bool remove(handle h, rcu_domain &readers) {
+        if (h.slot >= this->slots.size() || this->slots[h.slot].load() != h.generation) {
+            return false;
+        }
+
+        this->slots[h.slot].store(h.generation + 1, std::memory_order_release);
+        this->free_slots.push_back(h.slot);
+        this->live_count--;
+        this->dead_count++;
+
+        if (this->dead_count > this->live_count) {
+            this->entries.update(this->compacted(), readers);
+            this->dead_count = 0;
+        }
+        return true;
+    }
+
+    // remove every listener
+    void clear(rcu_domain &readers) {
+        for (const auto &e : this->entries.read()) {
+            if (e.alive()) {
+                this->slots[e.slot].store(e.generation + 1, std::memory_order_release);
+                this->free_slots.push_back(e.slot);
+            }
+        }
+        this->entries.update(std::make_unique<entry_list>(), readers);
+        this->live_count = 0;
+        this->dead_count = 0;
+    }
+
+};
+
+}
+
+#endif
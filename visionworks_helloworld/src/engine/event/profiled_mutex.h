@@ -0,0 +1,76 @@
+#ifndef SE_PROFILED_MUTEX
+#define SE_PROFILED_MUTEX
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace se {
+
+struct lock_stats {
+    // number of lock calls
+    std::size_t acquisitions;
+    // lock calls which found the mutex held by another thread
+    std::size_t contended;
+    // time spent waiting by the contended calls
+    std::uint64_t wait_ns;
+};
+
+// std::mutex counting how often and how long its users wait for it.
+// an uncontended lock costs a try_lock, the clock is only read when the mutex
+// is held by another thread.
+class profiled_mutex {
+
+private:
+
+    std::mutex mtx;
+    std::atomic<std::size_t> acquisitions;
+    std::atomic<std::size_t> contended;
+    std::atomic<std::uint64_t> wait_ns;
+
+public:
+
+    profiled_mutex()
+    : acquisitions(0), contended(0), wait_ns(0)
+    {}
+
+    profiled_mutex(const profiled_mutex&) = delete;
+    profiled_mutex& operator=(const profiled_mutex&) = delete;
+
+    void lock() {
+        if (!this->mtx.try_lock()) {
+            auto start = std::chrono::steady_clock::now();
+            this->mtx.lock();
+            auto waited = std::chrono::steady_clock::now() - start;
+
+            this->contended.fetch_add(1, std::memory_order_relaxed);
+            this->wait_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count(),
+                                    std::memory_order_relaxed);
+        }
+        this->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool try_lock() {
+        if (!this->mtx.try_lock()) {
+            return false;
+        }
+        this->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void unlock()
+    { this->mtx.unlock(); }
+
+    lock_stats stats() const {
+        return lock_stats{ this->acquisitions.load(std::memory_order_relaxed),
+                           this->contended.load(std::memory_order_relaxed),
+                           this->wait_ns.load(std::memory_order_relaxed) };
+    }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef SE_RCU
+#define SE_RCU
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace se {
+
+// the readers of a set of rcu_ptr, and the values the writers replaced.
+// a reader announces itself in one of a few counters, each on its own cache line, so
+// readers on different threads don't write to the same memory; entering and leaving a
+// read section never blocks.
+// every stripe has one counter per phase, and the readers enter the current phase. a
+// grace period ends when the counters of the previous phase are all back to zero; the
+// new readers are in the other phase meanwhile, so a busy domain still ends it. a
+// replaced value is deleted two grace periods after it was replaced, when every
+// reader which may have read it has left.
+class rcu_domain {
+
+public:
+
+    // replaced values pending before the writers wait for the readers, see reclaim
+    static const std::size_t max_retired = 64;
+
+private:
+
+    static const std::size_t stripe_count = 16;
+
+    struct alignas(64) stripe {
+        std::atomic<std::size_t> readers[2];
+    };
+
+    struct retired_value {
+        const void *value;
+        void (*destroy)(const void*);
+        // the grace periods ended when it was replaced
+        std::uint64_t grace_period;
+    };
+
+    struct thread_state {
+        std::size_t stripe;
+        // read sections of any domain the thread is in
+        std::size_t depth;
+    };
+
+    stripe stripes[stripe_count];
+
+    // ended grace periods, its parity is the phase of the new readers
+    std::atomic<std::uint64_t> grace_periods;
+
+    // taken by the writers only
+    std::mutex retired_mtx;
+    std::vector<retired_value> retired;
+
+    static thread_state &this_thread() {
+        static std::atomic<std::size_t> next_stripe(0);
+        static thread_local thread_state state = { next_stripe++ % stripe_count, 0 };
+        return state;
+    }
+
+    // end the grace period if no reader is left in the previous phase, and move
+    // the new readers to it; retired_mtx must be held
+    bool try_end_grace_period() {
+        auto g = this->grace_periods.load();
+        auto previous = (g + 1) & 1;
+
+        // sequentially consistent: a reader counted after this check entered after
+        // the values retired so far were replaced, and reads the new ones
+        for (auto &s : this->stripes) {
+            if (s.readers[previous].load() != 0) { return false; }
+        }
+
+        this->grace_periods.store(g + 1);
+        return true;
+    }
+
+    // delete the values no reader can use anymore; retired_mtx must be held
+    void free_passed() {
+        if (this->retired.empty()) {
+            return;
+        }
+
+        // two grace periods cover every value retired so far
+        if (this->try_end_grace_period()) {
+            this->try_end_grace_period();
+        }
+
+        auto g = this->grace_periods.load();
+
+        std::size_t kept = 0;
+        for (auto &r : this->retired) {
+            if (g >= r.grace_period + 2) {
+                r.destroy(r.value);
+            } else {
+                this->retired[kept++] = r;
+            }
+        }
+        this->retired.resize(kept);
+    }
+
+public:
+
+    rcu_domain()
+    : grace_periods(0)
+    {
+        for (auto &s : this->stripes) {
+            s.readers[0].store(0);
+            s.readers[1].store(0);
+        }
+    }
+
+    // no reader is left, every replaced value goes
+    ~rcu_domain() {
+        for (auto &r : this->retired) { r.destroy(r.value); }
+    }
+
+    rcu_domain(const rcu_domain&) = delete;
+    rcu_domain& operator=(const rcu_domain&) = delete;
+
+    // the pointers of the domain can be read while the guard exists
+    class read_guard {
+
+    private:
+
+        thread_state &thread;
+        std::atomic<std::size_t> &counter;
+
+    public:
+
+        explicit read_guard(rcu_domain &domain)
+        : thread(this_thread()),
+          counter(domain.stripes[this->thread.stripe].readers[domain.grace_periods.load() & 1])
+        {
+            // sequentially consistent, so a writer which finds no reader in this
+            // phase after replacing a pointer knows that this reader sees the new one
+            this->counter.fetch_add(1);
+            this->thread.depth++;
+        }
+
+        ~read_guard() {
+            this->thread.depth--;
+            this->counter.fetch_sub(1, std::memory_order_release);
+        }
+
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+    };
+
+    // true while the calling thread is inside a read section of any domain
+    static bool in_read_section()
+    { return this_thread().depth != 0; }
+
+    // hand over a value replaced by a writer, deleted once the readers which may
+    // still use it have left; deletes the older values already free and never waits
+    template<typename T>
+    void retire(const T *value) {
+        std::lock_guard<std::mutex> lock(this->retired_mtx);
+
+        retired_value r = { value, [](const void *p) { delete static_cast<const T*>(p); }, this->grace_periods.load() };
+        this->retired.push_back(r);
+        this->free_passed();
+    }
+
+    // delete the replaced values no reader can use anymore. past max_retired values
+    // the caller waits for the readers of the values replaced so far, unless it is
+    // inside a read section itself; it must not hold a lock a reader may wait for.
+    void reclaim() {
+        std::unique_lock<std::mutex> lock(this->retired_mtx);
+        this->free_passed();
+
+        if (this->retired.size() <= max_retired || in_read_section()) {
+            return;
+        }
+
+        // the readers of the current phase leave, the new ones don't hold back
+        // the grace periods; another writer may free the values first
+        auto target = this->grace_periods.load() + 2;
+        while (!this->retired.empty() && this->grace_periods.load() < target) {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+            this->free_passed();
+        }
+    }
+
+    // number of replaced values not deleted yet
+    std::size_t pending() {
+        std::lock_guard<std::mutex> lock(this->retired_mtx);
+        return this->retired.size();
+    }
+
+};
+
+// pointer to an immutable value, read without locks inside a read section
+// of an rcu_domain and replaced as a whole by the writers.
+// the writers must be serialized by the owner (e.g with a mutex), the replaced
+// values are given to the domain, which deletes them once no reader may still
+// use them; the domain must outlive the pointer.
+template<typename T>
+class rcu_ptr {
+
+private:
+
+    std::atomic<const T*> current;
+
+public:
+
+    rcu_ptr()
+    : current(new T())
+    {}
+
+    ~rcu_ptr()
+    { delete this->current.load(); }
+
+    rcu_ptr(const rcu_ptr&) = delete;
+    rcu_ptr& operator=(const rcu_ptr&) = delete;
+
+    // the current value; in a read section of the domain for the readers, the
+    // writers can read it at any time
+    const T& read() const
+    { return *this->current.load(); }
+
+    // publish a new value, the readers already in a read section may keep using
+    // the previous one until they leave it
+    void update(std::unique_ptr<T> value, rcu_domain &domain)
+    { domain.retire(this->current.exchange(value.release())); }
+
+    // copy of the current value for a writer to modify and publish
+    std::unique_ptr<T> copy() const
+    { return std::make_unique<T>(this->read()); }
+
+};
+
+}
+
+#endif
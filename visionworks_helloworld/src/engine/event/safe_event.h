@@ -24,7 +24,13 @@
 #ifndef SAFE_EVENT
 #define SAFE_EVENT
 
+#include "type_id.h"
 #include "event.h"
+#include "coalescer.h"
+#include "event_queue.h"
+#include "listener_table.h"
+#include "profiled_mutex.h"
+#include "rcu.h"
 #include "typed_map.h"
 #include "dispatcher.h"
 
@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <functional>
+
+#include "../safe_event.h"
+
+namespace {
+
+struct key_event {
+    int key;
+};
+
+struct mouse_event {
+    int x;
+};
+
+int failures = 0;
+
+void check(bool condition, const char *what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// the listener of a higher priority stopping an event hides it from the
+// listeners of lower priority of the same event, subscribed or added by listen
+void test_stop() {
+    se::dispatcher d;
+
+    int gui = 0, camera = 0, listened = 0;
+    bool capture = true;
+
+    auto camera_sub = d.subscribe<key_event>([&camera](const key_event &) {
+        ++camera;
+        return se::propagation::proceed;
+    });
+    d.listen<key_event>([&listened](const key_event &) { ++listened; });
+
+    // subscribed last, called first
+    auto gui_sub = d.subscribe<key_event>([&gui, &capture](const key_event &) {
+        ++gui;
+        return capture ? se::propagation::stop : se::propagation::proceed;
+    }, 100);
+
+    d.trigger(key_event{ 1 });
+    check(gui == 1, "the listener of the highest priority didn't see the event");
+    check(camera == 0, "a stopped event reached a subscription of lower priority");
+    check(listened == 0, "a stopped event reached a listener added by listen");
+
+    capture = false;
+    d.trigger(key_event{ 2 });
+    check(gui == 2 && camera == 1 && listened == 1, "an event which was not stopped didn't reach every listener");
+
+    // without the stopping listener the event goes through
+    capture = true;
+    gui_sub.reset();
+    d.trigger(key_event{ 3 });
+    check(gui == 2 && camera == 2 && listened == 2, "a reset subscription still stops the events");
+}
+
+// listeners of the same priority run in the order of subscription
+void test_order() {
+    se::dispatcher d;
+
+    int calls = 0, first = 0, second = 0;
+
+    auto first_sub = d.subscribe<key_event>([&calls, &first](const key_event &) {
+        first = ++calls;
+        return se::propagation::proceed;
+    }, 5);
+    auto second_sub = d.subscribe<key_event>([&calls, &second](const key_event &) {
+        second = ++calls;
+        return se::propagation::stop;
+    }, 5);
+    auto low_sub = d.subscribe<key_event>([](const key_event &) {
+        return se::propagation::proceed;
+    }, -5);
+
+    d.trigger(key_event{ 0 });
+    check(first == 1 && second == 2, "listeners of the same priority didn't run in the order of subscription");
+}
+
+// the listeners of all events see the events stopped by a listener of E, and
+// a listener of all events stops only the next listeners of all events
+void test_any() {
+    se::dispatcher d;
+
+    int keys = 0, any = 0, low_any = 0;
+
+    auto key_sub = d.subscribe<key_event>([&keys](const key_event &) {
+        ++keys;
+        return se::propagation::stop;
+    }, 100);
+    auto any_sub = d.subscribe_any([&any](const se::any_event &ev) {
+        ++any;
+        return se::is<mouse_event>(ev) ? se::propagation::stop : se::propagation::proceed;
+    }, 10);
+    auto low_any_sub = d.subscribe_any([&low_any](const se::any_event &) {
+        ++low_any;
+        return se::propagation::proceed;
+    });
+
+    d.trigger(key_event{ 1 });
+    check(keys == 1 && any == 1 && low_any == 1, "a listener of key_event stopped the listeners of all events");
+
+    d.add_event<mouse_event>();
+    check(d.trigger(mouse_event{ 1 }), "mouse_event was not registered");
+    check(any == 2, "the listener of all events didn't see mouse_event");
+    check(low_any == 1, "a stopped event reached a listener of all events of lower priority");
+}
+
+}
+
+int
+main() {
+    test_stop();
+    test_order();
+    test_any();
+
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef SE_TYPE_ID
+#define SE_TYPE_ID
+
+#include <atomic>
+#include <cstddef>
+
+namespace se {
+
+inline std::size_t next_type_id() {
+    static std::atomic<std::size_t> next(0);
+    return next++;
+}
+
+// dense id of a type, assigned on the first call for the type, so the ids of
+// the types in use are 0, 1, 2... and can index a vector instead of hashing a
+// type_info
+template<typename T>
+std::size_t type_id() {
+    static const std::size_t id = next_type_id();
+    return id;
+}
+
+}
+
+#endif
@@ -24,9 +24,11 @@
 #define SE_TYPED_MAP
 
 #include <iostream>
-#include <unordered_map>
-#include <typeindex>
+#include <cstddef>
 #include <functional>
+#include <vector>
+
+#include "type_id.h"
 
 namespace se {
 
@@ -41,14 +43,14 @@ class typed_map {
 
 private:
 
-    // the map, each type is referenced by it's type_index and cast to void*
-    std::unordered_map<std::type_index, std::pair<void *, std::function<void(void*)>>> map;
+    // the map, each type is stored at the index of its type_id and cast to void*
+    std::vector<std::pair<void *, std::function<void(void*)>>> map;
 
 public:
 
     ~typed_map() {
         for (auto &it : this->map) {
-            it.second.second(it.second.first);
+            if (it.first != nullptr) { it.second(it.first); }
         }
     }
 
@@ -56,14 +58,19 @@ public:
     // the first type parameter is the type of the new object to insert in the map
     // the second is the list of types parameters to instanciate the type
     // the methods parameters are the list of variable to pass to the type instanciation
-    // return false if instanciation failed, true otherwise
+    // return false if instanciation failed or T is already in the map, true otherwise
     template<typename T, class ...A>
     bool add(A... args) {
+        auto id = type_id<T>();
+
+        if (this->exist<T>()) { return false; }
+
         T *inst = new T(args...);
 
         if (inst == nullptr) { return false; }
+        if (id >= this->map.size()) { this->map.resize(id + 1); }
         auto f = deleter<T>;
-        map.emplace(std::type_index(typeid(T)), std::make_pair(inst, f));
+        this->map[id] = std::make_pair(inst, f);
         return true;
     }
 
@@ -71,21 +78,21 @@ public:
     // return nullptr if the type is not inside the map or a pointer to the type instance
     template<typename T>
     T *get() {
-        auto it = this->map.find(std::type_index(typeid(T)));
+        auto id = type_id<T>();
 
-        if (it == this->map.end()) { return nullptr; }
-        return static_cast<T*>(it->second.first);
+        if (id >= this->map.size()) { return nullptr; }
+        return static_cast<T*>(this->map[id].first);
     }
 
     // check if an instance of T is already on the map
     template<typename T>
     bool exist()
-    { return !(this->map.find(std::type_index(typeid(T))) == this->map.end()); }
+    { return this->get<T>() != nullptr; }
 
     template<typename T, class ...A>
     bool apply_while(std::function<bool(T*, A...)> f, A... args) {
         for (auto it = this->map.begin(); it != this->map.end(); ++it) {
-            if (f(static_cast<T*>(it->second.first, args)...) == true) {
+            if (it->first != nullptr && f(static_cast<T*>(it->first), args...) == true) {
                 return true;
             }
         }
@@ -0,0 +1,136 @@
+#include "image_writer.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+namespace graphics
+{
+
+// HELPERS
+namespace
+{
+
+std::array<uint32_t, 256> crcTable()
+{
+	std::array<uint32_t, 256> table;
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		uint32_t c = i;
+		for (int k = 0; k < 8; ++k)
+		{
+			c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		}
+		table[i] = c;
+	}
+	return table;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+	static const std::array<uint32_t, 256> table = crcTable();
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+void appendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back((uint8_t)(value >> 24));
+	out.push_back((uint8_t)(value >> 16));
+	out.push_back((uint8_t)(value >> 8));
+	out.push_back((uint8_t)value);
+}
+
+void appendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+	appendBigEndian(out, (uint32_t)data.size());
+
+	size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data.begin(), data.end());
+
+	appendBigEndian(out, crc32(out.data() + start, out.size() - start));
+}
+
+} // end anonymous namespace
+
+// STATIC FUNCTIONS
+bool ImageWriter::writePNG(const std::string & path, const uint8_t * rgba, uint32_t width, uint32_t height)
+{
+	if (!rgba || width == 0 || height == 0)
+	{
+		return false;
+	}
+
+	// scanlines, each one after its filter type (0, none)
+	size_t rowSize = (size_t)width * 4;
+	std::vector<uint8_t> raw;
+	raw.reserve((rowSize + 1) * height);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), rgba + y * rowSize, rgba + (y + 1) * rowSize);
+	}
+
+	// zlib stream of stored deflate blocks
+	std::vector<uint8_t> idat;
+	idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+	idat.push_back(0x78);
+	idat.push_back(0x01);
+
+	size_t offset = 0;
+	do
+	{
+		uint16_t length = (uint16_t)std::min<size_t>(65535, raw.size() - offset);
+		bool last = offset + length == raw.size();
+
+		idat.push_back(last ? 1 : 0);
+		idat.push_back((uint8_t)length);
+		idat.push_back((uint8_t)(length >> 8));
+		idat.push_back((uint8_t)~length);
+		idat.push_back((uint8_t)(~length >> 8));
+		idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + length);
+
+		offset += length;
+	} while (offset < raw.size());
+
+	uint32_t a = 1, b = 0;
+	for (uint8_t byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	appendBigEndian(idat, (b << 16) | a);
+
+	std::vector<uint8_t> header;
+	appendBigEndian(header, width);
+	appendBigEndian(header, height);
+	// 8 bits depth, RGBA, deflate, adaptive filtering, no interlace
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });
+
+	std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	appendChunk(png, "IHDR", header);
+	appendChunk(png, "IDAT", idat);
+	appendChunk(png, "IEND", {});
+
+	return writeRaw(path, png.data(), png.size());
+}
+
+bool ImageWriter::writeRaw(const std::string & path, const uint8_t * data, size_t size)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	file.write((const char*)data, (std::streamsize)size);
+	return (bool)file;
+}
+
+} // end namespace graphics
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace graphics
+{
+
+/**writes frames read back from the GPU, e.g. by a headless run**/
+class ImageWriter
+{
+public:
+	/**8 bits RGBA PNG, stored without compression: fast to write and no zlib needed, the files are big**/
+	static bool writePNG(const std::string& path, const uint8_t* rgba, uint32_t width, uint32_t height);
+
+	/**the bytes as they are, the size and the format are left to the file name**/
+	static bool writeRaw(const std::string& path, const uint8_t* data, size_t size);
+
+private:
+	ImageWriter() = delete;
+};
+
+} // end namespace graphics
\ No newline at end of file
@@ -78,8 +78,62 @@ std::shared_ptr<VulkanContext> VulkanContext::create(std::shared_ptr<VulkanWindo
 	return context;
 }
 
-bool VulkanContext::initialize()
+std::shared_ptr<VulkanContext> VulkanContext::createHeadless(const vk::Extent2D& resolution,
+															 int frameCount,
+															 vk::QueueFlags queueTypes,
+															 int physicalDeviceID,
+															 bool isDebug)
 {
+	std::shared_ptr<VulkanContext> context(new VulkanContext());
+	context->isDebugMode = isDebug;
+	context->instance = createVulkanInstance(nullptr, isDebug);
+
+	if (!context->instance)
+	{
+		std::cerr << "unable to create vulkan instance.\n";
+		return nullptr;
+	}
+
+	if (isDebug)
+	{
+		context->debugMsgCallback = createDebugCallback(context->instance);
+	}
+
+	auto GPUList = context->instance.enumeratePhysicalDevices();
+
+	if (physicalDeviceID < 0 || physicalDeviceID >= (int)GPUList.size())
+	{
+		std::cerr << "unable to find vulkan physical device (GPUs) " << physicalDeviceID << ".\n";
+		return nullptr;
+	}
+
+	context->device = VulkanDevice::create(GPUList[physicalDeviceID], queueTypes, false);
+
+	context->swapChain = VulkanSwapChain::createOffscreen(context->device, resolution,
+														  context->device->getQueueFamilyIndex(vk::QueueFlagBits::eGraphics),
+														  vk::Format::eB8G8R8A8Unorm, frameCount);
+
+	context->depthResource = VulkanDepthResource::create(resolution, GPUList[physicalDeviceID], context->device->logicalDevice);
+
+	context->defaultRenderPass = VulkanRenderPass::createDefault(context->swapChain, context->depthResource);
+
+	return context;
+}
+
+bool VulkanContext::initialize(bool headless)
+{
+	if (headless)
+	{
+		// no display needed, the vulkan loader is linked
+		if (SDL_Init(SDL_INIT_EVENTS) != 0)
+		{
+			SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
+			return false;
+		}
+
+		return true;
+	}
+
 	if (SDL_Init(SDL_INIT_VIDEO) != 0)
 	{
 		SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
@@ -97,7 +151,10 @@ bool VulkanContext::initialize()
 
 void VulkanContext::shutdown()
 {
-	SDL_Vulkan_UnloadLibrary();
+	if (SDL_WasInit(SDL_INIT_VIDEO))
+	{
+		SDL_Vulkan_UnloadLibrary();
+	}
 	SDL_Quit();
 }
 
@@ -138,10 +195,8 @@ vk::Instance VulkanContext::createVulkanInstance(const std::vector<const char*>&
 
 vk::Instance VulkanContext::createVulkanInstance(std::shared_ptr<VulkanWindow> window, bool enableDebug)
 {
-	assert(window);
-
 	auto vulkanInstanceLayers = std::vector<const char*>();
-	auto vulkanInstanceExtensions = window->requiredVkInstanceExtensions();
+	auto vulkanInstanceExtensions = window ? window->requiredVkInstanceExtensions() : std::vector<const char*>();
 
 	if (enableDebug)
 	{
@@ -42,10 +42,19 @@ public:
 												 int gpuID = 0,
 												 bool debug = true);
 
+	/** headless context, without window nor surface: the swapchain is a ring of offscreen textures (e.g. for servers
+	* and CI, on a software ICD such as lavapipe). Validation is off by default, the layers are rarely installed there */
+	static std::shared_ptr<VulkanContext> createHeadless(const vk::Extent2D& resolution,
+														 int frameCount = 3,
+														 vk::QueueFlags queueTypes = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute,
+														 int gpuID = 0,
+														 bool debug = false);
+
 
 	/****************************************************************************************************************************************************/
 	// STATIC FUNCTIONS
-	static bool initialize();
+	/*headless: without the SDL video subsystem, only the events*/
+	static bool initialize(bool headless = false);
 	static void shutdown();
 
 	static const std::string& EngineName();
@@ -58,6 +67,7 @@ public:
 
 	/*create vulkan instance */
 	static vk::Instance createVulkanInstance(const std::vector<const char*>& instanceLayers, const std::vector<const char*>& instanceExtensions);
+	/*the extensions required by the window, none without window*/
 	static vk::Instance createVulkanInstance(std::shared_ptr<VulkanWindow> window, bool enableDebug = true);
 
 	/*Create & destory Debug Callback*/
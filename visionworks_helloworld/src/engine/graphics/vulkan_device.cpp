@@ -17,6 +17,7 @@ void VulkanDevice::operator=(const VulkanDevice & other)
 	this->queueFamilyProperties = other.queueFamilyProperties;
 	this->supportedExtensions = other.supportedExtensions;
 	this->queueFamilyIndices = other.queueFamilyIndices;
+	this->swapChainEnabled = other.swapChainEnabled;
 
 	this->graphicsCmdPool = other.graphicsCmdPool;
 }
@@ -32,6 +33,7 @@ void VulkanDevice::operator=(VulkanDevice && other)
 	this->queueFamilyProperties = other.queueFamilyProperties;
 	this->supportedExtensions = other.supportedExtensions;
 	this->queueFamilyIndices = other.queueFamilyIndices;
+	this->swapChainEnabled = other.swapChainEnabled;
 
 	this->graphicsCmdPool = other.graphicsCmdPool;
 }
@@ -84,16 +86,19 @@ void VulkanDevice::createLogicalDevice()
 
 	// add swapchain extension
 	std::vector<const char*> deviceExtensions;
-	for (const auto& elem : supportedExtensions)
+	if (swapChainEnabled)
 	{
-		if (elem == std::string(VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+		for (const auto& elem : supportedExtensions)
 		{
-			deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+			if (elem == std::string(VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+			{
+				deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+			}
+		}
+		if (deviceExtensions.empty())
+		{
+			throw std::runtime_error("no swap chain exists, this gpu does not support swap chain");
 		}
-	}
-	if (deviceExtensions.empty())
-	{
-		throw std::runtime_error("no swap chain exists, this gpu does not support swap chain");
 	}
 
 
@@ -127,7 +132,7 @@ void VulkanDevice::createLogicalDevice()
 }
 
 // MEMBER FUNCTIONS
-VulkanDevice::VulkanDevice(const vk::PhysicalDevice & device, vk::QueueFlags queueFlgas)
+VulkanDevice::VulkanDevice(const vk::PhysicalDevice & device, vk::QueueFlags queueFlgas, bool enableSwapChain)
 {
 	this->physicalDevice = device;
 
@@ -145,6 +150,7 @@ VulkanDevice::VulkanDevice(const vk::PhysicalDevice & device, vk::QueueFlags que
 	assert(queueFamilyProperties.size() > 0);
 	// type of queue enabled
 	this->queueFlags = queueFlgas;
+	this->swapChainEnabled = enableSwapChain;
 	// Get list of supported device levels extensions
 	auto deviceExtensions = physicalDevice.enumerateDeviceExtensionProperties();
 	for (auto ext : deviceExtensions)
@@ -209,9 +215,9 @@ vk::CommandPool VulkanDevice::createCmdPool(uint32_t queueFamilyIndex, vk::Comma
 	return VulkanHelper::createCommandPool(logicalDevice, queueFamilyIndex, createFlags);
 }
 
-std::shared_ptr<VulkanDevice> VulkanDevice::create(const vk::PhysicalDevice & device, vk::QueueFlags queueFlags)
+std::shared_ptr<VulkanDevice> VulkanDevice::create(const vk::PhysicalDevice & device, vk::QueueFlags queueFlags, bool enableSwapChain)
 {
-	return std::shared_ptr<VulkanDevice>(new VulkanDevice(device, queueFlags));
+	return std::shared_ptr<VulkanDevice>(new VulkanDevice(device, queueFlags, enableSwapChain));
 }
 
 } //end namespace graphics
\ No newline at end of file
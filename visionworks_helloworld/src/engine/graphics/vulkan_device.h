@@ -45,6 +45,9 @@ public:
 
 	vk::QueueFlags queueFlags = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute | vk::QueueFlagBits::eTransfer;
 
+	/** @brief VK_KHR_swapchain is enabled, the offscreen rendering doesn't need it */
+	bool swapChainEnabled = true;
+
 	/**  @brief Typecast to VkDevice */
 	operator vk::Device() { return logicalDevice; };
 
@@ -61,7 +64,7 @@ public:
 	vk::CommandPool createCmdPool(uint32_t queueFamilyIndex, vk::CommandPoolCreateFlags createFlags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
 
 	/**static create function**/
-	static std::shared_ptr<VulkanDevice> create(const vk::PhysicalDevice& device, vk::QueueFlags queueFlags);
+	static std::shared_ptr<VulkanDevice> create(const vk::PhysicalDevice& device, vk::QueueFlags queueFlags, bool enableSwapChain = true);
 
 private:
 
@@ -69,7 +72,7 @@ private:
 	VulkanDevice(VulkanDevice&&) = delete;
 
 	VulkanDevice() {};
-	VulkanDevice(const vk::PhysicalDevice& device, vk::QueueFlags queueFlags);
+	VulkanDevice(const vk::PhysicalDevice& device, vk::QueueFlags queueFlags, bool enableSwapChain);
 	void operator=(const VulkanDevice& other);
 	void operator=(VulkanDevice&& other);
 
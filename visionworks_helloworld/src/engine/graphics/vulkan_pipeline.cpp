@@ -194,10 +194,12 @@ void VulkanGraphicsPipeline::setColorBlendState(bool logicOpEnabled, vk::LogicOp
 	{
 		std::cout << "no attachments specified...use default settings.\n";
 
-		// color blend should not include depth 
+		// one blend state per color attachment, whatever its final layout (present, or transfer source
+		// for the offscreen images of the headless mode); depth and stencil attachments are not blended
 		for (int i = 0; i < (int)renderPass->attachments.size(); ++i)
 		{
-			if (renderPass->attachments[i].finalLayout == vk::ImageLayout::ePresentSrcKHR)
+			const vk::Format format = renderPass->attachments[i].format;
+			if (!VulkanHelper::isDepthFormat(format) && !VulkanHelper::isStencilFormat(format))
 			{
 				vk::PipelineColorBlendAttachmentState pipeColorBlendAttachment;
 
@@ -79,7 +79,7 @@ std::shared_ptr<VulkanRenderPass> VulkanRenderPass::createDefault(std::shared_pt
 	attachments[AttachmentKey::COLOR].setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
 	attachments[AttachmentKey::COLOR].setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
 	attachments[AttachmentKey::COLOR].setInitialLayout(vk::ImageLayout::eUndefined);
-	attachments[AttachmentKey::COLOR].setFinalLayout(vk::ImageLayout::ePresentSrcKHR);
+	attachments[AttachmentKey::COLOR].setFinalLayout(swapChain->presentLayout);
 
 	attachments[AttachmentKey::DEPTH].setFormat(depth->format);
 	attachments[AttachmentKey::DEPTH].setSamples(vk::SampleCountFlagBits::e1);
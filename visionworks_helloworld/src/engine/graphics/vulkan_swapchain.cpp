@@ -1,7 +1,12 @@
 #include "vulkan_swapchain.h"
+#include <algorithm>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <iostream>
 #include "vulkan_helper.h"
+#include "vulkan_device.h"
+#include "vulkan_texture.h"
+#include "vulkan_buffer.h"
 
 namespace graphics
 {
@@ -19,6 +24,27 @@ VulkanSwapChain::~VulkanSwapChain()
 		});
 		swapChain = nullptr;
 	}
+
+	if (d_device)
+	{
+		for (const auto& fence : d_readbackFences)
+		{
+			logicalDevice.destroyFence(fence);
+		}
+		d_readbackFences.clear();
+
+		if (d_readbackPool)
+		{
+			logicalDevice.destroyCommandPool(d_readbackPool);
+			d_readbackPool = nullptr;
+		}
+
+		// the image views belong to the textures
+		d_readbackBuffers.clear();
+		d_targets.clear();
+		buffers.clear();
+		d_device = nullptr;
+	}
 }
 
 std::shared_ptr<VulkanSwapChain> VulkanSwapChain::create(const vk::PhysicalDevice & physicalDevice,
@@ -218,8 +244,66 @@ std::shared_ptr<VulkanSwapChain> VulkanSwapChain::create(const vk::PhysicalDevic
 	return data;
 }
 
+std::shared_ptr<VulkanSwapChain> VulkanSwapChain::createOffscreen(std::shared_ptr<VulkanDevice> device,
+																 const vk::Extent2D & resolution,
+																 uint32_t graphicsQueueIndex,
+																 vk::Format format,
+																 int frameCount)
+{
+	assert(device && vk::Device(*device));
+
+	std::shared_ptr<VulkanSwapChain> data(new VulkanSwapChain());
+	data->d_device = device;
+	data->logicalDevice = vk::Device(*device);
+	data->colorFormat = format;
+	data->surfaceFormat = vk::SurfaceFormatKHR(format, data->colorSpace);
+	data->actualExtent = resolution;
+	// a readback is done with an image once the next one is presented
+	data->frameCount = std::max(frameCount, 2);
+	data->presentMode = vk::PresentModeKHR::eImmediate;
+	data->presentQueueIndex = graphicsQueueIndex;
+	data->presentLayout = vk::ImageLayout::eTransferSrcOptimal;
+	data->d_queue = device->queue(graphicsQueueIndex);
+
+	data->buffers.resize(data->frameCount);
+	for (int i = 0; i < data->frameCount; ++i)
+	{
+		auto target = VulkanTexture::create(device, format, vk::Extent3D(resolution.width, resolution.height, 1),
+											vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+											vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+		data->buffers[i].imageSubresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+		data->buffers[i].image = target->image;
+		data->buffers[i].imageView = target->acquireImageView(vk::ImageViewType::e2D,
+			vk::ComponentMapping(vk::ComponentSwizzle::eR, vk::ComponentSwizzle::eG, vk::ComponentSwizzle::eB, vk::ComponentSwizzle::eA),
+			data->buffers[i].imageSubresourceRange);
+
+		data->d_targets.push_back(target);
+	}
+
+	return data;
+}
+
 uint32_t VulkanSwapChain::acquireNewFrame(vk::Semaphore sema, vk::Fence fence)
 {
+	if (isOffscreen())
+	{
+		// Nothing to wait for: the semaphore is signaled by an empty submission, after the commands
+		// submitted before, so the last use of the image (render and readback) is done when it is
+		uint32_t index = d_nextImage;
+		d_nextImage = (d_nextImage + 1) % (uint32_t)frameCount;
+
+		vk::SubmitInfo submitInfo;
+		if (sema)
+		{
+			submitInfo.setSignalSemaphoreCount(1);
+			submitInfo.setPSignalSemaphores(&sema);
+		}
+		d_queue.submit(submitInfo, fence);
+
+		return index;
+	}
+
 	assert(logicalDevice && swapChain);
 	auto val = logicalDevice.acquireNextImageKHR(swapChain, UINT64_MAX, sema, fence);
 #ifdef _DEBUG
@@ -230,6 +314,39 @@ uint32_t VulkanSwapChain::acquireNewFrame(vk::Semaphore sema, vk::Fence fence)
 
 void VulkanSwapChain::queuePresent(vk::Queue queue, uint32_t imageIndex, vk::Semaphore waitSemaphore)
 {
+	if (isOffscreen())
+	{
+		assert(imageIndex < (uint32_t)frameCount);
+
+		// The submission consumes the semaphore, as the presentation would, and copies the image
+		// to host memory if a readback was requested
+		vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eTransfer;
+		vk::SubmitInfo submitInfo;
+		if (waitSemaphore)
+		{
+			submitInfo.setWaitSemaphoreCount(1);
+			submitInfo.setPWaitSemaphores(&waitSemaphore);
+			submitInfo.setPWaitDstStageMask(&waitStage);
+		}
+
+		vk::Fence fence = nullptr;
+		if (d_readbackRequested)
+		{
+			fence = d_readbackFences[imageIndex];
+			logicalDevice.waitForFences(1, &fence, VK_TRUE, UINT64_MAX);
+			logicalDevice.resetFences(1, &fence);
+
+			submitInfo.setCommandBufferCount(1);
+			submitInfo.setPCommandBuffers(&d_readbackCommands[imageIndex]);
+
+			d_readbackRequested = false;
+			d_lastReadbackImage = (int)imageIndex;
+		}
+
+		queue.submit(submitInfo, fence);
+		return;
+	}
+
 	vk::PresentInfoKHR presentInfo;
 	presentInfo.setSwapchainCount(1);
 	presentInfo.setPSwapchains(&swapChain);
@@ -244,4 +361,87 @@ void VulkanSwapChain::queuePresent(vk::Queue queue, uint32_t imageIndex, vk::Sem
 	queue.presentKHR(presentInfo);
 }
 
+bool VulkanSwapChain::isOffscreen() const
+{
+	return !d_targets.empty();
+}
+
+void VulkanSwapChain::requestReadback()
+{
+	assert(isOffscreen());
+
+	if (d_readbackCommands.empty())
+	{
+		createReadbackResources();
+	}
+
+	d_readbackRequested = true;
+	d_lastReadbackImage = -1;
+}
+
+int VulkanSwapChain::lastReadbackImage() const
+{
+	return d_lastReadbackImage;
+}
+
+bool VulkanSwapChain::readFrame(uint32_t imageIndex, std::vector<uint8_t>& pixels)
+{
+	if (!isOffscreen() || imageIndex >= d_readbackBuffers.size())
+	{
+		return false;
+	}
+
+	if (logicalDevice.waitForFences(1, &d_readbackFences[imageIndex], VK_TRUE, UINT64_MAX) != vk::Result::eSuccess)
+	{
+		return false;
+	}
+
+	auto& buffer = d_readbackBuffers[imageIndex];
+	pixels.resize((size_t)buffer->size);
+
+	auto mapped = buffer->map();
+	memcpy(pixels.data(), mapped, pixels.size());
+	buffer->unmap();
+
+	return true;
+}
+
+void VulkanSwapChain::createReadbackResources()
+{
+	assert(d_device && d_readbackCommands.empty());
+	assert((colorFormat == vk::Format::eB8G8R8A8Unorm || colorFormat == vk::Format::eR8G8B8A8Unorm ||
+			colorFormat == vk::Format::eB8G8R8A8Srgb || colorFormat == vk::Format::eR8G8B8A8Srgb) && "unsupported readback format");
+
+	// 8 bits per channel formats, as the render pass can target
+	vk::DeviceSize size = (vk::DeviceSize)actualExtent.width * actualExtent.height * 4;
+
+	d_readbackPool = d_device->createCmdPool(presentQueueIndex);
+	d_readbackCommands = logicalDevice.allocateCommandBuffers(
+		vk::CommandBufferAllocateInfo(d_readbackPool, vk::CommandBufferLevel::ePrimary, frameCount));
+
+	for (int i = 0; i < frameCount; ++i)
+	{
+		auto buffer = VulkanBuffer::create(d_device, (size_t)size, vk::BufferUsageFlagBits::eTransferDst,
+										   vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+		d_readbackBuffers.push_back(buffer);
+		d_readbackFences.push_back(logicalDevice.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled)));
+
+		// The image is in presentLayout at the end of the render pass
+		auto& command = d_readbackCommands[i];
+		command.begin(vk::CommandBufferBeginInfo());
+		{
+			vk::BufferImageCopy region;
+			region.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1));
+			region.setImageExtent(vk::Extent3D(actualExtent.width, actualExtent.height, 1));
+			command.copyImageToBuffer(buffers[i].image, presentLayout, buffer->buffer, region);
+
+			vk::BufferMemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead,
+											VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, buffer->buffer, 0, VK_WHOLE_SIZE);
+			command.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+									vk::DependencyFlags(), nullptr, barrier, nullptr);
+		}
+		command.end();
+	}
+}
+
 } // end namespace graphics
\ No newline at end of file
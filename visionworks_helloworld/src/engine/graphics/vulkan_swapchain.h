@@ -4,6 +4,14 @@
 namespace graphics
 {
 
+class VulkanDevice;
+class VulkanTexture;
+class VulkanBuffer;
+
+/**
+* Presents to a window surface, or renders into a ring of offscreen textures (createOffscreen) when there is
+* no display, e.g. on servers and CI. Both are used the same way: acquireNewFrame, submit, queuePresent.
+*/
 class VulkanSwapChain
 {
 public:
@@ -28,6 +36,9 @@ public:
 	vk::PresentModeKHR presentMode;
 	vk::SurfaceFormatKHR surfaceFormat;
 
+	/** @brief layout of the images at the end of the default render pass */
+	vk::ImageLayout presentLayout = vk::ImageLayout::ePresentSrcKHR;
+
 	vk::Device logicalDevice = nullptr;
 	std::vector<SwapChainBuffers> buffers;
 	vk::SwapchainKHR swapChain = nullptr;
@@ -43,10 +54,29 @@ public:
 												   vk::SwapchainKHR oldSwapChain = nullptr,
 												   int frameCount = 3, int imageArrayLayers = 1);
 
+	/**ring of frameCount (2 at least) color textures, no surface nor VK_KHR_swapchain needed**/
+	static std::shared_ptr<VulkanSwapChain> createOffscreen(std::shared_ptr<VulkanDevice> device,
+															const vk::Extent2D& resolution,
+															uint32_t graphicsQueueIndex,
+															vk::Format format = vk::Format::eB8G8R8A8Unorm,
+															int frameCount = 3);
+
 	// MEMBER FUNCTIONS
 	uint32_t acquireNewFrame(vk::Semaphore sema, vk::Fence fence = nullptr);
 	void queuePresent(vk::Queue queue, uint32_t imageIndex, vk::Semaphore waitSemaphore = nullptr);
 
+	// OFFSCREEN FUNCTIONS
+	bool isOffscreen() const;
+
+	/**copy the next presented image to host memory, read by readFrame**/
+	void requestReadback();
+
+	/**@ return the image copied by the last readback, -1 if none since requestReadback**/
+	int lastReadbackImage() const;
+
+	/**wait for the readback of the image, pixels are tightly packed rows in surfaceFormat.format**/
+	bool readFrame(uint32_t imageIndex, std::vector<uint8_t>& pixels);
+
 private:
 	VulkanSwapChain(const VulkanSwapChain&) = delete;
 	VulkanSwapChain(VulkanSwapChain&&) = delete;
@@ -55,6 +85,20 @@ private:
 
 	VulkanSwapChain() {};
 
+	// offscreen ring, the readback resources are created by the first requestReadback
+	std::shared_ptr<VulkanDevice> d_device;
+	std::vector<std::shared_ptr<VulkanTexture>> d_targets;
+	vk::Queue d_queue;
+	uint32_t d_nextImage = 0;
+
+	vk::CommandPool d_readbackPool;
+	std::vector<vk::CommandBuffer> d_readbackCommands;
+	std::vector<vk::Fence> d_readbackFences;
+	std::vector<std::shared_ptr<VulkanBuffer>> d_readbackBuffers;
+	bool d_readbackRequested = false;
+	int d_lastReadbackImage = -1;
+
+	void createReadbackResources();
 
 };
 
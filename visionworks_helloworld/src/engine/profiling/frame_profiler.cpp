@@ -0,0 +1,223 @@
+#include "frame_profiler.h"
+#include <assert.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace profiling
+{
+
+// HELPERS
+namespace
+{
+
+// The names are literals of the engine, still they must not break the JSON
+std::string escapeJson(const char* text)
+{
+	std::string out;
+	for (const char* c = text; c && *c; ++c)
+	{
+		switch (*c)
+		{
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		default:
+			if ((unsigned char)*c < 0x20)
+			{
+				char code[8];
+				std::snprintf(code, sizeof(code), "\\u%04x", (unsigned)*c);
+				out += code;
+			}
+			else
+			{
+				out += *c;
+			}
+		}
+	}
+	return out;
+}
+
+void writeTraceEvent(std::ofstream& file, bool& first, const TimedRange& range, double frameStartMs, int track)
+{
+	char numbers[96];
+	// microseconds
+	std::snprintf(numbers, sizeof(numbers), "\"ts\":%.3f,\"dur\":%.3f", 1000.0 * (frameStartMs + range.beginMs),
+				  1000.0 * std::max(0.0, range.endMs - range.beginMs));
+
+	file << (first ? "" : ",\n") << "{\"name\":\"" << escapeJson(range.name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << track
+		<< "," << numbers << "}";
+	first = false;
+}
+
+} // end anonymous namespace
+
+// MEMBERS
+FrameProfiler::FrameProfiler(size_t frameCapacity)
+	: d_records(std::max<size_t>(frameCapacity, 1))
+	, d_origin(Clock::now())
+{
+	for (auto& record : d_records)
+	{
+		record.cpuRanges.reserve(64);
+		record.gpuRanges.reserve(16);
+	}
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+	d_enabled = enabled;
+}
+
+bool FrameProfiler::enabled() const
+{
+	return d_enabled;
+}
+
+void FrameProfiler::beginFrame(uint64_t frameNumber)
+{
+	assert(!d_recording && "endFrame is missing");
+
+	d_frameNumber = frameNumber;
+	if (!d_enabled)
+	{
+		return;
+	}
+
+	d_current = (d_current + 1) % d_records.size();
+	d_frameStart = Clock::now();
+	d_depth = 0;
+	d_recording = true;
+
+	auto& record = d_records[d_current];
+	record.frameNumber = frameNumber;
+	record.startMs = std::chrono::duration<double, std::milli>(d_frameStart - d_origin).count();
+	record.durationMs = 0.0;
+	record.cpuRanges.clear();
+	record.gpuRanges.clear();
+}
+
+void FrameProfiler::endFrame()
+{
+	if (!d_recording)
+	{
+		return;
+	}
+
+	d_records[d_current].durationMs = sinceFrameStart();
+	d_recording = false;
+	d_completed = std::min(d_completed + 1, d_records.size());
+}
+
+uint64_t FrameProfiler::frameNumber() const
+{
+	return d_frameNumber;
+}
+
+size_t FrameProfiler::beginRange(const char* name)
+{
+	assert(d_recording);
+
+	auto& ranges = d_records[d_current].cpuRanges;
+	double now = sinceFrameStart();
+	ranges.push_back(TimedRange{ name, now, now, d_depth++ });
+	return ranges.size() - 1;
+}
+
+void FrameProfiler::endRange(size_t index)
+{
+	// the frame ended inside the scope
+	if (!d_recording)
+	{
+		return;
+	}
+
+	auto& ranges = d_records[d_current].cpuRanges;
+	assert(index < ranges.size());
+	ranges[index].endMs = sinceFrameStart();
+	d_depth--;
+}
+
+void FrameProfiler::addGpuRange(uint64_t frameNumber, const char* name, double beginMs, double endMs)
+{
+	for (size_t age = 0; age < recordCount(); ++age)
+	{
+		auto& record = d_records[recordIndex(age)];
+		if (record.frameNumber == frameNumber)
+		{
+			record.gpuRanges.push_back(TimedRange{ name, beginMs, endMs, 0 });
+			return;
+		}
+	}
+}
+
+size_t FrameProfiler::recordCount() const
+{
+	// the oldest record is reused while recording
+	return d_recording ? std::min(d_completed, d_records.size() - 1) : d_completed;
+}
+
+const FrameRecord& FrameProfiler::record(size_t age) const
+{
+	assert(age < recordCount());
+	return d_records[recordIndex(age)];
+}
+
+void FrameProfiler::clear()
+{
+	assert(!d_recording);
+	d_completed = 0;
+}
+
+bool FrameProfiler::writeChromeTrace(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+	bool first = false;
+
+	// oldest first
+	for (size_t age = recordCount(); age-- > 0;)
+	{
+		const auto& frame = record(age);
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "frame %llu", (unsigned long long)frame.frameNumber);
+		writeTraceEvent(file, first, TimedRange{ name, 0.0, frame.durationMs, 0 }, frame.startMs, 0);
+
+		for (const auto& range : frame.cpuRanges)
+		{
+			writeTraceEvent(file, first, range, frame.startMs, 0);
+		}
+		for (const auto& range : frame.gpuRanges)
+		{
+			writeTraceEvent(file, first, range, frame.startMs, 1);
+		}
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return (bool)file;
+}
+
+size_t FrameProfiler::recordIndex(size_t age) const
+{
+	// the current record is not complete while recording
+	size_t last = d_recording ? d_current + d_records.size() - 1 : d_current;
+	return (last + d_records.size() - age) % d_records.size();
+}
+
+double FrameProfiler::sinceFrameStart() const
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - d_frameStart).count();
+}
+
+} // end namespace profiling
\ No newline at end of file
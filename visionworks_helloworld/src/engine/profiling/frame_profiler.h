@@ -0,0 +1,120 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace profiling
+{
+
+// A timed part of a frame, in milliseconds from the start of the frame
+struct TimedRange
+{
+	// Static string (e.g. a literal), only the pointer is kept
+	const char* name;
+	double beginMs;
+	double endMs;
+	// Nesting of the CPU scopes, 0 for the outermost ones
+	int depth;
+};
+
+struct FrameRecord
+{
+	uint64_t frameNumber = 0;
+	// Start of the frame, from the start of the profiler
+	double startMs = 0.0;
+	double durationMs = 0.0;
+	std::vector<TimedRange> cpuRanges;
+	// Filled once the GPU is done with the frame, a few frames later
+	std::vector<TimedRange> gpuRanges;
+};
+
+// Per-frame timings of the engine: the CPU scopes (ProfileScope) and the GPU passes (GpuTimer) of the last
+// frames, kept in a ring of records which are reused, so a frame recorded doesn't allocate once warmed up.
+// Disabled, a scope costs a branch. Used from the thread of the main loop only.
+class FrameProfiler
+{
+public:
+	explicit FrameProfiler(size_t frameCapacity = 240);
+
+	// Takes effect at the next frame
+	void setEnabled(bool enabled);
+	bool enabled() const;
+	// True between beginFrame and endFrame of an enabled frame
+	bool recording() const { return d_recording; }
+
+	void beginFrame(uint64_t frameNumber);
+	void endFrame();
+	// Number of the frame begun last, recorded or not
+	uint64_t frameNumber() const;
+
+	// Used by ProfileScope, returns the index of the range
+	size_t beginRange(const char* name);
+	void endRange(size_t index);
+
+	// Add the time of a GPU pass to the record of the frame, if it is still in the ring
+	void addGpuRange(uint64_t frameNumber, const char* name, double beginMs, double endMs);
+
+	// Completed frames in the ring
+	size_t recordCount() const;
+	// 0 for the last completed frame, up to recordCount() - 1
+	const FrameRecord& record(size_t age) const;
+
+	void clear();
+
+	// Chrome trace (chrome://tracing, Perfetto) of the frames in the ring: the CPU ranges on one track and the GPU passes
+	// on another, each frame of the GPU aligned to the start of the frame
+	bool writeChromeTrace(const std::string& path) const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	std::vector<FrameRecord> d_records;
+	size_t d_current = 0;
+	size_t d_completed = 0;
+	uint64_t d_frameNumber = 0;
+	bool d_enabled = false;
+	bool d_recording = false;
+	int d_depth = 0;
+	Clock::time_point d_origin;
+	Clock::time_point d_frameStart;
+
+	size_t recordIndex(size_t age) const;
+	double sinceFrameStart() const;
+};
+
+// Times its scope into the frame of the profiler; nothing is read nor written if the profiler is null or not recording
+class ProfileScope
+{
+public:
+	ProfileScope(FrameProfiler* profiler, const char* name)
+		: d_profiler(profiler && profiler->recording() ? profiler : nullptr)
+	{
+		if (d_profiler)
+		{
+			d_index = d_profiler->beginRange(name);
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (d_profiler)
+		{
+			d_profiler->endRange(d_index);
+		}
+	}
+
+private:
+	FrameProfiler* d_profiler;
+	size_t d_index = 0;
+
+	ProfileScope(const ProfileScope&) = delete;
+	void operator=(const ProfileScope&) = delete;
+};
+
+} // end namespace profiling
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// Times the rest of the block, e.g. PROFILE_SCOPE(profiler(), "update")
+#define PROFILE_SCOPE(profiler, name) profiling::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)((profiler), (name))
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "gpu_timer.h"
+#include <assert.h>
+#include <algorithm>
+#include "frame_profiler.h"
+#include "../graphics/vulkan_device.h"
+
+namespace profiling
+{
+
+GpuTimer::GpuTimer(std::shared_ptr<graphics::VulkanDevice> device, uint32_t framesInFlight, uint32_t maxPasses)
+	: d_device(device)
+	, d_maxPasses(maxPasses)
+{
+	assert(device && framesInFlight > 0 && maxPasses > 0);
+
+	uint32_t validBits = device->queueFamilyProperties[device->queueFamilyIndices.graphics].timestampValidBits;
+	if (validBits == 0)
+	{
+		return;
+	}
+
+	d_timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+	d_timestampPeriod = device->properties.limits.timestampPeriod;
+	d_results.resize(4 * (size_t)maxPasses);
+
+	d_frames.resize(framesInFlight);
+	for (auto& frame : d_frames)
+	{
+		frame.pool = device->logicalDevice.createQueryPool(vk::QueryPoolCreateInfo(vk::QueryPoolCreateFlags(), vk::QueryType::eTimestamp, 2 * maxPasses));
+	}
+
+	// The queries are unavailable until written, for collect to leave out the passes not recorded in the first frames
+	auto command = device->logicalDevice.allocateCommandBuffers(
+		vk::CommandBufferAllocateInfo(device->graphicsCmdPool, vk::CommandBufferLevel::ePrimary, 1))[0];
+	command.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	for (auto& frame : d_frames)
+	{
+		command.resetQueryPool(frame.pool, 0, 2 * maxPasses);
+	}
+	command.end();
+
+	vk::SubmitInfo info;
+	info.commandBufferCount = 1;
+	info.pCommandBuffers = &command;
+	auto queue = device->queue(device->queueFamilyIndices.graphics);
+	queue.submit(info, nullptr);
+	queue.waitIdle();
+
+	device->logicalDevice.freeCommandBuffers(device->graphicsCmdPool, 1, &command);
+}
+
+GpuTimer::~GpuTimer()
+{
+	for (auto& frame : d_frames)
+	{
+		d_device->logicalDevice.destroyQueryPool(frame.pool);
+	}
+}
+
+bool GpuTimer::supported() const
+{
+	return !d_frames.empty();
+}
+
+uint32_t GpuTimer::addPass(const char* name)
+{
+	assert(d_passes.size() < d_maxPasses && "too many passes");
+	d_passes.push_back(name);
+	return (uint32_t)d_passes.size() - 1;
+}
+
+void GpuTimer::reset(vk::CommandBuffer command, uint32_t frameInFlight)
+{
+	if (!supported())
+	{
+		return;
+	}
+
+	assert(frameInFlight < d_frames.size());
+	command.resetQueryPool(d_frames[frameInFlight].pool, 0, 2 * d_maxPasses);
+}
+
+void GpuTimer::begin(vk::CommandBuffer command, uint32_t frameInFlight, uint32_t pass)
+{
+	if (!supported())
+	{
+		return;
+	}
+
+	assert(frameInFlight < d_frames.size() && pass < d_passes.size());
+	command.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, d_frames[frameInFlight].pool, 2 * pass);
+}
+
+void GpuTimer::end(vk::CommandBuffer command, uint32_t frameInFlight, uint32_t pass)
+{
+	if (!supported())
+	{
+		return;
+	}
+
+	assert(frameInFlight < d_frames.size() && pass < d_passes.size());
+	command.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, d_frames[frameInFlight].pool, 2 * pass + 1);
+}
+
+void GpuTimer::submitted(uint32_t frameInFlight, uint64_t frameNumber)
+{
+	if (!supported())
+	{
+		return;
+	}
+
+	assert(frameInFlight < d_frames.size());
+	d_frames[frameInFlight].frameNumber = frameNumber;
+	d_frames[frameInFlight].pending = true;
+}
+
+void GpuTimer::collect(uint32_t frameInFlight, FrameProfiler& profiler)
+{
+	if (!supported() || d_passes.empty())
+	{
+		return;
+	}
+
+	assert(frameInFlight < d_frames.size());
+	auto& frame = d_frames[frameInFlight];
+	if (!frame.pending)
+	{
+		return;
+	}
+	frame.pending = false;
+
+	if (!profiler.enabled())
+	{
+		return;
+	}
+
+	// eNotReady when some passes were not recorded, their availability is 0
+	uint32_t queryCount = 2 * (uint32_t)d_passes.size();
+	d_device->logicalDevice.getQueryPoolResults(frame.pool, 0, queryCount, 2 * queryCount * sizeof(uint64_t), d_results.data(),
+												2 * sizeof(uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+
+	auto available = [this](uint32_t query) { return d_results[2 * query + 1] != 0; };
+	auto timestamp = [this](uint32_t query) { return d_results[2 * query] & d_timestampMask; };
+
+	// The passes are placed from the first one of the frame
+	bool any = false;
+	uint64_t origin = 0;
+	for (uint32_t pass = 0; pass < d_passes.size(); ++pass)
+	{
+		if (available(2 * pass) && available(2 * pass + 1))
+		{
+			origin = any ? std::min(origin, timestamp(2 * pass)) : timestamp(2 * pass);
+			any = true;
+		}
+	}
+
+	for (uint32_t pass = 0; pass < d_passes.size() && any; ++pass)
+	{
+		if (!available(2 * pass) || !available(2 * pass + 1))
+		{
+			continue;
+		}
+
+		double begin = ((timestamp(2 * pass) - origin) & d_timestampMask) * d_timestampPeriod / 1e6;
+		double end = ((timestamp(2 * pass + 1) - origin) & d_timestampMask) * d_timestampPeriod / 1e6;
+		profiler.addGpuRange(frame.frameNumber, d_passes[pass], begin, end);
+	}
+}
+
+} // end namespace profiling
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace graphics { class VulkanDevice; }
+
+namespace profiling
+{
+
+class FrameProfiler;
+
+// GPU time of the passes of a frame, by timestamp queries: one query pool per frame in flight, so the results of a
+// frame are read once its fence is waited, without stalling. The commands may be recorded once and submitted again.
+class GpuTimer
+{
+public:
+	GpuTimer(std::shared_ptr<graphics::VulkanDevice> device, uint32_t framesInFlight, uint32_t maxPasses = 16);
+	~GpuTimer();
+
+	// False if the graphics queue has no timestamps, the other functions then do nothing
+	bool supported() const;
+
+	// Register a pass, its name is a static string (e.g. a literal)
+	uint32_t addPass(const char* name);
+
+	// Record in the first command buffer of the frame, outside a render pass, before the passes
+	void reset(vk::CommandBuffer command, uint32_t frameInFlight);
+	void begin(vk::CommandBuffer command, uint32_t frameInFlight, uint32_t pass);
+	void end(vk::CommandBuffer command, uint32_t frameInFlight, uint32_t pass);
+
+	// The commands of the frame in flight were submitted for the frame number
+	void submitted(uint32_t frameInFlight, uint64_t frameNumber);
+
+	// Once the fence of the frame in flight is waited: add the times of its passes to the frame of the profiler.
+	// A pass not recorded in the frame is left out.
+	void collect(uint32_t frameInFlight, FrameProfiler& profiler);
+
+private:
+	struct FrameQueries
+	{
+		vk::QueryPool pool;
+		uint64_t frameNumber = 0;
+		bool pending = false;
+	};
+
+	std::shared_ptr<graphics::VulkanDevice> d_device;
+	std::vector<FrameQueries> d_frames;
+	std::vector<const char*> d_passes;
+	// value and availability of each query
+	std::vector<uint64_t> d_results;
+	uint32_t d_maxPasses;
+	uint64_t d_timestampMask = 0;
+	// nanoseconds per tick
+	double d_timestampPeriod = 0.0;
+
+	GpuTimer(const GpuTimer&) = delete;
+	void operator=(const GpuTimer&) = delete;
+};
+
+} // end namespace profiling
\ No newline at end of file
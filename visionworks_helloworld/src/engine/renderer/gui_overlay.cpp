@@ -35,13 +35,18 @@ GuiOverlay::GuiOverlay(std::shared_ptr<se::dispatcher> dispatcher, std::shared_p
 
 GuiOverlay::~GuiOverlay()
 {
+	d_eventSubscription.reset();
+
 	if (!d_commands.empty())
 	{
 		vk::Device(*d_context->device).freeCommandBuffers(d_context->device->graphicsCmdPool, d_commands);
 		d_commands.clear();
 
 		ImGui_ImplVulkan_Shutdown();
-		ImGui_ImplSDL2_Shutdown();
+		if (d_context->window)
+		{
+			ImGui_ImplSDL2_Shutdown();
+		}
 		ImGui::DestroyContext();
 	}
 }
@@ -49,7 +54,17 @@ GuiOverlay::~GuiOverlay()
 void GuiOverlay::startFrame()
 {
 	ImGui_ImplVulkan_NewFrame();
-	ImGui_ImplSDL2_NewFrame((SDL_Window*)d_context->window->intenalPointer());
+	if (d_context->window)
+	{
+		ImGui_ImplSDL2_NewFrame((SDL_Window*)d_context->window->intenalPointer());
+	}
+	else
+	{
+		// Headless: a constant step keeps the frames read back reproducible
+		ImGuiIO& io = ImGui::GetIO();
+		io.DisplaySize = ImVec2((float)d_context->swapChain->actualExtent.width, (float)d_context->swapChain->actualExtent.height);
+		io.DeltaTime = 1.0f / 60.0f;
+	}
 	ImGui::NewFrame();
 }
 
@@ -60,17 +75,12 @@ void GuiOverlay::endFrame()
 
 void GuiOverlay::initData()
 {
-	d_dispatcher->listen_any([](const se::any_event& ev) {
-		if (se::is<SDL_Event>(ev))
-		{
-			auto real_ev = se::into<SDL_Event>(ev);
-			ImGui_ImplSDL2_ProcessEvent(&real_ev);
-		}
-	});
-
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO(); (void)io;
-	ImGui_ImplSDL2_InitForVulkan((SDL_Window*)d_context->window->intenalPointer());
+	if (d_context->window)
+	{
+		ImGui_ImplSDL2_InitForVulkan((SDL_Window*)d_context->window->intenalPointer());
+	}
 	ImGui_ImplVulkan_Init(&d_init_info, vk::RenderPass(*d_context->defaultRenderPass));
 	ImGui::StyleColorsDark();
 
@@ -98,6 +108,29 @@ void GuiOverlay::initData()
 		vk::CommandBufferAllocateInfo(d_context->device->graphicsCmdPool,
 		vk::CommandBufferLevel::ePrimary,
 		d_context->swapChain->frameCount));
+
+	// The inputs captured by the GUI (e.g. a click on a window, a key typed in a text field) don't reach
+	// the listeners of lower priority
+	d_eventSubscription = d_dispatcher->subscribe<SDL_Event>([](const SDL_Event& ev) {
+		auto real_ev = ev;
+		ImGui_ImplSDL2_ProcessEvent(&real_ev);
+
+		const ImGuiIO& io = ImGui::GetIO();
+		switch (ev.type)
+		{
+		case SDL_MOUSEMOTION:
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+		case SDL_MOUSEWHEEL:
+			return io.WantCaptureMouse ? se::propagation::stop : se::propagation::proceed;
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		case SDL_TEXTINPUT:
+			return io.WantCaptureKeyboard ? se::propagation::stop : se::propagation::proceed;
+		default:
+			return se::propagation::proceed;
+		}
+	}, EVENT_PRIORITY);
 }
 
 vk::CommandBuffer GuiOverlay::render(uint32_t frameID,vk::RenderPass renderPass)
@@ -118,9 +151,17 @@ vk::CommandBuffer GuiOverlay::render(uint32_t frameID,vk::RenderPass renderPass)
 
 	command.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eSimultaneousUse, nullptr));
 	{
+		if (d_gpuTimer)
+		{
+			d_gpuTimer->begin(command, frameID, d_gpuPass);
+		}
 		//command.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
 		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), command);
 		//command.endRenderPass();
+		if (d_gpuTimer)
+		{
+			d_gpuTimer->end(command, frameID, d_gpuPass);
+		}
 	}
 	command.end();
 
@@ -129,12 +170,81 @@ vk::CommandBuffer GuiOverlay::render(uint32_t frameID,vk::RenderPass renderPass)
 
 void GuiOverlay::cleanup()
 {
+	d_eventSubscription.reset();
+	d_gpuTimer = nullptr;
+
 	vk::Device(*d_context->device).freeCommandBuffers(d_context->device->graphicsCmdPool, d_commands);
 	d_commands.clear();
 
 	ImGui_ImplVulkan_Shutdown();
-	ImGui_ImplSDL2_Shutdown();
+	if (d_context->window)
+	{
+		ImGui_ImplSDL2_Shutdown();
+	}
 	ImGui::DestroyContext();
 }
 
+void GuiOverlay::setGpuTimer(std::shared_ptr<profiling::GpuTimer> timer)
+{
+	d_gpuTimer = timer;
+	if (d_gpuTimer)
+	{
+		d_gpuPass = d_gpuTimer->addPass("gui");
+	}
+}
+
+void GuiOverlay::profilerPanel(profiling::FrameProfiler& profiler)
+{
+	ImGui::Begin("profiler");
+
+	bool enabled = profiler.enabled();
+	if (ImGui::Checkbox("record", &enabled))
+	{
+		profiler.setEnabled(enabled);
+	}
+
+	size_t count = profiler.recordCount();
+	if (count > 0)
+	{
+		ImGui::SameLine();
+		if (ImGui::Button("export trace"))
+		{
+			profiler.writeChromeTrace("frame_trace.json");
+		}
+
+		// oldest first
+		d_plotValues.resize(count);
+		for (size_t age = 0; age < count; ++age)
+		{
+			d_plotValues[count - 1 - age] = (float)profiler.record(age).durationMs;
+		}
+		ImGui::PlotLines("frame (ms)", d_plotValues.data(), (int)count, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+
+		const auto& last = profiler.record(0);
+		ImGui::Text("CPU, frame %llu: %.3f ms", (unsigned long long)last.frameNumber, last.durationMs);
+		for (const auto& range : last.cpuRanges)
+		{
+			ImGui::Text("%*s%s %.3f ms", 2 * range.depth, "", range.name, range.endMs - range.beginMs);
+		}
+
+		// the GPU times come a few frames later
+		for (size_t age = 0; age < count; ++age)
+		{
+			const auto& frame = profiler.record(age);
+			if (!frame.gpuRanges.empty())
+			{
+				ImGui::Separator();
+				ImGui::Text("GPU, frame %llu", (unsigned long long)frame.frameNumber);
+				for (const auto& range : frame.gpuRanges)
+				{
+					ImGui::Text("%s %.3f ms", range.name, range.endMs - range.beginMs);
+				}
+				break;
+			}
+		}
+	}
+
+	ImGui::End();
+}
+
 } // end namespace renderer
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include "../api/imgui_impl_sdl.h"
 #include "../api/imgui_impl_vulkan.h"
 #include "../event/safe_event.h"
+#include "../profiling/frame_profiler.h"
+#include "../profiling/gpu_timer.h"
 
 namespace graphics { class VulkanContext; class VulkanDescriptorSet; }
 
@@ -29,17 +31,30 @@ public:
 	vk::CommandBuffer render(uint32_t frameID, vk::RenderPass renderPass) override;
 	void cleanup() override;
 
+	// Times the GUI pass of each frame, frameID being the frame in flight
+	void setGpuTimer(std::shared_ptr<profiling::GpuTimer> timer);
+	// Panel of the timings of the last frames, between startFrame and endFrame
+	void profilerPanel(profiling::FrameProfiler& profiler);
+
 
 private:
 	std::shared_ptr<se::dispatcher> d_dispatcher;
 	std::shared_ptr<graphics::VulkanContext> d_context;
+	se::subscription d_eventSubscription;
 
 	ImGui_ImplVulkan_InitInfo d_init_info;
 	std::vector<vk::CommandBuffer> d_commands;
 	std::shared_ptr<graphics::VulkanDescriptorSet> d_descriptorSet;
 
+	std::shared_ptr<profiling::GpuTimer> d_gpuTimer;
+	uint32_t d_gpuPass = 0;
+	std::vector<float> d_plotValues;
+
 	static void check_vk_result(VkResult err);
 
+	// The GUI sees the SDL events before the listeners of lower priority
+	static constexpr int EVENT_PRIORITY = 100;
+
 	GuiOverlay(GuiOverlay&&) = delete;
 	GuiOverlay(const GuiOverlay&) = delete;
 	void operator=(GuiOverlay&&) = delete;
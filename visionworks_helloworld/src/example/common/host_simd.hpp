@@ -0,0 +1,31 @@
+#ifndef NVX_HOST_SIMD_HPP
+#define NVX_HOST_SIMD_HPP
+
+//
+// Instruction sets available to the host (CPU) implementations of the samples.
+// x64 always has SSE2; AVX2 is used only when the compiler targets it (/arch:AVX2, -mavx2).
+//
+
+#if defined(__AVX2__)
+#  define NVX_HOST_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define NVX_HOST_SSE2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define NVX_HOST_NEON 1
+#endif
+
+#if defined(NVX_HOST_AVX2)
+#  include <immintrin.h>
+#elif defined(NVX_HOST_SSE2)
+#  include <emmintrin.h>
+#endif
+
+#if defined(NVX_HOST_NEON)
+#  include <arm_neon.h>
+#endif
+
+#endif
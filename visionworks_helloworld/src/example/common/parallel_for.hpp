@@ -0,0 +1,59 @@
+#ifndef NVX_PARALLEL_FOR_HPP
+#define NVX_PARALLEL_FOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <VX/vx.h>
+
+namespace nvx
+{
+    inline vx_uint32 getNumHostThreads()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Calls body(first, last) for consecutive ranges of [begin, end) of at most 'grain' items.
+    // Ranges are distributed among the calling thread and up to getNumHostThreads() - 1 helpers,
+    // so body must only write data that belongs to its own range.
+    template <typename Body>
+    void parallelFor(vx_int32 begin, vx_int32 end, vx_int32 grain, const Body& body)
+    {
+        if (end <= begin)
+            return;
+
+        grain = std::max(1, grain);
+        vx_int32 numRanges = (end - begin + grain - 1) / grain;
+        vx_int32 numThreads = std::min(static_cast<vx_int32>(getNumHostThreads()), numRanges);
+
+        if (numThreads <= 1)
+        {
+            body(begin, end);
+            return;
+        }
+
+        std::atomic<vx_int32> next(0);
+        auto worker = [&]
+        {
+            for (vx_int32 r = next++; r < numRanges; r = next++)
+            {
+                vx_int32 first = begin + r * grain;
+                body(first, std::min(end, first + grain));
+            }
+        };
+
+        std::vector<std::thread> helpers;
+        helpers.reserve(numThreads - 1);
+        for (vx_int32 t = 1; t < numThreads; ++t)
+            helpers.emplace_back(worker);
+
+        worker();
+
+        for (std::thread& helper : helpers)
+            helper.join();
+    }
+}
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef NVX_RENDER_LAYOUT_HPP
+#define NVX_RENDER_LAYOUT_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include <VX/vx.h>
+
+#include "NVXIO/Utility.hpp"
+
+namespace nvx
+{
+    //
+    // Layout of the views of a demo window. The views are ROIs of one mosaic image: the nodes that produce
+    // the views write straight into the mosaic, and the renderer draws all of them with a single putImage,
+    // so no view is copied into a composed image every frame.
+    //
+    class RenderLayout
+    {
+    public:
+        struct View
+        {
+            vx_uint32 x, y, width, height;
+        };
+
+        RenderLayout() : mosaic_(NULL), width_(0), height_(0) {}
+        ~RenderLayout() { release(); }
+
+        // Views are added before create(), the index of the view is returned
+        vx_uint32 addView(vx_uint32 x, vx_uint32 y, vx_uint32 width, vx_uint32 height)
+        {
+            View view = { x, y, width, height };
+            views_.push_back(view);
+
+            width_ = std::max(width_, x + width);
+            height_ = std::max(height_, y + height);
+
+            return static_cast<vx_uint32>(views_.size() - 1);
+        }
+
+        // Grid of columns x rows cells of the same size from (x, y), the cells are added row by row.
+        // The index of the first cell is returned.
+        vx_uint32 addGrid(vx_uint32 x, vx_uint32 y, vx_uint32 columns, vx_uint32 rows,
+                          vx_uint32 cellWidth, vx_uint32 cellHeight)
+        {
+            vx_uint32 first = static_cast<vx_uint32>(views_.size());
+
+            for (vx_uint32 r = 0; r < rows; ++r)
+                for (vx_uint32 c = 0; c < columns; ++c)
+                    addView(x + c * cellWidth, y + r * cellHeight, cellWidth, cellHeight);
+
+            return first;
+        }
+
+        // Size of the mosaic, the bounding box of the views. The renderer is created with this size.
+        vx_uint32 getWidth() const { return width_; }
+        vx_uint32 getHeight() const { return height_; }
+
+        vx_uint32 getNumViews() const { return static_cast<vx_uint32>(views_.size()); }
+        const View& getView(vx_uint32 index) const { return views_[index]; }
+
+        // Allocates the mosaic and the ROI image of every view
+        void create(vx_context context, vx_df_image format)
+        {
+            release();
+
+            mosaic_ = vxCreateImage(context, width_, height_, format);
+            NVXIO_CHECK_REFERENCE(mosaic_);
+
+            for (const View& view : views_)
+            {
+                vx_rectangle_t rect;
+                rect.start_x = view.x;
+                rect.start_y = view.y;
+                rect.end_x = view.x + view.width;
+                rect.end_y = view.y + view.height;
+
+                vx_image roi = vxCreateImageFromROI(mosaic_, &rect);
+                NVXIO_CHECK_REFERENCE(roi);
+                rois_.push_back(roi);
+            }
+        }
+
+        void release()
+        {
+            for (vx_image& roi : rois_)
+                vxReleaseImage(&roi);
+            rois_.clear();
+
+            if (mosaic_)
+                vxReleaseImage(&mosaic_);
+        }
+
+        // The image drawn by the renderer
+        vx_image getMosaic() const { return mosaic_; }
+        // The image a producer of the view writes to, valid after create()
+        vx_image getViewImage(vx_uint32 index) const { return rois_[index]; }
+
+    private:
+        RenderLayout(const RenderLayout&);
+        RenderLayout& operator=(const RenderLayout&);
+
+        std::vector<View> views_;
+        std::vector<vx_image> rois_;
+        vx_image mosaic_;
+        vx_uint32 width_;
+        vx_uint32 height_;
+    };
+}
+
+#endif
@@ -0,0 +1,460 @@
+#include "host_hough_circles.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "NVXIO/Utility.hpp"
+
+#include "../common/parallel_for.hpp"
+
+HostHoughCircles::Params::Params()
+{
+    dp = 2.0f;
+    minDist = 10.0f;
+    minRadius = 1;
+    maxRadius = 25;
+    accThreshold = 110;
+    circlesCapacity = 300;
+    numBands = 4;
+}
+
+HostHoughCircles::HostHoughCircles()
+{
+    width_ = 0;
+    height_ = 0;
+    accWidth_ = 0;
+    accHeight_ = 0;
+}
+
+void HostHoughCircles::init(vx_uint32 width, vx_uint32 height, const Params& params)
+{
+    NVXIO_ASSERT(width > 0 && height > 0);
+    NVXIO_ASSERT(params.dp >= 1.0f && params.minDist > 0.0f);
+    NVXIO_ASSERT(params.minRadius <= params.maxRadius && params.maxRadius > 0);
+
+    params_ = params;
+    width_ = static_cast<vx_int32>(width);
+    height_ = static_cast<vx_int32>(height);
+
+    accWidth_ = static_cast<vx_int32>(std::ceil(width_ / params_.dp)) + 1;
+    accHeight_ = static_cast<vx_int32>(std::ceil(height_ / params_.dp)) + 1;
+
+    // Split the radius range (in accumulator cells) into bands of equal width
+
+    vx_int32 minStep = std::max(1, static_cast<vx_int32>(std::floor(params_.minRadius / params_.dp)));
+    vx_int32 maxStep = std::max(minStep, static_cast<vx_int32>(std::ceil(params_.maxRadius / params_.dp)));
+    vx_int32 numSteps = maxStep - minStep + 1;
+
+    vx_int32 numBands = std::max(1, static_cast<vx_int32>(params_.numBands));
+    numBands = std::min(numBands, numSteps);
+
+    bands_.resize(numBands);
+    for (vx_int32 b = 0; b < numBands; ++b)
+    {
+        Band& band = bands_[b];
+
+        // Neighbouring bands overlap by one cell, so circles on the border of two bands
+        // get all their votes in at least one of them
+
+        band.minStep = std::max(minStep, minStep + numSteps * b / numBands - 1);
+        band.maxStep = minStep + numSteps * (b + 1) / numBands - 1;
+
+        band.minRadius = std::max(static_cast<vx_float32>(params_.minRadius), band.minStep * params_.dp);
+        band.maxRadius = std::min(static_cast<vx_float32>(params_.maxRadius), (band.maxStep + 1) * params_.dp);
+
+        band.accum.assign(accWidth_ * accHeight_, 0);
+        band.distHist.assign(static_cast<vx_size>(band.maxRadius - band.minRadius) + 2, 0);
+        band.candidates.clear();
+    }
+
+    points_.reserve(width_ * height_ / 8);
+    circles_.reserve(params_.circlesCapacity);
+    accepted_.clear();
+    accepted_.reserve(params_.circlesCapacity);
+    seeds_.reserve(params_.circlesCapacity);
+
+    policy_.reset();
+}
+
+void HostHoughCircles::setOutputTransform(const HoughOutputTransform& transform)
+{
+    transform_ = transform;
+}
+
+void HostHoughCircles::process(vx_image edges, vx_image dx, vx_image dy)
+{
+    vx_rectangle_t rect = {
+        0u, 0u,
+        static_cast<vx_uint32>(width_), static_cast<vx_uint32>(height_)
+    };
+
+    vx_map_id edges_map_id, dx_map_id, dy_map_id;
+    vx_imagepatch_addressing_t edges_addr, dx_addr, dy_addr;
+    void *edges_ptr = nullptr, *dx_ptr = nullptr, *dy_ptr = nullptr;
+    NVXIO_SAFE_CALL( vxMapImagePatch(edges, &rect, 0, &edges_map_id, &edges_addr, &edges_ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+    NVXIO_SAFE_CALL( vxMapImagePatch(dx, &rect, 0, &dx_map_id, &dx_addr, &dx_ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+    NVXIO_SAFE_CALL( vxMapImagePatch(dy, &rect, 0, &dy_map_id, &dy_addr, &dy_ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+
+    process(static_cast<const vx_uint8*>(edges_ptr), edges_addr.stride_y,
+            static_cast<const vx_int16*>(dx_ptr), dx_addr.stride_y,
+            static_cast<const vx_int16*>(dy_ptr), dy_addr.stride_y);
+
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(edges, edges_map_id) );
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(dx, dx_map_id) );
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(dy, dy_map_id) );
+}
+
+void HostHoughCircles::process(const vx_uint8* edges, vx_size edgesStride,
+                               const vx_int16* dx, vx_size dxStride,
+                               const vx_int16* dy, vx_size dyStride)
+{
+    if (!policy_.isFullDetectionDue())
+    {
+        track(edges, edgesStride, dx, dxStride, dy, dyStride);
+
+        if (policy_.acceptTracked(circles_.size()))
+        {
+            policy_.update(false, circles_.size());
+            return;
+        }
+    }
+
+    detect(edges, edgesStride, dx, dxStride, dy, dyStride);
+    policy_.update(true, circles_.size());
+}
+
+void HostHoughCircles::setTracking(const HoughTrackingParams& params)
+{
+    policy_.setParams(params);
+}
+
+bool HostHoughCircles::wasTracked() const
+{
+    return policy_.wasTracked();
+}
+
+void HostHoughCircles::collectPoints(const vx_uint8* edges, vx_size edgesStride,
+                                     const vx_int16* dx, vx_size dxStride,
+                                     const vx_int16* dy, vx_size dyStride,
+                                     vx_int32 minX, vx_int32 minY, vx_int32 maxX, vx_int32 maxY,
+                                     std::vector<EdgePoint>& points) const
+{
+    // Edge points with a defined gradient direction
+
+    points.clear();
+    for (vx_int32 y = minY; y <= maxY; ++y)
+    {
+        const vx_uint8* edgesRow = edges + y * edgesStride;
+        const vx_int16* dxRow = reinterpret_cast<const vx_int16*>(reinterpret_cast<const vx_uint8*>(dx) + y * dxStride);
+        const vx_int16* dyRow = reinterpret_cast<const vx_int16*>(reinterpret_cast<const vx_uint8*>(dy) + y * dyStride);
+
+        for (vx_int32 x = minX; x <= maxX; ++x)
+        {
+            if (!edgesRow[x] || (dxRow[x] == 0 && dyRow[x] == 0))
+                continue;
+
+            vx_float32 gx = dxRow[x], gy = dyRow[x];
+            vx_float32 invNorm = 1.0f / std::sqrt(gx * gx + gy * gy);
+
+            EdgePoint p = {
+                static_cast<vx_float32>(x), static_cast<vx_float32>(y),
+                gx * invNorm, gy * invNorm
+            };
+            points.push_back(p);
+        }
+    }
+}
+
+void HostHoughCircles::detect(const vx_uint8* edges, vx_size edgesStride,
+                              const vx_int16* dx, vx_size dxStride,
+                              const vx_int16* dy, vx_size dyStride)
+{
+    collectPoints(edges, edgesStride, dx, dxStride, dy, dyStride,
+                  0, 0, width_ - 1, height_ - 1, points_);
+
+    // Vote and find the candidates of every band
+
+    nvx::parallelFor(0, static_cast<vx_int32>(bands_.size()), 1, [this](vx_int32 first, vx_int32 last)
+    {
+        for (vx_int32 b = first; b < last; ++b)
+            processBand(bands_[b]);
+    });
+
+    // Merge the bands: the strongest candidates suppress their neighbours
+
+    candidates_.clear();
+    for (const Band& band : bands_)
+        candidates_.insert(candidates_.end(), band.candidates.begin(), band.candidates.end());
+
+    emitCircles();
+}
+
+void HostHoughCircles::processBand(Band& band) const
+{
+    std::fill(band.accum.begin(), band.accum.end(), 0);
+    band.candidates.clear();
+
+    const vx_float32 invDp = 1.0f / params_.dp;
+
+    // Both directions of the gradient, one accumulator cell per step
+
+    for (const EdgePoint& p : points_)
+    {
+        for (vx_int32 sign = -1; sign <= 1; sign += 2)
+        {
+            vx_float32 sx = sign * p.nx, sy = sign * p.ny;
+            vx_float32 ax = p.x * invDp + sx * band.minStep;
+            vx_float32 ay = p.y * invDp + sy * band.minStep;
+
+            for (vx_int32 k = band.minStep; k <= band.maxStep; ++k, ax += sx, ay += sy)
+            {
+                vx_int32 ix = static_cast<vx_int32>(std::lrint(ax));
+                vx_int32 iy = static_cast<vx_int32>(std::lrint(ay));
+
+                // The further cells of the ray are outside too
+                if (ix < 0 || ix >= accWidth_ || iy < 0 || iy >= accHeight_)
+                    break;
+
+                vx_uint16& votes = band.accum[iy * accWidth_ + ix];
+                if (votes != 0xFFFF)
+                    ++votes;
+            }
+        }
+    }
+
+    // Local maxima above the threshold are the center candidates
+
+    for (vx_int32 y = 1; y < accHeight_ - 1; ++y)
+    {
+        const vx_uint16* row = &band.accum[y * accWidth_];
+
+        for (vx_int32 x = 1; x < accWidth_ - 1; ++x)
+        {
+            vx_uint16 v = row[x];
+            if (v <= params_.accThreshold ||
+                v <= row[x - 1] || v < row[x + 1] ||
+                v <= row[x - accWidth_] || v < row[x + accWidth_])
+            {
+                continue;
+            }
+
+            vx_float32 cx = x * params_.dp, cy = y * params_.dp;
+            vx_float32 radius = estimateRadius(band, points_, cx, cy);
+
+            if (radius > 0.0f)
+            {
+                Candidate c = { cx, cy, radius, v };
+                band.candidates.push_back(c);
+            }
+        }
+    }
+}
+
+vx_float32 HostHoughCircles::estimateRadius(Band& band, const std::vector<EdgePoint>& points, vx_float32 cx, vx_float32 cy) const
+{
+    std::fill(band.distHist.begin(), band.distHist.end(), 0);
+
+    const vx_float32 minR2 = band.minRadius * band.minRadius;
+    const vx_float32 maxR2 = band.maxRadius * band.maxRadius;
+
+    for (const EdgePoint& p : points)
+    {
+        vx_float32 ddx = p.x - cx, ddy = p.y - cy;
+        if (std::fabs(ddx) > band.maxRadius || std::fabs(ddy) > band.maxRadius)
+            continue;
+
+        vx_float32 d2 = ddx * ddx + ddy * ddy;
+        if (d2 < minR2 || d2 > maxR2)
+            continue;
+
+        ++band.distHist[static_cast<vx_size>(std::sqrt(d2) - band.minRadius)];
+    }
+
+    // The best radius has the most edge points per unit of circumference.
+    // Neighbouring distances are summed up to tolerate thick and slightly elliptic edges;
+    // each bin is normalised by its own radius so that the window doesn't lean towards
+    // the smaller distances, and the radius is the count-weighted mean of the window.
+
+    const vx_size bins = band.distHist.size();
+    auto binRadius = [&band](vx_size i) { return band.minRadius + i + 0.5f; };
+
+    vx_float32 bestScore = 0.0f;
+    vx_size bestBin = bins;
+    for (vx_size i = 0; i < bins; ++i)
+    {
+        if (binRadius(i) > band.maxRadius)
+            break;
+
+        vx_size first = i > 0 ? i - 1 : i, last = std::min(i + 1, bins - 1);
+
+        vx_float32 score = 0.0f;
+        for (vx_size j = first; j <= last; ++j)
+            score += band.distHist[j] / binRadius(j);
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestBin = i;
+        }
+    }
+
+    if (bestBin == bins)
+        return 0.0f;
+
+    vx_size first = bestBin > 0 ? bestBin - 1 : bestBin, last = std::min(bestBin + 1, bins - 1);
+
+    vx_float32 weighted = 0.0f;
+    vx_uint32 count = 0;
+    for (vx_size j = first; j <= last; ++j)
+    {
+        weighted += band.distHist[j] * binRadius(j);
+        count += band.distHist[j];
+    }
+
+    return weighted / count;
+}
+
+void HostHoughCircles::track(const vx_uint8* edges, vx_size edgesStride,
+                             const vx_int16* dx, vx_size dxStride,
+                             const vx_int16* dy, vx_size dyStride)
+{
+    // The circles of the previous frame are the seeds, each of them gives at most one candidate
+
+    seeds_.swap(accepted_);
+    candidates_.clear();
+
+    const HoughTrackingParams& tracking = policy_.getParams();
+
+    for (const Candidate& seed : seeds_)
+    {
+        vx_float32 reach = std::min(seed.radius + tracking.radiusRange, static_cast<vx_float32>(params_.maxRadius)) +
+                           tracking.centerRange + 1.0f;
+
+        vx_int32 minX = std::max(0, static_cast<vx_int32>(std::floor(seed.x - reach)));
+        vx_int32 minY = std::max(0, static_cast<vx_int32>(std::floor(seed.y - reach)));
+        vx_int32 maxX = std::min(width_ - 1, static_cast<vx_int32>(std::ceil(seed.x + reach)));
+        vx_int32 maxY = std::min(height_ - 1, static_cast<vx_int32>(std::ceil(seed.y + reach)));
+
+        if (minX > maxX || minY > maxY)
+            continue;
+
+        collectPoints(edges, edgesStride, dx, dxStride, dy, dyStride,
+                      minX, minY, maxX, maxY, trackPoints_);
+
+        trackCircle(seed);
+    }
+
+    emitCircles();
+}
+
+void HostHoughCircles::trackCircle(const Candidate& seed)
+{
+    const HoughTrackingParams& tracking = policy_.getParams();
+    const vx_float32 invDp = 1.0f / params_.dp;
+
+    trackBand_.minRadius = std::max(static_cast<vx_float32>(params_.minRadius), seed.radius - tracking.radiusRange);
+    trackBand_.maxRadius = std::min(static_cast<vx_float32>(params_.maxRadius), seed.radius + tracking.radiusRange);
+    if (trackBand_.minRadius > trackBand_.maxRadius)
+        return;
+
+    trackBand_.minStep = std::max(1, static_cast<vx_int32>(std::floor(trackBand_.minRadius * invDp)));
+    trackBand_.maxStep = std::max(trackBand_.minStep, static_cast<vx_int32>(std::ceil(trackBand_.maxRadius * invDp)));
+
+    // Accumulator cells around the previous center only
+
+    vx_int32 win = static_cast<vx_int32>(std::ceil(tracking.centerRange * invDp));
+    vx_int32 side = 2 * win + 1;
+    vx_int32 originX = static_cast<vx_int32>(std::lrint(seed.x * invDp)) - win;
+    vx_int32 originY = static_cast<vx_int32>(std::lrint(seed.y * invDp)) - win;
+
+    trackAccum_.assign(side * side, 0);
+
+    for (const EdgePoint& p : trackPoints_)
+    {
+        for (vx_int32 sign = -1; sign <= 1; sign += 2)
+        {
+            vx_float32 sx = sign * p.nx, sy = sign * p.ny;
+            vx_float32 ax = p.x * invDp + sx * trackBand_.minStep - originX;
+            vx_float32 ay = p.y * invDp + sy * trackBand_.minStep - originY;
+
+            for (vx_int32 k = trackBand_.minStep; k <= trackBand_.maxStep; ++k, ax += sx, ay += sy)
+            {
+                vx_int32 ix = static_cast<vx_int32>(std::lrint(ax));
+                vx_int32 iy = static_cast<vx_int32>(std::lrint(ay));
+
+                if (ix >= 0 && ix < side && iy >= 0 && iy < side)
+                {
+                    vx_uint16& votes = trackAccum_[iy * side + ix];
+                    if (votes != 0xFFFF)
+                        ++votes;
+                }
+            }
+        }
+    }
+
+    vx_int32 best = static_cast<vx_int32>(std::max_element(trackAccum_.begin(), trackAccum_.end()) - trackAccum_.begin());
+    vx_uint16 votes = trackAccum_[best];
+    if (votes <= params_.accThreshold)
+        return;
+
+    vx_float32 cx = (originX + best % side) * params_.dp;
+    vx_float32 cy = (originY + best / side) * params_.dp;
+
+    trackBand_.distHist.assign(static_cast<vx_size>(trackBand_.maxRadius - trackBand_.minRadius) + 2, 0);
+    vx_float32 radius = estimateRadius(trackBand_, trackPoints_, cx, cy);
+
+    if (radius > 0.0f)
+    {
+        Candidate c = { cx, cy, radius, votes };
+        candidates_.push_back(c);
+    }
+}
+
+void HostHoughCircles::emitCircles()
+{
+    circles_.clear();
+    accepted_.clear();
+
+    std::stable_sort(candidates_.begin(), candidates_.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.votes > b.votes; });
+
+    vx_float32 minDist2 = params_.minDist * params_.minDist;
+
+    for (const Candidate& c : candidates_)
+    {
+        if (accepted_.size() >= params_.circlesCapacity)
+            break;
+
+        bool isFar = std::all_of(accepted_.begin(), accepted_.end(), [&](const Candidate& other)
+        {
+            vx_float32 ddx = other.x - c.x, ddy = other.y - c.y;
+            return ddx * ddx + ddy * ddy >= minDist2;
+        });
+
+        if (isFar)
+        {
+            accepted_.push_back(c);
+
+            nvx_point3f_t circle = { c.x, c.y, c.radius };
+            circles_.push_back(transform_.apply(circle));
+        }
+    }
+}
+
+const std::vector<nvx_point3f_t>& HostHoughCircles::getCircles() const
+{
+    return circles_;
+}
+
+HoughCirclesView HostHoughCircles::getCirclesView() const
+{
+    return HoughCirclesView(circles_.data(), circles_.size());
+}
+
+void HostHoughCircles::copyCircles(vx_array circles) const
+{
+    NVXIO_SAFE_CALL( vxTruncateArray(circles, 0) );
+
+    if (!circles_.empty())
+        NVXIO_SAFE_CALL( vxAddArrayItems(circles, circles_.size(), circles_.data(), sizeof(nvx_point3f_t)) );
+}
@@ -0,0 +1,143 @@
+#ifndef HOST_HOUGH_CIRCLES_HPP
+#define HOST_HOUGH_CIRCLES_HPP
+
+#include <vector>
+
+#include <NVX/nvx.h>
+
+#include "hough_results.hpp"
+#include "hough_tracking.hpp"
+
+//
+// Host (CPU) implementation of nvxHoughCirclesNode (gradient Hough transform).
+//
+// Every edge point votes for the possible centers along its gradient direction, at the distances
+// from minRadius to maxRadius, into an accumulator downscaled by dp. The radius range is split into
+// bands, each band has its own 2D accumulator and is processed on its own thread. The memory
+// footprint depends on the number of bands and on the frame size, but not on maxRadius.
+// Local maxima of every band accumulator above accThreshold are the center candidates, the radius
+// is chosen among the band radii by the number of edge points at that distance from the center.
+//
+// In the tracking mode (setTracking) the circles of the previous frame are searched for only around
+// their centers and radii, with a small accumulator per circle fed by the edge points near the circle.
+//
+class HostHoughCircles
+{
+public:
+    // Same meaning as the parameters of nvxHoughCirclesNode
+    struct Params
+    {
+        // inverse ratio of the accumulator resolution to the image resolution
+        vx_float32 dp;
+        // minimum distance between the centers of the detected circles
+        vx_float32 minDist;
+        vx_uint32 minRadius;
+        vx_uint32 maxRadius;
+        // accumulator threshold for the circle centers
+        vx_uint32 accThreshold;
+        // maximum number of reported circles
+        vx_uint32 circlesCapacity;
+        // number of radius bands, processed in parallel. The circles near the band borders depend
+        // on it, so it is fixed rather than derived from the number of host threads.
+        vx_uint32 numBands;
+
+        Params();
+    };
+
+    HostHoughCircles();
+
+    void init(vx_uint32 width, vx_uint32 height, const Params& params = Params());
+
+    // Transform of the reported circles, e.g. back to the full-resolution frame. Identity by default.
+    // Detection itself (minDist included) works in the coordinates of the edge map.
+    void setOutputTransform(const HoughOutputTransform& transform);
+
+    // Tracking mode for video streams, off by default
+    void setTracking(const HoughTrackingParams& params);
+    // Whether the circles of the last frame were tracked rather than fully detected
+    bool wasTracked() const;
+
+    // Edge map of VX_DF_IMAGE_U8 format and its derivatives of VX_DF_IMAGE_S16 format (vxSobel3x3Node)
+    void process(vx_image edges, vx_image dx, vx_image dy);
+    // Same for images in host memory, strides are in bytes
+    void process(const vx_uint8* edges, vx_size edgesStride,
+                 const vx_int16* dx, vx_size dxStride,
+                 const vx_int16* dy, vx_size dyStride);
+
+    // Circles as (x, y, radius), the same layout as the output of nvxHoughCirclesNode
+    const std::vector<nvx_point3f_t>& getCircles() const;
+    HoughCirclesView getCirclesView() const;
+
+    // Replaces the content of an array of NVX_TYPE_POINT3F items
+    void copyCircles(vx_array circles) const;
+
+private:
+    struct EdgePoint
+    {
+        vx_float32 x, y;
+        // unit gradient direction
+        vx_float32 nx, ny;
+    };
+
+    struct Candidate
+    {
+        vx_float32 x, y, radius;
+        vx_uint32 votes;
+    };
+
+    struct Band
+    {
+        // radius range in accumulator cells (voting) and in pixels (radius estimation)
+        vx_int32 minStep, maxStep;
+        vx_float32 minRadius, maxRadius;
+        std::vector<vx_uint16> accum;
+        std::vector<Candidate> candidates;
+        // number of edge points at every distance of the band, used to choose the radius
+        std::vector<vx_uint32> distHist;
+    };
+
+    void collectPoints(const vx_uint8* edges, vx_size edgesStride,
+                       const vx_int16* dx, vx_size dxStride,
+                       const vx_int16* dy, vx_size dyStride,
+                       vx_int32 minX, vx_int32 minY, vx_int32 maxX, vx_int32 maxY,
+                       std::vector<EdgePoint>& points) const;
+
+    void detect(const vx_uint8* edges, vx_size edgesStride,
+                const vx_int16* dx, vx_size dxStride,
+                const vx_int16* dy, vx_size dyStride);
+    void processBand(Band& band) const;
+
+    void track(const vx_uint8* edges, vx_size edgesStride,
+               const vx_int16* dx, vx_size dxStride,
+               const vx_int16* dy, vx_size dyStride);
+    void trackCircle(const Candidate& seed);
+
+    vx_float32 estimateRadius(Band& band, const std::vector<EdgePoint>& points, vx_float32 cx, vx_float32 cy) const;
+
+    // Non-maximum suppression of candidates_ into accepted_ and circles_
+    void emitCircles();
+
+    Params params_;
+
+    vx_int32 width_;
+    vx_int32 height_;
+
+    vx_int32 accWidth_;
+    vx_int32 accHeight_;
+
+    std::vector<EdgePoint> points_;
+    std::vector<Band> bands_;
+    std::vector<Candidate> candidates_;
+    std::vector<Candidate> accepted_;
+
+    HoughTrackingPolicy policy_;
+    std::vector<Candidate> seeds_;
+    std::vector<EdgePoint> trackPoints_;
+    std::vector<vx_uint16> trackAccum_;
+    Band trackBand_;
+
+    HoughOutputTransform transform_;
+    std::vector<nvx_point3f_t> circles_;
+};
+
+#endif
@@ -0,0 +1,472 @@
+#include "host_hough_segments.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "NVXIO/Utility.hpp"
+
+namespace
+{
+    // Fixed-point precision of the minor coordinate while tracing a segment
+    const vx_int32 SHIFT = 16;
+
+    // States of the edge map points
+    const vx_uint8 NOT_EDGE = 0;
+    const vx_uint8 EDGE = 1;
+    const vx_uint8 VOTED_EDGE = 2;
+
+    // Narrows [xMin, xMax] to the x where lo <= coef * x + c0 <= hi
+    void clipRange(vx_float32 coef, vx_float32 c0, vx_float32 lo, vx_float32 hi,
+                   vx_float32& xMin, vx_float32& xMax)
+    {
+        if (std::fabs(coef) < 1e-6f)
+        {
+            if (c0 < lo || c0 > hi)
+                xMax = xMin - 1.0f;
+            return;
+        }
+
+        vx_float32 x1 = (lo - c0) / coef, x2 = (hi - c0) / coef;
+        if (x1 > x2)
+            std::swap(x1, x2);
+
+        xMin = std::max(xMin, x1);
+        xMax = std::min(xMax, x2);
+    }
+}
+
+HostHoughSegments::Params::Params()
+{
+    rho = 1.0f;
+    theta = nvxio::PI_F / 180.0f;
+    votesThreshold = 100;
+    minLineLength = 25;
+    maxLineGap = 2;
+    linesCapacity = 300;
+}
+
+HostHoughSegments::HostHoughSegments()
+{
+    width_ = 0;
+    height_ = 0;
+    numAngle_ = 0;
+    numRho_ = 0;
+}
+
+void HostHoughSegments::init(vx_uint32 width, vx_uint32 height, const Params& params)
+{
+    NVXIO_ASSERT(width > 0 && height > 0);
+    NVXIO_ASSERT(params.rho > 0.0f && params.theta > 0.0f);
+
+    params_ = params;
+    width_ = static_cast<vx_int32>(width);
+    height_ = static_cast<vx_int32>(height);
+
+    numAngle_ = std::max(1, static_cast<vx_int32>(std::lround(nvxio::PI_F / params_.theta)));
+    numRho_ = static_cast<vx_int32>(std::lround(((width_ + height_) * 2 + 1) / params_.rho));
+
+    trigTable_.resize(numAngle_ * 2);
+    for (vx_int32 n = 0; n < numAngle_; ++n)
+    {
+        vx_float64 angle = n * static_cast<vx_float64>(params_.theta);
+        trigTable_[n * 2 + 0] = static_cast<vx_float32>(std::cos(angle) / params_.rho);
+        trigTable_[n * 2 + 1] = static_cast<vx_float32>(std::sin(angle) / params_.rho);
+    }
+
+    accum_.assign(numAngle_ * numRho_, 0);
+    mask_.assign(width_ * height_, 0);
+    points_.reserve(width_ * height_ / 8);
+    segments_.reserve(params_.linesCapacity);
+    detected_.clear();
+    detected_.reserve(params_.linesCapacity);
+    seeds_.reserve(params_.linesCapacity);
+
+    policy_.reset();
+}
+
+void HostHoughSegments::setOutputTransform(const HoughOutputTransform& transform)
+{
+    transform_ = transform;
+}
+
+void HostHoughSegments::process(vx_image edges)
+{
+    vx_rectangle_t rect = {
+        0u, 0u,
+        static_cast<vx_uint32>(width_), static_cast<vx_uint32>(height_)
+    };
+
+    vx_map_id map_id;
+    vx_imagepatch_addressing_t addr;
+    void* ptr = nullptr;
+    NVXIO_SAFE_CALL( vxMapImagePatch(edges, &rect, 0, &map_id, &addr, &ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+
+    process(static_cast<const vx_uint8*>(ptr), addr.stride_y);
+
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(edges, map_id) );
+}
+
+void HostHoughSegments::process(const vx_uint8* edges, vx_size stride)
+{
+    if (!policy_.isFullDetectionDue())
+    {
+        track(edges, stride);
+
+        if (policy_.acceptTracked(segments_.size()))
+        {
+            policy_.update(false, segments_.size());
+            return;
+        }
+    }
+
+    detect(edges, stride);
+    policy_.update(true, segments_.size());
+}
+
+void HostHoughSegments::setTracking(const HoughTrackingParams& params)
+{
+    policy_.setParams(params);
+}
+
+bool HostHoughSegments::wasTracked() const
+{
+    return policy_.wasTracked();
+}
+
+void HostHoughSegments::detect(const vx_uint8* edges, vx_size stride)
+{
+    segments_.clear();
+    detected_.clear();
+    std::fill(accum_.begin(), accum_.end(), 0);
+
+    // Collect edge points
+
+    points_.clear();
+    for (vx_int32 y = 0; y < height_; ++y)
+    {
+        const vx_uint8* row = edges + y * stride;
+        vx_uint8* mask = &mask_[y * width_];
+
+        for (vx_int32 x = 0; x < width_; ++x)
+        {
+            mask[x] = row[x] ? EDGE : NOT_EDGE;
+            if (row[x])
+                points_.push_back(y * width_ + x);
+        }
+    }
+
+    // The same frame always gives the same segments
+
+    rng_.seed(0x1234567u);
+    std::shuffle(points_.begin(), points_.end(), rng_);
+
+    const vx_int32 rhoOffset = (numRho_ - 1) / 2;
+
+    for (vx_size i = 0; i < points_.size() && segments_.size() < params_.linesCapacity; ++i)
+    {
+        vx_int32 x = points_[i] % width_;
+        vx_int32 y = points_[i] / width_;
+
+        // The point could have been removed by a segment found earlier
+        if (mask_[points_[i]] == NOT_EDGE)
+            continue;
+
+        // Points that have voted stay in the edge map, so segments are traced through them
+        mask_[points_[i]] = VOTED_EDGE;
+
+        // Vote and find the best cell among the updated ones
+
+        vx_uint32 maxVotes = params_.votesThreshold > 0 ? params_.votesThreshold - 1 : 0;
+        vx_int32 maxAngle = -1;
+
+        const vx_float32* trig = trigTable_.data();
+        vx_uint16* accRow = accum_.data();
+        for (vx_int32 n = 0; n < numAngle_; ++n, trig += 2, accRow += numRho_)
+        {
+            vx_int32 r = static_cast<vx_int32>(std::lrint(x * trig[0] + y * trig[1])) + rhoOffset;
+            vx_uint16& votes = accRow[r];
+            if (votes != 0xFFFF)
+                ++votes;
+
+            if (votes > maxVotes)
+            {
+                maxVotes = votes;
+                maxAngle = n;
+            }
+        }
+
+        if (maxAngle < 0)
+            continue;
+
+        nvx_point4f_t segment;
+        if (traceSegment(x, y, trigTable_[maxAngle * 2 + 0], trigTable_[maxAngle * 2 + 1], segment))
+            emitSegment(segment);
+    }
+}
+
+void HostHoughSegments::track(const vx_uint8* edges, vx_size stride)
+{
+    // The segments of the previous frame are the seeds, each of them gives at most one segment
+
+    seeds_.swap(detected_);
+    segments_.clear();
+    detected_.clear();
+
+    for (vx_int32 y = 0; y < height_; ++y)
+    {
+        const vx_uint8* row = edges + y * stride;
+        vx_uint8* mask = &mask_[y * width_];
+
+        for (vx_int32 x = 0; x < width_; ++x)
+            mask[x] = row[x] ? EDGE : NOT_EDGE;
+    }
+
+    for (vx_size i = 0; i < seeds_.size() && segments_.size() < params_.linesCapacity; ++i)
+        trackSegment(seeds_[i]);
+}
+
+void HostHoughSegments::trackSegment(const nvx_point4f_t& seed)
+{
+    const HoughTrackingParams& tracking = policy_.getParams();
+
+    vx_float32 ex = seed.z - seed.x, ey = seed.w - seed.y;
+    vx_float32 length = std::sqrt(ex * ex + ey * ey);
+    if (length < 1.0f)
+        return;
+
+    // Direction (ux, uy) of the seed, its normal is (-uy, ux)
+
+    vx_float32 ux = ex / length, uy = ey / length;
+    vx_float32 midX = (seed.x + seed.z) * 0.5f, midY = (seed.y + seed.w) * 0.5f;
+
+    // Angles around the one of the seed, and for every angle the distance bins around its middle
+
+    vx_int32 angleSteps = static_cast<vx_int32>(std::ceil(tracking.angleRange / params_.theta));
+    vx_int32 numAngles = 2 * angleSteps + 1;
+    vx_int32 rhoSteps = static_cast<vx_int32>(std::ceil(tracking.distanceRange / params_.rho));
+    vx_int32 numRho = 2 * rhoSteps + 1;
+
+    vx_float64 seedAngle = std::atan2(ux, -uy);
+
+    trackTrig_.resize(numAngles * 2);
+    trackCenter_.resize(numAngles);
+    for (vx_int32 n = 0; n < numAngles; ++n)
+    {
+        vx_float64 angle = seedAngle + (n - angleSteps) * static_cast<vx_float64>(params_.theta);
+        trackTrig_[n * 2 + 0] = static_cast<vx_float32>(std::cos(angle) / params_.rho);
+        trackTrig_[n * 2 + 1] = static_cast<vx_float32>(std::sin(angle) / params_.rho);
+        trackCenter_[n] = static_cast<vx_int32>(std::lrint(midX * trackTrig_[n * 2 + 0] + midY * trackTrig_[n * 2 + 1]));
+    }
+
+    trackAccum_.assign(numAngles * numRho, 0);
+
+    // Corridor around the seed: wide enough for the allowed shift and rotation, and a bit longer
+
+    vx_float32 halfWidth = tracking.distanceRange + 0.5f * length * std::sin(tracking.angleRange) + 1.0f;
+    vx_float32 margin = tracking.distanceRange + 1.0f;
+    vx_float32 reach = halfWidth + margin;
+
+    vx_int32 minY = std::max(0, static_cast<vx_int32>(std::floor(std::min(seed.y, seed.w) - reach)));
+    vx_int32 maxY = std::min(height_ - 1, static_cast<vx_int32>(std::ceil(std::max(seed.y, seed.w) + reach)));
+
+    auto corridorRow = [&](vx_int32 y, vx_int32& xBegin, vx_int32& xEnd)
+    {
+        vx_float32 xMin = 0.0f, xMax = static_cast<vx_float32>(width_ - 1);
+        vx_float32 ry = y - seed.y;
+
+        // distance to the seed line, and position along it
+        clipRange(-uy, uy * seed.x + ry * ux, -halfWidth, halfWidth, xMin, xMax);
+        clipRange(ux, -ux * seed.x + ry * uy, -margin, length + margin, xMin, xMax);
+
+        xBegin = static_cast<vx_int32>(std::ceil(xMin));
+        xEnd = static_cast<vx_int32>(std::floor(xMax)) + 1;
+    };
+
+    for (vx_int32 y = minY; y <= maxY; ++y)
+    {
+        vx_int32 xBegin, xEnd;
+        corridorRow(y, xBegin, xEnd);
+
+        const vx_uint8* mask = &mask_[y * width_];
+        for (vx_int32 x = xBegin; x < xEnd; ++x)
+        {
+            if (mask[x] == NOT_EDGE)
+                continue;
+
+            const vx_float32* trig = trackTrig_.data();
+            vx_uint16* accRow = trackAccum_.data();
+            for (vx_int32 n = 0; n < numAngles; ++n, trig += 2, accRow += numRho)
+            {
+                vx_int32 r = static_cast<vx_int32>(std::lrint(x * trig[0] + y * trig[1])) - trackCenter_[n] + rhoSteps;
+                if (r >= 0 && r < numRho)
+                    ++accRow[r];
+            }
+        }
+    }
+
+    vx_int32 best = static_cast<vx_int32>(std::max_element(trackAccum_.begin(), trackAccum_.end()) - trackAccum_.begin());
+    if (trackAccum_[best] < params_.votesThreshold)
+        return;
+
+    vx_int32 bestAngle = best / numRho;
+    vx_int32 bestRho = best % numRho - rhoSteps + trackCenter_[bestAngle];
+    vx_float32 nx = trackTrig_[bestAngle * 2 + 0], ny = trackTrig_[bestAngle * 2 + 1];
+
+    // Trace from the point of the best line closest to the middle of the seed
+
+    vx_int32 startX = -1, startY = -1;
+    vx_float32 minDist2 = 0.0f;
+
+    for (vx_int32 y = minY; y <= maxY; ++y)
+    {
+        vx_int32 xBegin, xEnd;
+        corridorRow(y, xBegin, xEnd);
+
+        const vx_uint8* mask = &mask_[y * width_];
+        for (vx_int32 x = xBegin; x < xEnd; ++x)
+        {
+            if (mask[x] == NOT_EDGE || static_cast<vx_int32>(std::lrint(x * nx + y * ny)) != bestRho)
+                continue;
+
+            vx_float32 dist2 = (x - midX) * (x - midX) + (y - midY) * (y - midY);
+            if (startX < 0 || dist2 < minDist2)
+            {
+                startX = x;
+                startY = y;
+                minDist2 = dist2;
+            }
+        }
+    }
+
+    nvx_point4f_t segment;
+    if (startX >= 0 && traceSegment(startX, startY, nx, ny, segment))
+        emitSegment(segment);
+}
+
+bool HostHoughSegments::traceSegment(vx_int32 x, vx_int32 y, vx_float32 nx, vx_float32 ny, nvx_point4f_t& segment)
+{
+    // Direction of the line: perpendicular to the normal
+
+    vx_float32 a = -ny;
+    vx_float32 b = nx;
+
+    // Step by one pixel along the major axis, and by a fixed-point fraction along the other
+
+    bool xMajor = std::fabs(a) > std::fabs(b);
+    vx_int32 x0 = x, y0 = y, dx0, dy0;
+    if (xMajor)
+    {
+        dx0 = a > 0 ? 1 : -1;
+        dy0 = static_cast<vx_int32>(std::lrint(b * (1 << SHIFT) / std::fabs(a)));
+        y0 = (y0 << SHIFT) + (1 << (SHIFT - 1));
+    }
+    else
+    {
+        dy0 = b > 0 ? 1 : -1;
+        dx0 = static_cast<vx_int32>(std::lrint(a * (1 << SHIFT) / std::fabs(b)));
+        x0 = (x0 << SHIFT) + (1 << (SHIFT - 1));
+    }
+
+    // Walk in both directions while the gaps are short enough
+
+    vx_int32 endX[2] = {x, x}, endY[2] = {y, y};
+
+    for (vx_int32 k = 0; k < 2; ++k)
+    {
+        vx_int32 gap = 0;
+        vx_int32 dx = k ? -dx0 : dx0, dy = k ? -dy0 : dy0;
+
+        for (vx_int32 px = x0, py = y0; ; px += dx, py += dy)
+        {
+            vx_int32 cx = xMajor ? px : px >> SHIFT;
+            vx_int32 cy = xMajor ? py >> SHIFT : py;
+
+            if (cx < 0 || cx >= width_ || cy < 0 || cy >= height_)
+                break;
+
+            if (mask_[cy * width_ + cx] != NOT_EDGE)
+            {
+                gap = 0;
+                endX[k] = cx;
+                endY[k] = cy;
+            }
+            else if (++gap > static_cast<vx_int32>(params_.maxLineGap))
+            {
+                break;
+            }
+        }
+    }
+
+    bool good = std::abs(endX[1] - endX[0]) >= static_cast<vx_int32>(params_.minLineLength) ||
+                std::abs(endY[1] - endY[0]) >= static_cast<vx_int32>(params_.minLineLength);
+
+    // Remove the traced points from the edge map.
+    // Points of an accepted segment also take their votes back.
+
+    for (vx_int32 k = 0; k < 2; ++k)
+    {
+        vx_int32 dx = k ? -dx0 : dx0, dy = k ? -dy0 : dy0;
+
+        for (vx_int32 px = x0, py = y0; ; px += dx, py += dy)
+        {
+            vx_int32 cx = xMajor ? px : px >> SHIFT;
+            vx_int32 cy = xMajor ? py >> SHIFT : py;
+
+            vx_uint8& m = mask_[cy * width_ + cx];
+            if (good && m == VOTED_EDGE)
+                unvote(cx, cy);
+            m = NOT_EDGE;
+
+            if (cx == endX[k] && cy == endY[k])
+                break;
+        }
+    }
+
+    if (good)
+    {
+        segment.x = static_cast<vx_float32>(endX[0]);
+        segment.y = static_cast<vx_float32>(endY[0]);
+        segment.z = static_cast<vx_float32>(endX[1]);
+        segment.w = static_cast<vx_float32>(endY[1]);
+    }
+
+    return good;
+}
+
+void HostHoughSegments::emitSegment(const nvx_point4f_t& segment)
+{
+    detected_.push_back(segment);
+    segments_.push_back(transform_.apply(segment));
+}
+
+void HostHoughSegments::unvote(vx_int32 x, vx_int32 y)
+{
+    const vx_int32 rhoOffset = (numRho_ - 1) / 2;
+
+    const vx_float32* trig = trigTable_.data();
+    vx_uint16* accRow = accum_.data();
+    for (vx_int32 n = 0; n < numAngle_; ++n, trig += 2, accRow += numRho_)
+    {
+        vx_int32 r = static_cast<vx_int32>(std::lrint(x * trig[0] + y * trig[1])) + rhoOffset;
+        --accRow[r];
+    }
+}
+
+const std::vector<nvx_point4f_t>& HostHoughSegments::getSegments() const
+{
+    return segments_;
+}
+
+HoughSegmentsView HostHoughSegments::getSegmentsView() const
+{
+    return HoughSegmentsView(segments_.data(), segments_.size());
+}
+
+void HostHoughSegments::copySegments(vx_array lines) const
+{
+    NVXIO_SAFE_CALL( vxTruncateArray(lines, 0) );
+
+    if (!segments_.empty())
+        NVXIO_SAFE_CALL( vxAddArrayItems(lines, segments_.size(), segments_.data(), sizeof(nvx_point4f_t)) );
+}
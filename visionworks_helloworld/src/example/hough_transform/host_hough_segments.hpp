@@ -0,0 +1,111 @@
+#ifndef HOST_HOUGH_SEGMENTS_HPP
+#define HOST_HOUGH_SEGMENTS_HPP
+
+#include <random>
+#include <vector>
+
+#include <NVX/nvx.h>
+
+#include "hough_results.hpp"
+#include "hough_tracking.hpp"
+
+//
+// Host (CPU) implementation of nvxHoughSegmentsNode: progressive probabilistic Hough transform.
+//
+// Edge points are visited in random order. Every point votes into the accumulator and,
+// as soon as one of its cells reaches votesThreshold, the segment through the point is
+// traced in the edge map. Points of an accepted segment are removed from the edge map and
+// their votes are taken back, so most points never vote at all.
+//
+// The accumulator holds 16-bit counters laid out theta-major: the votes of one point for
+// consecutive angles go to consecutive rows of numRho counters.
+//
+// In the tracking mode (setTracking) every segment of the previous frame is searched for only in a
+// corridor around it: the edge points of the corridor vote for the angles and distances close to the
+// ones of the segment, and the segment is traced from the best cell.
+//
+class HostHoughSegments
+{
+public:
+    // Same meaning as the parameters of nvxHoughSegmentsNode
+    struct Params
+    {
+        // distance resolution of the accumulator in pixels
+        vx_float32 rho;
+        // angle resolution of the accumulator in radians
+        vx_float32 theta;
+        vx_uint32 votesThreshold;
+        vx_uint32 minLineLength;
+        vx_uint32 maxLineGap;
+        // maximum number of reported segments
+        vx_uint32 linesCapacity;
+
+        Params();
+    };
+
+    HostHoughSegments();
+
+    void init(vx_uint32 width, vx_uint32 height, const Params& params = Params());
+
+    // Transform of the reported segments, e.g. back to the full-resolution frame. Identity by default.
+    void setOutputTransform(const HoughOutputTransform& transform);
+
+    // Tracking mode for video streams, off by default
+    void setTracking(const HoughTrackingParams& params);
+    // Whether the segments of the last frame were tracked rather than fully detected
+    bool wasTracked() const;
+
+    // Edge map of VX_DF_IMAGE_U8 format, non-zero pixels are edges
+    void process(vx_image edges);
+    // Same for an edge map in host memory
+    void process(const vx_uint8* edges, vx_size stride);
+
+    // Segments as (x1, y1, x2, y2), the same layout as the output of nvxHoughSegmentsNode
+    const std::vector<nvx_point4f_t>& getSegments() const;
+    HoughSegmentsView getSegmentsView() const;
+
+    // Replaces the content of an array of NVX_TYPE_POINT4F items
+    void copySegments(vx_array lines) const;
+
+private:
+    void detect(const vx_uint8* edges, vx_size stride);
+    void track(const vx_uint8* edges, vx_size stride);
+    void trackSegment(const nvx_point4f_t& seed);
+
+    // Line through (x, y) with the normal (nx, ny)
+    bool traceSegment(vx_int32 x, vx_int32 y, vx_float32 nx, vx_float32 ny, nvx_point4f_t& segment);
+    void emitSegment(const nvx_point4f_t& segment);
+    void unvote(vx_int32 x, vx_int32 y);
+
+    Params params_;
+
+    vx_int32 width_;
+    vx_int32 height_;
+
+    vx_int32 numAngle_;
+    vx_int32 numRho_;
+
+    // cos(angle) / rho, sin(angle) / rho for every angle
+    std::vector<vx_float32> trigTable_;
+    std::vector<vx_uint16> accum_;
+
+    // Edge points which don't belong to a traced segment yet, and whether they have voted
+    std::vector<vx_uint8> mask_;
+    std::vector<vx_int32> points_;
+
+    std::minstd_rand rng_;
+
+    HoughTrackingPolicy policy_;
+    // Segments of the last frame in the coordinates of the edge map, and the ones tracked from
+    std::vector<nvx_point4f_t> detected_;
+    std::vector<nvx_point4f_t> seeds_;
+    // Angles (cos / rho, sin / rho) and accumulator of the tracked segment
+    std::vector<vx_float32> trackTrig_;
+    std::vector<vx_int32> trackCenter_;
+    std::vector<vx_uint16> trackAccum_;
+
+    HoughOutputTransform transform_;
+    std::vector<nvx_point4f_t> segments_;
+};
+
+#endif
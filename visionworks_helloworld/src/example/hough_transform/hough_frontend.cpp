@@ -0,0 +1,589 @@
+#include "hough_frontend.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "NVXIO/Utility.hpp"
+
+#include "../common/host_simd.hpp"
+#include "../common/parallel_for.hpp"
+
+namespace
+{
+    // Edge candidate which becomes an edge only if it is connected to a strong one
+    const vx_uint8 WEAK = 1;
+    const vx_uint8 EDGE = 255;
+
+    // For a 960 pixels wide downscaled frame, a tile of 32 rows keeps about 300 KB of intermediate data
+    const vx_uint32 DEFAULT_TILE_ROWS = 32;
+
+    inline vx_int32 clampRow(vx_int32 y, vx_int32 height)
+    {
+        return std::min(std::max(y, 0), height - 1);
+    }
+
+    // BT.709 luma, the same as the color conversion to VX_DF_IMAGE_U8
+    inline void convertRowToGray(const vx_uint8* src, vx_uint8* dst, vx_int32 width)
+    {
+        for (vx_int32 x = 0; x < width; ++x, src += 4)
+            dst[x] = static_cast<vx_uint8>((54 * src[0] + 183 * src[1] + 19 * src[2] + 128) >> 8);
+    }
+
+    //
+    // Median of 9 values by the min/max exchange network, for scalar and vector types
+    //
+
+    struct ScalarMinMax
+    {
+        typedef vx_uint8 Type;
+        static Type min(Type a, Type b) { return std::min(a, b); }
+        static Type max(Type a, Type b) { return std::max(a, b); }
+    };
+
+#if defined(NVX_HOST_SSE2)
+    struct VectorMinMax
+    {
+        typedef __m128i Type;
+        static const vx_int32 WIDTH = 16;
+        static Type load(const vx_uint8* p) { return _mm_loadu_si128((const __m128i*)p); }
+        static void store(vx_uint8* p, Type v) { _mm_storeu_si128((__m128i*)p, v); }
+        static Type min(Type a, Type b) { return _mm_min_epu8(a, b); }
+        static Type max(Type a, Type b) { return _mm_max_epu8(a, b); }
+    };
+#elif defined(NVX_HOST_NEON)
+    struct VectorMinMax
+    {
+        typedef uint8x16_t Type;
+        static const vx_int32 WIDTH = 16;
+        static Type load(const vx_uint8* p) { return vld1q_u8(p); }
+        static void store(vx_uint8* p, Type v) { vst1q_u8(p, v); }
+        static Type min(Type a, Type b) { return vminq_u8(a, b); }
+        static Type max(Type a, Type b) { return vmaxq_u8(a, b); }
+    };
+#endif
+
+    template <typename Ops>
+    inline void sort2(typename Ops::Type& a, typename Ops::Type& b)
+    {
+        typename Ops::Type t = a;
+        a = Ops::min(a, b);
+        b = Ops::max(t, b);
+    }
+
+    template <typename Ops>
+    inline typename Ops::Type median9(typename Ops::Type p[9])
+    {
+        sort2<Ops>(p[1], p[2]); sort2<Ops>(p[4], p[5]); sort2<Ops>(p[7], p[8]);
+        sort2<Ops>(p[0], p[1]); sort2<Ops>(p[3], p[4]); sort2<Ops>(p[6], p[7]);
+        sort2<Ops>(p[1], p[2]); sort2<Ops>(p[4], p[5]); sort2<Ops>(p[7], p[8]);
+        sort2<Ops>(p[0], p[3]); sort2<Ops>(p[5], p[8]); sort2<Ops>(p[4], p[7]);
+        sort2<Ops>(p[3], p[6]); sort2<Ops>(p[1], p[4]); sort2<Ops>(p[2], p[5]);
+        sort2<Ops>(p[4], p[7]); sort2<Ops>(p[4], p[2]); sort2<Ops>(p[6], p[4]);
+        sort2<Ops>(p[4], p[2]);
+        return p[4];
+    }
+
+    // Rows are padded by one replicated pixel on both sides
+    void medianRow(const vx_uint8* r0, const vx_uint8* r1, const vx_uint8* r2, vx_uint8* dst, vx_int32 width)
+    {
+        vx_int32 x = 0;
+
+#if defined(NVX_HOST_SSE2) || defined(NVX_HOST_NEON)
+        for (; x + VectorMinMax::WIDTH <= width; x += VectorMinMax::WIDTH)
+        {
+            VectorMinMax::Type p[9] = {
+                VectorMinMax::load(r0 + x), VectorMinMax::load(r0 + x + 1), VectorMinMax::load(r0 + x + 2),
+                VectorMinMax::load(r1 + x), VectorMinMax::load(r1 + x + 1), VectorMinMax::load(r1 + x + 2),
+                VectorMinMax::load(r2 + x), VectorMinMax::load(r2 + x + 1), VectorMinMax::load(r2 + x + 2)
+            };
+            VectorMinMax::store(dst + x, median9<VectorMinMax>(p));
+        }
+#endif
+
+        for (; x < width; ++x)
+        {
+            vx_uint8 p[9] = {
+                r0[x], r0[x + 1], r0[x + 2],
+                r1[x], r1[x + 1], r1[x + 2],
+                r2[x], r2[x + 1], r2[x + 2]
+            };
+            dst[x] = median9<ScalarMinMax>(p);
+        }
+    }
+
+    inline void padRow(vx_uint8* row, vx_int32 width)
+    {
+        row[0] = row[1];
+        row[width + 1] = row[width];
+    }
+}
+
+HoughFrontEnd::Params::Params()
+{
+    scaleFactor = 0.5f;
+    scaleType = VX_INTERPOLATION_TYPE_BILINEAR;
+    cannyLowerThresh = 230;
+    cannyUpperThresh = 250;
+    tileRows = DEFAULT_TILE_ROWS;
+}
+
+HoughFrontEnd::HoughFrontEnd()
+{
+    srcWidth_ = 0;
+    srcHeight_ = 0;
+    width_ = 0;
+    height_ = 0;
+    tileRows_ = 0;
+    src_ = nullptr;
+    srcStride_ = 0;
+    std::memset(lut_, 0, sizeof(lut_));
+}
+
+void HoughFrontEnd::init(vx_uint32 srcWidth, vx_uint32 srcHeight, const Params& params)
+{
+    NVXIO_ASSERT(params.scaleFactor > 0.0f && params.scaleFactor <= 1.0f);
+    NVXIO_ASSERT(params.cannyLowerThresh <= params.cannyUpperThresh);
+
+    params_ = params;
+    srcWidth_ = static_cast<vx_int32>(srcWidth);
+    srcHeight_ = static_cast<vx_int32>(srcHeight);
+    width_ = static_cast<vx_int32>(srcWidth * params_.scaleFactor);
+    height_ = static_cast<vx_int32>(srcHeight * params_.scaleFactor);
+
+    NVXIO_ASSERT(width_ > 0 && height_ > 0);
+
+    tileRows_ = params_.tileRows > 0 ? std::min(static_cast<vx_int32>(params_.tileRows), height_) : height_;
+
+    computeTaps(srcHeight_, height_, rowTaps_);
+    computeTaps(srcWidth_, width_, colTaps_);
+
+    vx_int32 numTiles = (height_ + tileRows_ - 1) / tileRows_;
+
+    median_.assign(width_ * height_, 0);
+    tileHists_.assign(numTiles * 256, 0);
+    edges_.assign(width_ * height_, 0);
+    dx_.assign(width_ * height_, 0);
+    dy_.assign(width_ * height_, 0);
+    tileStrong_.resize(numTiles);
+
+    // The largest tile with its halo rows: 1 row on each side for the median and the gradients,
+    // 2 for the equalized rows, and the source rows the scaled ones are computed from
+
+    vx_int32 maxGrayRows = 0;
+    for (vx_int32 t = 0; t < numTiles; ++t)
+    {
+        vx_int32 s0 = clampRow(t * tileRows_ - 1, height_);
+        vx_int32 s1 = clampRow(std::min(height_, (t + 1) * tileRows_), height_);
+        maxGrayRows = std::max(maxGrayRows, rowTaps_[s1].last - rowTaps_[s0].first + 1);
+    }
+
+    const vx_int32 paddedWidth = width_ + 2;
+
+    tileBuffers_.resize(std::min(static_cast<vx_int32>(nvx::getNumHostThreads()), numTiles));
+    for (TileBuffers& buffers : tileBuffers_)
+    {
+        buffers.gray.assign(maxGrayRows * srcWidth_, 0);
+        buffers.scaled.assign((tileRows_ + 2) * paddedWidth, 0);
+        buffers.equalized.assign((tileRows_ + 4) * paddedWidth, 0);
+        buffers.gx.assign((tileRows_ + 2) * width_, 0);
+        buffers.gy.assign((tileRows_ + 2) * width_, 0);
+        buffers.mag.assign((tileRows_ + 2) * paddedWidth, 0);
+    }
+}
+
+vx_uint32 HoughFrontEnd::getWidth() const
+{
+    return static_cast<vx_uint32>(width_);
+}
+
+vx_uint32 HoughFrontEnd::getHeight() const
+{
+    return static_cast<vx_uint32>(height_);
+}
+
+void HoughFrontEnd::computeTaps(vx_int32 srcSize, vx_int32 dstSize, std::vector<Tap>& taps) const
+{
+    vx_float32 inv = static_cast<vx_float32>(srcSize) / dstSize;
+
+    taps.resize(dstSize);
+    for (vx_int32 d = 0; d < dstSize; ++d)
+    {
+        Tap& t = taps[d];
+
+        if (params_.scaleType == VX_INTERPOLATION_TYPE_NEAREST_NEIGHBOR)
+        {
+            t.first = t.last = std::min(srcSize - 1, static_cast<vx_int32>((d + 0.5f) * inv));
+            t.weight = 0;
+        }
+        else if (params_.scaleType == VX_INTERPOLATION_TYPE_AREA)
+        {
+            t.first = std::min(srcSize - 1, static_cast<vx_int32>(d * inv));
+            t.last = std::max(t.first, std::min(srcSize - 1, static_cast<vx_int32>(std::ceil((d + 1) * inv)) - 1));
+            t.weight = 0;
+        }
+        else
+        {
+            vx_float32 f = std::max(0.0f, (d + 0.5f) * inv - 0.5f);
+            vx_int32 i = static_cast<vx_int32>(f);
+            t.first = std::min(i, srcSize - 1);
+            t.last = std::min(i + 1, srcSize - 1);
+            t.weight = static_cast<vx_int32>(std::lrint((f - i) * 256));
+        }
+    }
+}
+
+void HoughFrontEnd::scaleRow(const vx_uint8* gray, vx_int32 grayFirstRow, vx_int32 row, vx_uint8* dst) const
+{
+    const Tap& rt = rowTaps_[row];
+    const vx_uint8* r0 = gray + (rt.first - grayFirstRow) * srcWidth_;
+    const vx_uint8* r1 = gray + (rt.last - grayFirstRow) * srcWidth_;
+
+    if (params_.scaleType == VX_INTERPOLATION_TYPE_NEAREST_NEIGHBOR)
+    {
+        for (vx_int32 x = 0; x < width_; ++x)
+            dst[x] = r0[colTaps_[x].first];
+    }
+    else if (params_.scaleType == VX_INTERPOLATION_TYPE_AREA)
+    {
+        for (vx_int32 x = 0; x < width_; ++x)
+        {
+            const Tap& ct = colTaps_[x];
+            vx_uint32 sum = 0;
+            for (const vx_uint8* r = r0; r <= r1; r += srcWidth_)
+                for (vx_int32 c = ct.first; c <= ct.last; ++c)
+                    sum += r[c];
+
+            vx_uint32 count = (rt.last - rt.first + 1) * (ct.last - ct.first + 1);
+            dst[x] = static_cast<vx_uint8>((sum + count / 2) / count);
+        }
+    }
+    else
+    {
+        vx_int32 wy = rt.weight;
+        for (vx_int32 x = 0; x < width_; ++x)
+        {
+            const Tap& ct = colTaps_[x];
+            vx_int32 wx = ct.weight;
+            vx_int32 top = r0[ct.first] * (256 - wx) + r0[ct.last] * wx;
+            vx_int32 bottom = r1[ct.first] * (256 - wx) + r1[ct.last] * wx;
+            dst[x] = static_cast<vx_uint8>((top * (256 - wy) + bottom * wy + (1 << 15)) >> 16);
+        }
+    }
+}
+
+void HoughFrontEnd::process(vx_image frameRGBX, vx_image edges, vx_image dx, vx_image dy)
+{
+    vx_rectangle_t srcRect = {
+        0u, 0u,
+        static_cast<vx_uint32>(srcWidth_), static_cast<vx_uint32>(srcHeight_)
+    };
+
+    vx_map_id map_id;
+    vx_imagepatch_addressing_t addr;
+    void* ptr = nullptr;
+    NVXIO_SAFE_CALL( vxMapImagePatch(frameRGBX, &srcRect, 0, &map_id, &addr, &ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+
+    process(static_cast<const vx_uint8*>(ptr), addr.stride_y);
+
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(frameRGBX, map_id) );
+
+    // Upload the results
+
+    vx_rectangle_t dstRect = {
+        0u, 0u,
+        static_cast<vx_uint32>(width_), static_cast<vx_uint32>(height_)
+    };
+
+    vx_imagepatch_addressing_t u8Addr;
+    u8Addr.dim_x = width_;
+    u8Addr.dim_y = height_;
+    u8Addr.stride_x = sizeof(vx_uint8);
+    u8Addr.stride_y = width_ * sizeof(vx_uint8);
+    NVXIO_SAFE_CALL( vxCopyImagePatch(edges, &dstRect, 0, &u8Addr, edges_.data(), VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+
+    vx_imagepatch_addressing_t s16Addr;
+    s16Addr.dim_x = width_;
+    s16Addr.dim_y = height_;
+    s16Addr.stride_x = sizeof(vx_int16);
+    s16Addr.stride_y = width_ * sizeof(vx_int16);
+    NVXIO_SAFE_CALL( vxCopyImagePatch(dx, &dstRect, 0, &s16Addr, dx_.data(), VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+    NVXIO_SAFE_CALL( vxCopyImagePatch(dy, &dstRect, 0, &s16Addr, dy_.data(), VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+}
+
+template <typename Body>
+void HoughFrontEnd::forEachTile(const Body& body)
+{
+    vx_int32 numTiles = static_cast<vx_int32>(tileStrong_.size());
+    vx_int32 numBuffers = static_cast<vx_int32>(tileBuffers_.size());
+
+    // Every set of buffers is used by one thread at a time, for the tiles b, b + numBuffers, ...
+    nvx::parallelFor(0, numBuffers, 1, [this, &body, numTiles, numBuffers](vx_int32 first, vx_int32 last)
+    {
+        for (vx_int32 b = first; b < last; ++b)
+            for (vx_int32 t = b; t < numTiles; t += numBuffers)
+                body(t, tileBuffers_[b]);
+    });
+}
+
+void HoughFrontEnd::process(const vx_uint8* frameRGBX, vx_size stride)
+{
+    src_ = frameRGBX;
+    srcStride_ = stride;
+
+    vx_int32 numTiles = static_cast<vx_int32>(tileStrong_.size());
+
+    // Sweep 1: gray, scale, median, histogram
+
+    forEachTile([this](vx_int32 t, TileBuffers& buffers)
+    {
+        vx_uint32* hist = &tileHists_[t * 256];
+        std::fill(hist, hist + 256, 0);
+        medianSweep(t * tileRows_, std::min(height_, (t + 1) * tileRows_), buffers, hist);
+    });
+
+    // Equalization LUT from the histogram of the whole frame
+
+    vx_uint32 hist[256] = {};
+    for (vx_int32 t = 0; t < numTiles; ++t)
+        for (vx_int32 i = 0; i < 256; ++i)
+            hist[i] += tileHists_[t * 256 + i];
+
+    vx_uint32 total = static_cast<vx_uint32>(width_ * height_);
+    vx_uint32 cdfMin = 0;
+    for (vx_int32 i = 0; i < 256 && cdfMin == 0; ++i)
+        cdfMin = hist[i];
+
+    vx_uint32 cdf = 0;
+    for (vx_int32 i = 0; i < 256; ++i)
+    {
+        cdf += hist[i];
+        lut_[i] = total > cdfMin ?
+                    static_cast<vx_uint8>(std::lrint((cdf - std::min(cdf, cdfMin)) * 255.0 / (total - cdfMin))) :
+                    static_cast<vx_uint8>(i);
+    }
+
+    // Sweep 2: LUT, Sobel, Canny up to thresholding
+
+    forEachTile([this](vx_int32 t, TileBuffers& buffers)
+    {
+        edgesSweep(t * tileRows_, std::min(height_, (t + 1) * tileRows_), buffers, tileStrong_[t]);
+    });
+
+    propagateEdges();
+
+    src_ = nullptr;
+}
+
+void HoughFrontEnd::medianSweep(vx_int32 firstRow, vx_int32 lastRow, TileBuffers& buffers, vx_uint32* hist)
+{
+    // Downscaled rows of the tile plus one halo row on each side
+
+    vx_int32 s0 = clampRow(firstRow - 1, height_);
+    vx_int32 s1 = clampRow(lastRow, height_);
+
+    // Source rows they are computed from
+
+    vx_int32 g0 = rowTaps_[s0].first;
+    vx_int32 g1 = rowTaps_[s1].last;
+
+    vx_uint8* gray = buffers.gray.data();
+    for (vx_int32 y = g0; y <= g1; ++y)
+        convertRowToGray(src_ + y * srcStride_, gray + (y - g0) * srcWidth_, srcWidth_);
+
+    const vx_int32 paddedWidth = width_ + 2;
+    vx_uint8* scaled = buffers.scaled.data();
+    for (vx_int32 y = s0; y <= s1; ++y)
+    {
+        vx_uint8* row = scaled + (y - s0) * paddedWidth;
+        scaleRow(gray, g0, y, row + 1);
+        padRow(row, width_);
+    }
+
+    for (vx_int32 y = firstRow; y < lastRow; ++y)
+    {
+        const vx_uint8* r0 = scaled + (clampRow(y - 1, height_) - s0) * paddedWidth;
+        const vx_uint8* r1 = scaled + (y - s0) * paddedWidth;
+        const vx_uint8* r2 = scaled + (clampRow(y + 1, height_) - s0) * paddedWidth;
+
+        vx_uint8* dst = &median_[y * width_];
+        medianRow(r0, r1, r2, dst, width_);
+
+        for (vx_int32 x = 0; x < width_; ++x)
+            ++hist[dst[x]];
+    }
+}
+
+void HoughFrontEnd::edgesSweep(vx_int32 firstRow, vx_int32 lastRow, TileBuffers& buffers, std::vector<vx_int32>& strong)
+{
+    strong.clear();
+
+    const vx_int32 paddedWidth = width_ + 2;
+
+    // Equalized rows: Sobel of the halo rows needs one more row on each side
+
+    vx_int32 e0 = clampRow(firstRow - 2, height_);
+    vx_int32 e1 = clampRow(lastRow + 1, height_);
+
+    vx_uint8* equalized = buffers.equalized.data();
+    for (vx_int32 y = e0; y <= e1; ++y)
+    {
+        const vx_uint8* src = &median_[y * width_];
+        vx_uint8* row = equalized + (y - e0) * paddedWidth;
+        for (vx_int32 x = 0; x < width_; ++x)
+            row[x + 1] = lut_[src[x]];
+        padRow(row, width_);
+    }
+
+    // Sobel and L1 magnitude of the tile rows plus one halo row on each side
+
+    vx_int32 g0 = clampRow(firstRow - 1, height_);
+    vx_int32 g1 = clampRow(lastRow, height_);
+
+    vx_int16* gx = buffers.gx.data();
+    vx_int16* gy = buffers.gy.data();
+    vx_int32* mag = buffers.mag.data();
+
+    for (vx_int32 y = g0; y <= g1; ++y)
+    {
+        const vx_uint8* r0 = equalized + (clampRow(y - 1, height_) - e0) * paddedWidth;
+        const vx_uint8* r1 = equalized + (y - e0) * paddedWidth;
+        const vx_uint8* r2 = equalized + (clampRow(y + 1, height_) - e0) * paddedWidth;
+
+        vx_int16* gxRow = gx + (y - g0) * width_;
+        vx_int16* gyRow = gy + (y - g0) * width_;
+        vx_int32* magRow = mag + (y - g0) * paddedWidth;
+
+        for (vx_int32 x = 0; x < width_; ++x)
+        {
+            // x + 1 is the current pixel in the padded rows
+            vx_int32 h = (r0[x + 2] + 2 * r1[x + 2] + r2[x + 2]) - (r0[x] + 2 * r1[x] + r2[x]);
+            vx_int32 v = (r2[x] + 2 * r2[x + 1] + r2[x + 2]) - (r0[x] + 2 * r0[x + 1] + r0[x + 2]);
+            gxRow[x] = static_cast<vx_int16>(h);
+            gyRow[x] = static_cast<vx_int16>(v);
+            magRow[x + 1] = std::abs(h) + std::abs(v);
+        }
+        magRow[0] = magRow[1];
+        magRow[width_ + 1] = magRow[width_];
+
+        if (y >= firstRow && y < lastRow)
+        {
+            std::copy(gxRow, gxRow + width_, &dx_[y * width_]);
+            std::copy(gyRow, gyRow + width_, &dy_[y * width_]);
+        }
+    }
+
+    // Non-maximum suppression along the quantized gradient direction, and thresholding
+
+    // tan(22.5) and tan(67.5) in fixed point
+    const vx_int32 TAN22 = 13573, TAN67 = 79109, SHIFT = 15;
+
+    for (vx_int32 y = firstRow; y < lastRow; ++y)
+    {
+        const vx_int32* m0 = mag + (clampRow(y - 1, height_) - g0) * paddedWidth + 1;
+        const vx_int32* m1 = mag + (y - g0) * paddedWidth + 1;
+        const vx_int32* m2 = mag + (clampRow(y + 1, height_) - g0) * paddedWidth + 1;
+        const vx_int16* gxRow = gx + (y - g0) * width_;
+        const vx_int16* gyRow = gy + (y - g0) * width_;
+        vx_uint8* dst = &edges_[y * width_];
+
+        for (vx_int32 x = 0; x < width_; ++x)
+        {
+            vx_int32 m = m1[x];
+            dst[x] = 0;
+
+            if (m <= params_.cannyLowerThresh)
+                continue;
+
+            vx_int32 ax = std::abs(gxRow[x]), ay = std::abs(gyRow[x]);
+            vx_int32 before, after;
+
+            if ((ay << SHIFT) <= ax * TAN22)
+            {
+                before = m1[x - 1];
+                after = m1[x + 1];
+            }
+            else if ((ay << SHIFT) > ax * TAN67)
+            {
+                before = m0[x];
+                after = m2[x];
+            }
+            else if ((gxRow[x] ^ gyRow[x]) < 0)
+            {
+                before = m0[x + 1];
+                after = m2[x - 1];
+            }
+            else
+            {
+                before = m0[x - 1];
+                after = m2[x + 1];
+            }
+
+            if (m <= before || m < after)
+                continue;
+
+            if (m > params_.cannyUpperThresh)
+            {
+                dst[x] = EDGE;
+                strong.push_back(y * width_ + x);
+            }
+            else
+            {
+                dst[x] = WEAK;
+            }
+        }
+    }
+}
+
+void HoughFrontEnd::propagateEdges()
+{
+    // Hysteresis: the weak candidates connected to strong edges become edges
+
+    std::vector<vx_int32> stack;
+    for (const std::vector<vx_int32>& strong : tileStrong_)
+        stack.insert(stack.end(), strong.begin(), strong.end());
+
+    while (!stack.empty())
+    {
+        vx_int32 idx = stack.back();
+        stack.pop_back();
+
+        vx_int32 x = idx % width_, y = idx / width_;
+
+        for (vx_int32 ny = std::max(0, y - 1); ny <= std::min(height_ - 1, y + 1); ++ny)
+        {
+            for (vx_int32 nx = std::max(0, x - 1); nx <= std::min(width_ - 1, x + 1); ++nx)
+            {
+                vx_uint8& e = edges_[ny * width_ + nx];
+                if (e == WEAK)
+                {
+                    e = EDGE;
+                    stack.push_back(ny * width_ + nx);
+                }
+            }
+        }
+    }
+
+    // The remaining candidates are not edges
+
+    nvx::parallelFor(0, height_, tileRows_, [this](vx_int32 first, vx_int32 last)
+    {
+        for (vx_int32 i = first * width_; i < last * width_; ++i)
+            edges_[i] = edges_[i] == EDGE ? EDGE : 0;
+    });
+}
+
+const std::vector<vx_uint8>& HoughFrontEnd::getEdges() const
+{
+    return edges_;
+}
+
+const std::vector<vx_int16>& HoughFrontEnd::getDx() const
+{
+    return dx_;
+}
+
+const std::vector<vx_int16>& HoughFrontEnd::getDy() const
+{
+    return dy_;
+}
@@ -0,0 +1,121 @@
+#ifndef HOUGH_FRONTEND_HPP
+#define HOUGH_FRONTEND_HPP
+
+#include <vector>
+
+#include <NVX/nvx.h>
+
+//
+// Fused host implementation of the edge front-end of the Hough demo:
+//
+//   ColorConvert -> ScaleImage (down) -> Median3x3 -> EqualizeHist -> CannyEdgeDetector (L1, 3x3)
+//                                                               \--> Sobel3x3
+//
+// Instead of full-frame images between the stages, the downscaled frame is processed in tiles of
+// rows that go through all the stages at once, so the working set of a tile stays in the cache.
+// Tiles are processed in parallel, and every tile recomputes the few halo rows its filters need.
+//
+// Histogram equalization needs the histogram of the whole frame before any pixel can be mapped,
+// so the work is split into two sweeps over the tiles:
+//   1. color conversion, scaling and median filtering; the histogram is accumulated;
+//   2. equalization LUT, Sobel, Canny magnitude, non-maximum suppression and thresholding.
+// The median filtered frame is the one full-frame image written between the sweeps, one byte per pixel
+// of the downscaled frame; recomputing it in the second sweep would convert and scale every frame twice.
+// The hysteresis of Canny is then propagated from the strong edges of all tiles.
+//
+class HoughFrontEnd
+{
+public:
+    struct Params
+    {
+        vx_float32 scaleFactor;
+        // VX_INTERPOLATION_TYPE_NEAREST_NEIGHBOR, VX_INTERPOLATION_TYPE_BILINEAR or VX_INTERPOLATION_TYPE_AREA
+        vx_enum scaleType;
+        // Canny thresholds for the L1 norm of the 3x3 Sobel gradient
+        vx_int32 cannyLowerThresh;
+        vx_int32 cannyUpperThresh;
+        // number of rows of the downscaled frame processed by a tile, 0 - the whole frame in one tile
+        vx_uint32 tileRows;
+
+        Params();
+    };
+
+    HoughFrontEnd();
+
+    void init(vx_uint32 srcWidth, vx_uint32 srcHeight, const Params& params = Params());
+
+    // Size of the downscaled frame, the same as the one of vxScaleImageNode in the demo
+    vx_uint32 getWidth() const;
+    vx_uint32 getHeight() const;
+
+    // RGBX frame in, edges (VX_DF_IMAGE_U8) and derivatives (VX_DF_IMAGE_S16) of the downscaled size out
+    void process(vx_image frameRGBX, vx_image edges, vx_image dx, vx_image dy);
+    // Same for a frame in host memory, the results are kept in the host buffers below
+    void process(const vx_uint8* frameRGBX, vx_size stride);
+
+    const std::vector<vx_uint8>& getEdges() const;
+    const std::vector<vx_int16>& getDx() const;
+    const std::vector<vx_int16>& getDy() const;
+
+private:
+    // Source rows and columns every downscaled row/column is computed from
+    struct Tap
+    {
+        vx_int32 first, last;
+        // weight of 'last' in 1/256 (bilinear)
+        vx_int32 weight;
+    };
+
+    void computeTaps(vx_int32 srcSize, vx_int32 dstSize, std::vector<Tap>& taps) const;
+
+    // Intermediate rows of a tile and its halo, one set per worker thread, sized once by init
+    struct TileBuffers
+    {
+        std::vector<vx_uint8> gray;
+        std::vector<vx_uint8> scaled;
+        std::vector<vx_uint8> equalized;
+        std::vector<vx_int16> gx;
+        std::vector<vx_int16> gy;
+        std::vector<vx_int32> mag;
+    };
+
+    // Calls body(tile, buffers) for every tile, the tiles are shared among the sets of buffers
+    template <typename Body>
+    void forEachTile(const Body& body);
+
+    void medianSweep(vx_int32 firstRow, vx_int32 lastRow, TileBuffers& buffers, vx_uint32* hist);
+    void edgesSweep(vx_int32 firstRow, vx_int32 lastRow, TileBuffers& buffers, std::vector<vx_int32>& strong);
+    void propagateEdges();
+
+    void scaleRow(const vx_uint8* gray, vx_int32 grayFirstRow, vx_int32 row, vx_uint8* dst) const;
+
+    Params params_;
+
+    vx_int32 srcWidth_;
+    vx_int32 srcHeight_;
+    vx_int32 width_;
+    vx_int32 height_;
+    vx_int32 tileRows_;
+
+    std::vector<Tap> rowTaps_;
+    std::vector<Tap> colTaps_;
+
+    const vx_uint8* src_;
+    vx_size srcStride_;
+
+    // Median filtered frame, kept between the sweeps
+    std::vector<vx_uint8> median_;
+    std::vector<vx_uint32> tileHists_;
+    vx_uint8 lut_[256];
+
+    // Edges during the sweeps: 0 - no edge, WEAK - candidate, 255 - edge
+    std::vector<vx_uint8> edges_;
+    std::vector<vx_int16> dx_;
+    std::vector<vx_int16> dy_;
+
+    std::vector<std::vector<vx_int32>> tileStrong_;
+
+    std::vector<TileBuffers> tileBuffers_;
+};
+
+#endif
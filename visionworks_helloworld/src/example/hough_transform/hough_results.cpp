@@ -0,0 +1,73 @@
+#include "hough_results.hpp"
+
+#include <cmath>
+
+#include "NVXIO/Utility.hpp"
+
+HoughOutputTransform::HoughOutputTransform()
+{
+    m[0] = 1.0f; m[1] = 0.0f; m[2] = 0.0f;
+    m[3] = 0.0f; m[4] = 1.0f; m[5] = 0.0f;
+    radiusScale = 1.0f;
+}
+
+HoughOutputTransform HoughOutputTransform::scale(vx_float32 scaleX, vx_float32 scaleY,
+                                                 vx_float32 offsetX, vx_float32 offsetY)
+{
+    const vx_float32 matrix[6] = {
+        scaleX, 0.0f, offsetX,
+        0.0f, scaleY, offsetY
+    };
+    return affine(matrix);
+}
+
+HoughOutputTransform HoughOutputTransform::affine(const vx_float32 matrix[6])
+{
+    HoughOutputTransform transform;
+    for (vx_int32 i = 0; i < 6; ++i)
+        transform.m[i] = matrix[i];
+    transform.radiusScale = std::sqrt(std::fabs(matrix[0] * matrix[4] - matrix[1] * matrix[3]));
+    return transform;
+}
+
+bool HoughOutputTransform::isIdentity() const
+{
+    return m[0] == 1.0f && m[1] == 0.0f && m[2] == 0.0f &&
+           m[3] == 0.0f && m[4] == 1.0f && m[5] == 0.0f;
+}
+
+void transformHoughArray(vx_array array, const HoughOutputTransform& transform)
+{
+    if (transform.isIdentity())
+        return;
+
+    vx_enum itemType = 0;
+    vx_size numItems = 0;
+    NVXIO_SAFE_CALL( vxQueryArray(array, VX_ARRAY_ATTRIBUTE_ITEMTYPE, &itemType, sizeof(itemType)) );
+    NVXIO_SAFE_CALL( vxQueryArray(array, VX_ARRAY_ATTRIBUTE_NUMITEMS, &numItems, sizeof(numItems)) );
+    NVXIO_ASSERT(itemType == NVX_TYPE_POINT3F || itemType == NVX_TYPE_POINT4F);
+
+    if (numItems == 0)
+        return;
+
+    vx_map_id map_id;
+    vx_size stride;
+    void *ptr;
+    NVXIO_SAFE_CALL( vxMapArrayRange(array, 0, numItems, &map_id, &stride, &ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, 0) );
+
+    for (vx_size i = 0; i < numItems; ++i)
+    {
+        if (itemType == NVX_TYPE_POINT3F)
+        {
+            nvx_point3f_t *c = (nvx_point3f_t *)vxFormatArrayPointer(ptr, i, stride);
+            *c = transform.apply(*c);
+        }
+        else
+        {
+            nvx_point4f_t *s = (nvx_point4f_t *)vxFormatArrayPointer(ptr, i, stride);
+            *s = transform.apply(*s);
+        }
+    }
+
+    NVXIO_SAFE_CALL( vxUnmapArrayRange(array, map_id) );
+}
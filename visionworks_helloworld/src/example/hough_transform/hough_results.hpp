@@ -0,0 +1,81 @@
+#ifndef HOUGH_RESULTS_HPP
+#define HOUGH_RESULTS_HPP
+
+#include <NVX/nvx.h>
+
+//
+// Transform from the coordinates of the detector (the downscaled frame) to the output ones:
+//
+//   x' = m[0] * x + m[1] * y + m[2]
+//   y' = m[3] * x + m[4] * y + m[5]
+//
+// Radii are multiplied by sqrt(|det|), which is exact for similarity transforms.
+// The host detectors apply it when a result is emitted, so no pass over the results is needed.
+//
+struct HoughOutputTransform
+{
+    vx_float32 m[6];
+    vx_float32 radiusScale;
+
+    // Identity
+    HoughOutputTransform();
+
+    static HoughOutputTransform scale(vx_float32 scaleX, vx_float32 scaleY,
+                                      vx_float32 offsetX = 0.0f, vx_float32 offsetY = 0.0f);
+    static HoughOutputTransform affine(const vx_float32 matrix[6]);
+
+    bool isIdentity() const;
+
+    nvx_point3f_t apply(const nvx_point3f_t& circle) const
+    {
+        nvx_point3f_t out = {
+            m[0] * circle.x + m[1] * circle.y + m[2],
+            m[3] * circle.x + m[4] * circle.y + m[5],
+            circle.z * radiusScale
+        };
+        return out;
+    }
+
+    nvx_point4f_t apply(const nvx_point4f_t& segment) const
+    {
+        nvx_point4f_t out = {
+            m[0] * segment.x + m[1] * segment.y + m[2],
+            m[3] * segment.x + m[4] * segment.y + m[5],
+            m[0] * segment.z + m[1] * segment.w + m[2],
+            m[3] * segment.z + m[4] * segment.w + m[5]
+        };
+        return out;
+    }
+};
+
+// Applies the transform in place to an array of NVX_TYPE_POINT3F (circles) or NVX_TYPE_POINT4F (segments) items.
+// Needed for the results of nvxHoughCirclesNode and nvxHoughSegmentsNode, which have no output transform.
+void transformHoughArray(vx_array array, const HoughOutputTransform& transform);
+
+//
+// Read-only view of detection results, e.g. for a renderer. It doesn't own the items,
+// and is valid until the next call of process() of the detector it was taken from.
+//
+template <typename T>
+class HoughResultView
+{
+public:
+    HoughResultView() : data_(nullptr), size_(0) {}
+    HoughResultView(const T* data, vx_size size) : data_(data), size_(size) {}
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& operator[](vx_size i) const { return data_[i]; }
+
+    vx_size size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    const T* data_;
+    vx_size size_;
+};
+
+typedef HoughResultView<nvx_point3f_t> HoughCirclesView;
+typedef HoughResultView<nvx_point4f_t> HoughSegmentsView;
+
+#endif
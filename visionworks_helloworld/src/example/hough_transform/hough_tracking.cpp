@@ -0,0 +1,73 @@
+#include "hough_tracking.hpp"
+
+#include "NVXIO/Utility.hpp"
+
+HoughTrackingParams::HoughTrackingParams()
+{
+    fullDetectionPeriod = 0;
+    minTrackedFraction = 0.75f;
+    centerRange = 4.0f;
+    radiusRange = 3.0f;
+    distanceRange = 4.0f;
+    angleRange = 3.0f * nvxio::PI_F / 180.0f;
+}
+
+HoughTrackingPolicy::HoughTrackingPolicy()
+{
+    reset();
+}
+
+void HoughTrackingPolicy::setParams(const HoughTrackingParams& params)
+{
+    NVXIO_ASSERT(params.minTrackedFraction >= 0.0f && params.minTrackedFraction <= 1.0f);
+    NVXIO_ASSERT(params.centerRange >= 0.0f && params.radiusRange >= 0.0f);
+    NVXIO_ASSERT(params.distanceRange >= 0.0f && params.angleRange >= 0.0f);
+
+    params_ = params;
+    reset();
+}
+
+const HoughTrackingParams& HoughTrackingPolicy::getParams() const
+{
+    return params_;
+}
+
+void HoughTrackingPolicy::reset()
+{
+    hasDetection_ = false;
+    lastTracked_ = false;
+    framesSinceFull_ = 0;
+    lastFullCount_ = 0;
+}
+
+bool HoughTrackingPolicy::isFullDetectionDue() const
+{
+    return params_.fullDetectionPeriod <= 1 || !hasDetection_ ||
+           framesSinceFull_ + 1 >= params_.fullDetectionPeriod;
+}
+
+bool HoughTrackingPolicy::acceptTracked(vx_size numResults) const
+{
+    return numResults >= params_.minTrackedFraction * lastFullCount_;
+}
+
+void HoughTrackingPolicy::update(bool fullDetection, vx_size numResults)
+{
+    lastTracked_ = !fullDetection;
+
+    if (fullDetection)
+    {
+        hasDetection_ = true;
+        framesSinceFull_ = 0;
+        lastFullCount_ = numResults;
+    }
+    else
+    {
+        ++framesSinceFull_;
+    }
+}
+
+bool HoughTrackingPolicy::wasTracked() const
+{
+    return lastTracked_;
+}
@@ -0,0 +1,61 @@
+#ifndef HOUGH_TRACKING_HPP
+#define HOUGH_TRACKING_HPP
+
+#include <NVX/nvx.h>
+
+//
+// Tracking mode of the host Hough detectors for video streams.
+//
+// Between full detections every result of the previous frame is searched for only in a small
+// neighbourhood of its parameters: edge points near it vote for the nearby parameters only.
+// A full detection runs every fullDetectionPeriod frames, and at once when the number of tracked
+// results drops below minTrackedFraction of the last full detection (lost or new objects).
+//
+struct HoughTrackingParams
+{
+    // 0 or 1 - every frame is a full detection (tracking is off)
+    vx_uint32 fullDetectionPeriod;
+    vx_float32 minTrackedFraction;
+
+    // Circles: shift of the center and change of the radius between frames, in pixels
+    vx_float32 centerRange;
+    vx_float32 radiusRange;
+
+    // Segments: shift of the line in pixels and its rotation in radians between frames
+    vx_float32 distanceRange;
+    vx_float32 angleRange;
+
+    HoughTrackingParams();
+};
+
+// When to run a full detection instead of tracking
+class HoughTrackingPolicy
+{
+public:
+    HoughTrackingPolicy();
+
+    void setParams(const HoughTrackingParams& params);
+    const HoughTrackingParams& getParams() const;
+
+    // Forgets the previous frames, the next one is a full detection
+    void reset();
+
+    bool isFullDetectionDue() const;
+    // Whether the results of a tracked frame are kept, or a full detection is needed
+    bool acceptTracked(vx_size numResults) const;
+
+    void update(bool fullDetection, vx_size numResults);
+
+    // Whether the last frame was tracked
+    bool wasTracked() const;
+
+private:
+    HoughTrackingParams params_;
+
+    bool hasDetection_;
+    bool lastTracked_;
+    vx_uint32 framesSinceFull_;
+    vx_size lastFullCount_;
+};
+
+#endif
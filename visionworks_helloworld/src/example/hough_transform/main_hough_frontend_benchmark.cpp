@@ -0,0 +1,317 @@
+/*
+# Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <memory>
+#include <vector>
+
+#include <NVX/nvx.h>
+#include <NVX/nvx_timer.hpp>
+
+#include <NVXIO/Application.hpp>
+#include <NVXIO/FrameSource.hpp>
+#include <NVXIO/Utility.hpp>
+
+#include "hough_frontend.hpp"
+
+//
+// Benchmark of the edge front-end of the Hough demo: the staged graph with a full-frame
+// virtual image between the nodes versus HoughFrontEnd, tiled and as one tile.
+//
+
+namespace {
+
+struct Timing
+{
+    Timing() : total_ms(0), min_ms(1e9) {}
+
+    void add(double ms)
+    {
+        total_ms += ms;
+        min_ms = std::min(min_ms, ms);
+    }
+
+    double total_ms;
+    double min_ms;
+};
+
+// Edge pixel counts of the fused map against the reference graph map.
+// Background pixels are left out: they dominate any frame and would hide real differences.
+struct EdgeStats
+{
+    EdgeStats() : both(0), referenceOnly(0), testedOnly(0) {}
+
+    double precision() const { return percent(both, both + testedOnly); }
+    double recall() const { return percent(both, both + referenceOnly); }
+    double agreement() const { return percent(both, both + referenceOnly + testedOnly); }
+
+    static double percent(vx_size part, vx_size total)
+    {
+        return total > 0 ? 100.0 * part / total : 100.0;
+    }
+
+    vx_size both;
+    vx_size referenceOnly;
+    vx_size testedOnly;
+};
+
+void compareEdges(vx_image reference, vx_image tested, vx_uint32 width, vx_uint32 height, EdgeStats& stats)
+{
+    vx_rectangle_t rect = { 0u, 0u, width, height };
+
+    std::vector<vx_uint8> bufRef(width * height), bufTest(width * height);
+
+    vx_imagepatch_addressing_t addr;
+    addr.dim_x = width;
+    addr.dim_y = height;
+    addr.stride_x = sizeof(vx_uint8);
+    addr.stride_y = width * sizeof(vx_uint8);
+
+    NVXIO_SAFE_CALL( vxCopyImagePatch(reference, &rect, 0, &addr, bufRef.data(), VX_READ_ONLY, VX_MEMORY_TYPE_HOST) );
+    NVXIO_SAFE_CALL( vxCopyImagePatch(tested, &rect, 0, &addr, bufTest.data(), VX_READ_ONLY, VX_MEMORY_TYPE_HOST) );
+
+    for (vx_size i = 0; i < bufRef.size(); ++i)
+    {
+        bool inRef = bufRef[i] != 0, inTest = bufTest[i] != 0;
+        stats.both += inRef && inTest;
+        stats.referenceOnly += inRef && !inTest;
+        stats.testedOnly += !inRef && inTest;
+    }
+}
+
+}
+
+//
+// main - Application entry point
+//
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        nvxio::Application &app = nvxio::Application::get();
+
+        //
+        // Parse command line arguments
+        //
+
+        std::string sourceUri = "./data/signs.avi";
+        unsigned int numFrames = 100;
+        HoughFrontEnd::Params params;
+
+        app.setDescription("This sample compares the staged edge graph of the Hough demo with the fused host front-end");
+        app.addOption('s', "source", "Input URI", nvxio::OptionHandler::string(&sourceUri));
+        app.addOption('n', "frames", "Number of processed frames", nvxio::OptionHandler::unsignedInteger(&numFrames,
+                      nvxio::ranges::atLeast(1u)));
+        app.addOption('t', "tile", "Rows of the downscaled frame per tile", nvxio::OptionHandler::unsignedInteger(&params.tileRows,
+                      nvxio::ranges::atLeast(1u)));
+        app.addOption(0, "scale", "Scale factor", nvxio::OptionHandler::real(&params.scaleFactor,
+                      nvxio::ranges::moreThan(0.f) & nvxio::ranges::atMost(1.f)));
+        app.init(argc, argv);
+
+        //
+        // Create OpenVX context and frame source
+        //
+
+        nvxio::ContextGuard context;
+        vxDirective(context, VX_DIRECTIVE_ENABLE_PERFORMANCE);
+        vxRegisterLogCallback(context, &nvxio::stdoutLogCallback, vx_false_e);
+
+        std::unique_ptr<nvxio::FrameSource> frameSource(nvxio::createDefaultFrameSource(context, sourceUri));
+
+        if (!frameSource || !frameSource->open())
+        {
+            std::cerr << "Error: Can't open source URI " << sourceUri << std::endl;
+            return nvxio::Application::APP_EXIT_CODE_NO_RESOURCE;
+        }
+
+        nvxio::FrameSource::Parameters frameConfig = frameSource->getConfiguration();
+
+        HoughFrontEnd fused, fusedOneTile;
+        fused.init(frameConfig.frameWidth, frameConfig.frameHeight, params);
+
+        HoughFrontEnd::Params oneTileParams = params;
+        oneTileParams.tileRows = 0;
+        fusedOneTile.init(frameConfig.frameWidth, frameConfig.frameHeight, oneTileParams);
+
+        vx_uint32 width = fused.getWidth();
+        vx_uint32 height = fused.getHeight();
+
+        //
+        // Create OpenVX objects
+        //
+
+        vx_image frame = vxCreateImage(context, frameConfig.frameWidth, frameConfig.frameHeight, VX_DF_IMAGE_RGBX);
+        NVXIO_CHECK_REFERENCE(frame);
+
+        vx_image graphEdges = vxCreateImage(context, width, height, VX_DF_IMAGE_U8);
+        NVXIO_CHECK_REFERENCE(graphEdges);
+        vx_image graphDx = vxCreateImage(context, width, height, VX_DF_IMAGE_S16);
+        NVXIO_CHECK_REFERENCE(graphDx);
+        vx_image graphDy = vxCreateImage(context, width, height, VX_DF_IMAGE_S16);
+        NVXIO_CHECK_REFERENCE(graphDy);
+
+        vx_image fusedEdges = vxCreateImage(context, width, height, VX_DF_IMAGE_U8);
+        NVXIO_CHECK_REFERENCE(fusedEdges);
+        vx_image fusedDx = vxCreateImage(context, width, height, VX_DF_IMAGE_S16);
+        NVXIO_CHECK_REFERENCE(fusedDx);
+        vx_image fusedDy = vxCreateImage(context, width, height, VX_DF_IMAGE_S16);
+        NVXIO_CHECK_REFERENCE(fusedDy);
+
+        vx_threshold CannyThreshold = vxCreateThreshold(context, VX_THRESHOLD_TYPE_RANGE, VX_TYPE_INT32);
+        NVXIO_CHECK_REFERENCE(CannyThreshold);
+        NVXIO_SAFE_CALL( vxSetThresholdAttribute(CannyThreshold, VX_THRESHOLD_ATTRIBUTE_THRESHOLD_LOWER,
+                                                 &params.cannyLowerThresh, sizeof(params.cannyLowerThresh)) );
+        NVXIO_SAFE_CALL( vxSetThresholdAttribute(CannyThreshold, VX_THRESHOLD_ATTRIBUTE_THRESHOLD_UPPER,
+                                                 &params.cannyUpperThresh, sizeof(params.cannyUpperThresh)) );
+
+        //
+        // The staged graph of the demo
+        //
+
+        vx_graph graph = vxCreateGraph(context);
+        NVXIO_CHECK_REFERENCE(graph);
+
+        vx_image virt_U8 = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
+        vx_image virt_scaled = vxCreateVirtualImage(graph, width, height, VX_DF_IMAGE_U8);
+        vx_image virt_blurred = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
+        vx_image virt_equalized = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
+
+        vx_node nodes[] = {
+            vxColorConvertNode(graph, frame, virt_U8),
+            vxScaleImageNode(graph, virt_U8, virt_scaled, params.scaleType),
+            vxMedian3x3Node(graph, virt_scaled, virt_blurred),
+            vxEqualizeHistNode(graph, virt_blurred, virt_equalized),
+            vxCannyEdgeDetectorNode(graph, virt_equalized, CannyThreshold, 3, VX_NORM_L1, graphEdges),
+            vxSobel3x3Node(graph, virt_equalized, graphDx, graphDy)
+        };
+
+        for (vx_node node : nodes)
+            NVXIO_CHECK_REFERENCE(node);
+
+        vxReleaseImage(&virt_U8);
+        vxReleaseImage(&virt_scaled);
+        vxReleaseImage(&virt_blurred);
+        vxReleaseImage(&virt_equalized);
+        vxReleaseThreshold(&CannyThreshold);
+
+        if (vxVerifyGraph(graph) != VX_SUCCESS)
+        {
+            std::cerr << "Error: Graph verification failed. See the NVX LOG for explanation." << std::endl;
+            return nvxio::Application::APP_EXIT_CODE_INVALID_GRAPH;
+        }
+
+        //
+        // Run
+        //
+
+        Timing graphTime, fusedTime, oneTileTime;
+        EdgeStats edgeStats;
+        vx_uint32 processed = 0;
+
+        while (processed < numFrames)
+        {
+            nvxio::FrameSource::FrameStatus frameStatus = frameSource->fetch(frame);
+
+            if (frameStatus == nvxio::FrameSource::TIMEOUT)
+                continue;
+
+            if (frameStatus == nvxio::FrameSource::CLOSED)
+            {
+                if (processed == 0 || !frameSource->open())
+                    break;
+                continue;
+            }
+
+            nvx::Timer timer;
+
+            timer.tic();
+            NVXIO_SAFE_CALL( vxProcessGraph(graph) );
+            graphTime.add(timer.toc());
+
+            timer.tic();
+            fused.process(frame, fusedEdges, fusedDx, fusedDy);
+            fusedTime.add(timer.toc());
+
+            timer.tic();
+            fusedOneTile.process(frame, fusedEdges, fusedDx, fusedDy);
+            oneTileTime.add(timer.toc());
+
+            compareEdges(graphEdges, fusedEdges, width, height, edgeStats);
+            ++processed;
+        }
+
+        if (processed == 0)
+        {
+            std::cerr << "Source has no frames" << std::endl;
+            return nvxio::Application::APP_EXIT_CODE_NO_FRAMESOURCE;
+        }
+
+        //
+        // Report
+        //
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Resolution: " << frameConfig.frameWidth << 'x' << frameConfig.frameHeight
+                  << " -> " << width << 'x' << height << ", " << processed << " frames" << std::endl;
+        std::cout << "Staged graph         : " << graphTime.total_ms / processed << " ms/frame (min " << graphTime.min_ms << " ms)" << std::endl;
+        std::cout << "Fused, " << std::setw(4) << params.tileRows << " rows/tile : "
+                  << fusedTime.total_ms / processed << " ms/frame (min " << fusedTime.min_ms << " ms)" << std::endl;
+        std::cout << "Fused, one tile      : " << oneTileTime.total_ms / processed << " ms/frame (min " << oneTileTime.min_ms << " ms)" << std::endl;
+        std::cout << std::setprecision(2);
+        std::cout << "Edge pixels agreement with the graph: " << edgeStats.agreement() << " % (precision "
+                  << edgeStats.precision() << " %, recall " << edgeStats.recall() << " %)" << std::endl;
+
+        //
+        // Release all objects
+        //
+
+        for (vx_node& node : nodes)
+            vxReleaseNode(&node);
+        vxReleaseGraph(&graph);
+
+        vxReleaseImage(&frame);
+        vxReleaseImage(&graphEdges);
+        vxReleaseImage(&graphDx);
+        vxReleaseImage(&graphDy);
+        vxReleaseImage(&fusedEdges);
+        vxReleaseImage(&fusedDx);
+        vxReleaseImage(&fusedDy);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return nvxio::Application::APP_EXIT_CODE_ERROR;
+    }
+
+    return nvxio::Application::APP_EXIT_CODE_SUCCESS;
+}
@@ -0,0 +1,290 @@
+/*
+# Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include <NVX/nvx.h>
+#include <NVX/nvx_timer.hpp>
+
+#include <NVXIO/Application.hpp>
+
+#include "host_hough_circles.hpp"
+#include "host_hough_segments.hpp"
+
+//
+// Benchmark of the tracking mode of the host Hough detectors: the same synthetic frames, with
+// slowly moving circles and segments over sparse noise edges, go through a full detection on
+// every frame and through the tracking mode. No GPU and no video file are needed.
+//
+
+namespace {
+
+// Edge map and Sobel derivatives of one frame, as produced by the front-end of the demo
+struct SyntheticFrame
+{
+    vx_int32 width, height;
+    std::vector<vx_uint8> edges;
+    std::vector<vx_int16> dx, dy;
+};
+
+void drawSegment(SyntheticFrame& frame, vx_float32 x0, vx_float32 y0, vx_float32 x1, vx_float32 y1)
+{
+    vx_int32 steps = static_cast<vx_int32>(std::max(std::abs(x1 - x0), std::abs(y1 - y0))) + 1;
+    for (vx_int32 i = 0; i <= steps; ++i)
+    {
+        vx_int32 x = static_cast<vx_int32>(x0 + (x1 - x0) * i / steps + 0.5f);
+        vx_int32 y = static_cast<vx_int32>(y0 + (y1 - y0) * i / steps + 0.5f);
+        if (x >= 0 && x < frame.width && y >= 0 && y < frame.height)
+            frame.edges[y * frame.width + x] = 255;
+    }
+}
+
+// Frame 'index' of a sequence where every object moves by about one pixel per frame
+void makeFrame(vx_uint32 index, SyntheticFrame& frame)
+{
+    const vx_int32 w = frame.width, h = frame.height;
+    const vx_float32 t = static_cast<vx_float32>(index % 200);
+
+    std::fill(frame.edges.begin(), frame.edges.end(), 0);
+
+    // Filled discs, smoothed so the derivatives point across their borders
+    struct Disc { vx_float32 x, y, r; };
+    const Disc discs[] = {
+        { 0.45f * w + t, 0.40f * h, 20.0f },
+        { 0.70f * w, 0.60f * h + 0.5f * t, 12.0f },
+        { 0.80f * w - t, 0.25f * h, 24.0f },
+        { 0.20f * w, 0.70f * h - 0.5f * t, 16.0f }
+    };
+
+    std::vector<vx_int32> image(w * h, 0);
+    for (vx_int32 y = 0; y < h; ++y)
+        for (vx_int32 x = 0; x < w; ++x)
+            for (const Disc& d : discs)
+                if ((x - d.x) * (x - d.x) + (y - d.y) * (y - d.y) <= d.r * d.r)
+                    image[y * w + x] = 200;
+
+    // 5x5 box blur, in two separable passes
+    std::vector<vx_int32> tmp(w * h, 0);
+    for (vx_int32 y = 0; y < h; ++y)
+        for (vx_int32 x = 2; x < w - 2; ++x)
+            tmp[y * w + x] = image[y * w + x - 2] + image[y * w + x - 1] + image[y * w + x] + image[y * w + x + 1] + image[y * w + x + 2];
+    for (vx_int32 y = 2; y < h - 2; ++y)
+        for (vx_int32 x = 0; x < w; ++x)
+            image[y * w + x] = (tmp[(y - 2) * w + x] + tmp[(y - 1) * w + x] + tmp[y * w + x] + tmp[(y + 1) * w + x] + tmp[(y + 2) * w + x]) / 25;
+
+    std::fill(frame.dx.begin(), frame.dx.end(), 0);
+    std::fill(frame.dy.begin(), frame.dy.end(), 0);
+    for (vx_int32 y = 1; y < h - 1; ++y)
+    {
+        const vx_int32* r0 = &image[(y - 1) * w];
+        const vx_int32* r1 = &image[y * w];
+        const vx_int32* r2 = &image[(y + 1) * w];
+
+        for (vx_int32 x = 1; x < w - 1; ++x)
+        {
+            vx_int32 gx = (r0[x + 1] + 2 * r1[x + 1] + r2[x + 1]) - (r0[x - 1] + 2 * r1[x - 1] + r2[x - 1]);
+            vx_int32 gy = (r2[x - 1] + 2 * r2[x] + r2[x + 1]) - (r0[x - 1] + 2 * r0[x] + r0[x + 1]);
+            frame.dx[y * w + x] = static_cast<vx_int16>(gx);
+            frame.dy[y * w + x] = static_cast<vx_int16>(gy);
+            if (std::abs(gx) + std::abs(gy) > 250)
+                frame.edges[y * w + x] = 255;
+        }
+    }
+
+    drawSegment(frame, 0.03f * w, 0.10f * h + 0.5f * t, 0.94f * w, 0.10f * h + 0.5f * t);
+    drawSegment(frame, 0.15f * w + t, 0.02f * h, 0.15f * w + t, 0.83f * h);
+    drawSegment(frame, 0.23f * w, 0.12f * h + t, 0.62f * w, 0.65f * h + t);
+    drawSegment(frame, 0.55f * w - t, 0.90f * h, 0.95f * w - t, 0.75f * h);
+
+    // Sparse noise edges, different in every frame
+    std::minstd_rand rng(index);
+    for (vx_int32 i = 0; i < w * h / 100; ++i)
+        frame.edges[(rng() % h) * w + rng() % w] = 255;
+}
+
+// Time and results of one detector in one mode
+struct DetectorStats
+{
+    DetectorStats() : total_ms(0), trackedFrames(0), tracked_ms(0), numResults(0) {}
+
+    void add(double ms, bool tracked, vx_size results)
+    {
+        total_ms += ms;
+        numResults += results;
+        if (tracked)
+        {
+            ++trackedFrames;
+            tracked_ms += ms;
+        }
+    }
+
+    double total_ms;
+    // Frames where the results of the previous frame were tracked, the others ran a full detection
+    vx_uint32 trackedFrames;
+    double tracked_ms;
+    vx_size numResults;
+};
+
+void report(const char* name, const DetectorStats& full, const DetectorStats& tracking, vx_uint32 numFrames)
+{
+    double full_ms = full.total_ms / numFrames;
+    double tracking_ms = tracking.total_ms / numFrames;
+    double tracked_ms = tracking.trackedFrames > 0 ? tracking.tracked_ms / tracking.trackedFrames : 0.0;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << name << std::endl;
+    std::cout << "    full detection : " << full_ms << " ms/frame, "
+              << std::setprecision(1) << static_cast<double>(full.numResults) / numFrames << " results/frame" << std::endl;
+    std::cout << std::setprecision(3);
+    std::cout << "    tracking mode  : " << tracking_ms << " ms/frame, "
+              << std::setprecision(1) << static_cast<double>(tracking.numResults) / numFrames << " results/frame, "
+              << tracking.trackedFrames << " of " << numFrames << " frames tracked" << std::endl;
+    std::cout << std::setprecision(3);
+    std::cout << "    tracked frame  : " << tracked_ms << " ms" << std::endl;
+
+    std::cout << std::setprecision(1);
+    std::cout << "    speedup        : " << full_ms / tracking_ms << "x for the tracking mode";
+    if (tracked_ms > 0)
+        std::cout << ", " << full_ms / tracked_ms << "x for a tracked frame";
+    std::cout << std::endl;
+}
+
+}
+
+//
+// main - Application entry point
+//
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        nvxio::Application &app = nvxio::Application::get();
+
+        //
+        // Parse command line arguments
+        //
+
+        unsigned int width = 640, height = 480;
+        unsigned int numFrames = 100;
+        unsigned int fullDetectionPeriod = 10;
+
+        app.setDescription("This sample compares the full Hough detection of the host backend with its tracking mode");
+        app.addOption('w', "width", "Width of the edge map", nvxio::OptionHandler::unsignedInteger(&width,
+                      nvxio::ranges::atLeast(320u)));
+        app.addOption('h', "height", "Height of the edge map", nvxio::OptionHandler::unsignedInteger(&height,
+                      nvxio::ranges::atLeast(240u)));
+        app.addOption('n', "frames", "Number of processed frames", nvxio::OptionHandler::unsignedInteger(&numFrames,
+                      nvxio::ranges::atLeast(1u)));
+        app.addOption('t', "tracking", "Full detection every N frames in the tracking mode", nvxio::OptionHandler::unsignedInteger(&fullDetectionPeriod,
+                      nvxio::ranges::atLeast(2u)));
+        app.init(argc, argv);
+
+        //
+        // The default parameters of the demo
+        //
+
+        HostHoughSegments::Params segmentsParams;
+        HostHoughCircles::Params circlesParams;
+
+        HostHoughSegments fullSegments, trackedSegments;
+        HostHoughCircles fullCircles, trackedCircles;
+
+        fullSegments.init(width, height, segmentsParams);
+        trackedSegments.init(width, height, segmentsParams);
+        fullCircles.init(width, height, circlesParams);
+        trackedCircles.init(width, height, circlesParams);
+
+        HoughTrackingParams trackingParams;
+        trackingParams.fullDetectionPeriod = fullDetectionPeriod;
+        trackedSegments.setTracking(trackingParams);
+        trackedCircles.setTracking(trackingParams);
+
+        //
+        // Run
+        //
+
+        SyntheticFrame frame;
+        frame.width = static_cast<vx_int32>(width);
+        frame.height = static_cast<vx_int32>(height);
+        frame.edges.resize(width * height);
+        frame.dx.resize(width * height);
+        frame.dy.resize(width * height);
+
+        DetectorStats fullSegmentsStats, trackedSegmentsStats;
+        DetectorStats fullCirclesStats, trackedCirclesStats;
+
+        nvx::Timer timer;
+
+        for (vx_uint32 i = 0; i < numFrames; ++i)
+        {
+            makeFrame(i, frame);
+
+            const vx_size dStride = frame.width * sizeof(vx_int16);
+
+            timer.tic();
+            fullSegments.process(frame.edges.data(), frame.width);
+            fullSegmentsStats.add(timer.toc(), false, fullSegments.getSegments().size());
+
+            timer.tic();
+            trackedSegments.process(frame.edges.data(), frame.width);
+            trackedSegmentsStats.add(timer.toc(), trackedSegments.wasTracked(), trackedSegments.getSegments().size());
+
+            timer.tic();
+            fullCircles.process(frame.edges.data(), frame.width, frame.dx.data(), dStride, frame.dy.data(), dStride);
+            fullCirclesStats.add(timer.toc(), false, fullCircles.getCircles().size());
+
+            timer.tic();
+            trackedCircles.process(frame.edges.data(), frame.width, frame.dx.data(), dStride, frame.dy.data(), dStride);
+            trackedCirclesStats.add(timer.toc(), trackedCircles.wasTracked(), trackedCircles.getCircles().size());
+        }
+
+        //
+        // Report
+        //
+
+        std::cout << "Edge map: " << width << 'x' << height << ", " << numFrames << " frames, full detection every "
+                  << fullDetectionPeriod << " frames in the tracking mode" << std::endl;
+
+        report("Segments", fullSegmentsStats, trackedSegmentsStats, numFrames);
+        report("Circles", fullCirclesStats, trackedCirclesStats, numFrames);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return nvxio::Application::APP_EXIT_CODE_ERROR;
+    }
+
+    return nvxio::Application::APP_EXIT_CODE_SUCCESS;
+}
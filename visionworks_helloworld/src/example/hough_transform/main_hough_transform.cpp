@@ -43,6 +43,11 @@
 #include <NVXIO/SyncTimer.hpp>
 #include <NVXIO/Utility.hpp>
 
+#include "hough_frontend.hpp"
+#include "hough_results.hpp"
+#include "hough_tracking.hpp"
+#include "host_hough_circles.hpp"
+#include "host_hough_segments.hpp"
 
 namespace {
 
@@ -50,6 +55,24 @@ namespace {
 // Utility
 //
 
+// Where the Hough detectors run
+enum HoughBackend
+{
+    // nvxHoughSegmentsNode and nvxHoughCirclesNode
+    HOUGH_BACKEND_GPU,
+    // host implementations, fed with the edges computed by the graph
+    HOUGH_BACKEND_HOST
+};
+
+// How the edges and the derivatives are computed from the frame
+enum HoughFrontEndMode
+{
+    // one graph node per stage with full-frame virtual images between them
+    HOUGH_FRONTEND_GRAPH,
+    // all stages at once in tiles of rows on the host (HoughFrontEnd)
+    HOUGH_FRONTEND_FUSED
+};
+
 struct HoughTransformDemoParams
 {
     vx_uint32   switchPeriod;
@@ -256,10 +279,23 @@ int main(int argc, char** argv)
 		std::string configFile = "./data/hough_transform_demo_config.ini";
 
         HoughTransformDemoParams params;
+        HoughBackend backend = HOUGH_BACKEND_GPU;
+        HoughFrontEndMode frontEndMode = HOUGH_FRONTEND_GRAPH;
+        unsigned int fullDetectionPeriod = 0;
 
         app.setDescription("This demo demonstrates circles and lines detection via Hough transform");
         app.addOption('s', "source", "Input URI", nvxio::OptionHandler::string(&sourceUri));
         app.addOption('c', "config", "Config file path", nvxio::OptionHandler::string(&configFile));
+        app.addOption('b', "backend", "Hough detectors backend", nvxio::OptionHandler::oneOf(&backend, {
+                          {"gpu", HOUGH_BACKEND_GPU},
+                          {"host", HOUGH_BACKEND_HOST}
+                      }));
+        app.addOption('f', "frontend", "Edge detection front-end", nvxio::OptionHandler::oneOf(&frontEndMode, {
+                          {"graph", HOUGH_FRONTEND_GRAPH},
+                          {"fused", HOUGH_FRONTEND_FUSED}
+                      }));
+        app.addOption('t', "tracking", "Full Hough detection every N frames, tracking of the results in between (host backend)",
+                      nvxio::OptionHandler::unsignedInteger(&fullDetectionPeriod));
 
         app.init(argc, argv);
 
@@ -276,6 +312,12 @@ int main(int argc, char** argv)
 
         params.theta *= nvxio::PI_F / 180.0f; // convert to radians
 
+        if (fullDetectionPeriod > 1 && backend != HOUGH_BACKEND_HOST)
+        {
+            std::cerr << "Error: Tracking is supported by the host backend only" << std::endl;
+            return nvxio::Application::APP_EXIT_CODE_INVALID_VALUE;
+        }
+
         //
         // NVXIO-based renderer object and frame source are instantiated
         // and attached to the OpenVX context object. NVXIO ContextGuard
@@ -377,30 +419,31 @@ int main(int argc, char** argv)
         vx_graph graph = vxCreateGraph(context);
         NVXIO_CHECK_REFERENCE(graph);
 
+        vx_uint32 scaledWidth = static_cast<vx_uint32>(frameConfig.frameWidth * params.scaleFactor);
+        vx_uint32 scaledHeight = static_cast<vx_uint32>(frameConfig.frameHeight * params.scaleFactor);
+
         //
-        // Virtual images for internal processing
+        // The host detectors read the edges and the derivatives, and the fused front-end writes them,
+        // so they can't be virtual in these cases
         //
 
-        vx_image virt_U8 = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(virt_U8);
-
-        vx_image virt_scaled = vxCreateVirtualImage(graph, static_cast<vx_uint32>(frameConfig.frameWidth * params.scaleFactor),
-                                                    static_cast<vx_uint32>(frameConfig.frameHeight * params.scaleFactor), VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(virt_scaled);
+        bool hostDetectors = backend == HOUGH_BACKEND_HOST;
+        bool fusedFrontEnd = frontEndMode == HOUGH_FRONTEND_FUSED;
+        bool realEdges = hostDetectors || fusedFrontEnd;
 
-        vx_image virt_blurred = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(virt_blurred);
-
-        vx_image virt_equalized = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(virt_equalized);
-
-        vx_image virt_edges = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
+        vx_image virt_edges = realEdges ?
+                    vxCreateImage(context, scaledWidth, scaledHeight, VX_DF_IMAGE_U8) :
+                    vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
         NVXIO_CHECK_REFERENCE(virt_edges);
 
-        vx_image virt_dx = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_S16);
+        vx_image virt_dx = realEdges ?
+                    vxCreateImage(context, scaledWidth, scaledHeight, VX_DF_IMAGE_S16) :
+                    vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_S16);
         NVXIO_CHECK_REFERENCE(virt_dx);
 
-        vx_image virt_dy = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_S16);
+        vx_image virt_dy = realEdges ?
+                    vxCreateImage(context, scaledWidth, scaledHeight, VX_DF_IMAGE_S16) :
+                    vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_S16);
         NVXIO_CHECK_REFERENCE(virt_dy);
 
         //
@@ -415,50 +458,141 @@ int main(int argc, char** argv)
         // segments and circles. The detected line segments and circles are scaled
         // up back by params.scaleType
         //
+        // With the fused front-end all the stages up to Canny and Sobel run on the host
+        // before the graph, and the graph starts from the edges
+        //
+
+        vx_node cvtNode = nullptr;
+        vx_node scaleDownNode = nullptr;
+        vx_node median3x3Node = nullptr;
+        vx_node equalizeHistNode = nullptr;
+        vx_node CannyNode = nullptr;
+        vx_node Sobel3x3Node = nullptr;
+        HoughFrontEnd frontEnd;
+
+        if (!fusedFrontEnd)
+        {
+            //
+            // Virtual images for internal processing
+            //
+
+            vx_image virt_U8 = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
+            NVXIO_CHECK_REFERENCE(virt_U8);
+
+            vx_image virt_scaled = vxCreateVirtualImage(graph, scaledWidth, scaledHeight, VX_DF_IMAGE_U8);
+            NVXIO_CHECK_REFERENCE(virt_scaled);
+
+            vx_image virt_blurred = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
+            NVXIO_CHECK_REFERENCE(virt_blurred);
+
+            vx_image virt_equalized = vxCreateVirtualImage(graph, 0, 0, VX_DF_IMAGE_U8);
+            NVXIO_CHECK_REFERENCE(virt_equalized);
 
+            cvtNode = vxColorConvertNode(graph, frame, virt_U8);
+            NVXIO_CHECK_REFERENCE(cvtNode);
 
-        vx_node cvtNode = vxColorConvertNode(graph, frame, virt_U8);
-        NVXIO_CHECK_REFERENCE(cvtNode);
+            scaleDownNode = vxScaleImageNode(graph, virt_U8, virt_scaled, params.scaleType);
+            NVXIO_CHECK_REFERENCE(scaleDownNode);
 
-        vx_node scaleDownNode = vxScaleImageNode(graph, virt_U8, virt_scaled, params.scaleType);
-        NVXIO_CHECK_REFERENCE(scaleDownNode);
+            median3x3Node = vxMedian3x3Node(graph, virt_scaled, virt_blurred);
+            NVXIO_CHECK_REFERENCE(median3x3Node);
 
-        vx_node median3x3Node = vxMedian3x3Node(graph, virt_scaled, virt_blurred);
-        NVXIO_CHECK_REFERENCE(median3x3Node);
+            equalizeHistNode = vxEqualizeHistNode(graph, virt_blurred, virt_equalized);
+            NVXIO_CHECK_REFERENCE(equalizeHistNode);
 
-        vx_node equalizeHistNode = vxEqualizeHistNode(graph, virt_blurred, virt_equalized);
-        NVXIO_CHECK_REFERENCE(equalizeHistNode);
+            CannyNode = vxCannyEdgeDetectorNode(graph, virt_equalized, CannyThreshold, 3, VX_NORM_L1, virt_edges);
+            NVXIO_CHECK_REFERENCE(CannyNode);
 
-        vx_node CannyNode = vxCannyEdgeDetectorNode(graph, virt_equalized, CannyThreshold, 3, VX_NORM_L1, virt_edges);
-        NVXIO_CHECK_REFERENCE(CannyNode);
+            Sobel3x3Node = vxSobel3x3Node(graph, virt_equalized, virt_dx, virt_dy);
+            NVXIO_CHECK_REFERENCE(Sobel3x3Node);
+
+            //
+            // Release virtual images (the graph will hold references internally)
+            //
+
+            vxReleaseImage(&virt_U8);
+            vxReleaseImage(&virt_scaled);
+            vxReleaseImage(&virt_blurred);
+            vxReleaseImage(&virt_equalized);
+        }
+        else
+        {
+            HoughFrontEnd::Params frontEndParams;
+            frontEndParams.scaleFactor = params.scaleFactor;
+            frontEndParams.scaleType = params.scaleType;
+            frontEndParams.cannyLowerThresh = params.CannyLowerThresh;
+            frontEndParams.cannyUpperThresh = params.CannyUpperThresh;
+
+            frontEnd.init(frameConfig.frameWidth, frameConfig.frameHeight, frontEndParams);
+        }
 
         vx_node scaleUpNode = vxScaleImageNode(graph, virt_edges, edges, params.scaleType);
         NVXIO_CHECK_REFERENCE(scaleUpNode);
 
-        vx_node Sobel3x3Node = vxSobel3x3Node(graph, virt_equalized, virt_dx, virt_dy);
-        NVXIO_CHECK_REFERENCE(Sobel3x3Node);
+        //
+        // Detected line segments and circles are scaled up back to the frame
+        //
 
-        vx_node HoughCirclesNode = nvxHoughCirclesNode(graph, virt_edges, virt_dx, virt_dy,
-                                                       circles, nullptr,  params.dp, params.minDist,
-                                                       params.minRadius, params.maxRadius, params.accThreshold);
-        NVXIO_CHECK_REFERENCE(HoughCirclesNode);
+        HoughOutputTransform outputTransform = HoughOutputTransform::scale(1.0f / params.scaleFactor, 1.0f / params.scaleFactor);
 
-        vx_node HoughSegmentsNode = nvxHoughSegmentsNode(graph, virt_edges, lines, params.rho, params.theta,
-                                                         params.votesThreshold, params.minLineLength,
-                                                         params.maxLineGap, nullptr);
-        NVXIO_CHECK_REFERENCE(HoughSegmentsNode);
+        vx_node HoughCirclesNode = nullptr;
+        vx_node HoughSegmentsNode = nullptr;
+        HostHoughCircles hostCircles;
+        HostHoughSegments hostSegments;
+
+        if (!hostDetectors)
+        {
+            HoughCirclesNode = nvxHoughCirclesNode(graph, virt_edges, virt_dx, virt_dy,
+                                                   circles, nullptr,  params.dp, params.minDist,
+                                                   params.minRadius, params.maxRadius, params.accThreshold);
+            NVXIO_CHECK_REFERENCE(HoughCirclesNode);
+
+            HoughSegmentsNode = nvxHoughSegmentsNode(graph, virt_edges, lines, params.rho, params.theta,
+                                                     params.votesThreshold, params.minLineLength,
+                                                     params.maxLineGap, nullptr);
+            NVXIO_CHECK_REFERENCE(HoughSegmentsNode);
+        }
+        else
+        {
+            HostHoughCircles::Params circlesParams;
+            circlesParams.dp = params.dp;
+            circlesParams.minDist = params.minDist;
+            circlesParams.minRadius = params.minRadius;
+            circlesParams.maxRadius = params.maxRadius;
+            circlesParams.accThreshold = params.accThreshold;
+            circlesParams.circlesCapacity = params.circlesCapacity;
+
+            hostCircles.init(scaledWidth, scaledHeight, circlesParams);
+            hostCircles.setOutputTransform(outputTransform);
+
+            HostHoughSegments::Params segmentsParams;
+            segmentsParams.rho = params.rho;
+            segmentsParams.theta = params.theta;
+            segmentsParams.votesThreshold = params.votesThreshold;
+            segmentsParams.minLineLength = params.minLineLength;
+            segmentsParams.maxLineGap = params.maxLineGap;
+            segmentsParams.linesCapacity = params.linesCapacity;
+
+            hostSegments.init(scaledWidth, scaledHeight, segmentsParams);
+            hostSegments.setOutputTransform(outputTransform);
+
+            HoughTrackingParams trackingParams;
+            trackingParams.fullDetectionPeriod = fullDetectionPeriod;
+
+            hostCircles.setTracking(trackingParams);
+            hostSegments.setTracking(trackingParams);
+        }
 
         //
         // Release virtual images (the graph will hold references internally)
         //
 
-        vxReleaseImage(&virt_U8);
-        vxReleaseImage(&virt_scaled);
-        vxReleaseImage(&virt_blurred);
-        vxReleaseImage(&virt_equalized);
-        vxReleaseImage(&virt_edges);
-        vxReleaseImage(&virt_dx);
-        vxReleaseImage(&virt_dy);
+        if (!realEdges)
+        {
+            vxReleaseImage(&virt_edges);
+            vxReleaseImage(&virt_dx);
+            vxReleaseImage(&virt_dy);
+        }
 
         //
         // Release Threshold object (the graph will hold references internally)
@@ -531,64 +665,58 @@ int main(int argc, char** argv)
                 nvx::Timer procTimer;
                 procTimer.tic();
 
-                NVXIO_SAFE_CALL( vxProcessGraph(graph) );
-
-                proc_ms = procTimer.toc();
+                double frontend_ms = 0;
+                if (fusedFrontEnd)
+                {
+                    nvx::Timer frontEndTimer;
+                    frontEndTimer.tic();
 
+                    frontEnd.process(frame, virt_edges, virt_dx, virt_dy);
 
-                //
-                // Scale detected circles
-                //
+                    frontend_ms = frontEndTimer.toc();
+                }
 
-                vx_size num_circles = 0;
-                NVXIO_SAFE_CALL( vxQueryArray(circles, VX_ARRAY_ATTRIBUTE_NUMITEMS, &num_circles, sizeof(num_circles)) );
-                std::cout << "Found " << num_circles << " circles" << std::endl;
+                NVXIO_SAFE_CALL( vxProcessGraph(graph) );
 
-                if (num_circles > 0)
+                double host_circles_ms = 0, host_segments_ms = 0;
+                if (hostDetectors)
                 {
-                    vx_map_id map_id;
-                    void *ptr;
-                    vx_size stride;
-                    NVXIO_SAFE_CALL( vxMapArrayRange(circles, 0, num_circles, &map_id, &stride, &ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, 0) );
+                    nvx::Timer hostTimer;
+                    hostTimer.tic();
 
-                    for (vx_size i = 0; i < num_circles; ++i)
-                    {
-                        nvx_point3f_t *c = (nvx_point3f_t *)vxFormatArrayPointer(ptr, i, stride);
-                        c->x /= params.scaleFactor;
-                        c->y /= params.scaleFactor;
-                        c->z /= params.scaleFactor;
-                    }
+                    hostCircles.process(virt_edges, virt_dx, virt_dy);
+                    hostCircles.copyCircles(circles);
+
+                    host_circles_ms = hostTimer.toc();
+                    hostTimer.tic();
+
+                    hostSegments.process(virt_edges);
+                    hostSegments.copySegments(lines);
 
-                    NVXIO_SAFE_CALL( vxUnmapArrayRange(circles, map_id) );
+                    host_segments_ms = hostTimer.toc();
                 }
 
+                proc_ms = procTimer.toc();
+
+
                 //
-                // Scale detected lines (convert it to array with start and end coordinates)
+                // The host detectors already report the results in the coordinates of the frame,
+                // the arrays of the Hough nodes are scaled here
                 //
 
-                vx_size lines_count = 0;
-                NVXIO_SAFE_CALL( vxQueryArray(lines, VX_ARRAY_ATTRIBUTE_NUMITEMS, &lines_count, sizeof(lines_count)) );
-                std::cout << "Found " << lines_count << " lines" << std::endl;
-
-                if (lines_count > 0)
+                if (!hostDetectors)
                 {
-                    vx_map_id map_id;
-                    vx_size stride;
-                    void *ptr;
-                    NVXIO_SAFE_CALL( vxMapArrayRange(lines, 0, lines_count, &map_id, &stride, &ptr, VX_READ_AND_WRITE, VX_MEMORY_TYPE_HOST, 0) );
-
-                    for (vx_size i = 0; i < lines_count; ++i)
-                    {
-                        nvx_point4f_t *coord = (nvx_point4f_t *)vxFormatArrayPointer(ptr, i, stride);
+                    transformHoughArray(circles, outputTransform);
+                    transformHoughArray(lines, outputTransform);
+                }
 
-                        coord->x /= params.scaleFactor;
-                        coord->y /= params.scaleFactor;
-                        coord->z /= params.scaleFactor;
-                        coord->w /= params.scaleFactor;
-                    }
+                vx_size num_circles = 0;
+                NVXIO_SAFE_CALL( vxQueryArray(circles, VX_ARRAY_ATTRIBUTE_NUMITEMS, &num_circles, sizeof(num_circles)) );
+                std::cout << "Found " << num_circles << " circles" << std::endl;
 
-                    NVXIO_SAFE_CALL( vxUnmapArrayRange(lines, map_id) );
-                }
+                vx_size lines_count = 0;
+                NVXIO_SAFE_CALL( vxQueryArray(lines, VX_ARRAY_ATTRIBUTE_NUMITEMS, &lines_count, sizeof(lines_count)) );
+                std::cout << "Found " << lines_count << " lines" << std::endl;
 
                 //
                 // switch image/edges view every switchPeriod-th frame
@@ -612,32 +740,55 @@ int main(int argc, char** argv)
                 NVXIO_SAFE_CALL( vxQueryGraph(graph, VX_GRAPH_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
                 std::cout << "Graph Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(cvtNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Color Convert Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                if (fusedFrontEnd)
+                {
+                    std::cout << "\t Fused Front-End Time (host) : " << frontend_ms << " ms" << std::endl;
+                }
+                else
+                {
+                    NVXIO_SAFE_CALL( vxQueryNode(cvtNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Color Convert Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+
+                    NVXIO_SAFE_CALL( vxQueryNode(scaleDownNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Scale Down Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(scaleDownNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Scale Down Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                    NVXIO_SAFE_CALL( vxQueryNode(median3x3Node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Median3x3 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(median3x3Node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Median3x3 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                    NVXIO_SAFE_CALL( vxQueryNode(equalizeHistNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Equalize Hist Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(equalizeHistNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Equalize Hist Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                    NVXIO_SAFE_CALL( vxQueryNode(CannyNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Canny Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(CannyNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Canny Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                    NVXIO_SAFE_CALL( vxQueryNode(Sobel3x3Node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Sobel 3x3 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                }
 
                 NVXIO_SAFE_CALL( vxQueryNode(scaleUpNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
                 std::cout << "\t Scale Up Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(Sobel3x3Node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Sobel 3x3 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
-
-                NVXIO_SAFE_CALL( vxQueryNode(HoughCirclesNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Hough Circles Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                if (HoughCirclesNode)
+                {
+                    NVXIO_SAFE_CALL( vxQueryNode(HoughCirclesNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Hough Circles Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                }
+                else
+                {
+                    std::cout << "\t Hough Circles Time (host" << (hostCircles.wasTracked() ? ", tracked" : "") << ") : "
+                              << host_circles_ms << " ms" << std::endl;
+                }
 
-                NVXIO_SAFE_CALL( vxQueryNode(HoughSegmentsNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Hough Segments Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                if (HoughSegmentsNode)
+                {
+                    NVXIO_SAFE_CALL( vxQueryNode(HoughSegmentsNode, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Hough Segments Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                }
+                else
+                {
+                    std::cout << "\t Hough Segments Time (host" << (hostSegments.wasTracked() ? ", tracked" : "") << ") : "
+                              << host_segments_ms << " ms" << std::endl;
+                }
             }
 
             double total_ms = totalTimer.toc();
@@ -725,18 +876,30 @@ int main(int argc, char** argv)
         // Release all objects
         //
 
-        vxReleaseNode(&cvtNode);
-        vxReleaseNode(&scaleDownNode);
-        vxReleaseNode(&median3x3Node);
-        vxReleaseNode(&equalizeHistNode);
-        vxReleaseNode(&CannyNode);
+        if (!fusedFrontEnd)
+        {
+            vxReleaseNode(&cvtNode);
+            vxReleaseNode(&scaleDownNode);
+            vxReleaseNode(&median3x3Node);
+            vxReleaseNode(&equalizeHistNode);
+            vxReleaseNode(&CannyNode);
+            vxReleaseNode(&Sobel3x3Node);
+        }
         vxReleaseNode(&scaleUpNode);
-        vxReleaseNode(&Sobel3x3Node);
-        vxReleaseNode(&HoughCirclesNode);
-        vxReleaseNode(&HoughSegmentsNode);
+        if (HoughCirclesNode)
+            vxReleaseNode(&HoughCirclesNode);
+        if (HoughSegmentsNode)
+            vxReleaseNode(&HoughSegmentsNode);
 
         vxReleaseGraph(&graph);
 
+        if (realEdges)
+        {
+            vxReleaseImage(&virt_edges);
+            vxReleaseImage(&virt_dx);
+            vxReleaseImage(&virt_dy);
+        }
+
         vxReleaseImage(&frame);
         vxReleaseImage(&edges);
         vxReleaseArray(&circles);
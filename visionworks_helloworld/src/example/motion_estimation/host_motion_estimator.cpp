@@ -0,0 +1,562 @@
+#include "host_motion_estimator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "../common/host_simd.hpp"
+#include "../common/parallel_for.hpp"
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    double elapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Cost of one pixel of vector distance, in SAD units of a block of the given size
+    inline vx_float32 distanceCost(vx_int32 blockSize)
+    {
+        return blockSize * blockSize / 8.0f;
+    }
+
+    //
+    // Sum of absolute differences
+    //
+
+    inline vx_uint32 sad8x8(const vx_uint8* a, vx_int32 strideA, const vx_uint8* b, vx_int32 strideB)
+    {
+#if defined(NVX_HOST_SSE2)
+        __m128i acc = _mm_setzero_si128();
+        for (vx_int32 y = 0; y < 8; y += 2)
+        {
+            __m128i va = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(a + y * strideA)),
+                                            _mm_loadl_epi64((const __m128i*)(a + (y + 1) * strideA)));
+            __m128i vb = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(b + y * strideB)),
+                                            _mm_loadl_epi64((const __m128i*)(b + (y + 1) * strideB)));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+        }
+        return static_cast<vx_uint32>(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#elif defined(NVX_HOST_NEON)
+        uint16x8_t acc = vdupq_n_u16(0);
+        for (vx_int32 y = 0; y < 8; ++y)
+            acc = vabal_u8(acc, vld1_u8(a + y * strideA), vld1_u8(b + y * strideB));
+        uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(acc));
+        return static_cast<vx_uint32>(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+#else
+        vx_uint32 sum = 0;
+        for (vx_int32 y = 0; y < 8; ++y)
+            for (vx_int32 x = 0; x < 8; ++x)
+                sum += std::abs(a[y * strideA + x] - b[y * strideB + x]);
+        return sum;
+#endif
+    }
+
+    inline vx_uint32 sadNxN(vx_int32 n, const vx_uint8* a, vx_int32 strideA, const vx_uint8* b, vx_int32 strideB)
+    {
+        if (n == 8)
+            return sad8x8(a, strideA, b, strideB);
+
+        vx_uint32 sum = 0;
+        for (vx_int32 y = 0; y < n; ++y)
+            for (vx_int32 x = 0; x < n; ++x)
+                sum += std::abs(a[y * strideA + x] - b[y * strideB + x]);
+        return sum;
+    }
+
+    // SAD of a block clipped by the frame border to bw x bh pixels, scaled to the area
+    // of a full B x B block so that partial blocks compete with full ones on equal terms
+    inline vx_float32 blockSad(vx_int32 B, vx_int32 bw, vx_int32 bh,
+                               const vx_uint8* a, vx_int32 strideA, const vx_uint8* b, vx_int32 strideB)
+    {
+        if (bw == B && bh == B)
+            return static_cast<vx_float32>(sadNxN(B, a, strideA, b, strideB));
+
+        vx_uint32 sum = 0;
+        for (vx_int32 y = 0; y < bh; ++y)
+            for (vx_int32 x = 0; x < bw; ++x)
+                sum += std::abs(a[y * strideA + x] - b[y * strideB + x]);
+        return static_cast<vx_float32>(sum) * (B * B) / (bw * bh);
+    }
+
+    inline vx_int32 divUp(vx_int32 a, vx_int32 b)
+    {
+        return (a + b - 1) / b;
+    }
+
+    inline vx_int32 distance(vx_int32 ax, vx_int32 ay, vx_int32 bx, vx_int32 by)
+    {
+        return std::abs(ax - bx) + std::abs(ay - by);
+    }
+
+    struct Candidate
+    {
+        vx_float32 cost;
+        vx_int32 x, y;
+    };
+
+    // Best candidate and the best one that is at least 'minDist' away from it
+    void selectBestPair(const std::vector<Candidate>& cands, vx_int32 minDist, Candidate& best, Candidate& second)
+    {
+        best = cands[0];
+        for (const Candidate& c : cands)
+            if (c.cost < best.cost)
+                best = c;
+
+        second = best;
+        bool found = false;
+        for (const Candidate& c : cands)
+        {
+            if (distance(c.x, c.y, best.x, best.y) >= std::max(minDist, 1) && (!found || c.cost < second.cost))
+            {
+                second = c;
+                found = true;
+            }
+        }
+    }
+}
+
+HostMotionEstimator::HostMotionEstimator()
+{
+    params_.biasWeight = 1.0f;
+    params_.mvDivFactor = 4;
+    params_.smoothnessFactor = 1.0f;
+
+    width_ = 0;
+    height_ = 0;
+
+    std::memset(&perf_, 0, sizeof(perf_));
+}
+
+void HostMotionEstimator::init(vx_uint32 width, vx_uint32 height, const std::vector<LevelConfig>& levels, const Params& params)
+{
+    params_ = params;
+    levels_ = levels;
+
+    width_ = static_cast<vx_int32>(width);
+    height_ = static_cast<vx_int32>(height);
+
+    prevPyr_.assign(levels_.size(), Plane());
+    currPyr_.assign(levels_.size(), Plane());
+    for (size_t level = 0; level < levels_.size(); ++level)
+    {
+        Plane plane;
+        plane.width = level == 0 ? width_ : (prevPyr_[level - 1].width + 1) / 2;
+        plane.height = level == 0 ? height_ : (prevPyr_[level - 1].height + 1) / 2;
+        plane.data.assign(plane.width * plane.height, 0);
+
+        prevPyr_[level] = plane;
+        currPyr_[level] = plane;
+    }
+
+    mfOut_.assign(getMotionFieldWidth() * getMotionFieldHeight() * 2, 0.0f);
+
+    std::memset(&perf_, 0, sizeof(perf_));
+}
+
+void HostMotionEstimator::convertRGBXToGray(const vx_uint8* src, vx_size srcStride,
+                                            vx_uint8* dst, vx_size dstStride,
+                                            vx_uint32 width, vx_uint32 height)
+{
+    nvx::parallelFor(0, static_cast<vx_int32>(height), 64, [&](vx_int32 y0, vx_int32 y1)
+    {
+        for (vx_int32 y = y0; y < y1; ++y)
+        {
+            const vx_uint8* s = src + y * srcStride;
+            vx_uint8* d = dst + y * dstStride;
+
+            for (vx_uint32 x = 0; x < width; ++x, s += 4)
+                d[x] = static_cast<vx_uint8>((54 * s[0] + 183 * s[1] + 19 * s[2] + 128) >> 8);
+        }
+    });
+}
+
+// Gaussian pyramid with the 5x5 [1 4 6 4 1] kernel and replicated borders,
+// the same filter as VX_SCALE_PYRAMID_HALF
+void HostMotionEstimator::buildPyramid(const vx_uint8* gray, vx_size stride, std::vector<Plane>& pyr) const
+{
+    Plane& base = pyr[0];
+    for (vx_int32 y = 0; y < base.height; ++y)
+        std::memcpy(&base.data[y * base.width], gray + y * stride, base.width);
+
+    std::vector<vx_uint16> tmp;
+    for (size_t level = 1; level < pyr.size(); ++level)
+    {
+        const Plane& src = pyr[level - 1];
+        Plane& dst = pyr[level];
+
+        // horizontal pass, every source row, every other column
+        tmp.resize(src.height * dst.width);
+        nvx::parallelFor(0, src.height, 32, [&](vx_int32 y0, vx_int32 y1)
+        {
+            for (vx_int32 y = y0; y < y1; ++y)
+            {
+                const vx_uint8* s = &src.data[y * src.width];
+                vx_uint16* t = &tmp[y * dst.width];
+                for (vx_int32 x = 0; x < dst.width; ++x)
+                {
+                    vx_int32 c = 2 * x;
+                    vx_int32 xm2 = std::max(c - 2, 0), xm1 = std::max(c - 1, 0);
+                    vx_int32 xp1 = std::min(c + 1, src.width - 1), xp2 = std::min(c + 2, src.width - 1);
+                    t[x] = static_cast<vx_uint16>(s[xm2] + 4 * s[xm1] + 6 * s[c] + 4 * s[xp1] + s[xp2]);
+                }
+            }
+        });
+
+        // vertical pass, every other row
+        nvx::parallelFor(0, dst.height, 32, [&](vx_int32 y0, vx_int32 y1)
+        {
+            for (vx_int32 y = y0; y < y1; ++y)
+            {
+                vx_int32 c = 2 * y;
+                const vx_uint16* r0 = &tmp[std::max(c - 2, 0) * dst.width];
+                const vx_uint16* r1 = &tmp[std::max(c - 1, 0) * dst.width];
+                const vx_uint16* r2 = &tmp[c * dst.width];
+                const vx_uint16* r3 = &tmp[std::min(c + 1, src.height - 1) * dst.width];
+                const vx_uint16* r4 = &tmp[std::min(c + 2, src.height - 1) * dst.width];
+                vx_uint8* d = &dst.data[y * dst.width];
+
+                for (vx_int32 x = 0; x < dst.width; ++x)
+                    d[x] = static_cast<vx_uint8>((r0[x] + 4 * r1[x] + 6 * r2[x] + 4 * r3[x] + r4[x] + 128) >> 8);
+            }
+        });
+    }
+}
+
+void HostMotionEstimator::setInitialFrame(const vx_uint8* gray, vx_size stride)
+{
+    buildPyramid(gray, stride, currPyr_);
+    std::fill(mfOut_.begin(), mfOut_.end(), 0.0f);
+}
+
+//
+// CreateMotionField: 8x8 block matching around the anchor taken from the coarser level.
+// The coarsest level is searched exhaustively over the whole window; finer levels only
+// evaluate the predictors (anchor of the block and of its neighbours, zero motion) and
+// refine the best of them with a small local search inside the window.
+//
+void HostMotionEstimator::createMotionField(vx_int32 level, const Field* anchor, Field& mf) const
+{
+    const Plane& prev = prevPyr_[level];
+    const Plane& curr = currPyr_[level];
+    const LevelConfig& cfg = levels_[level];
+    const vx_int32 B = 8;
+
+    mf.blockSize = B;
+    mf.width = divUp(curr.width, B);
+    mf.height = divUp(curr.height, B);
+    mf.best.resize(mf.width * mf.height);
+    mf.second.resize(mf.width * mf.height);
+
+    const vx_float32 biasCost = params_.biasWeight * distanceCost(B);
+
+    nvx::parallelFor(0, mf.height, 1, [&](vx_int32 by0, vx_int32 by1)
+    {
+        std::vector<Candidate> cands;
+
+        for (vx_int32 by = by0; by < by1; ++by)
+        {
+            for (vx_int32 bx = 0; bx < mf.width; ++bx)
+            {
+                vx_int32 idx = by * mf.width + bx;
+                vx_int32 x0 = bx * B, y0 = by * B;
+                vx_int32 bw = std::min(B, curr.width - x0), bh = std::min(B, curr.height - y0);
+                const vx_uint8* c = &curr.data[y0 * curr.width + x0];
+
+                vx_int32 ax = 0, ay = 0;
+                if (anchor)
+                {
+                    ax = 2 * anchor->best[idx].x;
+                    ay = 2 * anchor->best[idx].y;
+                }
+
+                // Search window around the anchor, restricted to the frame
+                vx_int32 minX = std::max(ax - cfg.winWidth / 2, -x0);
+                vx_int32 maxX = std::min(ax + cfg.winWidth / 2 - 1, prev.width - bw - x0);
+                vx_int32 minY = std::max(ay - cfg.winHeight / 2, -y0);
+                vx_int32 maxY = std::min(ay + cfg.winHeight / 2 - 1, prev.height - bh - y0);
+                if (minX > maxX) minX = maxX = std::min(std::max(ax, -x0), prev.width - bw - x0);
+                if (minY > maxY) minY = maxY = std::min(std::max(ay, -y0), prev.height - bh - y0);
+
+                cands.clear();
+                auto evaluate = [&](vx_int32 dx, vx_int32 dy)
+                {
+                    dx = std::min(std::max(dx, minX), maxX);
+                    dy = std::min(std::max(dy, minY), maxY);
+
+                    const vx_uint8* p = &prev.data[(y0 + dy) * prev.width + x0 + dx];
+                    Candidate cand;
+                    cand.cost = blockSad(B, bw, bh, c, curr.width, p, prev.width) + biasCost * distance(dx, dy, ax, ay);
+                    cand.x = dx;
+                    cand.y = dy;
+                    cands.push_back(cand);
+                };
+
+                if (!anchor)
+                {
+                    for (vx_int32 dy = minY; dy <= maxY; ++dy)
+                        for (vx_int32 dx = minX; dx <= maxX; ++dx)
+                            evaluate(dx, dy);
+                }
+                else
+                {
+                    evaluate(ax, ay);
+                    evaluate(2 * anchor->second[idx].x, 2 * anchor->second[idx].y);
+                    evaluate(0, 0);
+
+                    for (vx_int32 ny = std::max(by - 1, 0); ny <= std::min(by + 1, anchor->height - 1); ++ny)
+                    {
+                        for (vx_int32 nx = std::max(bx - 1, 0); nx <= std::min(bx + 1, anchor->width - 1); ++nx)
+                        {
+                            if (nx == bx && ny == by)
+                                continue;
+
+                            const MotionVector& p = anchor->best[ny * anchor->width + nx];
+                            evaluate(2 * p.x, 2 * p.y);
+                        }
+                    }
+
+                    Candidate best, second;
+                    selectBestPair(cands, params_.mvDivFactor, best, second);
+
+                    for (vx_int32 dy = -2; dy <= 2; ++dy)
+                        for (vx_int32 dx = -2; dx <= 2; ++dx)
+                            if (dx != 0 || dy != 0)
+                                evaluate(best.x + dx, best.y + dy);
+                }
+
+                Candidate best, second;
+                selectBestPair(cands, params_.mvDivFactor, best, second);
+
+                mf.best[idx].x = static_cast<vx_int16>(best.x);
+                mf.best[idx].y = static_cast<vx_int16>(best.y);
+                mf.second[idx].x = static_cast<vx_int16>(second.x);
+                mf.second[idx].y = static_cast<vx_int16>(second.y);
+            }
+        }
+    });
+}
+
+//
+// RefineMotionField: Jacobi iterations in which every block picks among its own two
+// candidates and the best vectors of its 4-neighbours, trading SAD for smoothness.
+// Every iteration reads only the previous one, so rows of blocks are refined in parallel.
+//
+void HostMotionEstimator::refineMotionField(vx_int32 level, Field& mf, Field& tmp) const
+{
+    const Plane& prev = prevPyr_[level];
+    const Plane& curr = currPyr_[level];
+    const vx_int32 B = mf.blockSize;
+    const vx_float32 smoothCost = params_.smoothnessFactor * distanceCost(B);
+
+    tmp.blockSize = B;
+    tmp.width = mf.width;
+    tmp.height = mf.height;
+    tmp.best.resize(mf.best.size());
+    tmp.second.resize(mf.second.size());
+
+    for (vx_int32 iter = 0; iter < levels_[level].numIters; ++iter)
+    {
+        const Field& src = mf;
+        Field& dst = tmp;
+
+        nvx::parallelFor(0, src.height, 4, [&](vx_int32 by0, vx_int32 by1)
+        {
+            std::vector<Candidate> cands;
+            MotionVector neighbours[4];
+
+            for (vx_int32 by = by0; by < by1; ++by)
+            {
+                for (vx_int32 bx = 0; bx < src.width; ++bx)
+                {
+                    vx_int32 idx = by * src.width + bx;
+                    vx_int32 x0 = bx * B, y0 = by * B;
+                    vx_int32 bw = std::min(B, curr.width - x0), bh = std::min(B, curr.height - y0);
+                    const vx_uint8* c = &curr.data[y0 * curr.width + x0];
+
+                    vx_int32 numNeighbours = 0;
+                    if (bx > 0) neighbours[numNeighbours++] = src.best[idx - 1];
+                    if (bx + 1 < src.width) neighbours[numNeighbours++] = src.best[idx + 1];
+                    if (by > 0) neighbours[numNeighbours++] = src.best[idx - src.width];
+                    if (by + 1 < src.height) neighbours[numNeighbours++] = src.best[idx + src.width];
+
+                    cands.clear();
+                    auto evaluate = [&](const MotionVector& mv)
+                    {
+                        vx_int32 dx = std::min(std::max<vx_int32>(mv.x, -x0), prev.width - bw - x0);
+                        vx_int32 dy = std::min(std::max<vx_int32>(mv.y, -y0), prev.height - bh - y0);
+
+                        vx_int32 dist = 0;
+                        for (vx_int32 n = 0; n < numNeighbours; ++n)
+                            dist += distance(dx, dy, neighbours[n].x, neighbours[n].y);
+
+                        const vx_uint8* p = &prev.data[(y0 + dy) * prev.width + x0 + dx];
+                        Candidate cand;
+                        cand.cost = blockSad(B, bw, bh, c, curr.width, p, prev.width) +
+                                    smoothCost * dist / std::max(numNeighbours, 1);
+                        cand.x = dx;
+                        cand.y = dy;
+                        cands.push_back(cand);
+                    };
+
+                    evaluate(src.best[idx]);
+                    evaluate(src.second[idx]);
+                    for (vx_int32 n = 0; n < numNeighbours; ++n)
+                        evaluate(neighbours[n]);
+
+                    Candidate best, second;
+                    selectBestPair(cands, params_.mvDivFactor, best, second);
+
+                    dst.best[idx].x = static_cast<vx_int16>(best.x);
+                    dst.best[idx].y = static_cast<vx_int16>(best.y);
+                    dst.second[idx].x = static_cast<vx_int16>(second.x);
+                    dst.second[idx].y = static_cast<vx_int16>(second.y);
+                }
+            }
+        });
+
+        std::swap(mf.best, tmp.best);
+        std::swap(mf.second, tmp.second);
+    }
+}
+
+//
+// PartitionMotionField: every block is split into four sub-blocks, each choosing among the
+// parent's candidates and the best vectors of the two parents adjacent to its quadrant.
+//
+void HostMotionEstimator::partitionMotionField(vx_int32 level, const Field& mf, Field& partitioned) const
+{
+    const Plane& prev = prevPyr_[level];
+    const Plane& curr = currPyr_[level];
+    const vx_int32 B = mf.blockSize / 2;
+    const vx_float32 smoothCost = params_.smoothnessFactor * distanceCost(B);
+
+    partitioned.blockSize = B;
+    partitioned.width = divUp(curr.width, B);
+    partitioned.height = divUp(curr.height, B);
+    partitioned.best.resize(partitioned.width * partitioned.height);
+    partitioned.second.resize(partitioned.width * partitioned.height);
+
+    nvx::parallelFor(0, partitioned.height, 8, [&](vx_int32 sy0, vx_int32 sy1)
+    {
+        std::vector<Candidate> cands;
+
+        for (vx_int32 sy = sy0; sy < sy1; ++sy)
+        {
+            for (vx_int32 sx = 0; sx < partitioned.width; ++sx)
+            {
+                vx_int32 px = sx / 2, py = sy / 2;
+                vx_int32 parent = py * mf.width + px;
+                vx_int32 x0 = sx * B, y0 = sy * B;
+                vx_int32 bw = std::min(B, curr.width - x0), bh = std::min(B, curr.height - y0);
+                const vx_uint8* c = &curr.data[y0 * curr.width + x0];
+                const MotionVector& anchor = mf.best[parent];
+
+                cands.clear();
+                auto evaluate = [&](const MotionVector& mv)
+                {
+                    vx_int32 dx = std::min(std::max<vx_int32>(mv.x, -x0), prev.width - bw - x0);
+                    vx_int32 dy = std::min(std::max<vx_int32>(mv.y, -y0), prev.height - bh - y0);
+
+                    const vx_uint8* p = &prev.data[(y0 + dy) * prev.width + x0 + dx];
+                    Candidate cand;
+                    cand.cost = blockSad(B, bw, bh, c, curr.width, p, prev.width) +
+                                smoothCost * distance(dx, dy, anchor.x, anchor.y);
+                    cand.x = dx;
+                    cand.y = dy;
+                    cands.push_back(cand);
+                };
+
+                evaluate(mf.best[parent]);
+                evaluate(mf.second[parent]);
+
+                vx_int32 hx = (sx & 1) ? px + 1 : px - 1;
+                if (hx >= 0 && hx < mf.width)
+                    evaluate(mf.best[py * mf.width + hx]);
+
+                vx_int32 vy = (sy & 1) ? py + 1 : py - 1;
+                if (vy >= 0 && vy < mf.height)
+                    evaluate(mf.best[vy * mf.width + px]);
+
+                Candidate best, second;
+                selectBestPair(cands, params_.mvDivFactor, best, second);
+
+                vx_int32 idx = sy * partitioned.width + sx;
+                partitioned.best[idx].x = static_cast<vx_int16>(best.x);
+                partitioned.best[idx].y = static_cast<vx_int16>(best.y);
+                partitioned.second[idx].x = static_cast<vx_int16>(second.x);
+                partitioned.second[idx].y = static_cast<vx_int16>(second.y);
+            }
+        }
+    });
+}
+
+void HostMotionEstimator::process(const vx_uint8* gray, vx_size stride)
+{
+    Clock::time_point start = Clock::now();
+    std::memset(&perf_, 0, sizeof(perf_));
+
+    std::swap(prevPyr_, currPyr_);
+    buildPyramid(gray, stride, currPyr_);
+    perf_.pyramid_ms = elapsedMs(start);
+
+    Field& mf8 = mf_[0];
+    Field& tmp = mf_[1];
+    Field& mf4 = mf_[2];
+
+    const Field* anchor = nullptr;
+    for (vx_int32 level = static_cast<vx_int32>(levels_.size()) - 1; level >= 0; --level)
+    {
+        Clock::time_point stage = Clock::now();
+        createMotionField(level, anchor, mf8);
+        perf_.create_ms += elapsedMs(stage);
+
+        stage = Clock::now();
+        refineMotionField(level, mf8, tmp);
+        perf_.refine_ms += elapsedMs(stage);
+
+        // The 4x4 field of this level has the same grid as the 8x8 field of the next finer level,
+        // the vectors are scaled by 2 when used as anchors there.
+        stage = Clock::now();
+        partitionMotionField(level, mf8, mf4);
+        perf_.partition_ms += elapsedMs(stage);
+
+        anchor = &mf4;
+    }
+
+    // Final partition into 2x2 blocks of the finest level
+    Clock::time_point stage = Clock::now();
+    partitionMotionField(0, mf4, tmp);
+    perf_.partition_ms += elapsedMs(stage);
+
+    for (size_t i = 0; i < tmp.best.size(); ++i)
+    {
+        mfOut_[2 * i + 0] = tmp.best[i].x;
+        mfOut_[2 * i + 1] = tmp.best[i].y;
+    }
+
+    perf_.total_ms = elapsedMs(start);
+}
+
+const std::vector<vx_float32>& HostMotionEstimator::getMotionField() const
+{
+    return mfOut_;
+}
+
+vx_uint32 HostMotionEstimator::getMotionFieldWidth() const
+{
+    return static_cast<vx_uint32>((width_ + 1) / 2);
+}
+
+vx_uint32 HostMotionEstimator::getMotionFieldHeight() const
+{
+    return static_cast<vx_uint32>((height_ + 1) / 2);
+}
+
+const HostMotionEstimator::Perf& HostMotionEstimator::getPerf() const
+{
+    return perf_;
+}
@@ -0,0 +1,107 @@
+#ifndef HOST_MOTION_ESTIMATOR_HPP
+#define HOST_MOTION_ESTIMATOR_HPP
+
+#include <vector>
+#include <VX/vx.h>
+
+//
+// Host (CPU) implementation of the Iterative Motion Estimation pipeline:
+// CreateMotionField, RefineMotionField, PartitionMotionField and MultiplyByScalar
+// for every pyramid level. It works on plain gray buffers, so it needs neither a GPU nor an OpenVX context.
+//
+class HostMotionEstimator
+{
+public:
+    // Same meaning as IterativeMotionEstimator::Params.
+    // Distances (mvDivFactor) are measured in pixels of the processed pyramid level.
+    struct Params
+    {
+        vx_float32 biasWeight;
+        vx_int32 mvDivFactor;
+        vx_float32 smoothnessFactor;
+    };
+
+    struct LevelConfig
+    {
+        vx_int32 winWidth;
+        vx_int32 winHeight;
+        vx_int32 numIters;
+    };
+
+    // Accumulated time of the stages for the last processed frame
+    struct Perf
+    {
+        double pyramid_ms;
+        double create_ms;
+        double refine_ms;
+        double partition_ms;
+        double total_ms;
+    };
+
+    HostMotionEstimator();
+
+    // 'levels' lists the configuration from the finest (0) to the coarsest level.
+    // Any frame size is supported: blocks on the right and bottom borders are clipped
+    // to the frame, and pyramid levels are rounded up like VX_SCALE_PYRAMID_HALF.
+    void init(vx_uint32 width, vx_uint32 height, const std::vector<LevelConfig>& levels, const Params& params);
+
+    void setInitialFrame(const vx_uint8* gray, vx_size stride);
+    void process(const vx_uint8* gray, vx_size stride);
+
+    // Motion field for 2x2 blocks of the current frame, packed (dx, dy) pairs in pixels,
+    // ceil(width / 2) x ceil(height / 2) vectors.
+    // The vectors point from the current frame to the previous one.
+    const std::vector<vx_float32>& getMotionField() const;
+    vx_uint32 getMotionFieldWidth() const;
+    vx_uint32 getMotionFieldHeight() const;
+
+    const Perf& getPerf() const;
+
+    // BT.709 luma of an RGBX image, the same as the color conversion to VX_DF_IMAGE_U8
+    static void convertRGBXToGray(const vx_uint8* src, vx_size srcStride,
+                                  vx_uint8* dst, vx_size dstStride,
+                                  vx_uint32 width, vx_uint32 height);
+
+private:
+    struct MotionVector
+    {
+        vx_int16 x, y;
+    };
+
+    struct Plane
+    {
+        std::vector<vx_uint8> data;
+        vx_int32 width, height;
+    };
+
+    // Two candidate vectors per block, as produced by the NVX primitives
+    struct Field
+    {
+        std::vector<MotionVector> best;
+        std::vector<MotionVector> second;
+        vx_int32 width, height;
+        vx_int32 blockSize;
+    };
+
+    void buildPyramid(const vx_uint8* gray, vx_size stride, std::vector<Plane>& pyr) const;
+
+    void createMotionField(vx_int32 level, const Field* anchor, Field& mf) const;
+    void refineMotionField(vx_int32 level, Field& mf, Field& tmp) const;
+    void partitionMotionField(vx_int32 level, const Field& mf, Field& partitioned) const;
+
+    Params params_;
+    std::vector<LevelConfig> levels_;
+
+    vx_int32 width_;
+    vx_int32 height_;
+
+    std::vector<Plane> prevPyr_;
+    std::vector<Plane> currPyr_;
+
+    Field mf_[3];
+    std::vector<vx_float32> mfOut_;
+
+    Perf perf_;
+};
+
+#endif
@@ -28,6 +28,7 @@
 
 #include "iterative_motion_estimator.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -60,11 +61,13 @@ IterativeMotionEstimator::Params::Params()
     biasWeight = 1.0f;
     mvDivFactor = 4;
     smoothnessFactor = 1.0f;
+    borderMode = BORDER_FULL;
 }
 
-IterativeMotionEstimator::IterativeMotionEstimator(vx_context context)
+IterativeMotionEstimator::IterativeMotionEstimator(vx_context context, Backend backend)
 {
     context_ = context;
+    backend_ = backend;
     NVXIO_SAFE_CALL( vxRetainReference((vx_reference)context_) );
 
     format_ = VX_DF_IMAGE_VIRT;
@@ -79,6 +82,11 @@ IterativeMotionEstimator::IterativeMotionEstimator(vx_context context)
     currFrameROI_ = nullptr;
     mfOutROI_ = nullptr;
 
+    widthPyr_ = 0;
+    heightPyr_ = 0;
+    grayPadded_ = nullptr;
+    grayROI_ = nullptr;
+
     pyr_delay_ = nullptr;
 
     graph_ = nullptr;
@@ -107,7 +115,7 @@ void IterativeMotionEstimator::init(vx_image prevFrameRGBX, vx_image currFrameRG
     NVXIO_SAFE_CALL( vxQueryImage(prevFrameRGBX, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height)) );
 
     NVXIO_ASSERT(format == VX_DF_IMAGE_RGBX);
-    NVXIO_ASSERT(width >= 32 && height >= 32);
+    NVXIO_ASSERT(params.borderMode != BORDER_CROP || (width >= 32 && height >= 32));
 
     // Re-create graph
 
@@ -120,7 +128,30 @@ void IterativeMotionEstimator::init(vx_image prevFrameRGBX, vx_image currFrameRG
     height_ = height;
 
     createDataObjects(prevFrameRGBX, currFrameRGBX);
-    createMainGraph();
+
+    if (backend_ == BACKEND_HOST)
+    {
+        HostMotionEstimator::Params hostParams;
+        hostParams.biasWeight = params_.biasWeight;
+        hostParams.mvDivFactor = params_.mvDivFactor;
+        hostParams.smoothnessFactor = params_.smoothnessFactor;
+
+        std::vector<HostMotionEstimator::LevelConfig> levels(NUM_LEVELS);
+        for (vx_int32 level = 0; level < NUM_LEVELS; ++level)
+        {
+            levels[level].winWidth = winSizePerLevel[level].width;
+            levels[level].winHeight = winSizePerLevel[level].height;
+            levels[level].numIters = numItersPerLevel[level];
+        }
+
+        host_.reset(new HostMotionEstimator);
+        host_->init(widthROI_, heightROI_, levels, hostParams);
+    }
+    else
+    {
+        createMainGraph();
+    }
+
     processInitialFrame();
 }
 
@@ -136,40 +167,90 @@ void IterativeMotionEstimator::release()
     vxReleaseImage(&currFrameROI_);
     vxReleaseImage(&mfOutROI_);
 
+    vxReleaseImage(&grayPadded_);
+    vxReleaseImage(&grayROI_);
+
     vxReleaseDelay(&pyr_delay_);
 
     vxReleaseGraph(&graph_);
+
+    host_.reset();
+    hostGray_.clear();
 }
 
 // This function creates data objects that are not entirely linked to graphs
 void IterativeMotionEstimator::createDataObjects(vx_image prevFrameRGBX, vx_image currFrameRGBX)
 {
+    // Processed region of the frames: the whole frame, or its part with dimensions aligned to 32
+
+    if (params_.borderMode == BORDER_CROP)
+    {
+        widthROI_ = (width_ / 32) * 32;
+        heightROI_ = (height_ / 32) * 32;
+    }
+    else
+    {
+        widthROI_ = width_;
+        heightROI_ = height_;
+    }
+
+    // The NVX primitives need dimensions aligned to 32, so the GPU backend runs on pyramids
+    // padded up to the next multiple of 32. The host backend clips the border blocks instead.
+
+    widthPyr_ = widthROI_;
+    heightPyr_ = heightROI_;
+    if (backend_ == BACKEND_GPU)
+    {
+        widthPyr_ = (widthROI_ + 31) / 32 * 32;
+        heightPyr_ = (heightROI_ + 31) / 32 * 32;
+    }
+
     // Resulting motion field.
     // The algorithm calculates motion field for 2x2 pixel blocks,
     // that's why the motion field object is created with scale factor 2.
+    // The buffer is large enough for the padded field, mfOut_ only exposes the frame part.
 
     vx_uint32 mf_width = (width_ + 1) / 2;
     vx_uint32 mf_height = (height_ + 1) / 2;
 
-    mfOut_ = vxCreateImage(context_, mf_width, mf_height, NVX_DF_IMAGE_2F32);
-    NVXIO_CHECK_REFERENCE(mfOut_);
+    vx_uint32 mf_buf_width = std::max(mf_width, widthPyr_ / 2);
+    vx_uint32 mf_buf_height = std::max(mf_height, heightPyr_ / 2);
+
+    vx_image mf_buf = vxCreateImage(context_, mf_buf_width, mf_buf_height, NVX_DF_IMAGE_2F32);
+    NVXIO_CHECK_REFERENCE(mf_buf);
 
     // Fill the motion field with zeros
 
     {
         vx_imagepatch_addressing_t addr;
-        addr.dim_x = mf_width;
-        addr.dim_y = mf_height;
+        addr.dim_x = mf_buf_width;
+        addr.dim_y = mf_buf_height;
         addr.stride_x = 2*sizeof(vx_float32);
         addr.stride_y = addr.stride_x*addr.dim_x;
-        std::vector<vx_float32> buf(mf_width*mf_height*2, 0.0f);
-        NVXIO_SAFE_CALL( vxCopyImagePatch(mfOut_, NULL, 0, &addr, buf.data(), VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+        std::vector<vx_float32> buf(mf_buf_width*mf_buf_height*2, 0.0f);
+        NVXIO_SAFE_CALL( vxCopyImagePatch(mf_buf, NULL, 0, &addr, buf.data(), VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
     }
 
-    // Create ROIs with dimensions aligned to 32
+    vx_rectangle_t mf_out_rect = {
+        0u, 0u,
+        mf_width, mf_height
+    };
 
-    widthROI_ = (width_ / 32) * 32;
-    heightROI_ = (height_ / 32) * 32;
+    mfOut_ = vxCreateImageFromROI(mf_buf, &mf_out_rect);
+    NVXIO_CHECK_REFERENCE(mfOut_);
+
+    vx_rectangle_t mf_rect = {
+        0u, 0u,
+        backend_ == BACKEND_GPU ? widthPyr_ / 2 : (widthROI_ + 1) / 2,
+        backend_ == BACKEND_GPU ? heightPyr_ / 2 : (heightROI_ + 1) / 2
+    };
+
+    mfOutROI_ = vxCreateImageFromROI(mf_buf, &mf_rect);
+    NVXIO_CHECK_REFERENCE(mfOutROI_);
+
+    vxReleaseImage(&mf_buf);
+
+    // Input ROIs
 
     vx_rectangle_t frame_rect = {
         0u, 0u,
@@ -182,19 +263,38 @@ void IterativeMotionEstimator::createDataObjects(vx_image prevFrameRGBX, vx_imag
     currFrameROI_ = vxCreateImageFromROI(currFrameRGBX, &frame_rect);
     NVXIO_CHECK_REFERENCE(currFrameROI_);
 
-    vx_rectangle_t mf_rect = {
-        0u, 0u,
-        vx_uint32(widthROI_ / 2),
-        vx_uint32(heightROI_ / 2)
-    };
+    // The host backend keeps its pyramids on its own
 
-    mfOutROI_ = vxCreateImageFromROI(mfOut_, &mf_rect);
-    NVXIO_CHECK_REFERENCE(mfOutROI_);
+    if (backend_ == BACKEND_HOST)
+    {
+        hostGray_.resize(widthROI_ * heightROI_);
+        return;
+    }
+
+    // Padded gray frame. The color conversion writes directly into its top-left ROI,
+    // the padding is zeroed once here and never written again, so no per-frame copy is needed.
+
+    if (widthPyr_ != widthROI_ || heightPyr_ != heightROI_)
+    {
+        vx_pixel_value_t zero;
+        zero.U8 = 0;
+        vx_image zeros = vxCreateUniformImage(context_, widthPyr_, heightPyr_, VX_DF_IMAGE_U8, &zero);
+        NVXIO_CHECK_REFERENCE(zeros);
+
+        grayPadded_ = vxCreateImage(context_, widthPyr_, heightPyr_, VX_DF_IMAGE_U8);
+        NVXIO_CHECK_REFERENCE(grayPadded_);
+        NVXIO_SAFE_CALL( nvxuCopyImage(context_, zeros, grayPadded_) );
+
+        vxReleaseImage(&zeros);
+
+        grayROI_ = vxCreateImageFromROI(grayPadded_, &frame_rect);
+        NVXIO_CHECK_REFERENCE(grayROI_);
+    }
 
     // Two successive pyramids are necessary for the computation.
     // A delay object with 2 slots is created for this purpose.
 
-    vx_pyramid pyr_exemplar = vxCreatePyramid(context_, NUM_LEVELS, VX_SCALE_PYRAMID_HALF, widthROI_, heightROI_, VX_DF_IMAGE_U8);
+    vx_pyramid pyr_exemplar = vxCreatePyramid(context_, NUM_LEVELS, VX_SCALE_PYRAMID_HALF, widthPyr_, heightPyr_, VX_DF_IMAGE_U8);
     NVXIO_CHECK_REFERENCE(pyr_exemplar);
 
     pyr_delay_ = vxCreateDelay(context_, (vx_reference)pyr_exemplar, 2);
@@ -216,18 +316,31 @@ void IterativeMotionEstimator::createMainGraph()
 
     // Color Convert
 
-    vx_image frame_gray = vxCreateVirtualImage(graph_, 0, 0, VX_DF_IMAGE_U8);
-    NVXIO_CHECK_REFERENCE(frame_gray);
+    if (grayPadded_)
+    {
+        cvt_color_node_ = vxColorConvertNode(graph_, currFrameROI_, grayROI_);
+        NVXIO_CHECK_REFERENCE(cvt_color_node_);
 
-    cvt_color_node_ = vxColorConvertNode(graph_, currFrameROI_, frame_gray);
-    NVXIO_CHECK_REFERENCE(cvt_color_node_);
+        // Gaussian Pyramid
 
-    // Gaussian Pyramid
+        pyramid_node_ = vxGaussianPyramidNode(graph_, grayPadded_, curr_pyr);
+        NVXIO_CHECK_REFERENCE(pyramid_node_);
+    }
+    else
+    {
+        vx_image frame_gray = vxCreateVirtualImage(graph_, 0, 0, VX_DF_IMAGE_U8);
+        NVXIO_CHECK_REFERENCE(frame_gray);
 
-    pyramid_node_ = vxGaussianPyramidNode(graph_, frame_gray, curr_pyr);
-    NVXIO_CHECK_REFERENCE(pyramid_node_);
+        cvt_color_node_ = vxColorConvertNode(graph_, currFrameROI_, frame_gray);
+        NVXIO_CHECK_REFERENCE(cvt_color_node_);
 
-    vxReleaseImage(&frame_gray);
+        // Gaussian Pyramid
+
+        pyramid_node_ = vxGaussianPyramidNode(graph_, frame_gray, curr_pyr);
+        NVXIO_CHECK_REFERENCE(pyramid_node_);
+
+        vxReleaseImage(&frame_gray);
+    }
 
     // Virtual buffers
 
@@ -256,23 +369,23 @@ void IterativeMotionEstimator::createMainGraph()
     //
 
     vx_image sad_table_buf = vxCreateVirtualImage(graph_,
-                                                  (widthROI_ / 8) * winSizePerLevel[NUM_LEVELS - 1].width * winSizePerLevel[NUM_LEVELS - 1].height,
-                                                  heightROI_ / 8,
+                                                  (widthPyr_ / 8) * winSizePerLevel[NUM_LEVELS - 1].width * winSizePerLevel[NUM_LEVELS - 1].height,
+                                                  heightPyr_ / 8,
                                                   VX_DF_IMAGE_U32);
     NVXIO_CHECK_REFERENCE(sad_table_buf);
 
     vx_image mf_bufs[4];
 
-    mf_bufs[0] = vxCreateVirtualImage(graph_, widthROI_ / 4, heightROI_ / 4, NVX_DF_IMAGE_2S16);
+    mf_bufs[0] = vxCreateVirtualImage(graph_, widthPyr_ / 4, heightPyr_ / 4, NVX_DF_IMAGE_2S16);
     NVXIO_CHECK_REFERENCE(mf_bufs[0]);
 
-    mf_bufs[1] = vxCreateVirtualImage(graph_, widthROI_ / 4, heightROI_ / 4, NVX_DF_IMAGE_2S16);
+    mf_bufs[1] = vxCreateVirtualImage(graph_, widthPyr_ / 4, heightPyr_ / 4, NVX_DF_IMAGE_2S16);
     NVXIO_CHECK_REFERENCE(mf_bufs[1]);
 
-    mf_bufs[2] = vxCreateVirtualImage(graph_, widthROI_ / 4, heightROI_ / 4, NVX_DF_IMAGE_2S16);
+    mf_bufs[2] = vxCreateVirtualImage(graph_, widthPyr_ / 4, heightPyr_ / 4, NVX_DF_IMAGE_2S16);
     NVXIO_CHECK_REFERENCE(mf_bufs[2]);
 
-    mf_bufs[3] = vxCreateVirtualImage(graph_, widthROI_ / 2, heightROI_ / 2, NVX_DF_IMAGE_2S16);
+    mf_bufs[3] = vxCreateVirtualImage(graph_, widthPyr_ / 2, heightPyr_ / 2, NVX_DF_IMAGE_2S16);
     NVXIO_CHECK_REFERENCE(mf_bufs[3]);
 
     // Loop over levels
@@ -448,8 +561,23 @@ void IterativeMotionEstimator::createMainGraph()
 
 void IterativeMotionEstimator::processInitialFrame()
 {
+    if (backend_ == BACKEND_HOST)
+    {
+        readGrayFrame(prevFrameROI_);
+        host_->setInitialFrame(hostGray_.data(), widthROI_);
+        writeHostMotionField();
+        return;
+    }
+
     vx_pyramid prev_pyr = (vx_pyramid)vxGetReferenceFromDelay(pyr_delay_, -1);
 
+    if (grayPadded_)
+    {
+        NVXIO_SAFE_CALL( vxuColorConvert(context_, prevFrameROI_, grayROI_) );
+        NVXIO_SAFE_CALL( vxuGaussianPyramid(context_, grayPadded_, prev_pyr) );
+        return;
+    }
+
     vx_image frame_gray = vxCreateImage(context_, widthROI_, heightROI_, VX_DF_IMAGE_U8);
     NVXIO_CHECK_REFERENCE(frame_gray);
 
@@ -461,10 +589,55 @@ void IterativeMotionEstimator::processInitialFrame()
 
 void IterativeMotionEstimator::process()
 {
+    if (backend_ == BACKEND_HOST)
+    {
+        readGrayFrame(currFrameROI_);
+        host_->process(hostGray_.data(), widthROI_);
+        writeHostMotionField();
+        return;
+    }
+
     // Process graph
     NVXIO_SAFE_CALL( vxProcessGraph(graph_) );
 }
 
+void IterativeMotionEstimator::readGrayFrame(vx_image frameRGBX)
+{
+    vx_rectangle_t rect = {
+        0u, 0u,
+        widthROI_, heightROI_
+    };
+
+    vx_map_id map_id;
+    vx_imagepatch_addressing_t addr;
+    void* ptr = nullptr;
+    NVXIO_SAFE_CALL( vxMapImagePatch(frameRGBX, &rect, 0, &map_id, &addr, &ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+
+    HostMotionEstimator::convertRGBXToGray(static_cast<const vx_uint8*>(ptr), addr.stride_y,
+                                           hostGray_.data(), widthROI_,
+                                           widthROI_, heightROI_);
+
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(frameRGBX, map_id) );
+}
+
+void IterativeMotionEstimator::writeHostMotionField()
+{
+    vx_imagepatch_addressing_t addr;
+    addr.dim_x = host_->getMotionFieldWidth();
+    addr.dim_y = host_->getMotionFieldHeight();
+    addr.stride_x = 2*sizeof(vx_float32);
+    addr.stride_y = addr.stride_x*addr.dim_x;
+
+    vx_rectangle_t rect = {
+        0u, 0u,
+        addr.dim_x, addr.dim_y
+    };
+
+    NVXIO_SAFE_CALL( vxCopyImagePatch(mfOutROI_, &rect, 0, &addr,
+                                      const_cast<vx_float32*>(host_->getMotionField().data()),
+                                      VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+}
+
 vx_image IterativeMotionEstimator::getMotionField() const
 {
     return mfOut_;
@@ -472,6 +645,18 @@ vx_image IterativeMotionEstimator::getMotionField() const
 
 void IterativeMotionEstimator::printPerfs() const
 {
+    if (backend_ == BACKEND_HOST)
+    {
+        const HostMotionEstimator::Perf& hostPerf = host_->getPerf();
+
+        std::cout << "Host Time : " << hostPerf.total_ms << " ms" << std::endl;
+        std::cout << "\t Pyramid Time : " << hostPerf.pyramid_ms << " ms" << std::endl;
+        std::cout << "\t Create Motion Field (x " << NUM_LEVELS << ") Time : " << hostPerf.create_ms << " ms" << std::endl;
+        std::cout << "\t Refine Motion Field (x " << NUM_LEVELS << ") Time : " << hostPerf.refine_ms << " ms" << std::endl;
+        std::cout << "\t Partition Motion Field (x " << NUM_LEVELS + 1 << ") Time : " << hostPerf.partition_ms << " ms" << std::endl;
+        return;
+    }
+
     vx_perf_t perf;
 
     NVXIO_SAFE_CALL( vxQueryGraph(graph_, VX_GRAPH_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
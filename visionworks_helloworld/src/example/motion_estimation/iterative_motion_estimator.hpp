@@ -29,22 +29,42 @@
 #ifndef ITERATIVE_MOTION_ESTIMATOR_HPP
 #define ITERATIVE_MOTION_ESTIMATOR_HPP
 
+#include <memory>
 #include <vector>
 #include <VX/vx.h>
 
+#include "host_motion_estimator.hpp"
+
 class IterativeMotionEstimator
 {
 public:
+    enum Backend
+    {
+        // NVX motion field primitives, executed on the GPU
+        BACKEND_GPU,
+        // HostMotionEstimator, no GPU required
+        BACKEND_HOST
+    };
+
+    enum BorderMode
+    {
+        // Only the top-left part of the frame with dimensions aligned to 32 gets motion vectors
+        BORDER_CROP,
+        // The whole frame gets motion vectors
+        BORDER_FULL
+    };
+
     struct Params
     {
         vx_float32 biasWeight;
         vx_int32 mvDivFactor;
         vx_float32 smoothnessFactor;
+        BorderMode borderMode;
 
         Params();
     };
 
-    explicit IterativeMotionEstimator(vx_context context);
+    explicit IterativeMotionEstimator(vx_context context, Backend backend = BACKEND_GPU);
     ~IterativeMotionEstimator();
 
     void init(vx_image prevFrameRGBX, vx_image currFrameRGBX, const Params& params = Params());
@@ -61,9 +81,14 @@ private:
     void processInitialFrame();
     void createMainGraph();
 
+    void readGrayFrame(vx_image frameRGBX);
+    void writeHostMotionField();
+
 private:
     vx_context context_;
 
+    Backend backend_;
+
     Params params_;
 
     // Format for current frames
@@ -74,13 +99,21 @@ private:
     // Resulting motion field
     vx_image mfOut_;
 
-    // Input/output ROIs (with dimensions aligned to 32)
+    // Input/output ROIs (the whole frame or its part with dimensions aligned to 32)
     vx_uint32 widthROI_;
     vx_uint32 heightROI_;
     vx_image prevFrameROI_;
     vx_image currFrameROI_;
     vx_image mfOutROI_;
 
+    // Size of the pyramids (padded to 32 for the GPU backend)
+    vx_uint32 widthPyr_;
+    vx_uint32 heightPyr_;
+
+    // Zero padded gray frame and its part covered by the frame (GPU backend, unaligned frames)
+    vx_image grayPadded_;
+    vx_image grayROI_;
+
     // Two successive pyramids
     vx_delay pyr_delay_;
 
@@ -94,6 +127,10 @@ private:
     std::vector<vx_node> refine_mf_nodes_;
     std::vector<vx_node> partition_mf_nodes_;
     std::vector<vx_node> mult_mf_nodes_;
+
+    // Host backend
+    std::unique_ptr<HostMotionEstimator> host_;
+    std::vector<vx_uint8> hostGray_;
 };
 
 
@@ -0,0 +1,166 @@
+/*
+# Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "host_motion_estimator.hpp"
+
+//
+// Regression test of the host motion estimator, without a GPU: a synthetic textured frame is
+// shifted by a known (dx, dy), and the vectors of the field must be -(dx, dy), also for frame
+// sizes which are not a multiple of the block size.
+//
+
+namespace {
+
+// Smooth value noise, defined for any pixel so the shifted frame has no border of its own
+vx_uint8 texture(vx_int32 x, vx_int32 y)
+{
+    const vx_int32 cell = 4;
+
+    struct Lattice
+    {
+        static vx_float32 at(vx_int32 i, vx_int32 j)
+        {
+            vx_uint32 h = static_cast<vx_uint32>(i) * 73856093u ^ static_cast<vx_uint32>(j) * 19349663u;
+            h ^= h >> 13;
+            h *= 0x5bd1e995u;
+            h ^= h >> 15;
+            return static_cast<vx_float32>(h & 0xff);
+        }
+    };
+
+    vx_int32 i = (x >= 0 ? x : x - cell + 1) / cell;
+    vx_int32 j = (y >= 0 ? y : y - cell + 1) / cell;
+    vx_float32 fx = static_cast<vx_float32>(x - i * cell) / cell;
+    vx_float32 fy = static_cast<vx_float32>(y - j * cell) / cell;
+
+    vx_float32 top = Lattice::at(i, j) * (1 - fx) + Lattice::at(i + 1, j) * fx;
+    vx_float32 bottom = Lattice::at(i, j + 1) * (1 - fx) + Lattice::at(i + 1, j + 1) * fx;
+
+    return static_cast<vx_uint8>(top * (1 - fy) + bottom * fy + 0.5f);
+}
+
+// The content at (x, y) of the current frame is at (x - dx, y - dy) in the previous one
+void makeFrame(vx_int32 width, vx_int32 height, vx_int32 dx, vx_int32 dy, std::vector<vx_uint8>& frame)
+{
+    frame.resize(width * height);
+    for (vx_int32 y = 0; y < height; ++y)
+        for (vx_int32 x = 0; x < width; ++x)
+            frame[y * width + x] = texture(x - dx, y - dy);
+}
+
+// Share of the vectors which must be exact; the blocks near the borders whose content
+// comes from outside the frame may be off
+bool testShift(vx_uint32 width, vx_uint32 height, vx_int32 dx, vx_int32 dy, double minExact)
+{
+    // Same pyramid as IterativeMotionEstimator
+    std::vector<HostMotionEstimator::LevelConfig> levels(3);
+    levels[0].winWidth = 16; levels[0].winHeight = 16; levels[0].numIters = 6;
+    levels[1].winWidth = 32; levels[1].winHeight = 16; levels[1].numIters = 4;
+    levels[2].winWidth = 48; levels[2].winHeight = 32; levels[2].numIters = 4;
+
+    HostMotionEstimator::Params params;
+    params.biasWeight = 1.0f;
+    params.mvDivFactor = 4;
+    params.smoothnessFactor = 1.0f;
+
+    std::vector<vx_uint8> prev, curr;
+    makeFrame(width, height, 0, 0, prev);
+    makeFrame(width, height, dx, dy, curr);
+
+    HostMotionEstimator estimator;
+    estimator.init(width, height, levels, params);
+    estimator.setInitialFrame(&prev[0], width);
+    estimator.process(&curr[0], width);
+
+    const std::vector<vx_float32>& field = estimator.getMotionField();
+    vx_uint32 fieldWidth = estimator.getMotionFieldWidth();
+    vx_uint32 fieldHeight = estimator.getMotionFieldHeight();
+
+    std::cout << width << "x" << height << ", shift (" << dx << ", " << dy << "): ";
+
+    if (fieldWidth != (width + 1) / 2 || fieldHeight != (height + 1) / 2 ||
+        field.size() != 2u * fieldWidth * fieldHeight)
+    {
+        std::cout << "wrong field size " << fieldWidth << "x" << fieldHeight << std::endl;
+        return false;
+    }
+
+    vx_size exact = 0;
+    for (vx_size i = 0; i < field.size(); i += 2)
+    {
+        if (!std::isfinite(field[i]) || !std::isfinite(field[i + 1]))
+        {
+            std::cout << "vector " << i / 2 << " is not finite" << std::endl;
+            return false;
+        }
+        if (field[i] == -dx && field[i + 1] == -dy)
+            ++exact;
+    }
+
+    vx_size total = field.size() / 2;
+    bool ok = exact >= minExact * total;
+
+    std::cout << exact << "/" << total << " exact vectors" << (ok ? "" : ", too few") << std::endl;
+    return ok;
+}
+
+}
+
+//
+// main - Application entry point
+//
+
+int main()
+{
+    bool ok = true;
+
+    ok &= testShift(640, 480, 3, 2, 0.95);
+    ok &= testShift(640, 480, -5, 3, 0.95);
+    ok &= testShift(640, 480, 0, 0, 0.99);
+
+    // Not a multiple of the 8x8 blocks, nor of the pyramid levels
+    ok &= testShift(641, 487, 3, 2, 0.95);
+    ok &= testShift(33, 17, 1, 1, 0.7);
+
+    // Degenerate frame: only the size of the field is checked
+    ok &= testShift(1, 1, 0, 0, 0.0);
+
+    if (!ok)
+    {
+        std::cerr << "The host motion estimator missed the known shift" << std::endl;
+        return 1;
+    }
+
+    std::cout << "The host motion estimator found every shift" << std::endl;
+    return 0;
+}
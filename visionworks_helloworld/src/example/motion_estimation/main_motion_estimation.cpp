@@ -43,6 +43,8 @@
 #include "NVXIO/Utility.hpp"
 
 #include "iterative_motion_estimator.hpp"
+#include "motion_field_analyzer.hpp"
+#include "motion_field_recorder.hpp"
 
 //
 // Process events
@@ -87,6 +89,10 @@ static bool read(const std::string& configFile,
 						 nvxio::ranges::atLeast(0) & nvxio::ranges::atMost(16)));
 	parser->addParameter("smoothnessFactor", nvxio::OptionHandler::real(&params.smoothnessFactor,
 						 nvxio::ranges::atLeast(0.0f)));
+	parser->addParameter("borderMode", nvxio::OptionHandler::oneOf(&params.borderMode, {
+						 {"crop", IterativeMotionEstimator::BORDER_CROP},
+						 {"full", IterativeMotionEstimator::BORDER_FULL},
+						 }));
 
 	message = parser->parse(configFile);
 
@@ -113,10 +119,17 @@ int main(int argc, char** argv)
 
 		std::string sourceUri = "./data/pedestrians.mp4";
 		std::string configFile = "./data/motion_estimation_demo_config.ini";
+		IterativeMotionEstimator::Backend backend = IterativeMotionEstimator::BACKEND_GPU;
+		std::string recordPath;
 
 		app.setDescription("This sample demonstrates Iterative Motion Estimation algorithm");
 		app.addOption('s', "source", "Source URI", nvxio::OptionHandler::string(&sourceUri));
 		app.addOption('c', "config", "Config file path", nvxio::OptionHandler::string(&configFile));
+		app.addOption('b', "backend", "Motion estimation backend", nvxio::OptionHandler::oneOf(&backend, {
+			{"gpu", IterativeMotionEstimator::BACKEND_GPU},
+			{"host", IterativeMotionEstimator::BACKEND_HOST}
+					  }));
+		app.addOption('r', "record", "Record motion fields to a compressed file", nvxio::OptionHandler::string(&recordPath));
 		app.init(argc, argv);
 
 		//
@@ -198,7 +211,7 @@ int main(int argc, char** argv)
 		// Create algorithm
 		//
 
-		IterativeMotionEstimator ime(context);
+		IterativeMotionEstimator ime(context, backend);
 
 		nvxio::FrameSource::FrameStatus frameStatus;
 		do
@@ -213,6 +226,24 @@ int main(int argc, char** argv)
 
 		ime.init(prevFrame, currFrame, params);
 
+		//
+		// Create motion field consumers
+		//
+
+		vx_uint32 mfWidth = 0, mfHeight = 0;
+		NVXIO_SAFE_CALL( vxQueryImage(ime.getMotionField(), VX_IMAGE_ATTRIBUTE_WIDTH, &mfWidth, sizeof(mfWidth)) );
+		NVXIO_SAFE_CALL( vxQueryImage(ime.getMotionField(), VX_IMAGE_ATTRIBUTE_HEIGHT, &mfHeight, sizeof(mfHeight)) );
+
+		MotionFieldAnalyzer analyzer;
+		analyzer.init(mfWidth, mfHeight);
+
+		MotionFieldRecorder recorder;
+		if (!recordPath.empty() && !recorder.open(recordPath, mfWidth, mfHeight))
+		{
+			std::cerr << "Error: cannot open " << recordPath << " for recording" << std::endl;
+			return nvxio::Application::APP_EXIT_CODE_NO_RESOURCE;
+		}
+
 		//
 		// Main loop
 		//
@@ -269,6 +300,35 @@ int main(int argc, char** argv)
 				ime.process();
 
 				proc_ms = procTimer.toc();
+
+				//
+				// Consume the motion field, mapped once for all the consumers
+				//
+
+				vx_image motionField = ime.getMotionField();
+
+				vx_rectangle_t mfRect = {
+					0u, 0u,
+					mfWidth, mfHeight
+				};
+
+				vx_map_id mfMapId;
+				vx_imagepatch_addressing_t mfAddr;
+				void* mfPtr = nullptr;
+				NVXIO_SAFE_CALL( vxMapImagePatch(motionField, &mfRect, 0, &mfMapId, &mfAddr, &mfPtr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+
+				const vx_float32* field = static_cast<const vx_float32*>(mfPtr);
+
+				analyzer.analyze(field, mfAddr.stride_y);
+				bool recorded = !recorder.isOpened() || recorder.write(field, mfAddr.stride_y);
+
+				NVXIO_SAFE_CALL( vxUnmapImagePatch(motionField, mfMapId) );
+
+				if (!recorded)
+				{
+					std::cerr << "Error: cannot write to " << recordPath << std::endl;
+					recorder.close();
+				}
 			}
 
 			double total_ms = totalTimer.toc();
@@ -308,6 +368,15 @@ int main(int argc, char** argv)
 			msg << "Resolution: " << frameConfig.frameWidth << 'x' << frameConfig.frameHeight << std::endl;
 			msg << "Algorithm: " << proc_ms << " ms / " << 1000.0 / proc_ms << " FPS" << std::endl;
 			msg << "Display: " << total_ms << " ms / " << 1000.0 / total_ms << " FPS" << std::endl;
+
+			const MotionFieldAnalyzer::RegionStats& motion = analyzer.getGlobal();
+			msg << "Dominant motion: (" << motion.dominantX << ", " << motion.dominantY << "), moving: "
+				<< 100.0f * motion.movingFraction << " %" << std::endl;
+			if (recorder.isOpened())
+			{
+				msg << "Recorded: " << recorder.getNumFrames() << " fields, "
+					<< recorder.getNumBytes() / 1024.0 << " KB" << std::endl;
+			}
 			msg << "Space - pause/resume" << std::endl;
 			msg << "Esc - close the sample";
 
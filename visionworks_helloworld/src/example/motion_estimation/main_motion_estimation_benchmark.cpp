@@ -0,0 +1,240 @@
+/*
+# Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <memory>
+
+#include <NVX/nvx.h>
+#include <NVX/nvx_timer.hpp>
+
+#include "NVXIO/Application.hpp"
+#include "NVXIO/FrameSource.hpp"
+#include "NVXIO/Utility.hpp"
+
+#include "iterative_motion_estimator.hpp"
+
+//
+// Benchmark of the border modes of the Iterative Motion Estimator.
+// Runs the same frames with BORDER_CROP and BORDER_FULL and reports the cost of
+// producing motion vectors for the whole frame.
+//
+
+struct BenchmarkResult
+{
+    vx_uint32 numFrames;
+    double ms_per_frame;
+};
+
+static bool fetchFrame(nvxio::FrameSource& frameSource, vx_image frame)
+{
+    nvxio::FrameSource::FrameStatus frameStatus;
+    do
+    {
+        frameStatus = frameSource.fetch(frame);
+    } while (frameStatus == nvxio::FrameSource::TIMEOUT);
+
+    return frameStatus == nvxio::FrameSource::OK;
+}
+
+static bool runBenchmark(vx_context context, const std::string& sourceUri,
+                         IterativeMotionEstimator::Backend backend,
+                         IterativeMotionEstimator::BorderMode borderMode,
+                         vx_uint32 numFrames, vx_uint32 warmupFrames,
+                         BenchmarkResult& result)
+{
+    std::unique_ptr<nvxio::FrameSource> frameSource(nvxio::createDefaultFrameSource(context, sourceUri));
+
+    if (!frameSource || !frameSource->open())
+    {
+        std::cerr << "Error: cannot open frame source!" << std::endl;
+        return false;
+    }
+
+    nvxio::FrameSource::Parameters frameConfig = frameSource->getConfiguration();
+
+    vx_image frameExemplar = vxCreateImage(context,
+                                           frameConfig.frameWidth, frameConfig.frameHeight, VX_DF_IMAGE_RGBX);
+    NVXIO_CHECK_REFERENCE(frameExemplar);
+    vx_delay frame_delay = vxCreateDelay(context, (vx_reference)frameExemplar, 2);
+    NVXIO_CHECK_REFERENCE(frame_delay);
+    vxReleaseImage(&frameExemplar);
+
+    vx_image prevFrame = (vx_image)vxGetReferenceFromDelay(frame_delay, -1);
+    vx_image currFrame = (vx_image)vxGetReferenceFromDelay(frame_delay, 0);
+
+    result.numFrames = 0;
+    result.ms_per_frame = 0.0;
+
+    if (!fetchFrame(*frameSource, prevFrame))
+    {
+        std::cerr << "Source has no frames" << std::endl;
+        vxReleaseDelay(&frame_delay);
+        return false;
+    }
+
+    IterativeMotionEstimator::Params params;
+    params.borderMode = borderMode;
+
+    IterativeMotionEstimator ime(context, backend);
+    ime.init(prevFrame, currFrame, params);
+
+    double total_ms = 0.0;
+    for (vx_uint32 i = 0; i < warmupFrames + numFrames; ++i)
+    {
+        if (!fetchFrame(*frameSource, currFrame))
+            break;
+
+        nvx::Timer procTimer;
+        procTimer.tic();
+
+        ime.process();
+
+        double proc_ms = procTimer.toc();
+
+        if (i >= warmupFrames)
+        {
+            total_ms += proc_ms;
+            ++result.numFrames;
+        }
+
+        vxAgeDelay(frame_delay);
+    }
+
+    if (result.numFrames > 0)
+        result.ms_per_frame = total_ms / result.numFrames;
+
+    vxReleaseDelay(&frame_delay);
+
+    return result.numFrames > 0;
+}
+
+//
+// main - Application entry point
+//
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        nvxio::Application &app = nvxio::Application::get();
+
+        //
+        // Parse command line arguments
+        //
+
+        std::string sourceUri = "./data/pedestrians.mp4";
+        IterativeMotionEstimator::Backend backend = IterativeMotionEstimator::BACKEND_GPU;
+        unsigned int numFrames = 100;
+        unsigned int warmupFrames = 5;
+
+        app.setDescription("This sample measures the cost of full-frame motion estimation compared to the 32-aligned crop");
+        app.addOption('s', "source", "Source URI", nvxio::OptionHandler::string(&sourceUri));
+        app.addOption('b', "backend", "Motion estimation backend", nvxio::OptionHandler::oneOf(&backend, {
+            {"gpu", IterativeMotionEstimator::BACKEND_GPU},
+            {"host", IterativeMotionEstimator::BACKEND_HOST}
+                      }));
+        app.addOption('n', "frames", "Number of measured frames", nvxio::OptionHandler::unsignedInteger(&numFrames,
+                      nvxio::ranges::atLeast(1u)));
+        app.addOption('w', "warmup", "Number of frames processed before the measurement", nvxio::OptionHandler::unsignedInteger(&warmupFrames));
+        app.init(argc, argv);
+
+        //
+        // Create OpenVX context
+        //
+
+        nvxio::ContextGuard context;
+        vxRegisterLogCallback(context, &nvxio::stdoutLogCallback, vx_false_e);
+
+        //
+        // Query the frame size
+        //
+
+        vx_uint32 width = 0, height = 0;
+        {
+            std::unique_ptr<nvxio::FrameSource> frameSource(nvxio::createDefaultFrameSource(context, sourceUri));
+
+            if (!frameSource || !frameSource->open())
+            {
+                std::cerr << "Error: cannot open frame source!" << std::endl;
+                return nvxio::Application::APP_EXIT_CODE_NO_RESOURCE;
+            }
+
+            if (frameSource->getSourceType() == nvxio::FrameSource::SINGLE_IMAGE_SOURCE)
+            {
+                std::cerr << "Can't work on a single image." << std::endl;
+                return nvxio::Application::APP_EXIT_CODE_INVALID_FORMAT;
+            }
+
+            nvxio::FrameSource::Parameters frameConfig = frameSource->getConfiguration();
+            width = frameConfig.frameWidth;
+            height = frameConfig.frameHeight;
+        }
+
+        //
+        // Run both border modes on the same frames
+        //
+
+        BenchmarkResult crop, full;
+
+        if (!runBenchmark(context, sourceUri, backend, IterativeMotionEstimator::BORDER_CROP, numFrames, warmupFrames, crop) ||
+            !runBenchmark(context, sourceUri, backend, IterativeMotionEstimator::BORDER_FULL, numFrames, warmupFrames, full))
+        {
+            return nvxio::Application::APP_EXIT_CODE_NO_FRAMESOURCE;
+        }
+
+        // Motion vectors are produced for 2x2 pixel blocks
+
+        vx_uint32 crop_mf_width = (width / 32) * 32 / 2, crop_mf_height = (height / 32) * 32 / 2;
+        vx_uint32 full_mf_width = (width + 1) / 2, full_mf_height = (height + 1) / 2;
+
+        double crop_coverage = 100.0 * crop_mf_width * crop_mf_height / (full_mf_width * full_mf_height);
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Resolution: " << width << 'x' << height << std::endl;
+        std::cout << "Backend: " << (backend == IterativeMotionEstimator::BACKEND_GPU ? "gpu" : "host") << std::endl;
+        std::cout << std::endl;
+        std::cout << "crop : " << crop.ms_per_frame << " ms/frame (" << crop.numFrames << " frames), field "
+                  << crop_mf_width << 'x' << crop_mf_height << " (" << std::setprecision(1) << crop_coverage << "% of the frame)" << std::endl;
+        std::cout << std::setprecision(3);
+        std::cout << "full : " << full.ms_per_frame << " ms/frame (" << full.numFrames << " frames), field "
+                  << full_mf_width << 'x' << full_mf_height << " (100.0% of the frame)" << std::endl;
+        std::cout << std::endl;
+        std::cout << std::setprecision(1);
+        std::cout << "Full-frame overhead: " << 100.0 * (full.ms_per_frame - crop.ms_per_frame) / crop.ms_per_frame << " %" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return nvxio::Application::APP_EXIT_CODE_ERROR;
+    }
+
+    return nvxio::Application::APP_EXIT_CODE_SUCCESS;
+}
@@ -0,0 +1,361 @@
+#include "motion_field_analyzer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "NVXIO/Utility.hpp"
+
+#include "../common/host_simd.hpp"
+#include "../common/parallel_for.hpp"
+
+namespace
+{
+    // Per-vector classification shared by the SIMD and the scalar paths
+    struct Classifier
+    {
+        vx_float32 threshold2;
+        vx_float32 histScale;
+        vx_float32 histMaxBin;
+        vx_float32 invStep;
+    };
+
+    inline void classify(const Classifier& c, vx_float32 dx, vx_float32 dy,
+                         vx_int32& bin, vx_int32& qx, vx_int32& qy, bool& moving)
+    {
+        vx_float32 mag2 = dx * dx + dy * dy;
+        moving = mag2 > c.threshold2;
+        bin = static_cast<vx_int32>(std::min(std::sqrt(mag2) * c.histScale, c.histMaxBin));
+        qx = static_cast<vx_int32>(std::lrint(dx * c.invStep));
+        qy = static_cast<vx_int32>(std::lrint(dy * c.invStep));
+    }
+}
+
+MotionFieldAnalyzer::Params::Params()
+{
+    regionsX = 4;
+    regionsY = 4;
+    motionThreshold = 1.0f;
+    histogramBins = 32;
+    histogramMaxMagnitude = 32.0f;
+    dominantRange = 16.0f;
+    dominantStep = 1.0f;
+}
+
+MotionFieldAnalyzer::MotionFieldAnalyzer()
+{
+    fieldWidth_ = 0;
+    fieldHeight_ = 0;
+    cellsPerAxis_ = 0;
+    global_ = RegionStats();
+}
+
+void MotionFieldAnalyzer::init(vx_uint32 fieldWidth, vx_uint32 fieldHeight, const Params& params)
+{
+    NVXIO_ASSERT(fieldWidth > 0 && fieldHeight > 0);
+    NVXIO_ASSERT(params.regionsX > 0 && params.regionsY > 0);
+    NVXIO_ASSERT(params.regionsX <= fieldWidth && params.regionsY <= fieldHeight);
+    NVXIO_ASSERT(params.histogramBins > 0 && params.histogramMaxMagnitude > 0.0f);
+    NVXIO_ASSERT(params.dominantStep > 0.0f && params.dominantRange >= 0.0f);
+
+    params_ = params;
+    fieldWidth_ = fieldWidth;
+    fieldHeight_ = fieldHeight;
+
+    regionStartX_.resize(params_.regionsX + 1);
+    for (vx_uint32 i = 0; i <= params_.regionsX; ++i)
+        regionStartX_[i] = i * fieldWidth_ / params_.regionsX;
+
+    regionStartY_.resize(params_.regionsY + 1);
+    for (vx_uint32 i = 0; i <= params_.regionsY; ++i)
+        regionStartY_[i] = i * fieldHeight_ / params_.regionsY;
+
+    vx_uint32 numRegions = params_.regionsX * params_.regionsY;
+
+    cellsPerAxis_ = 2 * static_cast<vx_int32>(params_.dominantRange / params_.dominantStep) + 1;
+    cells_.assign(numRegions * cellsPerAxis_ * cellsPerAxis_, Cell());
+    globalCells_.assign(cellsPerAxis_ * cellsPerAxis_, Cell());
+    accumulators_.assign(numRegions, Accumulator());
+
+    regions_.assign(numRegions, RegionStats());
+    for (vx_uint32 ry = 0; ry < params_.regionsY; ++ry)
+    {
+        for (vx_uint32 rx = 0; rx < params_.regionsX; ++rx)
+        {
+            RegionStats& region = regions_[ry * params_.regionsX + rx];
+            region.x = regionStartX_[rx];
+            region.y = regionStartY_[ry];
+            region.width = regionStartX_[rx + 1] - regionStartX_[rx];
+            region.height = regionStartY_[ry + 1] - regionStartY_[ry];
+        }
+    }
+
+    global_ = RegionStats();
+    global_.width = fieldWidth_;
+    global_.height = fieldHeight_;
+
+    histogram_.assign(params_.histogramBins, 0);
+    partialHistograms_.assign(params_.regionsY * params_.histogramBins, 0);
+    changeMask_.assign(fieldWidth_ * fieldHeight_, 0);
+}
+
+void MotionFieldAnalyzer::analyze(vx_image motionField)
+{
+    vx_uint32 width = 0, height = 0;
+    NVXIO_SAFE_CALL( vxQueryImage(motionField, VX_IMAGE_ATTRIBUTE_WIDTH, &width, sizeof(width)) );
+    NVXIO_SAFE_CALL( vxQueryImage(motionField, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height)) );
+    NVXIO_ASSERT(width == fieldWidth_ && height == fieldHeight_);
+
+    vx_rectangle_t rect = {
+        0u, 0u,
+        width, height
+    };
+
+    vx_map_id map_id;
+    vx_imagepatch_addressing_t addr;
+    void* ptr = nullptr;
+    NVXIO_SAFE_CALL( vxMapImagePatch(motionField, &rect, 0, &map_id, &addr, &ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+
+    analyze(static_cast<const vx_float32*>(ptr), addr.stride_y);
+
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(motionField, map_id) );
+}
+
+void MotionFieldAnalyzer::analyze(const vx_float32* field, vx_size stride)
+{
+    std::fill(cells_.begin(), cells_.end(), Cell());
+    std::fill(accumulators_.begin(), accumulators_.end(), Accumulator());
+    std::fill(partialHistograms_.begin(), partialHistograms_.end(), 0);
+
+    // Rows of regions don't share any output, so they are processed in parallel
+
+    nvx::parallelFor(0, static_cast<vx_int32>(params_.regionsY), 1, [&](vx_int32 first, vx_int32 last)
+    {
+        for (vx_int32 ry = first; ry < last; ++ry)
+        {
+            for (vx_uint32 y = regionStartY_[ry]; y < regionStartY_[ry + 1]; ++y)
+            {
+                const vx_float32* row = reinterpret_cast<const vx_float32*>(reinterpret_cast<const vx_uint8*>(field) + y * stride);
+                analyzeRow(ry, y, row);
+            }
+        }
+    });
+
+    // Reduce the partial results
+
+    std::fill(histogram_.begin(), histogram_.end(), 0);
+    for (vx_uint32 ry = 0; ry < params_.regionsY; ++ry)
+        for (vx_uint32 bin = 0; bin < params_.histogramBins; ++bin)
+            histogram_[bin] += partialHistograms_[ry * params_.histogramBins + bin];
+
+    std::fill(globalCells_.begin(), globalCells_.end(), Cell());
+    Accumulator globalAcc = Accumulator();
+
+    vx_size cellsPerRegion = cellsPerAxis_ * cellsPerAxis_;
+    for (vx_size r = 0; r < regions_.size(); ++r)
+    {
+        const Cell* cells = &cells_[r * cellsPerRegion];
+        finishRegion(regions_[r], accumulators_[r], cells);
+
+        for (vx_size i = 0; i < cellsPerRegion; ++i)
+        {
+            globalCells_[i].count += cells[i].count;
+            globalCells_[i].sumX += cells[i].sumX;
+            globalCells_[i].sumY += cells[i].sumY;
+        }
+
+        globalAcc.sumX += accumulators_[r].sumX;
+        globalAcc.sumY += accumulators_[r].sumY;
+        globalAcc.moving += accumulators_[r].moving;
+    }
+
+    finishRegion(global_, globalAcc, globalCells_.data());
+}
+
+void MotionFieldAnalyzer::analyzeRow(vx_uint32 regionRow, vx_uint32 row, const vx_float32* src)
+{
+    Classifier c;
+    c.threshold2 = params_.motionThreshold * params_.motionThreshold;
+    c.histScale = params_.histogramBins / params_.histogramMaxMagnitude;
+    c.histMaxBin = static_cast<vx_float32>(params_.histogramBins - 1);
+    c.invStep = 1.0f / params_.dominantStep;
+
+    const vx_int32 half = cellsPerAxis_ / 2;
+    const vx_size cellsPerRegion = cellsPerAxis_ * cellsPerAxis_;
+
+    vx_uint32* hist = &partialHistograms_[regionRow * params_.histogramBins];
+    vx_uint8* mask = &changeMask_[row * fieldWidth_];
+
+    for (vx_uint32 rx = 0; rx < params_.regionsX; ++rx)
+    {
+        vx_uint32 regionIdx = regionRow * params_.regionsX + rx;
+        Cell* cells = &cells_[regionIdx * cellsPerRegion];
+        Accumulator& acc = accumulators_[regionIdx];
+
+        auto vote = [&](vx_uint32 x, vx_float32 dx, vx_float32 dy, vx_int32 bin, vx_int32 qx, vx_int32 qy, bool moving)
+        {
+            ++hist[bin];
+            mask[x] = moving ? 255 : 0;
+            acc.moving += moving ? 1 : 0;
+
+            if (qx >= -half && qx <= half && qy >= -half && qy <= half)
+            {
+                Cell& cell = cells[(qy + half) * cellsPerAxis_ + (qx + half)];
+                ++cell.count;
+                cell.sumX += dx;
+                cell.sumY += dy;
+            }
+        };
+
+        vx_uint32 x = regionStartX_[rx];
+        const vx_uint32 end = regionStartX_[rx + 1];
+
+        vx_float32 sumX = 0.0f, sumY = 0.0f;
+
+#if defined(NVX_HOST_SSE2)
+        // 4 vectors per iteration: deinterleave, then magnitudes, bins and quantized vectors at once
+        __m128 vSumX = _mm_setzero_ps(), vSumY = _mm_setzero_ps();
+        const __m128 vThreshold2 = _mm_set1_ps(c.threshold2);
+        const __m128 vHistScale = _mm_set1_ps(c.histScale);
+        const __m128 vHistMaxBin = _mm_set1_ps(c.histMaxBin);
+        const __m128 vInvStep = _mm_set1_ps(c.invStep);
+
+        alignas(16) vx_int32 bins[4], qxs[4], qys[4];
+        alignas(16) vx_float32 dxs[4], dys[4];
+
+        for (; x + 4 <= end; x += 4)
+        {
+            __m128 a = _mm_loadu_ps(src + 2 * x);
+            __m128 b = _mm_loadu_ps(src + 2 * x + 4);
+            __m128 dx = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 dy = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+            vSumX = _mm_add_ps(vSumX, dx);
+            vSumY = _mm_add_ps(vSumY, dy);
+
+            __m128 mag2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            int moving = _mm_movemask_ps(_mm_cmpgt_ps(mag2, vThreshold2));
+
+            _mm_store_si128((__m128i*)bins, _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(_mm_sqrt_ps(mag2), vHistScale), vHistMaxBin)));
+            _mm_store_si128((__m128i*)qxs, _mm_cvtps_epi32(_mm_mul_ps(dx, vInvStep)));
+            _mm_store_si128((__m128i*)qys, _mm_cvtps_epi32(_mm_mul_ps(dy, vInvStep)));
+            _mm_store_ps(dxs, dx);
+            _mm_store_ps(dys, dy);
+
+            for (vx_int32 i = 0; i < 4; ++i)
+                vote(x + i, dxs[i], dys[i], bins[i], qxs[i], qys[i], (moving >> i) & 1);
+        }
+
+        alignas(16) vx_float32 partial[4];
+        _mm_store_ps(partial, vSumX);
+        sumX = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+        _mm_store_ps(partial, vSumY);
+        sumY = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+#elif defined(NVX_HOST_NEON) && defined(__aarch64__)
+        float32x4_t vSumX = vdupq_n_f32(0.0f), vSumY = vdupq_n_f32(0.0f);
+        const float32x4_t vThreshold2 = vdupq_n_f32(c.threshold2);
+        const float32x4_t vHistScale = vdupq_n_f32(c.histScale);
+        const float32x4_t vHistMaxBin = vdupq_n_f32(c.histMaxBin);
+        const float32x4_t vInvStep = vdupq_n_f32(c.invStep);
+
+        vx_int32 bins[4], qxs[4], qys[4];
+        vx_uint32 moving[4];
+        vx_float32 dxs[4], dys[4];
+
+        for (; x + 4 <= end; x += 4)
+        {
+            float32x4x2_t v = vld2q_f32(src + 2 * x);
+
+            vSumX = vaddq_f32(vSumX, v.val[0]);
+            vSumY = vaddq_f32(vSumY, v.val[1]);
+
+            float32x4_t mag2 = vmlaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]);
+            vst1q_u32(moving, vcgtq_f32(mag2, vThreshold2));
+
+            vst1q_s32(bins, vcvtq_s32_f32(vminq_f32(vmulq_f32(vsqrtq_f32(mag2), vHistScale), vHistMaxBin)));
+            vst1q_s32(qxs, vcvtnq_s32_f32(vmulq_f32(v.val[0], vInvStep)));
+            vst1q_s32(qys, vcvtnq_s32_f32(vmulq_f32(v.val[1], vInvStep)));
+            vst1q_f32(dxs, v.val[0]);
+            vst1q_f32(dys, v.val[1]);
+
+            for (vx_int32 i = 0; i < 4; ++i)
+                vote(x + i, dxs[i], dys[i], bins[i], qxs[i], qys[i], moving[i] != 0);
+        }
+
+        sumX = vaddvq_f32(vSumX);
+        sumY = vaddvq_f32(vSumY);
+#endif
+
+        for (; x < end; ++x)
+        {
+            vx_float32 dx = src[2 * x], dy = src[2 * x + 1];
+
+            vx_int32 bin, qx, qy;
+            bool moving;
+            classify(c, dx, dy, bin, qx, qy, moving);
+
+            sumX += dx;
+            sumY += dy;
+
+            vote(x, dx, dy, bin, qx, qy, moving);
+        }
+
+        acc.sumX += sumX;
+        acc.sumY += sumY;
+    }
+}
+
+void MotionFieldAnalyzer::finishRegion(RegionStats& stats, const Accumulator& acc, const Cell* cells) const
+{
+    vx_uint32 count = stats.width * stats.height;
+
+    stats.meanX = static_cast<vx_float32>(acc.sumX / count);
+    stats.meanY = static_cast<vx_float32>(acc.sumY / count);
+    stats.movingFraction = static_cast<vx_float32>(acc.moving) / count;
+
+    const Cell* best = std::max_element(cells, cells + cellsPerAxis_ * cellsPerAxis_,
+                                        [](const Cell& a, const Cell& b) { return a.count < b.count; });
+
+    stats.dominantSupport = best->count;
+    if (best->count > 0)
+    {
+        stats.dominantX = best->sumX / best->count;
+        stats.dominantY = best->sumY / best->count;
+    }
+    else
+    {
+        // Every vector is out of the dominant search range
+        stats.dominantX = stats.meanX;
+        stats.dominantY = stats.meanY;
+    }
+}
+
+const std::vector<MotionFieldAnalyzer::RegionStats>& MotionFieldAnalyzer::getRegions() const
+{
+    return regions_;
+}
+
+const MotionFieldAnalyzer::RegionStats& MotionFieldAnalyzer::getGlobal() const
+{
+    return global_;
+}
+
+const std::vector<vx_uint32>& MotionFieldAnalyzer::getMagnitudeHistogram() const
+{
+    return histogram_;
+}
+
+const std::vector<vx_uint8>& MotionFieldAnalyzer::getChangeMask() const
+{
+    return changeMask_;
+}
+
+vx_uint32 MotionFieldAnalyzer::getFieldWidth() const
+{
+    return fieldWidth_;
+}
+
+vx_uint32 MotionFieldAnalyzer::getFieldHeight() const
+{
+    return fieldHeight_;
+}
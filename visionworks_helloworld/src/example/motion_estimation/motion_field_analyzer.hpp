@@ -0,0 +1,107 @@
+#ifndef MOTION_FIELD_ANALYZER_HPP
+#define MOTION_FIELD_ANALYZER_HPP
+
+#include <vector>
+#include <VX/vx.h>
+
+//
+// Statistics of a motion field (NVX_DF_IMAGE_2F32, as returned by IterativeMotionEstimator::getMotionField).
+// Everything is computed in one pass over the field: per-region dominant and mean motion,
+// the magnitude histogram and the change mask of moving vectors.
+//
+class MotionFieldAnalyzer
+{
+public:
+    struct Params
+    {
+        // The field is split into regionsX x regionsY regions of (almost) equal size
+        vx_uint32 regionsX;
+        vx_uint32 regionsY;
+        // Vectors longer than that (in pixels) are marked as moving in the change mask
+        vx_float32 motionThreshold;
+        // Magnitude histogram covers [0, histogramMaxMagnitude), longer vectors go to the last bin
+        vx_uint32 histogramBins;
+        vx_float32 histogramMaxMagnitude;
+        // Dominant motion is searched among vectors with |dx|, |dy| <= dominantRange,
+        // quantized to dominantStep pixels
+        vx_float32 dominantRange;
+        vx_float32 dominantStep;
+
+        Params();
+    };
+
+    struct RegionStats
+    {
+        // Position and size of the region in motion field vectors
+        vx_uint32 x, y, width, height;
+        // Most frequent motion: mean of the vectors that fall into the most populated quantization cell
+        vx_float32 dominantX, dominantY;
+        // Number of vectors in that cell
+        vx_uint32 dominantSupport;
+        vx_float32 meanX, meanY;
+        // Share of the vectors marked in the change mask
+        vx_float32 movingFraction;
+    };
+
+    MotionFieldAnalyzer();
+
+    void init(vx_uint32 fieldWidth, vx_uint32 fieldHeight, const Params& params = Params());
+
+    // Maps the whole field once and updates all statistics
+    void analyze(vx_image motionField);
+    // Same for a field in host memory: 'stride' is the distance between rows in bytes
+    void analyze(const vx_float32* field, vx_size stride);
+
+    // Regions in row-major order
+    const std::vector<RegionStats>& getRegions() const;
+    // Statistics of the whole field
+    const RegionStats& getGlobal() const;
+
+    const std::vector<vx_uint32>& getMagnitudeHistogram() const;
+
+    // One byte per vector: 255 for moving vectors, 0 for the others
+    const std::vector<vx_uint8>& getChangeMask() const;
+
+    vx_uint32 getFieldWidth() const;
+    vx_uint32 getFieldHeight() const;
+
+private:
+    // Vote of the dominant motion search: count and sum of the vectors of one quantization cell
+    struct Cell
+    {
+        vx_uint32 count;
+        vx_float32 sumX, sumY;
+    };
+
+    struct Accumulator
+    {
+        vx_float64 sumX, sumY;
+        vx_uint32 moving;
+    };
+
+    void analyzeRow(vx_uint32 regionRow, vx_uint32 row, const vx_float32* src);
+    void finishRegion(RegionStats& stats, const Accumulator& acc, const Cell* cells) const;
+
+    Params params_;
+
+    vx_uint32 fieldWidth_;
+    vx_uint32 fieldHeight_;
+
+    // Column where every region column starts, plus the field width
+    std::vector<vx_uint32> regionStartX_;
+    std::vector<vx_uint32> regionStartY_;
+
+    vx_int32 cellsPerAxis_;
+    std::vector<Cell> cells_;
+    std::vector<Cell> globalCells_;
+    std::vector<Accumulator> accumulators_;
+
+    std::vector<RegionStats> regions_;
+    RegionStats global_;
+    std::vector<vx_uint32> histogram_;
+    // Partial histograms of the rows of regions, which are analyzed in parallel
+    std::vector<vx_uint32> partialHistograms_;
+    std::vector<vx_uint8> changeMask_;
+};
+
+#endif
@@ -0,0 +1,386 @@
+#include "motion_field_recorder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "NVXIO/Utility.hpp"
+
+namespace
+{
+    const char MAGIC[4] = {'N', 'V', 'M', 'F'};
+    const vx_uint16 VERSION = 1;
+
+    const vx_uint8 KEY_FRAME = 0;
+    const vx_uint8 DELTA_FRAME = 1;
+
+    // Quantized values are kept far from the vx_int32 limits, so deltas never overflow
+    const vx_float32 MAX_QUANTIZED = static_cast<vx_float32>(1 << 24);
+
+    //
+    // Little-endian serialization
+    //
+
+    void putU32(std::vector<vx_uint8>& buf, vx_uint32 v)
+    {
+        for (vx_int32 i = 0; i < 4; ++i)
+            buf.push_back(static_cast<vx_uint8>(v >> (8 * i)));
+    }
+
+    vx_uint32 getU32(const vx_uint8* p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<vx_uint32>(p[3]) << 24);
+    }
+
+    void putVarint(std::vector<vx_uint8>& buf, vx_uint32 v)
+    {
+        while (v >= 0x80)
+        {
+            buf.push_back(static_cast<vx_uint8>(v | 0x80));
+            v >>= 7;
+        }
+        buf.push_back(static_cast<vx_uint8>(v));
+    }
+
+    bool getVarint(const vx_uint8*& p, const vx_uint8* end, vx_uint32& v)
+    {
+        v = 0;
+        for (vx_int32 shift = 0; shift < 35 && p < end; shift += 7)
+        {
+            vx_uint8 byte = *p++;
+            v |= static_cast<vx_uint32>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    inline vx_uint32 zigzag(vx_int32 v)
+    {
+        return (static_cast<vx_uint32>(v) << 1) ^ static_cast<vx_uint32>(v >> 31);
+    }
+
+    inline vx_int32 unzigzag(vx_uint32 v)
+    {
+        return static_cast<vx_int32>(v >> 1) ^ -static_cast<vx_int32>(v & 1);
+    }
+
+    //
+    // Run-length coding
+    //
+
+    void encode(const vx_int32* values, vx_size count, std::vector<vx_uint8>& out)
+    {
+        vx_size i = 0;
+        while (i < count)
+        {
+            vx_size run = i;
+            while (run < count && values[run] == 0)
+                ++run;
+
+            // Single zeros between literals are cheaper as literals
+            if (run - i >= 2 || run == count)
+            {
+                putVarint(out, static_cast<vx_uint32>(run - i) << 1);
+                i = run;
+                continue;
+            }
+
+            vx_size last = i;
+            while (last < count && !(values[last] == 0 && last + 1 < count && values[last + 1] == 0))
+                ++last;
+
+            putVarint(out, (static_cast<vx_uint32>(last - i) << 1) | 1);
+            for (; i < last; ++i)
+                putVarint(out, zigzag(values[i]));
+        }
+    }
+
+    bool decode(const vx_uint8* p, const vx_uint8* end, vx_int32* values, vx_size count)
+    {
+        vx_size i = 0;
+        while (i < count)
+        {
+            vx_uint32 token;
+            if (!getVarint(p, end, token))
+                return false;
+
+            vx_size n = token >> 1;
+            if (n == 0 || n > count - i)
+                return false;
+
+            if (token & 1)
+            {
+                for (vx_size k = 0; k < n; ++k)
+                {
+                    vx_uint32 v;
+                    if (!getVarint(p, end, v))
+                        return false;
+                    values[i++] = unzigzag(v);
+                }
+            }
+            else
+            {
+                std::fill(values + i, values + i + n, 0);
+                i += n;
+            }
+        }
+        return p == end;
+    }
+}
+
+//
+// MotionFieldRecorder
+//
+
+MotionFieldRecorder::MotionFieldRecorder()
+{
+    file_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+    step_ = 1.0f;
+    keyFrameInterval_ = 1;
+    numFrames_ = 0;
+    numBytes_ = 0;
+}
+
+MotionFieldRecorder::~MotionFieldRecorder()
+{
+    close();
+}
+
+bool MotionFieldRecorder::open(const std::string& path, vx_uint32 width, vx_uint32 height,
+                               vx_float32 step, vx_uint32 keyFrameInterval)
+{
+    NVXIO_ASSERT(width > 0 && height > 0);
+    NVXIO_ASSERT(step > 0.0f && keyFrameInterval > 0);
+
+    close();
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+        return false;
+
+    width_ = width;
+    height_ = height;
+    step_ = step;
+    keyFrameInterval_ = keyFrameInterval;
+    numFrames_ = 0;
+
+    std::vector<vx_uint8> header(MAGIC, MAGIC + 4);
+    putU32(header, VERSION);
+    putU32(header, width_);
+    putU32(header, height_);
+    vx_uint32 stepBits;
+    std::memcpy(&stepBits, &step_, sizeof(stepBits));
+    putU32(header, stepBits);
+    putU32(header, keyFrameInterval_);
+
+    numBytes_ = std::fwrite(header.data(), 1, header.size(), file_);
+    if (numBytes_ != header.size())
+    {
+        close();
+        return false;
+    }
+
+    prev_.assign(width_ * height_ * 2, 0);
+    values_.resize(width_ * height_ * 2);
+
+    return true;
+}
+
+void MotionFieldRecorder::close()
+{
+    if (file_)
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool MotionFieldRecorder::isOpened() const
+{
+    return file_ != nullptr;
+}
+
+bool MotionFieldRecorder::write(vx_image motionField)
+{
+    vx_rectangle_t rect = {
+        0u, 0u,
+        width_, height_
+    };
+
+    vx_map_id map_id;
+    vx_imagepatch_addressing_t addr;
+    void* ptr = nullptr;
+    NVXIO_SAFE_CALL( vxMapImagePatch(motionField, &rect, 0, &map_id, &addr, &ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+
+    bool ok = write(static_cast<const vx_float32*>(ptr), addr.stride_y);
+
+    NVXIO_SAFE_CALL( vxUnmapImagePatch(motionField, map_id) );
+
+    return ok;
+}
+
+bool MotionFieldRecorder::write(const vx_float32* field, vx_size stride)
+{
+    if (!file_)
+        return false;
+
+    bool keyFrame = numFrames_ % keyFrameInterval_ == 0;
+    vx_float32 invStep = 1.0f / step_;
+
+    // Quantize and subtract the previous frame in place
+
+    for (vx_uint32 y = 0; y < height_; ++y)
+    {
+        const vx_float32* src = reinterpret_cast<const vx_float32*>(reinterpret_cast<const vx_uint8*>(field) + y * stride);
+        vx_int32* dst = &values_[y * width_ * 2];
+        vx_int32* prev = &prev_[y * width_ * 2];
+
+        for (vx_uint32 i = 0; i < width_ * 2; ++i)
+        {
+            vx_float32 q = std::min(std::max(src[i] * invStep, -MAX_QUANTIZED), MAX_QUANTIZED);
+            vx_int32 v = static_cast<vx_int32>(std::lrint(q));
+            dst[i] = keyFrame ? v : v - prev[i];
+            prev[i] = v;
+        }
+    }
+
+    payload_.clear();
+    encode(values_.data(), values_.size(), payload_);
+
+    std::vector<vx_uint8> frameHeader(1, keyFrame ? KEY_FRAME : DELTA_FRAME);
+    putU32(frameHeader, static_cast<vx_uint32>(payload_.size()));
+
+    if (std::fwrite(frameHeader.data(), 1, frameHeader.size(), file_) != frameHeader.size() ||
+        std::fwrite(payload_.data(), 1, payload_.size(), file_) != payload_.size())
+    {
+        return false;
+    }
+
+    numBytes_ += frameHeader.size() + payload_.size();
+    ++numFrames_;
+
+    return true;
+}
+
+vx_uint32 MotionFieldRecorder::getNumFrames() const
+{
+    return numFrames_;
+}
+
+vx_uint64 MotionFieldRecorder::getNumBytes() const
+{
+    return numBytes_;
+}
+
+//
+// MotionFieldPlayer
+//
+
+MotionFieldPlayer::MotionFieldPlayer()
+{
+    file_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+    step_ = 1.0f;
+    hasKeyFrame_ = false;
+}
+
+MotionFieldPlayer::~MotionFieldPlayer()
+{
+    close();
+}
+
+bool MotionFieldPlayer::open(const std::string& path)
+{
+    close();
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_)
+        return false;
+
+    vx_uint8 header[24];
+    if (std::fread(header, 1, sizeof(header), file_) != sizeof(header) ||
+        std::memcmp(header, MAGIC, 4) != 0 || getU32(header + 4) != VERSION)
+    {
+        close();
+        return false;
+    }
+
+    width_ = getU32(header + 8);
+    height_ = getU32(header + 12);
+    vx_uint32 stepBits = getU32(header + 16);
+    std::memcpy(&step_, &stepBits, sizeof(step_));
+
+    if (width_ == 0 || height_ == 0 || !(step_ > 0.0f))
+    {
+        close();
+        return false;
+    }
+
+    hasKeyFrame_ = false;
+    values_.assign(width_ * height_ * 2, 0);
+    decoded_.resize(values_.size());
+
+    return true;
+}
+
+void MotionFieldPlayer::close()
+{
+    if (file_)
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool MotionFieldPlayer::isOpened() const
+{
+    return file_ != nullptr;
+}
+
+vx_uint32 MotionFieldPlayer::getWidth() const
+{
+    return width_;
+}
+
+vx_uint32 MotionFieldPlayer::getHeight() const
+{
+    return height_;
+}
+
+bool MotionFieldPlayer::read(std::vector<vx_float32>& field)
+{
+    if (!file_)
+        return false;
+
+    vx_uint8 frameHeader[5];
+    if (std::fread(frameHeader, 1, sizeof(frameHeader), file_) != sizeof(frameHeader))
+        return false;
+
+    vx_uint8 type = frameHeader[0];
+    vx_uint32 size = getU32(frameHeader + 1);
+
+    if (type != KEY_FRAME && (type != DELTA_FRAME || !hasKeyFrame_))
+        return false;
+
+    payload_.resize(size);
+    if (std::fread(payload_.data(), 1, size, file_) != size)
+        return false;
+
+    if (!decode(payload_.data(), payload_.data() + size, decoded_.data(), decoded_.size()))
+        return false;
+
+    for (vx_size i = 0; i < values_.size(); ++i)
+        values_[i] = type == KEY_FRAME ? decoded_[i] : values_[i] + decoded_[i];
+
+    hasKeyFrame_ = true;
+
+    field.resize(values_.size());
+    for (vx_size i = 0; i < values_.size(); ++i)
+        field[i] = values_[i] * step_;
+
+    return true;
+}
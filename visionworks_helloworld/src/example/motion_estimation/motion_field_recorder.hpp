@@ -0,0 +1,98 @@
+#ifndef MOTION_FIELD_RECORDER_HPP
+#define MOTION_FIELD_RECORDER_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <VX/vx.h>
+
+//
+// Compressed recording of motion fields.
+//
+// File layout (all numbers are little-endian):
+//   header:  "NVMF", u16 version, u16 reserved, u32 width, u32 height, f32 step, u32 keyFrameInterval
+//   frame:   u8 type (0 - key frame, 1 - delta frame), u32 payload size, payload
+//
+// Vectors are quantized to 'step' pixels. A key frame stores the quantized (dx, dy) values,
+// a delta frame stores their differences from the previous frame. The values are then
+// run-length coded: a varint token (n << 1) is a run of n zeros, (n << 1) | 1 is followed by
+// n literal values as zigzag varints. Static scenes and steady camera motion collapse to a
+// few bytes per frame.
+//
+class MotionFieldRecorder
+{
+public:
+    MotionFieldRecorder();
+    ~MotionFieldRecorder();
+
+    // 'step' is the quantization step in pixels, every 'keyFrameInterval'-th frame is a key frame
+    bool open(const std::string& path, vx_uint32 width, vx_uint32 height,
+              vx_float32 step = 1.0f / 16.0f, vx_uint32 keyFrameInterval = 30);
+    void close();
+
+    bool isOpened() const;
+
+    // Motion field of NVX_DF_IMAGE_2F32 format with the size passed to open()
+    bool write(vx_image motionField);
+    // Same for a field in host memory: 'stride' is the distance between rows in bytes
+    bool write(const vx_float32* field, vx_size stride);
+
+    vx_uint32 getNumFrames() const;
+    // Bytes written so far, including the header
+    vx_uint64 getNumBytes() const;
+
+private:
+    MotionFieldRecorder(const MotionFieldRecorder&) = delete;
+    MotionFieldRecorder& operator=(const MotionFieldRecorder&) = delete;
+
+    FILE* file_;
+    vx_uint32 width_;
+    vx_uint32 height_;
+    vx_float32 step_;
+    vx_uint32 keyFrameInterval_;
+
+    vx_uint32 numFrames_;
+    vx_uint64 numBytes_;
+
+    std::vector<vx_int32> prev_;
+    std::vector<vx_int32> values_;
+    std::vector<vx_uint8> payload_;
+};
+
+//
+// Reads files written by MotionFieldRecorder
+//
+class MotionFieldPlayer
+{
+public:
+    MotionFieldPlayer();
+    ~MotionFieldPlayer();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpened() const;
+
+    vx_uint32 getWidth() const;
+    vx_uint32 getHeight() const;
+
+    // Decodes the next frame into packed (dx, dy) pairs, width * height vectors.
+    // Returns false at the end of the file or if the file is corrupted.
+    bool read(std::vector<vx_float32>& field);
+
+private:
+    MotionFieldPlayer(const MotionFieldPlayer&) = delete;
+    MotionFieldPlayer& operator=(const MotionFieldPlayer&) = delete;
+
+    FILE* file_;
+    vx_uint32 width_;
+    vx_uint32 height_;
+    vx_float32 step_;
+
+    bool hasKeyFrame_;
+    std::vector<vx_int32> values_;
+    std::vector<vx_int32> decoded_;
+    std::vector<vx_uint8> payload_;
+};
+
+#endif
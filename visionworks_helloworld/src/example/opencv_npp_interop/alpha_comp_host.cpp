@@ -0,0 +1,311 @@
+#include "alpha_comp_host.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "../common/host_simd.hpp"
+#include "../common/parallel_for.hpp"
+
+bool isValidAlphaCompOp(vx_enum op)
+{
+    return op >= ALPHA_COMP_OVER && op <= ALPHA_COMP_PREMUL;
+}
+
+AlphaCompWeights getAlphaCompWeights(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2)
+{
+    const vx_uint32 a1 = alpha1, a2 = alpha2;
+    const vx_uint32 na1 = 255 - a1, na2 = 255 - a2;
+
+    AlphaCompWeights w = { 0, 0 };
+
+    switch (op)
+    {
+    case ALPHA_COMP_OVER:
+        w.w1 = alpha1;
+        w.w2 = alphaCompDiv255(na1 * a2);
+        break;
+    case ALPHA_COMP_IN:
+        w.w1 = alphaCompDiv255(a1 * a2);
+        break;
+    case ALPHA_COMP_OUT:
+        w.w1 = alphaCompDiv255(a1 * na2);
+        break;
+    case ALPHA_COMP_ATOP:
+        w.w1 = alphaCompDiv255(a1 * a2);
+        w.w2 = alphaCompDiv255(na1 * a2);
+        break;
+    case ALPHA_COMP_XOR:
+        w.w1 = alphaCompDiv255(a1 * na2);
+        w.w2 = alphaCompDiv255(na1 * a2);
+        break;
+    case ALPHA_COMP_PLUS:
+        w.w1 = alpha1;
+        w.w2 = alpha2;
+        break;
+
+    // Premultiplied pixels already hold their own alpha
+
+    case ALPHA_COMP_OVER_PREMUL:
+        w.w1 = 255;
+        w.w2 = static_cast<vx_uint8>(na1);
+        break;
+    case ALPHA_COMP_IN_PREMUL:
+        w.w1 = alpha2;
+        break;
+    case ALPHA_COMP_OUT_PREMUL:
+        w.w1 = static_cast<vx_uint8>(na2);
+        break;
+    case ALPHA_COMP_ATOP_PREMUL:
+        w.w1 = alpha2;
+        w.w2 = static_cast<vx_uint8>(na1);
+        break;
+    case ALPHA_COMP_XOR_PREMUL:
+        w.w1 = static_cast<vx_uint8>(na2);
+        w.w2 = static_cast<vx_uint8>(na1);
+        break;
+    case ALPHA_COMP_PLUS_PREMUL:
+        w.w1 = 255;
+        w.w2 = 255;
+        break;
+    case ALPHA_COMP_PREMUL:
+        w.w1 = alpha1;
+        break;
+    }
+
+    return w;
+}
+
+void alphaCompRow(const vx_uint8* src1, const vx_uint8* src2, vx_uint8* dst,
+                  vx_uint32 width, AlphaCompWeights weights)
+{
+    vx_uint32 x = 0;
+
+    // The 16-bit sums saturate at 65535, which is above 255 * 255, so the saturated
+    // pixels stay saturated. round(x / 255) is ((x + 128) * 257) >> 16 up to 65535.
+
+#if defined(NVX_HOST_AVX2)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i w1 = _mm256_set1_epi16(weights.w1);
+        const __m256i w2 = _mm256_set1_epi16(weights.w2);
+        const __m256i half = _mm256_set1_epi16(128);
+        const __m256i mul = _mm256_set1_epi16(257);
+
+        for (; x + 32 <= width; x += 32)
+        {
+            __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + x));
+            __m256i p2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + x));
+
+            // unpack and pack both work within 128-bit lanes, so the order is kept
+            __m256i lo = _mm256_adds_epu16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(p1, zero), w1),
+                                           _mm256_mullo_epi16(_mm256_unpacklo_epi8(p2, zero), w2));
+            __m256i hi = _mm256_adds_epu16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(p1, zero), w1),
+                                           _mm256_mullo_epi16(_mm256_unpackhi_epi8(p2, zero), w2));
+
+            lo = _mm256_mulhi_epu16(_mm256_adds_epu16(lo, half), mul);
+            hi = _mm256_mulhi_epu16(_mm256_adds_epu16(hi, half), mul);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_packus_epi16(lo, hi));
+        }
+    }
+#elif defined(NVX_HOST_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i w1 = _mm_set1_epi16(weights.w1);
+        const __m128i w2 = _mm_set1_epi16(weights.w2);
+        const __m128i half = _mm_set1_epi16(128);
+        const __m128i mul = _mm_set1_epi16(257);
+
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + x));
+            __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + x));
+
+            __m128i lo = _mm_adds_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(p1, zero), w1),
+                                        _mm_mullo_epi16(_mm_unpacklo_epi8(p2, zero), w2));
+            __m128i hi = _mm_adds_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(p1, zero), w1),
+                                        _mm_mullo_epi16(_mm_unpackhi_epi8(p2, zero), w2));
+
+            lo = _mm_mulhi_epu16(_mm_adds_epu16(lo, half), mul);
+            hi = _mm_mulhi_epu16(_mm_adds_epu16(hi, half), mul);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+        }
+    }
+#elif defined(NVX_HOST_NEON)
+    {
+        const uint8x8_t w1 = vdup_n_u8(weights.w1);
+        const uint8x8_t w2 = vdup_n_u8(weights.w2);
+        const uint16x8_t maxSum = vdupq_n_u16(255 * 255);
+
+        for (; x + 16 <= width; x += 16)
+        {
+            uint8x16_t p1 = vld1q_u8(src1 + x);
+            uint8x16_t p2 = vld1q_u8(src2 + x);
+
+            // Clamped to 255 * 255 so the rounding below can't overflow
+            uint16x8_t lo = vminq_u16(vqaddq_u16(vmull_u8(vget_low_u8(p1), w1), vmull_u8(vget_low_u8(p2), w2)), maxSum);
+            uint16x8_t hi = vminq_u16(vqaddq_u16(vmull_u8(vget_high_u8(p1), w1), vmull_u8(vget_high_u8(p2), w2)), maxSum);
+
+            // (x + ((x + 128) >> 8) + 128) >> 8
+            uint8x8_t rlo = vraddhn_u16(lo, vrshrq_n_u16(lo, 8));
+            uint8x8_t rhi = vraddhn_u16(hi, vrshrq_n_u16(hi, 8));
+
+            vst1q_u8(dst + x, vcombine_u8(rlo, rhi));
+        }
+    }
+#endif
+
+    for (; x < width; ++x)
+        dst[x] = alphaCompDiv255(static_cast<vx_uint32>(weights.w1) * src1[x] + static_cast<vx_uint32>(weights.w2) * src2[x]);
+}
+
+namespace
+{
+    // 1 2 1 of a row, replicated border. Sums are at most 4 * 255.
+    void blurRowH(const vx_uint8* src, vx_uint16* dst, vx_int32 width)
+    {
+        if (width == 1)
+        {
+            dst[0] = static_cast<vx_uint16>(src[0] * 4);
+            return;
+        }
+
+        dst[0] = static_cast<vx_uint16>(src[0] * 3 + src[1]);
+
+        vx_int32 x = 1;
+
+#if defined(NVX_HOST_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; x + 16 <= width - 1; x += 16)
+        {
+            __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x - 1));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+            __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 1));
+
+            __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(l, zero), _mm_unpacklo_epi8(r, zero)),
+                                       _mm_slli_epi16(_mm_unpacklo_epi8(c, zero), 1));
+            __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(l, zero), _mm_unpackhi_epi8(r, zero)),
+                                       _mm_slli_epi16(_mm_unpackhi_epi8(c, zero), 1));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 8), hi);
+        }
+#elif defined(NVX_HOST_NEON)
+        for (; x + 16 <= width - 1; x += 16)
+        {
+            uint8x16_t l = vld1q_u8(src + x - 1);
+            uint8x16_t c = vld1q_u8(src + x);
+            uint8x16_t r = vld1q_u8(src + x + 1);
+
+            uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(l), vget_low_u8(r)), vshll_n_u8(vget_low_u8(c), 1));
+            uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(l), vget_high_u8(r)), vshll_n_u8(vget_high_u8(c), 1));
+
+            vst1q_u16(dst + x, lo);
+            vst1q_u16(dst + x + 8, hi);
+        }
+#endif
+
+        for (; x < width - 1; ++x)
+            dst[x] = static_cast<vx_uint16>(src[x - 1] + 2 * src[x] + src[x + 1]);
+
+        dst[width - 1] = static_cast<vx_uint16>(src[width - 2] + src[width - 1] * 3);
+    }
+
+    // 1 2 1 of three horizontally blurred rows, divided by 16
+    void blurRowV(const vx_uint16* r0, const vx_uint16* r1, const vx_uint16* r2, vx_uint8* dst, vx_int32 width)
+    {
+        vx_int32 x = 0;
+
+#if defined(NVX_HOST_SSE2)
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + x)),
+                                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(r2 + x))),
+                                       _mm_slli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + x)), 1));
+            __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + x + 8)),
+                                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(r2 + x + 8))),
+                                       _mm_slli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + x + 8)), 1));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                             _mm_packus_epi16(_mm_srli_epi16(lo, 4), _mm_srli_epi16(hi, 4)));
+        }
+#elif defined(NVX_HOST_NEON)
+        for (; x + 16 <= width; x += 16)
+        {
+            uint16x8_t lo = vaddq_u16(vaddq_u16(vld1q_u16(r0 + x), vld1q_u16(r2 + x)), vshlq_n_u16(vld1q_u16(r1 + x), 1));
+            uint16x8_t hi = vaddq_u16(vaddq_u16(vld1q_u16(r0 + x + 8), vld1q_u16(r2 + x + 8)), vshlq_n_u16(vld1q_u16(r1 + x + 8), 1));
+
+            vst1q_u8(dst + x, vcombine_u8(vshrn_n_u16(lo, 4), vshrn_n_u16(hi, 4)));
+        }
+#endif
+
+        for (; x < width; ++x)
+            dst[x] = static_cast<vx_uint8>((r0[x] + 2 * r1[x] + r2[x]) >> 4);
+    }
+}
+
+void alphaCompHost(const vx_uint8* src1, vx_size src1Stride, vx_uint8 alpha1,
+                   const vx_uint8* src2, vx_size src2Stride, vx_uint8 alpha2,
+                   vx_uint8* dst, vx_size dstStride,
+                   vx_uint32 width, vx_uint32 height, vx_enum op)
+{
+    const AlphaCompWeights weights = getAlphaCompWeights(op, alpha1, alpha2);
+
+    // About 64 KB of every image per range
+    vx_int32 grain = std::max(1, static_cast<vx_int32>((1 << 16) / std::max(1u, width)));
+
+    nvx::parallelFor(0, static_cast<vx_int32>(height), grain, [&](vx_int32 first, vx_int32 last)
+    {
+        for (vx_int32 y = first; y < last; ++y)
+        {
+            alphaCompRow(src1 + y * src1Stride, src2 + y * src2Stride, dst + y * dstStride,
+                         width, weights);
+        }
+    });
+}
+
+void blurAlphaCompHost(const vx_uint8* src1, vx_size src1Stride, vx_uint8 alpha1,
+                       const vx_uint8* src2, vx_size src2Stride, vx_uint8 alpha2,
+                       vx_uint8* dst, vx_size dstStride,
+                       vx_uint32 width, vx_uint32 height, vx_enum op)
+{
+    const AlphaCompWeights weights = getAlphaCompWeights(op, alpha1, alpha2);
+    const vx_int32 w = static_cast<vx_int32>(width);
+    const vx_int32 h = static_cast<vx_int32>(height);
+
+    // Bands of rows; every band blurs its two halo rows once more
+    vx_int32 grain = std::max(8, static_cast<vx_int32>((1 << 18) / std::max(1, w)));
+
+    nvx::parallelFor(0, h, grain, [&](vx_int32 first, vx_int32 last)
+    {
+        // Three horizontally blurred rows per source, used as a ring, and one vertically blurred row per source
+        std::vector<vx_uint16> lines(6 * w);
+        std::vector<vx_uint8> blurred(2 * w);
+
+        vx_uint16* ring1[3] = { &lines[0], &lines[w], &lines[2 * w] };
+        vx_uint16* ring2[3] = { &lines[3 * w], &lines[4 * w], &lines[5 * w] };
+
+        auto blurSourceRow = [&](vx_int32 y, vx_int32 slot)
+        {
+            vx_int32 sy = std::min(std::max(y, 0), h - 1);
+            blurRowH(src1 + sy * src1Stride, ring1[slot], w);
+            blurRowH(src2 + sy * src2Stride, ring2[slot], w);
+        };
+
+        blurSourceRow(first - 1, 0);
+        blurSourceRow(first, 1);
+
+        for (vx_int32 y = first; y < last; ++y)
+        {
+            vx_int32 prev = (y - first) % 3, cur = (y - first + 1) % 3, next = (y - first + 2) % 3;
+            blurSourceRow(y + 1, next);
+
+            blurRowV(ring1[prev], ring1[cur], ring1[next], &blurred[0], w);
+            blurRowV(ring2[prev], ring2[cur], ring2[next], &blurred[w], w);
+
+            alphaCompRow(&blurred[0], &blurred[w], dst + y * dstStride, width, weights);
+        }
+    });
+}
@@ -0,0 +1,66 @@
+#ifndef ALPHA_COMP_HOST_HPP
+#define ALPHA_COMP_HOST_HPP
+
+#include <VX/vx.h>
+
+//
+// Compositing operations of the AlphaComp node. The values are the ones of NppiAlphaOp,
+// so the NPP backend passes them through.
+//
+enum AlphaCompOp
+{
+    ALPHA_COMP_OVER,
+    ALPHA_COMP_IN,
+    ALPHA_COMP_OUT,
+    ALPHA_COMP_ATOP,
+    ALPHA_COMP_XOR,
+    ALPHA_COMP_PLUS,
+    ALPHA_COMP_OVER_PREMUL,
+    ALPHA_COMP_IN_PREMUL,
+    ALPHA_COMP_OUT_PREMUL,
+    ALPHA_COMP_ATOP_PREMUL,
+    ALPHA_COMP_XOR_PREMUL,
+    ALPHA_COMP_PLUS_PREMUL,
+    ALPHA_COMP_PREMUL
+};
+
+//
+// With constant alphas every operation is dst = w1 * src1 + w2 * src2 with 8-bit weights
+// (in 1/255), saturated to 255. The weights of the three-factor terms (e.g. alpha1 * alpha2)
+// are rounded to 8 bits first, then every pixel is rounded to nearest.
+//
+struct AlphaCompWeights
+{
+    vx_uint8 w1, w2;
+};
+
+bool isValidAlphaCompOp(vx_enum op);
+
+AlphaCompWeights getAlphaCompWeights(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2);
+
+// round(x / 255) saturated to 255, the rounding of every backend of the host implementation
+inline vx_uint8 alphaCompDiv255(vx_uint32 x)
+{
+    vx_uint32 r = (x + 127) / 255;
+    return static_cast<vx_uint8>(r > 255 ? 255 : r);
+}
+
+// One row, SIMD when available
+void alphaCompRow(const vx_uint8* src1, const vx_uint8* src2, vx_uint8* dst,
+                  vx_uint32 width, AlphaCompWeights weights);
+
+// Single-channel 8-bit images, strides in bytes; rows are processed in parallel
+void alphaCompHost(const vx_uint8* src1, vx_size src1Stride, vx_uint8 alpha1,
+                   const vx_uint8* src2, vx_size src2Stride, vx_uint8 alpha2,
+                   vx_uint8* dst, vx_size dstStride,
+                   vx_uint32 width, vx_uint32 height, vx_enum op);
+
+// Gaussian3x3 of both sources (replicated border, truncated like vxGaussian3x3Node) followed by
+// alphaCompHost, in one sweep: every band of rows keeps three horizontally blurred rows per source
+// and composes every output row as soon as it is blurred, so no blurred image is stored
+void blurAlphaCompHost(const vx_uint8* src1, vx_size src1Stride, vx_uint8 alpha1,
+                       const vx_uint8* src2, vx_size src2Stride, vx_uint8 alpha2,
+                       vx_uint8* dst, vx_size dstStride,
+                       vx_uint32 width, vx_uint32 height, vx_enum op);
+
+#endif
@@ -26,20 +26,35 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#if defined USE_OPENCV && defined USE_NPP
-
 #include "alpha_comp_node.hpp"
 
+#ifdef USE_NPP
+#include <cuda_runtime_api.h>
+#include <nppcore.h>
+#include <nppi.h>
+
+static_assert(ALPHA_COMP_OVER == static_cast<int>(NPPI_OP_ALPHA_OVER) &&
+              ALPHA_COMP_PLUS == static_cast<int>(NPPI_OP_ALPHA_PLUS) &&
+              ALPHA_COMP_PREMUL == static_cast<int>(NPPI_OP_ALPHA_PREMUL),
+              "AlphaCompOp must match NppiAlphaOp");
+#endif
+
 //
 // Define user kernel
 //
 
 #define KERNEL_ALPHA_COMP_NAME "example.nvx.alpha_comp"
 
+#ifdef USE_NPP
+#define KERNEL_ALPHA_COMP_TARGET "gpu:"
+#else
+#define KERNEL_ALPHA_COMP_TARGET "cpu:"
+#endif
+
 // Kernel implementation
 static vx_status VX_CALLBACK alphaComp_kernel(vx_node node, const vx_reference *parameters, vx_uint32 num)
 {
-    if (num != 6)
+    if (num != 7)
         return VX_FAILURE;
 
     vx_image src1 = (vx_image)parameters[0];
@@ -55,21 +70,28 @@ static vx_status VX_CALLBACK alphaComp_kernel(vx_node node, const vx_reference *
 
     vx_status status = VX_SUCCESS;
 
+    // Backend chosen at the graph verification (alphaComp_initialize)
+
+    vx_enum* backend = NULL;
+    vxQueryNode(node, VX_NODE_ATTRIBUTE_LOCAL_DATA_PTR, &backend, sizeof(backend));
+    if (backend == NULL)
+        return VX_FAILURE;
+
+    const vx_enum memoryType = *backend == ALPHA_COMP_BACKEND_NPP ? NVX_MEMORY_TYPE_CUDA : VX_MEMORY_TYPE_HOST;
+
     // Get scalars values
 
     vxCopyScalar(s_alpha1, &alpha1, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
     vxCopyScalar(s_alpha2, &alpha2, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
     vxCopyScalar(s_alphaOp, &alphaOp, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
 
-    // Get CUDA stream, which is used for current node
-
-    cudaStream_t stream = NULL;
-    vxQueryNode(node, NVX_NODE_CUDA_STREAM, &stream, sizeof(stream));
-
-    // Use this stream for NPP launch
-    nppSetStream(stream);
+    if (!isValidAlphaCompOp(alphaOp))
+    {
+        vxAddLogEntry((vx_reference)s_alphaOp, VX_ERROR_INVALID_VALUE, "[%s:%u] Unknown \'alphaOp\' in AlphaComp Kernel", __FUNCTION__, __LINE__);
+        return VX_ERROR_INVALID_VALUE;
+    }
 
-    // Map OpenVX data objects into CUDA device memory
+    // Map OpenVX data objects into the memory of the backend
 
     vx_rectangle_t rect = {};
     vxGetValidRegionImage(src1, &rect);
@@ -77,7 +99,7 @@ static vx_status VX_CALLBACK alphaComp_kernel(vx_node node, const vx_reference *
     vx_map_id src1_map_id;
     vx_uint8* src1_ptr;
     vx_imagepatch_addressing_t src1_addr;
-    status = vxMapImagePatch(src1, &rect, 0, &src1_map_id, &src1_addr, (void **)&src1_ptr, VX_READ_ONLY, NVX_MEMORY_TYPE_CUDA, 0);
+    status = vxMapImagePatch(src1, &rect, 0, &src1_map_id, &src1_addr, (void **)&src1_ptr, VX_READ_ONLY, memoryType, 0);
 
     if (status != VX_SUCCESS)
     {
@@ -88,7 +110,7 @@ static vx_status VX_CALLBACK alphaComp_kernel(vx_node node, const vx_reference *
     vx_map_id src2_map_id;
     vx_uint8* src2_ptr;
     vx_imagepatch_addressing_t src2_addr;
-    vxMapImagePatch(src2, &rect, 0, &src2_map_id, &src2_addr, (void **)&src2_ptr, VX_READ_ONLY, NVX_MEMORY_TYPE_CUDA, 0);
+    status = vxMapImagePatch(src2, &rect, 0, &src2_map_id, &src2_addr, (void **)&src2_ptr, VX_READ_ONLY, memoryType, 0);
 
     if (status != VX_SUCCESS)
     {
@@ -100,34 +122,54 @@ static vx_status VX_CALLBACK alphaComp_kernel(vx_node node, const vx_reference *
     vx_map_id dst_map_id;
     vx_uint8* dst_ptr;
     vx_imagepatch_addressing_t dst_addr;
-    status = vxMapImagePatch(dst, &rect, 0, &dst_map_id, &dst_addr, (void **)&dst_ptr, VX_WRITE_ONLY, NVX_MEMORY_TYPE_CUDA, 0);
+    status = vxMapImagePatch(dst, &rect, 0, &dst_map_id, &dst_addr, (void **)&dst_ptr, VX_WRITE_ONLY, memoryType, 0);
 
     if (status != VX_SUCCESS)
     {
-        vxAddLogEntry((vx_reference)src2, status, "[%s:%u] Failed to access \'dst\' in AlphaComp Kernel", __FUNCTION__, __LINE__);
+        vxAddLogEntry((vx_reference)dst, status, "[%s:%u] Failed to access \'dst\' in AlphaComp Kernel", __FUNCTION__, __LINE__);
         vxUnmapImagePatch(src1, src1_map_id);
         vxUnmapImagePatch(src2, src2_map_id);
         return status;
     }
 
-    // Call NPP function
+    if (*backend == ALPHA_COMP_BACKEND_HOST)
+    {
+        alphaCompHost(src1_ptr, src1_addr.stride_y, alpha1,
+                      src2_ptr, src2_addr.stride_y, alpha2,
+                      dst_ptr, dst_addr.stride_y,
+                      src1_addr.dim_x, src1_addr.dim_y, alphaOp);
+    }
+#ifdef USE_NPP
+    else
+    {
+        // Get CUDA stream, which is used for current node
 
-    NppiSize oSizeROI;
-    oSizeROI.width = src1_addr.dim_x;
-    oSizeROI.height = src1_addr.dim_y;
+        cudaStream_t stream = NULL;
+        vxQueryNode(node, NVX_NODE_CUDA_STREAM, &stream, sizeof(stream));
 
-    NppStatus npp_status = nppiAlphaCompC_8u_C1R(src1_ptr, src1_addr.stride_y, alpha1,
-                                                 src2_ptr, src2_addr.stride_y, alpha2,
-                                                 dst_ptr, dst_addr.stride_y,
-                                                 oSizeROI,
-                                                 static_cast<NppiAlphaOp>(alphaOp));
-    if (npp_status != NPP_SUCCESS)
-    {
-        vxAddLogEntry((vx_reference)node, VX_FAILURE, "[%s:%u] nppiAlphaCompC_8u_C1R error", __FUNCTION__, __LINE__);
-        status = VX_FAILURE;
+        // Use this stream for NPP launch
+        nppSetStream(stream);
+
+        // Call NPP function
+
+        NppiSize oSizeROI;
+        oSizeROI.width = src1_addr.dim_x;
+        oSizeROI.height = src1_addr.dim_y;
+
+        NppStatus npp_status = nppiAlphaCompC_8u_C1R(src1_ptr, src1_addr.stride_y, alpha1,
+                                                     src2_ptr, src2_addr.stride_y, alpha2,
+                                                     dst_ptr, dst_addr.stride_y,
+                                                     oSizeROI,
+                                                     static_cast<NppiAlphaOp>(alphaOp));
+        if (npp_status != NPP_SUCCESS)
+        {
+            vxAddLogEntry((vx_reference)node, VX_FAILURE, "[%s:%u] nppiAlphaCompC_8u_C1R error", __FUNCTION__, __LINE__);
+            status = VX_FAILURE;
+        }
     }
+#endif
 
-    // Unmap OpenVX data objects from CUDA device memory
+    // Unmap OpenVX data objects
 
     vxUnmapImagePatch(src1, src1_map_id);
     vxUnmapImagePatch(src2, src2_map_id);
@@ -140,13 +182,14 @@ static vx_status VX_CALLBACK alphaComp_kernel(vx_node node, const vx_reference *
 static vx_status VX_CALLBACK alphaComp_validate(vx_node, const vx_reference parameters[],
                                                 vx_uint32 num_params, vx_meta_format metas[])
 {
-    if (num_params != 6) return VX_ERROR_INVALID_PARAMETERS;
+    if (num_params != 7) return VX_ERROR_INVALID_PARAMETERS;
 
     vx_image src1 = (vx_image)parameters[0];
     vx_scalar alpha1 = (vx_scalar)parameters[1];
     vx_image src2 = (vx_image)parameters[2];
     vx_scalar alpha2 = (vx_scalar)parameters[3];
     vx_scalar alphaOp = (vx_scalar)parameters[5];
+    vx_scalar backend = (vx_scalar)parameters[6];
 
     vx_df_image src1_format = 0;
     vxQueryImage(src1, VX_IMAGE_ATTRIBUTE_FORMAT, &src1_format, sizeof(src1_format));
@@ -203,6 +246,18 @@ static vx_status VX_CALLBACK alphaComp_validate(vx_node, const vx_reference para
         vxAddLogEntry((vx_reference)alphaOp, status, "[%s:%u] Invalid format for \'alphaOp\' in AlphaComp Kernel, it should be VX_TYPE_ENUM", __FUNCTION__, __LINE__);
     }
 
+    if (backend)
+    {
+        vx_enum backend_type = 0;
+        vxQueryScalar(backend, VX_SCALAR_ATTRIBUTE_TYPE, &backend_type, sizeof(backend_type));
+
+        if (backend_type != VX_TYPE_ENUM)
+        {
+            status = VX_ERROR_INVALID_TYPE;
+            vxAddLogEntry((vx_reference)backend, status, "[%s:%u] Invalid format for \'backend\' in AlphaComp Kernel, it should be VX_TYPE_ENUM", __FUNCTION__, __LINE__);
+        }
+    }
+
     vx_meta_format dst_meta = metas[4];
 
     vxSetMetaFormatAttribute(dst_meta, VX_IMAGE_ATTRIBUTE_FORMAT, &src1_format, sizeof(src1_format));
@@ -212,6 +267,56 @@ static vx_status VX_CALLBACK alphaComp_validate(vx_node, const vx_reference para
     return status;
 }
 
+// Chooses the backend of the node once the parameters are validated
+static vx_status VX_CALLBACK alphaComp_initialize(vx_node node, const vx_reference parameters[], vx_uint32 num_params)
+{
+    if (num_params != 7) return VX_ERROR_INVALID_PARAMETERS;
+
+    vx_enum requested = ALPHA_COMP_BACKEND_AUTO;
+    if (parameters[6])
+        vxCopyScalar((vx_scalar)parameters[6], &requested, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+
+    bool haveNpp = false;
+#ifdef USE_NPP
+    int numDevices = 0;
+    haveNpp = cudaGetDeviceCount(&numDevices) == cudaSuccess && numDevices > 0;
+#endif
+
+    vx_enum resolved = ALPHA_COMP_BACKEND_HOST;
+
+    switch (requested)
+    {
+    case ALPHA_COMP_BACKEND_AUTO:
+        resolved = haveNpp ? ALPHA_COMP_BACKEND_NPP : ALPHA_COMP_BACKEND_HOST;
+        break;
+
+    case ALPHA_COMP_BACKEND_NPP:
+        if (!haveNpp)
+        {
+            vxAddLogEntry((vx_reference)node, VX_ERROR_NOT_SUPPORTED, "[%s:%u] NPP backend of AlphaComp Kernel is not available", __FUNCTION__, __LINE__);
+            return VX_ERROR_NOT_SUPPORTED;
+        }
+        resolved = ALPHA_COMP_BACKEND_NPP;
+        break;
+
+    case ALPHA_COMP_BACKEND_HOST:
+        break;
+
+    default:
+        vxAddLogEntry((vx_reference)node, VX_ERROR_INVALID_VALUE, "[%s:%u] Unknown \'backend\' in AlphaComp Kernel", __FUNCTION__, __LINE__);
+        return VX_ERROR_INVALID_VALUE;
+    }
+
+    vx_enum* backend = NULL;
+    vx_status status = vxQueryNode(node, VX_NODE_ATTRIBUTE_LOCAL_DATA_PTR, &backend, sizeof(backend));
+    if (status != VX_SUCCESS || backend == NULL)
+        return VX_FAILURE;
+
+    *backend = resolved;
+
+    return VX_SUCCESS;
+}
+
 // Register user defined kernel in OpenVX context
 vx_status registerAlphaCompKernel(vx_context context)
 {
@@ -225,11 +330,11 @@ vx_status registerAlphaCompKernel(vx_context context)
         return status;
     }
 
-    vx_kernel kernel = vxAddUserKernel(context, "gpu:" KERNEL_ALPHA_COMP_NAME, id,
+    vx_kernel kernel = vxAddUserKernel(context, KERNEL_ALPHA_COMP_TARGET KERNEL_ALPHA_COMP_NAME, id,
                                        alphaComp_kernel,
-                                       6,    // numParams
+                                       7,    // numParams
                                        alphaComp_validate,
-                                       NULL, // init
+                                       alphaComp_initialize,
                                        NULL  // deinit
                                        );
 
@@ -246,6 +351,11 @@ vx_status registerAlphaCompKernel(vx_context context)
     status |= vxAddParameterToKernel(kernel, 3, VX_INPUT , VX_TYPE_SCALAR, VX_PARAMETER_STATE_REQUIRED); // alpha2
     status |= vxAddParameterToKernel(kernel, 4, VX_OUTPUT, VX_TYPE_IMAGE , VX_PARAMETER_STATE_REQUIRED); // dst
     status |= vxAddParameterToKernel(kernel, 5, VX_INPUT , VX_TYPE_SCALAR, VX_PARAMETER_STATE_REQUIRED); // alphaOp
+    status |= vxAddParameterToKernel(kernel, 6, VX_INPUT , VX_TYPE_SCALAR, VX_PARAMETER_STATE_OPTIONAL); // backend
+
+    // The backend resolved by alphaComp_initialize
+    vx_size localDataSize = sizeof(vx_enum);
+    status |= vxSetKernelAttribute(kernel, VX_KERNEL_ATTRIBUTE_LOCAL_DATA_SIZE, &localDataSize, sizeof(localDataSize));
 
     if (status != VX_SUCCESS)
     {
@@ -267,7 +377,8 @@ vx_status registerAlphaCompKernel(vx_context context)
 }
 
 // Create AlphaComp node
-vx_node alphaCompNode(vx_graph graph, vx_image src1, vx_scalar alpha1, vx_image src2, vx_scalar alpha2, vx_image dst, vx_scalar alphaOp)
+vx_node alphaCompNode(vx_graph graph, vx_image src1, vx_scalar alpha1, vx_image src2, vx_scalar alpha2, vx_image dst, vx_scalar alphaOp,
+                      vx_scalar backend)
 {
     vx_node node = NULL;
 
@@ -286,10 +397,10 @@ vx_node alphaCompNode(vx_graph graph, vx_image src1, vx_scalar alpha1, vx_image
             vxSetParameterByIndex(node, 3, (vx_reference)alpha2);
             vxSetParameterByIndex(node, 4, (vx_reference)dst);
             vxSetParameterByIndex(node, 5, (vx_reference)alphaOp);
+            if (backend)
+                vxSetParameterByIndex(node, 6, (vx_reference)backend);
         }
     }
 
     return node;
 }
-
-#endif // defined USE_OPENCV && defined USE_NPP
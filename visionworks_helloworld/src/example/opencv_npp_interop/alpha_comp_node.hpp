@@ -29,23 +29,31 @@
 #ifndef __NVX_ALPHA_COMP_NODE_HPP__
 #define __NVX_ALPHA_COMP_NODE_HPP__
 
-#if defined USE_OPENCV && defined USE_NPP
+#include <NVX/nvx.h>
 
-#include <cuda_runtime_api.h>
-#include <nppcore.h>
-#include <nppi.h>
+#include "alpha_comp_host.hpp"
 
-#include <NVX/nvx.h>
+// Where the AlphaComp node runs
+enum AlphaCompBackend
+{
+    // NPP when the sample is built with it and a CUDA device is present, the host otherwise
+    ALPHA_COMP_BACKEND_AUTO,
+    // nppiAlphaCompC_8u_C1R on the CUDA stream of the node
+    ALPHA_COMP_BACKEND_NPP,
+    // SIMD host implementation (alpha_comp_host.hpp)
+    ALPHA_COMP_BACKEND_HOST
+};
 
 // Register AlphaComp kernel in OpenVX context
 vx_status registerAlphaCompKernel(vx_context context);
 
-// Create AlphaComp node
+// Create AlphaComp node.
+// alphaOp is a VX_TYPE_ENUM scalar of AlphaCompOp (the values of NppiAlphaOp).
+// backend is an optional VX_TYPE_ENUM scalar of AlphaCompBackend, it is resolved when the graph is verified.
 vx_node alphaCompNode(vx_graph graph,
                       vx_image src1, vx_scalar alpha1,
                       vx_image src2, vx_scalar alpha2,
-                      vx_image dst, vx_scalar alphaOp);
-
-#endif // defined USE_OPENCV && defined USE_NPP
+                      vx_image dst, vx_scalar alphaOp,
+                      vx_scalar backend = NULL);
 
 #endif // __NVX_ALPHA_COMP_NODE_HPP__
@@ -0,0 +1,26 @@
+#ifndef BLUR_ALPHA_COMP_NODE_HPP
+#define BLUR_ALPHA_COMP_NODE_HPP
+
+#include <NVX/nvx.h>
+
+#include "alpha_comp_host.hpp"
+
+//
+// Fused Gaussian3x3 + AlphaComp host kernel:
+//
+//   dst = AlphaComp(Gaussian3x3(src1), alpha1, Gaussian3x3(src2), alpha2, alphaOp)
+//
+// The same result as two vxGaussian3x3Node and alphaCompNode with the host backend, in a single
+// tiled sweep over the sources without blurred intermediate images (see blurAlphaCompHost).
+//
+
+// Register BlurAlphaComp kernel in OpenVX context
+vx_status registerBlurAlphaCompKernel(vx_context context);
+
+// Create BlurAlphaComp node, the parameters are the ones of alphaCompNode
+vx_node blurAlphaCompNode(vx_graph graph,
+                          vx_image src1, vx_scalar alpha1,
+                          vx_image src2, vx_scalar alpha2,
+                          vx_image dst, vx_scalar alphaOp);
+
+#endif
@@ -0,0 +1,377 @@
+#include "layer_comp_host.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "../common/host_simd.hpp"
+#include "../common/parallel_for.hpp"
+
+namespace
+{
+    // Pixels of a row composed at once, so the rows of a tile stay in L1 while all the layers go over them
+    const vx_int32 TILE_WIDTH = 512;
+
+    bool isPremulOp(vx_enum op)
+    {
+        return op >= ALPHA_COMP_OVER_PREMUL && op <= ALPHA_COMP_PLUS_PREMUL;
+    }
+
+    // Alpha of src1 op src2: the weights are the alphas of the sources in the result,
+    // premultiplied sources carry their alphas in the pixels
+    vx_uint8 compositeAlpha(vx_enum op, AlphaCompWeights w, vx_uint8 alpha1, vx_uint8 alpha2)
+    {
+        vx_uint32 a = isPremulOp(op) ? alphaCompDiv255(static_cast<vx_uint32>(w.w1) * alpha1) +
+                                       alphaCompDiv255(static_cast<vx_uint32>(w.w2) * alpha2)
+                                     : static_cast<vx_uint32>(w.w1) + w.w2;
+        return static_cast<vx_uint8>(std::min(a, 255u));
+    }
+
+#if defined(NVX_HOST_SSE2) || defined(NVX_HOST_NEON)
+
+    // 8 values of 8 bits in 16-bit lanes
+
+#if defined(NVX_HOST_SSE2)
+    typedef __m128i U16x8;
+
+    inline U16x8 load8(const vx_uint8* p)
+    {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128());
+    }
+
+    inline void store8(vx_uint8* p, U16x8 v)
+    {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(v, v));
+    }
+
+    inline U16x8 dup(vx_uint16 v) { return _mm_set1_epi16(static_cast<short>(v)); }
+    inline U16x8 add(U16x8 a, U16x8 b) { return _mm_add_epi16(a, b); }
+    inline U16x8 sub(U16x8 a, U16x8 b) { return _mm_sub_epi16(a, b); }
+    inline U16x8 min255(U16x8 a) { return _mm_min_epi16(a, dup(255)); }
+
+    // round(a * b / 255), the same as alphaCompDiv255(a * b)
+    inline U16x8 mul255(U16x8 a, U16x8 b)
+    {
+        return _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(a, b), dup(128)), dup(257));
+    }
+#else
+    typedef uint16x8_t U16x8;
+
+    inline U16x8 load8(const vx_uint8* p) { return vmovl_u8(vld1_u8(p)); }
+    inline void store8(vx_uint8* p, U16x8 v) { vst1_u8(p, vmovn_u16(v)); }
+
+    inline U16x8 dup(vx_uint16 v) { return vdupq_n_u16(v); }
+    inline U16x8 add(U16x8 a, U16x8 b) { return vaddq_u16(a, b); }
+    inline U16x8 sub(U16x8 a, U16x8 b) { return vsubq_u16(a, b); }
+    inline U16x8 min255(U16x8 a) { return vminq_u16(a, dup(255)); }
+
+    // ((t + (t >> 8)) >> 8) with t = a * b + 128 is ((t * 257) >> 16)
+    inline U16x8 mul255(U16x8 a, U16x8 b)
+    {
+        U16x8 t = vaddq_u16(vmulq_u16(a, b), dup(128));
+        return vshrq_n_u16(vsraq_n_u16(t, t, 8), 8);
+    }
+#endif
+
+    // Vector form of getAlphaCompWeights
+    template <vx_enum Op>
+    inline void opWeights(U16x8 a1, U16x8 a2, U16x8& w1, U16x8& w2)
+    {
+        const U16x8 full = dup(255);
+
+        if constexpr (Op == ALPHA_COMP_OVER)             { w1 = a1;                     w2 = mul255(sub(full, a1), a2); }
+        else if constexpr (Op == ALPHA_COMP_IN)          { w1 = mul255(a1, a2);         w2 = dup(0); }
+        else if constexpr (Op == ALPHA_COMP_OUT)         { w1 = mul255(a1, sub(full, a2)); w2 = dup(0); }
+        else if constexpr (Op == ALPHA_COMP_ATOP)        { w1 = mul255(a1, a2);         w2 = mul255(sub(full, a1), a2); }
+        else if constexpr (Op == ALPHA_COMP_XOR)         { w1 = mul255(a1, sub(full, a2)); w2 = mul255(sub(full, a1), a2); }
+        else if constexpr (Op == ALPHA_COMP_PLUS)        { w1 = a1;                     w2 = a2; }
+        else if constexpr (Op == ALPHA_COMP_OVER_PREMUL) { w1 = full;                   w2 = sub(full, a1); }
+        else if constexpr (Op == ALPHA_COMP_IN_PREMUL)   { w1 = a2;                     w2 = dup(0); }
+        else if constexpr (Op == ALPHA_COMP_OUT_PREMUL)  { w1 = sub(full, a2);          w2 = dup(0); }
+        else if constexpr (Op == ALPHA_COMP_ATOP_PREMUL) { w1 = a2;                     w2 = sub(full, a1); }
+        else if constexpr (Op == ALPHA_COMP_XOR_PREMUL)  { w1 = sub(full, a2);          w2 = sub(full, a1); }
+        else if constexpr (Op == ALPHA_COMP_PLUS_PREMUL) { w1 = full;                   w2 = full; }
+        else                                             { w1 = a1;                     w2 = dup(0); }
+    }
+
+#endif
+
+    // Weights of every pixel for the alphas of the layer (alpha1) and of the composite below it (alpha2),
+    // alpha2 is replaced by the alpha of the new composite
+    template <vx_enum Op>
+    void weightsRow(const vx_uint8* alpha1, vx_uint8* alpha2, vx_uint8* w1, vx_uint8* w2, vx_int32 n)
+    {
+        vx_int32 x = 0;
+
+#if defined(NVX_HOST_SSE2) || defined(NVX_HOST_NEON)
+        for (; x + 8 <= n; x += 8)
+        {
+            U16x8 a1 = load8(alpha1 + x), a2 = load8(alpha2 + x), vw1, vw2;
+            opWeights<Op>(a1, a2, vw1, vw2);
+
+            U16x8 a = isPremulOp(Op) ? add(mul255(vw1, a1), mul255(vw2, a2)) : add(vw1, vw2);
+
+            store8(w1 + x, vw1);
+            store8(w2 + x, vw2);
+            store8(alpha2 + x, min255(a));
+        }
+#endif
+
+        for (; x < n; ++x)
+        {
+            AlphaCompWeights w = getAlphaCompWeights(Op, alpha1[x], alpha2[x]);
+            w1[x] = w.w1;
+            w2[x] = w.w2;
+            alpha2[x] = compositeAlpha(Op, w, alpha1[x], alpha2[x]);
+        }
+    }
+
+    typedef void (*WeightsRowFunc)(const vx_uint8*, vx_uint8*, vx_uint8*, vx_uint8*, vx_int32);
+
+    WeightsRowFunc getWeightsRow(vx_enum op)
+    {
+        switch (op)
+        {
+        case ALPHA_COMP_OVER:        return &weightsRow<ALPHA_COMP_OVER>;
+        case ALPHA_COMP_IN:          return &weightsRow<ALPHA_COMP_IN>;
+        case ALPHA_COMP_OUT:         return &weightsRow<ALPHA_COMP_OUT>;
+        case ALPHA_COMP_ATOP:        return &weightsRow<ALPHA_COMP_ATOP>;
+        case ALPHA_COMP_XOR:         return &weightsRow<ALPHA_COMP_XOR>;
+        case ALPHA_COMP_PLUS:        return &weightsRow<ALPHA_COMP_PLUS>;
+        case ALPHA_COMP_OVER_PREMUL: return &weightsRow<ALPHA_COMP_OVER_PREMUL>;
+        case ALPHA_COMP_IN_PREMUL:   return &weightsRow<ALPHA_COMP_IN_PREMUL>;
+        case ALPHA_COMP_OUT_PREMUL:  return &weightsRow<ALPHA_COMP_OUT_PREMUL>;
+        case ALPHA_COMP_ATOP_PREMUL: return &weightsRow<ALPHA_COMP_ATOP_PREMUL>;
+        case ALPHA_COMP_XOR_PREMUL:  return &weightsRow<ALPHA_COMP_XOR_PREMUL>;
+        case ALPHA_COMP_PLUS_PREMUL: return &weightsRow<ALPHA_COMP_PLUS_PREMUL>;
+        default:                     return &weightsRow<ALPHA_COMP_PREMUL>;
+        }
+    }
+
+    // alpha = round(alpha * constant / 255)
+    void scaleAlphaRow(vx_uint8* alpha, vx_uint8 constant, vx_int32 n)
+    {
+        vx_int32 x = 0;
+
+#if defined(NVX_HOST_SSE2) || defined(NVX_HOST_NEON)
+        const U16x8 c = dup(constant);
+
+        for (; x + 8 <= n; x += 8)
+            store8(alpha + x, mul255(load8(alpha + x), c));
+#endif
+
+        for (; x < n; ++x)
+            alpha[x] = alphaCompDiv255(static_cast<vx_uint32>(alpha[x]) * constant);
+    }
+
+    // Every weight of a pixel for its 4 channels
+    void expandWeights4(const vx_uint8* w, vx_uint8* dst, vx_int32 n)
+    {
+        vx_int32 x = 0;
+
+#if defined(NVX_HOST_SSE2)
+        for (; x + 16 <= n; x += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + x));
+            __m128i lo = _mm_unpacklo_epi8(v, v);
+            __m128i hi = _mm_unpackhi_epi8(v, v);
+
+            __m128i* d = reinterpret_cast<__m128i*>(dst + 4 * x);
+            _mm_storeu_si128(d + 0, _mm_unpacklo_epi16(lo, lo));
+            _mm_storeu_si128(d + 1, _mm_unpackhi_epi16(lo, lo));
+            _mm_storeu_si128(d + 2, _mm_unpacklo_epi16(hi, hi));
+            _mm_storeu_si128(d + 3, _mm_unpackhi_epi16(hi, hi));
+        }
+#elif defined(NVX_HOST_NEON)
+        for (; x + 16 <= n; x += 16)
+        {
+            uint8x16_t v = vld1q_u8(w + x);
+            uint8x16x2_t twice = vzipq_u8(v, v);
+            uint8x16x2_t lo = vzipq_u8(twice.val[0], twice.val[0]);
+            uint8x16x2_t hi = vzipq_u8(twice.val[1], twice.val[1]);
+
+            vx_uint8* d = dst + 4 * x;
+            vst1q_u8(d, lo.val[0]);
+            vst1q_u8(d + 16, lo.val[1]);
+            vst1q_u8(d + 32, hi.val[0]);
+            vst1q_u8(d + 48, hi.val[1]);
+        }
+#endif
+
+        for (; x < n; ++x)
+        {
+            vx_uint8* d = dst + 4 * x;
+            d[0] = d[1] = d[2] = d[3] = w[x];
+        }
+    }
+
+    // dst = w1 * src + w2 * dst with a weight per value, rounded and saturated like alphaCompRow
+    void blendRow(const vx_uint8* src, vx_uint8* dst, const vx_uint8* w1, const vx_uint8* w2, vx_int32 n)
+    {
+        vx_int32 x = 0;
+
+#if defined(NVX_HOST_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i half = _mm_set1_epi16(128);
+        const __m128i mul = _mm_set1_epi16(257);
+
+        for (; x + 16 <= n; x += 16)
+        {
+            __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+            __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + x));
+            __m128i q1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w1 + x));
+            __m128i q2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w2 + x));
+
+            __m128i lo = _mm_adds_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(p1, zero), _mm_unpacklo_epi8(q1, zero)),
+                                        _mm_mullo_epi16(_mm_unpacklo_epi8(p2, zero), _mm_unpacklo_epi8(q2, zero)));
+            __m128i hi = _mm_adds_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(p1, zero), _mm_unpackhi_epi8(q1, zero)),
+                                        _mm_mullo_epi16(_mm_unpackhi_epi8(p2, zero), _mm_unpackhi_epi8(q2, zero)));
+
+            lo = _mm_mulhi_epu16(_mm_adds_epu16(lo, half), mul);
+            hi = _mm_mulhi_epu16(_mm_adds_epu16(hi, half), mul);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+        }
+#elif defined(NVX_HOST_NEON)
+        const uint16x8_t maxSum = vdupq_n_u16(255 * 255);
+
+        for (; x + 16 <= n; x += 16)
+        {
+            uint8x16_t p1 = vld1q_u8(src + x);
+            uint8x16_t p2 = vld1q_u8(dst + x);
+            uint8x16_t q1 = vld1q_u8(w1 + x);
+            uint8x16_t q2 = vld1q_u8(w2 + x);
+
+            uint16x8_t lo = vminq_u16(vqaddq_u16(vmull_u8(vget_low_u8(p1), vget_low_u8(q1)),
+                                                 vmull_u8(vget_low_u8(p2), vget_low_u8(q2))), maxSum);
+            uint16x8_t hi = vminq_u16(vqaddq_u16(vmull_u8(vget_high_u8(p1), vget_high_u8(q1)),
+                                                 vmull_u8(vget_high_u8(p2), vget_high_u8(q2))), maxSum);
+
+            uint8x8_t rlo = vraddhn_u16(lo, vrshrq_n_u16(lo, 8));
+            uint8x8_t rhi = vraddhn_u16(hi, vrshrq_n_u16(hi, 8));
+
+            vst1q_u8(dst + x, vcombine_u8(rlo, rhi));
+        }
+#endif
+
+        for (; x < n; ++x)
+            dst[x] = alphaCompDiv255(static_cast<vx_uint32>(w1[x]) * src[x] + static_cast<vx_uint32>(w2[x]) * dst[x]);
+    }
+}
+
+void layerCompHost(const LayerCompHostLayer* layers, vx_uint32 numLayers, vx_uint32 channels,
+                   vx_uint8* dst, vx_size dstStride, vx_uint32 width, vx_uint32 height)
+{
+    if (numLayers == 0)
+        return;
+
+    const vx_int32 w = static_cast<vx_int32>(width);
+    const vx_int32 ch = static_cast<vx_int32>(channels);
+
+    // A layer has the same alpha at every pixel without a mask and an alpha channel. As long as the layers
+    // below have it too, the weights are the same at every pixel and alphaCompRow composes the layer.
+    std::vector<WeightsRowFunc> weightsRows(numLayers);
+    std::vector<bool> uniform(numLayers);
+
+    for (vx_uint32 i = 0; i < numLayers; ++i)
+    {
+        weightsRows[i] = getWeightsRow(layers[i].op);
+        uniform[i] = layers[i].mask == NULL && ch == 1;
+    }
+
+    // About 64 KB of the destination per range
+    vx_int32 grain = std::max(1, static_cast<vx_int32>((1 << 16) / std::max(1, w * ch)));
+
+    nvx::parallelFor(0, static_cast<vx_int32>(height), grain, [&](vx_int32 first, vx_int32 last)
+    {
+        const vx_int32 tile = std::min(TILE_WIDTH, w);
+
+        // Alphas of the layer and of the composite, the weights of the layer and the ones of every channel
+        std::vector<vx_uint8> buffer(4 * tile + 2 * ch * tile);
+
+        vx_uint8* layerAlpha = &buffer[0];
+        vx_uint8* alpha = layerAlpha + tile;
+        vx_uint8* w1 = alpha + tile;
+        vx_uint8* w2 = w1 + tile;
+        vx_uint8* w1c = ch == 1 ? w1 : w2 + tile;
+        vx_uint8* w2c = ch == 1 ? w2 : w1c + ch * tile;
+
+        // Per-pixel alpha of a layer
+        auto loadLayerAlpha = [&](const LayerCompHostLayer& layer, vx_int32 y, vx_int32 x0, vx_int32 n, vx_uint8* a)
+        {
+            if (layer.mask)
+            {
+                std::memcpy(a, layer.mask + y * layer.maskStride + x0, n);
+            }
+            else if (ch == 4)
+            {
+                const vx_uint8* src = layer.data + y * layer.stride + 4 * x0;
+                for (vx_int32 x = 0; x < n; ++x)
+                    a[x] = src[4 * x + 3];
+            }
+            else
+            {
+                std::memset(a, 255, n);
+            }
+
+            if (layer.alpha != 255)
+                scaleAlphaRow(a, layer.alpha, n);
+        };
+
+        for (vx_int32 y = first; y < last; ++y)
+        {
+            for (vx_int32 x0 = 0; x0 < w; x0 += tile)
+            {
+                const vx_int32 n = std::min(tile, w - x0);
+                vx_uint8* d = dst + y * dstStride + ch * x0;
+
+                // The bottom layer is the background
+
+                std::memcpy(d, layers[0].data + y * layers[0].stride + ch * x0, ch * n);
+
+                bool uniformAlpha = uniform[0];
+                vx_uint8 constAlpha = layers[0].alpha;
+
+                if (!uniformAlpha)
+                    loadLayerAlpha(layers[0], y, x0, n, alpha);
+
+                for (vx_uint32 i = 1; i < numLayers; ++i)
+                {
+                    const LayerCompHostLayer& layer = layers[i];
+                    const vx_uint8* src = layer.data + y * layer.stride + ch * x0;
+
+                    if (uniformAlpha && uniform[i])
+                    {
+                        AlphaCompWeights weights = getAlphaCompWeights(layer.op, layer.alpha, constAlpha);
+                        alphaCompRow(src, d, d, ch * n, weights);
+                        constAlpha = compositeAlpha(layer.op, weights, layer.alpha, constAlpha);
+                        continue;
+                    }
+
+                    if (uniformAlpha)
+                    {
+                        std::memset(alpha, constAlpha, n);
+                        uniformAlpha = false;
+                    }
+
+                    loadLayerAlpha(layer, y, x0, n, layerAlpha);
+                    weightsRows[i](layerAlpha, alpha, w1, w2, n);
+
+                    if (ch == 4)
+                    {
+                        expandWeights4(w1, w1c, n);
+                        expandWeights4(w2, w2c, n);
+                    }
+
+                    blendRow(src, d, w1c, w2c, ch * n);
+                }
+
+                if (ch == 4)
+                {
+                    for (vx_int32 x = 0; x < n; ++x)
+                        d[4 * x + 3] = uniformAlpha ? constAlpha : alpha[x];
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,38 @@
+#ifndef LAYER_COMP_HOST_HPP
+#define LAYER_COMP_HOST_HPP
+
+#include <VX/vx.h>
+
+#include "alpha_comp_host.hpp"
+
+//
+// Composition of N layers of the same size and format in one pass over the destination:
+//
+//   dst = layer[N-1] op[N-1] ( ... (layer[2] op[2] (layer[1] op[1] layer[0])))
+//
+// Every step is the AlphaComp operation of a layer (src1) over the composite of the layers below it
+// (src2), with the weights of getAlphaCompWeights computed for every pixel. The alpha of a composite
+// is the Porter-Duff alpha of its operation, computed from the same 8-bit weights, so the result is
+// the one of chained alphaCompHost calls given the exact alphas of the intermediate composites.
+// The bottom layer is the background, its operation is not used.
+//
+struct LayerCompHostLayer
+{
+    const vx_uint8* data;
+    vx_size stride;
+    // per-pixel alpha of VX_DF_IMAGE_U8 format, or NULL
+    const vx_uint8* mask;
+    vx_size maskStride;
+    // constant alpha, the per-pixel one is multiplied by it
+    vx_uint8 alpha;
+    // AlphaCompOp
+    vx_enum op;
+};
+
+// 'channels' is 1 for VX_DF_IMAGE_U8 layers and 4 for VX_DF_IMAGE_RGBX ones. RGBX layers without a mask
+// use their X channel as the per-pixel alpha, and the X channel of dst receives the alpha of the composite.
+// Rows are processed in parallel, every row in tiles that keep the working rows in the cache.
+void layerCompHost(const LayerCompHostLayer* layers, vx_uint32 numLayers, vx_uint32 channels,
+                   vx_uint8* dst, vx_size dstStride, vx_uint32 width, vx_uint32 height);
+
+#endif
@@ -0,0 +1,338 @@
+#include "layer_comp_node.hpp"
+
+#include <vector>
+
+//
+// Define user kernel
+//
+
+#define KERNEL_LAYER_COMP_NAME "example.nvx.layer_comp"
+
+// dst, then image, mask, alpha and op of every layer
+#define LAYER_COMP_NUM_PARAMS (1 + 4 * LAYER_COMP_MAX_LAYERS)
+
+static vx_uint32 layerParam(vx_uint32 layer, vx_uint32 item)
+{
+    return 1 + 4 * layer + item;
+}
+
+enum { LAYER_IMAGE, LAYER_MASK, LAYER_ALPHA, LAYER_OP };
+
+// The layers are the first ones with an image
+static vx_uint32 countLayers(const vx_reference* parameters)
+{
+    vx_uint32 numLayers = 0;
+    while (numLayers < LAYER_COMP_MAX_LAYERS && parameters[layerParam(numLayers, LAYER_IMAGE)])
+        ++numLayers;
+
+    return numLayers;
+}
+
+// Kernel implementation
+static vx_status VX_CALLBACK layerComp_kernel(vx_node, const vx_reference *parameters, vx_uint32 num)
+{
+    if (num != LAYER_COMP_NUM_PARAMS)
+        return VX_FAILURE;
+
+    vx_image dst = (vx_image)parameters[0];
+    vx_uint32 numLayers = countLayers(parameters);
+
+    vx_status status = VX_SUCCESS;
+
+    // Get scalars values
+
+    LayerCompHostLayer layers[LAYER_COMP_MAX_LAYERS] = {};
+
+    for (vx_uint32 i = 0; i < numLayers; ++i)
+    {
+        vx_scalar s_alpha = (vx_scalar)parameters[layerParam(i, LAYER_ALPHA)];
+        vx_scalar s_op = (vx_scalar)parameters[layerParam(i, LAYER_OP)];
+
+        layers[i].alpha = 255;
+        layers[i].op = ALPHA_COMP_OVER;
+
+        if (s_alpha)
+            vxCopyScalar(s_alpha, &layers[i].alpha, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+        if (s_op)
+            vxCopyScalar(s_op, &layers[i].op, VX_READ_ONLY, VX_MEMORY_TYPE_HOST);
+
+        if (!isValidAlphaCompOp(layers[i].op))
+        {
+            vxAddLogEntry((vx_reference)s_op, VX_ERROR_INVALID_VALUE, "[%s:%u] Unknown \'op\' of layer %u in LayerComp Kernel", __FUNCTION__, __LINE__, i);
+            return VX_ERROR_INVALID_VALUE;
+        }
+    }
+
+    // Map OpenVX data objects into host memory
+
+    vx_rectangle_t rect = {};
+    vxGetValidRegionImage((vx_image)parameters[layerParam(0, LAYER_IMAGE)], &rect);
+
+    struct Mapping
+    {
+        vx_image image;
+        vx_map_id id;
+    };
+
+    std::vector<Mapping> mappings;
+    mappings.reserve(2 * numLayers + 1);
+
+    auto mapImage = [&](vx_image image, vx_enum usage, vx_uint8*& ptr, vx_imagepatch_addressing_t& addr) -> bool
+    {
+        vx_map_id id;
+        status = vxMapImagePatch(image, &rect, 0, &id, &addr, (void **)&ptr, usage, VX_MEMORY_TYPE_HOST, 0);
+
+        if (status != VX_SUCCESS)
+        {
+            vxAddLogEntry((vx_reference)image, status, "[%s:%u] Failed to access an image in LayerComp Kernel", __FUNCTION__, __LINE__);
+            return false;
+        }
+
+        Mapping mapping = { image, id };
+        mappings.push_back(mapping);
+        return true;
+    };
+
+    vx_uint8* dst_ptr = NULL;
+    vx_imagepatch_addressing_t dst_addr;
+    bool mapped = mapImage(dst, VX_WRITE_ONLY, dst_ptr, dst_addr);
+
+    for (vx_uint32 i = 0; mapped && i < numLayers; ++i)
+    {
+        vx_image image = (vx_image)parameters[layerParam(i, LAYER_IMAGE)];
+        vx_image mask = (vx_image)parameters[layerParam(i, LAYER_MASK)];
+
+        vx_uint8* ptr = NULL;
+        vx_imagepatch_addressing_t addr;
+        mapped = mapImage(image, VX_READ_ONLY, ptr, addr);
+
+        layers[i].data = ptr;
+        layers[i].stride = addr.stride_y;
+
+        if (mapped && mask)
+        {
+            mapped = mapImage(mask, VX_READ_ONLY, ptr, addr);
+
+            layers[i].mask = ptr;
+            layers[i].maskStride = addr.stride_y;
+        }
+    }
+
+    if (mapped)
+    {
+        layerCompHost(layers, numLayers, dst_addr.stride_x,
+                      dst_ptr, dst_addr.stride_y,
+                      dst_addr.dim_x, dst_addr.dim_y);
+    }
+
+    // Unmap OpenVX data objects from host memory
+
+    for (const Mapping& mapping : mappings)
+        vxUnmapImagePatch(mapping.image, mapping.id);
+
+    return status;
+}
+
+// Parameter validator
+static vx_status VX_CALLBACK layerComp_validate(vx_node node, const vx_reference parameters[],
+                                                vx_uint32 num_params, vx_meta_format metas[])
+{
+    if (num_params != LAYER_COMP_NUM_PARAMS) return VX_ERROR_INVALID_PARAMETERS;
+
+    vx_uint32 numLayers = countLayers(parameters);
+
+    vx_df_image format = 0;
+    vx_uint32 width = 0, height = 0;
+
+    vx_status status = VX_SUCCESS;
+
+    for (vx_uint32 i = 0; i < LAYER_COMP_MAX_LAYERS; ++i)
+    {
+        vx_image image = (vx_image)parameters[layerParam(i, LAYER_IMAGE)];
+        vx_image mask = (vx_image)parameters[layerParam(i, LAYER_MASK)];
+        vx_scalar alpha = (vx_scalar)parameters[layerParam(i, LAYER_ALPHA)];
+        vx_scalar op = (vx_scalar)parameters[layerParam(i, LAYER_OP)];
+
+        if (i >= numLayers)
+        {
+            if (image || mask || alpha || op)
+            {
+                status = VX_ERROR_INVALID_PARAMETERS;
+                vxAddLogEntry((vx_reference)node, status, "[%s:%u] Layer %u of LayerComp Kernel follows a layer without image", __FUNCTION__, __LINE__, i);
+            }
+            continue;
+        }
+
+        vx_df_image image_format = 0;
+        vx_uint32 image_width = 0, image_height = 0;
+
+        vxQueryImage(image, VX_IMAGE_ATTRIBUTE_FORMAT, &image_format, sizeof(image_format));
+        vxQueryImage(image, VX_IMAGE_ATTRIBUTE_WIDTH, &image_width, sizeof(image_width));
+        vxQueryImage(image, VX_IMAGE_ATTRIBUTE_HEIGHT, &image_height, sizeof(image_height));
+
+        if (i == 0)
+        {
+            format = image_format;
+            width = image_width;
+            height = image_height;
+
+            if (format != VX_DF_IMAGE_U8 && format != VX_DF_IMAGE_RGBX)
+            {
+                status = VX_ERROR_INVALID_FORMAT;
+                vxAddLogEntry((vx_reference)image, status, "[%s:%u] Invalid format of layers in LayerComp Kernel, it should be VX_DF_IMAGE_U8 or VX_DF_IMAGE_RGBX", __FUNCTION__, __LINE__);
+            }
+        }
+        else if (image_format != format || image_width != width || image_height != height)
+        {
+            status = VX_ERROR_INVALID_PARAMETERS;
+            vxAddLogEntry((vx_reference)image, status, "[%s:%u] Layers 0 and %u have different size/format in LayerComp Kernel", __FUNCTION__, __LINE__, i);
+        }
+
+        if (mask)
+        {
+            vx_df_image mask_format = 0;
+            vx_uint32 mask_width = 0, mask_height = 0;
+
+            vxQueryImage(mask, VX_IMAGE_ATTRIBUTE_FORMAT, &mask_format, sizeof(mask_format));
+            vxQueryImage(mask, VX_IMAGE_ATTRIBUTE_WIDTH, &mask_width, sizeof(mask_width));
+            vxQueryImage(mask, VX_IMAGE_ATTRIBUTE_HEIGHT, &mask_height, sizeof(mask_height));
+
+            if (mask_format != VX_DF_IMAGE_U8 || mask_width != width || mask_height != height)
+            {
+                status = VX_ERROR_INVALID_PARAMETERS;
+                vxAddLogEntry((vx_reference)mask, status, "[%s:%u] Mask of layer %u in LayerComp Kernel should be VX_DF_IMAGE_U8 of the size of the layers", __FUNCTION__, __LINE__, i);
+            }
+        }
+
+        if (alpha)
+        {
+            vx_enum alpha_type = 0;
+            vxQueryScalar(alpha, VX_SCALAR_ATTRIBUTE_TYPE, &alpha_type, sizeof(alpha_type));
+
+            if (alpha_type != VX_TYPE_UINT8)
+            {
+                status = VX_ERROR_INVALID_TYPE;
+                vxAddLogEntry((vx_reference)alpha, status, "[%s:%u] Invalid format for \'alpha\' of layer %u in LayerComp Kernel, it should be VX_TYPE_UINT8", __FUNCTION__, __LINE__, i);
+            }
+        }
+
+        if (op)
+        {
+            vx_enum op_type = 0;
+            vxQueryScalar(op, VX_SCALAR_ATTRIBUTE_TYPE, &op_type, sizeof(op_type));
+
+            if (op_type != VX_TYPE_ENUM)
+            {
+                status = VX_ERROR_INVALID_TYPE;
+                vxAddLogEntry((vx_reference)op, status, "[%s:%u] Invalid format for \'op\' of layer %u in LayerComp Kernel, it should be VX_TYPE_ENUM", __FUNCTION__, __LINE__, i);
+            }
+        }
+    }
+
+    vx_meta_format dst_meta = metas[0];
+
+    vxSetMetaFormatAttribute(dst_meta, VX_IMAGE_ATTRIBUTE_FORMAT, &format, sizeof(format));
+    vxSetMetaFormatAttribute(dst_meta, VX_IMAGE_ATTRIBUTE_WIDTH, &width, sizeof(width));
+    vxSetMetaFormatAttribute(dst_meta, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height));
+
+    return status;
+}
+
+// Register user defined kernel in OpenVX context
+vx_status registerLayerCompKernel(vx_context context)
+{
+    vx_status status = VX_SUCCESS;
+
+    vx_enum id;
+    status = vxAllocateUserKernelId(context, &id);
+    if (status != VX_SUCCESS)
+    {
+        vxAddLogEntry((vx_reference)context, status, "Failed to allocate an ID for the LayerComp kernel");
+        return status;
+    }
+
+    vx_kernel kernel = vxAddUserKernel(context, "cpu:" KERNEL_LAYER_COMP_NAME, id,
+                                       layerComp_kernel,
+                                       LAYER_COMP_NUM_PARAMS,
+                                       layerComp_validate,
+                                       NULL, // init
+                                       NULL  // deinit
+                                       );
+
+    status = vxGetStatus((vx_reference)kernel);
+    if (status != VX_SUCCESS)
+    {
+        vxAddLogEntry((vx_reference)context, status, "Failed to create LayerComp Kernel");
+        return status;
+    }
+
+    status |= vxAddParameterToKernel(kernel, 0, VX_OUTPUT, VX_TYPE_IMAGE, VX_PARAMETER_STATE_REQUIRED); // dst
+
+    for (vx_uint32 i = 0; i < LAYER_COMP_MAX_LAYERS; ++i)
+    {
+        // Only the image of the bottom layer is required
+        vx_enum imageState = i == 0 ? VX_PARAMETER_STATE_REQUIRED : VX_PARAMETER_STATE_OPTIONAL;
+
+        status |= vxAddParameterToKernel(kernel, layerParam(i, LAYER_IMAGE), VX_INPUT, VX_TYPE_IMAGE , imageState);
+        status |= vxAddParameterToKernel(kernel, layerParam(i, LAYER_MASK) , VX_INPUT, VX_TYPE_IMAGE , VX_PARAMETER_STATE_OPTIONAL);
+        status |= vxAddParameterToKernel(kernel, layerParam(i, LAYER_ALPHA), VX_INPUT, VX_TYPE_SCALAR, VX_PARAMETER_STATE_OPTIONAL);
+        status |= vxAddParameterToKernel(kernel, layerParam(i, LAYER_OP)   , VX_INPUT, VX_TYPE_SCALAR, VX_PARAMETER_STATE_OPTIONAL);
+    }
+
+    if (status != VX_SUCCESS)
+    {
+        vxReleaseKernel(&kernel);
+        vxAddLogEntry((vx_reference)context, status, "Failed to initialize LayerComp Kernel parameters");
+        return VX_FAILURE;
+    }
+
+    status = vxFinalizeKernel(kernel);
+
+    if (status != VX_SUCCESS)
+    {
+        vxReleaseKernel(&kernel);
+        vxAddLogEntry((vx_reference)context, status, "Failed to finalize LayerComp Kernel");
+        return VX_FAILURE;
+    }
+
+    return status;
+}
+
+// Create LayerComp node
+vx_node layerCompNode(vx_graph graph, const LayerCompLayer* layers, vx_uint32 numLayers, vx_image dst)
+{
+    vx_node node = NULL;
+
+    if (numLayers == 0 || numLayers > LAYER_COMP_MAX_LAYERS)
+    {
+        vxAddLogEntry((vx_reference)graph, VX_ERROR_INVALID_PARAMETERS, "[%s:%u] LayerComp node takes from 1 to %u layers", __FUNCTION__, __LINE__, LAYER_COMP_MAX_LAYERS);
+        return node;
+    }
+
+    vx_kernel kernel = vxGetKernelByName(vxGetContext((vx_reference)graph), KERNEL_LAYER_COMP_NAME);
+
+    if (vxGetStatus((vx_reference)kernel) == VX_SUCCESS)
+    {
+        node = vxCreateGenericNode(graph, kernel);
+        vxReleaseKernel(&kernel);
+
+        if (vxGetStatus((vx_reference)node) == VX_SUCCESS)
+        {
+            vxSetParameterByIndex(node, 0, (vx_reference)dst);
+
+            for (vx_uint32 i = 0; i < numLayers; ++i)
+            {
+                vxSetParameterByIndex(node, layerParam(i, LAYER_IMAGE), (vx_reference)layers[i].image);
+
+                if (layers[i].mask)
+                    vxSetParameterByIndex(node, layerParam(i, LAYER_MASK), (vx_reference)layers[i].mask);
+                if (layers[i].alpha)
+                    vxSetParameterByIndex(node, layerParam(i, LAYER_ALPHA), (vx_reference)layers[i].alpha);
+                if (layers[i].op)
+                    vxSetParameterByIndex(node, layerParam(i, LAYER_OP), (vx_reference)layers[i].op);
+            }
+        }
+    }
+
+    return node;
+}
@@ -0,0 +1,34 @@
+#ifndef LAYER_COMP_NODE_HPP
+#define LAYER_COMP_NODE_HPP
+
+#include <NVX/nvx.h>
+
+#include "layer_comp_host.hpp"
+
+//
+// LayerComp host kernel: composition of up to LAYER_COMP_MAX_LAYERS layers of VX_DF_IMAGE_U8 or
+// VX_DF_IMAGE_RGBX format in one pass over the destination (see layerCompHost), instead of a chain
+// of alphaCompNode with an intermediate image per step.
+//
+
+const vx_uint32 LAYER_COMP_MAX_LAYERS = 8;
+
+struct LayerCompLayer
+{
+    // All the layers are of the same size and format, the one of dst
+    vx_image image;
+    // VX_DF_IMAGE_U8 per-pixel alpha, or NULL. RGBX layers without it use their X channel.
+    vx_image mask;
+    // VX_TYPE_UINT8 constant alpha, or NULL for 255
+    vx_scalar alpha;
+    // VX_TYPE_ENUM AlphaCompOp of the layer over the layers below it, or NULL for ALPHA_COMP_OVER
+    vx_scalar op;
+};
+
+// Register LayerComp kernel in OpenVX context
+vx_status registerLayerCompKernel(vx_context context);
+
+// Create LayerComp node, layers[0] is the bottom one
+vx_node layerCompNode(vx_graph graph, const LayerCompLayer* layers, vx_uint32 numLayers, vx_image dst);
+
+#endif
@@ -0,0 +1,299 @@
+/*
+# Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "alpha_comp_host.hpp"
+
+//
+// Bit-exactness test of the host AlphaComp: every operation, a sweep of alpha pairs and
+// all 256 x 256 pixel pairs, through alphaCompHost and through alphaCompRow with widths
+// that leave a SIMD tail, against alphaCompDiv255(w1 * src1 + w2 * src2). The same pixels
+// are also checked within +-1 against the Porter-Duff formulas evaluated in double, which
+// don't share getAlphaCompWeights with the implementation. blurAlphaCompHost is compared
+// with a scalar Gaussian3x3 followed by alphaCompHost.
+//
+
+namespace {
+
+const vx_uint32 numPairs = 256 * 256;
+
+// Pixel pair i is (i % 256, i / 256)
+inline vx_uint8 pairSrc1(vx_uint32 i) { return static_cast<vx_uint8>(i % 256); }
+inline vx_uint8 pairSrc2(vx_uint32 i) { return static_cast<vx_uint8>((i / 256) % 256); }
+
+inline vx_uint8 reference(AlphaCompWeights w, vx_uint8 a, vx_uint8 b)
+{
+    return alphaCompDiv255(static_cast<vx_uint32>(w.w1) * a + static_cast<vx_uint32>(w.w2) * b);
+}
+
+// Porter-Duff compositing of two pixels with constant alphas, in double and rounded to nearest
+vx_uint8 porterDuff(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2, vx_uint8 a, vx_uint8 b)
+{
+    const double a1 = alpha1 / 255.0, a2 = alpha2 / 255.0;
+    const double s1 = a, s2 = b;
+
+    double r = 0;
+
+    switch (op)
+    {
+    case ALPHA_COMP_OVER:        r = a1 * s1 + (1 - a1) * a2 * s2; break;
+    case ALPHA_COMP_IN:          r = a1 * a2 * s1; break;
+    case ALPHA_COMP_OUT:         r = a1 * (1 - a2) * s1; break;
+    case ALPHA_COMP_ATOP:        r = a1 * a2 * s1 + (1 - a1) * a2 * s2; break;
+    case ALPHA_COMP_XOR:         r = a1 * (1 - a2) * s1 + (1 - a1) * a2 * s2; break;
+    case ALPHA_COMP_PLUS:        r = a1 * s1 + a2 * s2; break;
+
+    // The pixels are premultiplied by their own alpha already
+    case ALPHA_COMP_OVER_PREMUL: r = s1 + (1 - a1) * s2; break;
+    case ALPHA_COMP_IN_PREMUL:   r = s1 * a2; break;
+    case ALPHA_COMP_OUT_PREMUL:  r = s1 * (1 - a2); break;
+    case ALPHA_COMP_ATOP_PREMUL: r = s1 * a2 + s2 * (1 - a1); break;
+    case ALPHA_COMP_XOR_PREMUL:  r = s1 * (1 - a2) + s2 * (1 - a1); break;
+    case ALPHA_COMP_PLUS_PREMUL: r = s1 + s2; break;
+    case ALPHA_COMP_PREMUL:      r = a1 * s1; break;
+    }
+
+    return static_cast<vx_uint8>(std::min(std::floor(r + 0.5), 255.0));
+}
+
+struct Mismatches
+{
+    Mismatches() : count(0) {}
+
+    void check(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2, const char* path,
+               vx_uint8 a, vx_uint8 b, vx_uint8 expected, vx_uint8 actual)
+    {
+        if (expected == actual)
+            return;
+
+        // Only the first ones are worth reading
+        if (count < 10)
+        {
+            std::cerr << path << ": op " << op << ", alphas " << +alpha1 << '/' << +alpha2
+                      << ", pixels " << +a << '/' << +b << ": " << +actual
+                      << " instead of " << +expected << std::endl;
+        }
+        ++count;
+    }
+
+    // The 8-bit weights of the three-factor terms are rounded, so the result may be off by one
+    void checkPorterDuff(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2, vx_uint8 a, vx_uint8 b, vx_uint8 actual)
+    {
+        vx_uint8 expected = porterDuff(op, alpha1, alpha2, a, b);
+        if (std::abs(static_cast<vx_int32>(expected) - static_cast<vx_int32>(actual)) <= 1)
+            return;
+
+        check(op, alpha1, alpha2, "Porter-Duff", a, b, expected, actual);
+    }
+
+    vx_size count;
+};
+
+// All pairs as one image whose width is not a multiple of any SIMD width,
+// with row strides larger than the width
+void testImage(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2, Mismatches& mismatches)
+{
+    const vx_uint32 width = 257, height = (numPairs + width - 1) / width;
+    const vx_size stride1 = width + 3, stride2 = width + 5, dstStride = width + 1;
+
+    std::vector<vx_uint8> src1(stride1 * height), src2(stride2 * height), dst(dstStride * height);
+
+    for (vx_uint32 y = 0; y < height; ++y)
+    {
+        for (vx_uint32 x = 0; x < width; ++x)
+        {
+            vx_uint32 i = (y * width + x) % numPairs;
+            src1[y * stride1 + x] = pairSrc1(i);
+            src2[y * stride2 + x] = pairSrc2(i);
+        }
+    }
+
+    alphaCompHost(&src1[0], stride1, alpha1, &src2[0], stride2, alpha2, &dst[0], dstStride, width, height, op);
+
+    const AlphaCompWeights w = getAlphaCompWeights(op, alpha1, alpha2);
+
+    for (vx_uint32 y = 0; y < height; ++y)
+    {
+        for (vx_uint32 x = 0; x < width; ++x)
+        {
+            vx_uint8 a = src1[y * stride1 + x], b = src2[y * stride2 + x];
+            mismatches.check(op, alpha1, alpha2, "alphaCompHost", a, b, reference(w, a, b), dst[y * dstStride + x]);
+            mismatches.checkPorterDuff(op, alpha1, alpha2, a, b, dst[y * dstStride + x]);
+        }
+    }
+}
+
+// All pairs split into rows of the given width, read and written one byte off alignment
+void testRows(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2, vx_uint32 width, Mismatches& mismatches)
+{
+    std::vector<vx_uint8> src1(numPairs + 1), src2(numPairs + 1), dst(numPairs + 1);
+
+    for (vx_uint32 i = 0; i < numPairs; ++i)
+    {
+        src1[i + 1] = pairSrc1(i);
+        src2[i + 1] = pairSrc2(i);
+    }
+
+    const AlphaCompWeights w = getAlphaCompWeights(op, alpha1, alpha2);
+
+    for (vx_uint32 first = 0; first < numPairs; first += width)
+    {
+        vx_uint32 rowWidth = std::min(width, numPairs - first);
+        alphaCompRow(&src1[first + 1], &src2[first + 1], &dst[first + 1], rowWidth, w);
+    }
+
+    for (vx_uint32 i = 0; i < numPairs; ++i)
+        mismatches.check(op, alpha1, alpha2, "alphaCompRow", src1[i + 1], src2[i + 1],
+                         reference(w, src1[i + 1], src2[i + 1]), dst[i + 1]);
+}
+
+// Scalar 1 2 1 / 16 blur with replicated border, truncated like vxGaussian3x3Node
+void blurReference(const std::vector<vx_uint8>& src, vx_size stride, vx_int32 width, vx_int32 height,
+                   std::vector<vx_uint8>& dst)
+{
+    const vx_int32 k[3] = { 1, 2, 1 };
+
+    dst.resize(width * height);
+    for (vx_int32 y = 0; y < height; ++y)
+    {
+        for (vx_int32 x = 0; x < width; ++x)
+        {
+            vx_int32 sum = 0;
+            for (vx_int32 dy = -1; dy <= 1; ++dy)
+            {
+                vx_int32 sy = std::min(std::max(y + dy, 0), height - 1);
+                for (vx_int32 dx = -1; dx <= 1; ++dx)
+                {
+                    vx_int32 sx = std::min(std::max(x + dx, 0), width - 1);
+                    sum += k[dy + 1] * k[dx + 1] * src[sy * stride + sx];
+                }
+            }
+            dst[y * width + x] = static_cast<vx_uint8>(sum >> 4);
+        }
+    }
+}
+
+// Random images, so the border and the SIMD tail see every kind of neighbourhood
+void testBlur(vx_enum op, vx_uint8 alpha1, vx_uint8 alpha2, vx_uint32 width, vx_uint32 height, Mismatches& mismatches)
+{
+    const vx_size stride1 = width + 3, stride2 = width + 5, dstStride = width + 1;
+
+    std::vector<vx_uint8> src1(stride1 * height), src2(stride2 * height), dst(dstStride * height);
+
+    std::minstd_rand rng(width * 7919 + height);
+    for (vx_uint8& p : src1)
+        p = static_cast<vx_uint8>(rng() >> 8);
+    for (vx_uint8& p : src2)
+        p = static_cast<vx_uint8>(rng() >> 8);
+
+    blurAlphaCompHost(&src1[0], stride1, alpha1, &src2[0], stride2, alpha2, &dst[0], dstStride, width, height, op);
+
+    std::vector<vx_uint8> blurred1, blurred2, expected(width * height);
+    blurReference(src1, stride1, width, height, blurred1);
+    blurReference(src2, stride2, width, height, blurred2);
+    alphaCompHost(&blurred1[0], width, alpha1, &blurred2[0], width, alpha2, &expected[0], width, width, height, op);
+
+    for (vx_uint32 y = 0; y < height; ++y)
+    {
+        for (vx_uint32 x = 0; x < width; ++x)
+        {
+            vx_uint32 i = y * width + x;
+            mismatches.check(op, alpha1, alpha2, "blurAlphaCompHost", blurred1[i], blurred2[i],
+                             expected[i], dst[y * dstStride + x]);
+        }
+    }
+}
+
+}
+
+//
+// main - Application entry point
+//
+
+int main()
+{
+    // The ends of the range, both sides of 128 and a coarse sweep in between
+    std::vector<vx_uint8> alphas;
+    for (vx_uint32 a = 0; a <= 255; a += 17)
+        alphas.push_back(static_cast<vx_uint8>(a));
+    alphas.push_back(1);
+    alphas.push_back(127);
+    alphas.push_back(128);
+    alphas.push_back(254);
+
+    // Below, at and above the SSE2/NEON and AVX2 widths
+    const vx_uint32 rowWidths[] = { 1, 7, 15, 16, 17, 31, 32, 33, 47, 63, 65, 100 };
+
+    // Single rows and columns, SIMD tails, and enough rows for several bands of blurAlphaCompHost
+    const vx_uint32 blurSizes[][2] = { { 1, 1 }, { 1, 9 }, { 2, 2 }, { 18, 1 }, { 17, 5 }, { 33, 18 }, { 257, 31 }, { 100, 2700 } };
+
+    Mismatches mismatches;
+    vx_size numCases = 0;
+
+    for (vx_enum op = ALPHA_COMP_OVER; op <= ALPHA_COMP_PREMUL; ++op)
+    {
+        for (vx_uint8 alpha1 : alphas)
+        {
+            for (vx_uint8 alpha2 : alphas)
+            {
+                testImage(op, alpha1, alpha2, mismatches);
+                ++numCases;
+            }
+        }
+
+        // The row widths with a smaller set of alphas, the weights are covered above
+        for (vx_uint32 width : rowWidths)
+        {
+            testRows(op, 255, 255, width, mismatches);
+            testRows(op, 128, 51, width, mismatches);
+            testRows(op, 1, 254, width, mismatches);
+            numCases += 3;
+        }
+
+        for (const vx_uint32* size : blurSizes)
+        {
+            testBlur(op, 128, 51, size[0], size[1], mismatches);
+            ++numCases;
+        }
+    }
+
+    if (mismatches.count > 0)
+    {
+        std::cerr << mismatches.count << " mismatching pixels in " << numCases << " cases" << std::endl;
+        return 1;
+    }
+
+    std::cout << "AlphaComp is bit-exact in " << numCases << " cases" << std::endl;
+    return 0;
+}
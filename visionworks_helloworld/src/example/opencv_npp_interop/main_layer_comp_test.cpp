@@ -0,0 +1,315 @@
+/*
+# Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <NVX/nvx.h>
+
+#include "NVXIO/Application.hpp"
+#include "NVXIO/Utility.hpp"
+
+#include "layer_comp_node.hpp"
+
+//
+// Test of the LayerComp node: small graphs of U8 and RGBX layers, with and without masks,
+// constant alphas and operations, against layerCompHost on the same pixels. It also checks
+// that a layer following a layer without image is rejected by the graph verification.
+//
+
+namespace {
+
+const vx_uint32 width = 53, height = 17;
+
+// Host copy of a layer and the images it is made of
+struct TestLayer
+{
+    TestLayer() : image(NULL), mask(NULL), s_alpha(NULL), s_op(NULL), alpha(255), op(ALPHA_COMP_OVER) {}
+
+    std::vector<vx_uint8> data;
+    std::vector<vx_uint8> maskData;
+
+    vx_image image;
+    vx_image mask;
+    vx_scalar s_alpha;
+    vx_scalar s_op;
+
+    vx_uint8 alpha;
+    vx_enum op;
+};
+
+vx_imagepatch_addressing_t makeAddressing(vx_uint32 channels)
+{
+    vx_imagepatch_addressing_t addr;
+    addr.dim_x = width;
+    addr.dim_y = height;
+    addr.stride_x = channels;
+    addr.stride_y = width * channels;
+    return addr;
+}
+
+// Deterministic pixels which cover the whole 8-bit range
+std::vector<vx_uint8> makePixels(vx_uint32 channels, vx_uint32 seed)
+{
+    std::vector<vx_uint8> pixels(width * height * channels);
+    for (vx_size i = 0; i < pixels.size(); ++i)
+        pixels[i] = static_cast<vx_uint8>((i * (2 * seed + 7) + seed * 31 + i / 5) % 256);
+    return pixels;
+}
+
+vx_image createImage(vx_context context, vx_uint32 channels, const std::vector<vx_uint8>& pixels)
+{
+    vx_image image = vxCreateImage(context, width, height, channels == 4 ? VX_DF_IMAGE_RGBX : VX_DF_IMAGE_U8);
+    NVXIO_CHECK_REFERENCE(image);
+
+    vx_rectangle_t rect = { 0u, 0u, width, height };
+    vx_imagepatch_addressing_t addr = makeAddressing(channels);
+    NVXIO_SAFE_CALL( vxCopyImagePatch(image, &rect, 0, &addr, const_cast<vx_uint8*>(pixels.data()),
+                                      VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+    return image;
+}
+
+// Optional parameters are created only when they are set, the rest is left to the node defaults
+void createLayer(vx_context context, vx_uint32 channels, vx_uint32 seed, bool withMask,
+                 const vx_uint8* alpha, const vx_enum* op, TestLayer& layer)
+{
+    layer.data = makePixels(channels, seed);
+    layer.image = createImage(context, channels, layer.data);
+
+    if (withMask)
+    {
+        layer.maskData = makePixels(1, seed + 100);
+        layer.mask = createImage(context, 1, layer.maskData);
+    }
+
+    if (alpha)
+    {
+        layer.alpha = *alpha;
+        layer.s_alpha = vxCreateScalar(context, VX_TYPE_UINT8, &layer.alpha);
+        NVXIO_CHECK_REFERENCE(layer.s_alpha);
+    }
+
+    if (op)
+    {
+        layer.op = *op;
+        layer.s_op = vxCreateScalar(context, VX_TYPE_ENUM, &layer.op);
+        NVXIO_CHECK_REFERENCE(layer.s_op);
+    }
+}
+
+void releaseLayer(TestLayer& layer)
+{
+    vxReleaseImage(&layer.image);
+    if (layer.mask)
+        vxReleaseImage(&layer.mask);
+    if (layer.s_alpha)
+        vxReleaseScalar(&layer.s_alpha);
+    if (layer.s_op)
+        vxReleaseScalar(&layer.s_op);
+}
+
+// Runs the layers through a LayerComp node and through layerCompHost, returns the number of different bytes
+vx_size compareWithHost(vx_context context, vx_uint32 channels, std::vector<TestLayer>& layers)
+{
+    vx_graph graph = vxCreateGraph(context);
+    NVXIO_CHECK_REFERENCE(graph);
+
+    vx_image dst = vxCreateImage(context, width, height, channels == 4 ? VX_DF_IMAGE_RGBX : VX_DF_IMAGE_U8);
+    NVXIO_CHECK_REFERENCE(dst);
+
+    std::vector<LayerCompLayer> nodeLayers(layers.size());
+    std::vector<LayerCompHostLayer> hostLayers(layers.size());
+
+    for (vx_size i = 0; i < layers.size(); ++i)
+    {
+        LayerCompLayer nodeLayer = { layers[i].image, layers[i].mask, layers[i].s_alpha, layers[i].s_op };
+        nodeLayers[i] = nodeLayer;
+
+        LayerCompHostLayer hostLayer = { layers[i].data.data(), width * channels,
+                                         layers[i].mask ? layers[i].maskData.data() : NULL, width,
+                                         layers[i].alpha, layers[i].op };
+        hostLayers[i] = hostLayer;
+    }
+
+    vx_node node = layerCompNode(graph, nodeLayers.data(), static_cast<vx_uint32>(nodeLayers.size()), dst);
+    NVXIO_CHECK_REFERENCE(node);
+
+    NVXIO_SAFE_CALL( vxVerifyGraph(graph) );
+    NVXIO_SAFE_CALL( vxProcessGraph(graph) );
+
+    std::vector<vx_uint8> result(width * height * channels), expected(width * height * channels);
+
+    vx_rectangle_t rect = { 0u, 0u, width, height };
+    vx_imagepatch_addressing_t addr = makeAddressing(channels);
+    NVXIO_SAFE_CALL( vxCopyImagePatch(dst, &rect, 0, &addr, result.data(), VX_READ_ONLY, VX_MEMORY_TYPE_HOST) );
+
+    layerCompHost(hostLayers.data(), static_cast<vx_uint32>(hostLayers.size()), channels,
+                  expected.data(), width * channels, width, height);
+
+    vx_size mismatches = 0;
+    for (vx_size i = 0; i < result.size(); ++i)
+        mismatches += result[i] != expected[i];
+
+    vxReleaseNode(&node);
+    vxReleaseImage(&dst);
+    vxReleaseGraph(&graph);
+
+    return mismatches;
+}
+
+bool runCase(vx_context context, const std::string& name, vx_uint32 channels, std::vector<TestLayer>& layers)
+{
+    vx_size mismatches = compareWithHost(context, channels, layers);
+
+    for (TestLayer& layer : layers)
+        releaseLayer(layer);
+
+    if (mismatches > 0)
+    {
+        std::cerr << name << ": " << mismatches << " bytes differ from layerCompHost" << std::endl;
+        return false;
+    }
+
+    std::cout << name << ": OK" << std::endl;
+    return true;
+}
+
+// Layer 2 without layer 1: the node has to be rejected, not composed as if there were 1 or 3 layers
+bool runGapCase(vx_context context)
+{
+    vx_graph graph = vxCreateGraph(context);
+    NVXIO_CHECK_REFERENCE(graph);
+
+    TestLayer bottom, top;
+    createLayer(context, 1, 1, false, NULL, NULL, bottom);
+    createLayer(context, 1, 2, false, NULL, NULL, top);
+
+    vx_image dst = vxCreateImage(context, width, height, VX_DF_IMAGE_U8);
+    NVXIO_CHECK_REFERENCE(dst);
+
+    LayerCompLayer nodeLayer = { bottom.image, NULL, NULL, NULL };
+    vx_node node = layerCompNode(graph, &nodeLayer, 1, dst);
+    NVXIO_CHECK_REFERENCE(node);
+
+    // dst, then image, mask, alpha and op of every layer: the image of layer 2
+    NVXIO_SAFE_CALL( vxSetParameterByIndex(node, 1 + 4 * 2, (vx_reference)top.image) );
+
+    bool rejected = vxVerifyGraph(graph) != VX_SUCCESS;
+
+    vxReleaseNode(&node);
+    vxReleaseImage(&dst);
+    releaseLayer(bottom);
+    releaseLayer(top);
+    vxReleaseGraph(&graph);
+
+    if (!rejected)
+    {
+        std::cerr << "Gap between layers: the graph was verified" << std::endl;
+        return false;
+    }
+
+    std::cout << "Gap between layers: OK" << std::endl;
+    return true;
+}
+
+}
+
+//
+// main - Application entry point
+//
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        nvxio::Application &app = nvxio::Application::get();
+
+        app.setDescription("This sample checks the LayerComp node against its host implementation");
+        app.init(argc, argv);
+
+        nvxio::ContextGuard context;
+        NVXIO_SAFE_CALL( registerLayerCompKernel(context) );
+
+        const vx_uint8 alphaHalf = 128, alphaLow = 51;
+        const vx_enum opOver = ALPHA_COMP_OVER, opAtop = ALPHA_COMP_ATOP, opXor = ALPHA_COMP_XOR,
+                      opOverPremul = ALPHA_COMP_OVER_PREMUL, opPlus = ALPHA_COMP_PLUS;
+
+        bool ok = true;
+
+        // The bottom layer alone is copied
+        {
+            std::vector<TestLayer> layers(1);
+            createLayer(context, 1, 1, false, &alphaLow, NULL, layers[0]);
+            ok &= runCase(context, "U8, 1 layer", 1, layers);
+        }
+
+        // Every combination of the optional parameters. The background is not opaque,
+        // so the composite alphas differ from pixel to pixel.
+        {
+            std::vector<TestLayer> layers(5);
+            createLayer(context, 1, 1, true, NULL, NULL, layers[0]);
+            createLayer(context, 1, 2, false, &alphaHalf, NULL, layers[1]);
+            createLayer(context, 1, 3, false, NULL, &opAtop, layers[2]);
+            createLayer(context, 1, 4, true, &alphaLow, NULL, layers[3]);
+            createLayer(context, 1, 5, false, &alphaHalf, &opXor, layers[4]);
+            ok &= runCase(context, "U8, 5 layers", 1, layers);
+        }
+
+        // All the layers the node takes
+        {
+            std::vector<TestLayer> layers(LAYER_COMP_MAX_LAYERS);
+            for (vx_uint32 i = 0; i < LAYER_COMP_MAX_LAYERS; ++i)
+            {
+                vx_uint8 alpha = static_cast<vx_uint8>(255 - 29 * i);
+                createLayer(context, 1, i + 1, i % 2 == 1, &alpha, i % 3 == 2 ? &opPlus : &opOver, layers[i]);
+            }
+            ok &= runCase(context, "U8, max layers", 1, layers);
+        }
+
+        // The X channel as the per-pixel alpha of the layers without a mask
+        {
+            std::vector<TestLayer> layers(4);
+            createLayer(context, 4, 1, false, NULL, NULL, layers[0]);
+            createLayer(context, 4, 2, false, NULL, NULL, layers[1]);
+            createLayer(context, 4, 3, true, &alphaHalf, &opAtop, layers[2]);
+            createLayer(context, 4, 4, false, &alphaLow, &opOverPremul, layers[3]);
+            ok &= runCase(context, "RGBX, 4 layers", 4, layers);
+        }
+
+        ok &= runGapCase(context);
+
+        return ok ? nvxio::Application::APP_EXIT_CODE_SUCCESS : nvxio::Application::APP_EXIT_CODE_ERROR;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return nvxio::Application::APP_EXIT_CODE_ERROR;
+    }
+}
@@ -29,18 +29,12 @@
 #include <iostream>
 #include "NVXIO/Application.hpp"
 
-#if !defined USE_OPENCV || !defined USE_NPP
+#ifndef USE_OPENCV
 
 int main(int, char**)
 {
-#ifndef USE_OPENCV
     std::cout << "NVXIO and samples were built without OpenCV support." << std::endl;
     std::cout << "Install OpenCV for Tegra and rebuild the sample." << std::endl;
-#endif
-#ifndef USE_NPP
-    std::cout << "The sample was built without CUDA NPP support." << std::endl;
-    std::cout << "Install CUDA NPP library and rebuild the sample." << std::endl;
-#endif
 
     return nvxio::Application::APP_EXIT_CODE_ERROR;
 }
@@ -58,11 +52,23 @@ int main(int, char**)
 #include <opencv2/highgui/highgui.hpp>
 
 #include "alpha_comp_node.hpp"
+#include "blur_alpha_comp_node.hpp"
+#include "opencv_vx_interop.hpp"
+#include "../common/render_layout.hpp"
 
 #include "NVXIO/Render.hpp"
 #include "NVXIO/SyncTimer.hpp"
 #include "NVXIO/Utility.hpp"
 
+// How the blurred sources are composed
+enum AlphaCompPipeline
+{
+    // Gaussian3x3 nodes with full-frame virtual images between them and the AlphaComp node
+    ALPHA_COMP_PIPELINE_STAGED,
+    // a single BlurAlphaComp host node, the blurred rows never leave the cache
+    ALPHA_COMP_PIPELINE_FUSED
+};
+
 struct EventData
 {
     EventData(): shouldStop(false), pause(false) {}
@@ -132,8 +138,43 @@ int main(int argc, char* argv[])
         app.setDescription("This sample accepts as input two images and performs alpha blending of them");
         app.addOption(0, "img1", "First image", nvxio::OptionHandler::string(&fileName1));
         app.addOption(0, "img2", "Second image", nvxio::OptionHandler::string(&fileName2));
+
+        AlphaCompOp op = ALPHA_COMP_PLUS;
+        AlphaCompBackend backend = ALPHA_COMP_BACKEND_AUTO;
+        AlphaCompPipeline pipeline = ALPHA_COMP_PIPELINE_STAGED;
+
+        app.addOption(0, "op", "Alpha composition operation", nvxio::OptionHandler::oneOf(&op, {
+                          {"over", ALPHA_COMP_OVER},
+                          {"in", ALPHA_COMP_IN},
+                          {"out", ALPHA_COMP_OUT},
+                          {"atop", ALPHA_COMP_ATOP},
+                          {"xor", ALPHA_COMP_XOR},
+                          {"plus", ALPHA_COMP_PLUS},
+                          {"over_premul", ALPHA_COMP_OVER_PREMUL},
+                          {"in_premul", ALPHA_COMP_IN_PREMUL},
+                          {"out_premul", ALPHA_COMP_OUT_PREMUL},
+                          {"atop_premul", ALPHA_COMP_ATOP_PREMUL},
+                          {"xor_premul", ALPHA_COMP_XOR_PREMUL},
+                          {"plus_premul", ALPHA_COMP_PLUS_PREMUL},
+                          {"premul", ALPHA_COMP_PREMUL}
+                      }));
+        app.addOption('b', "backend", "Alpha composition backend of the staged pipeline (the fused one runs on the host)", nvxio::OptionHandler::oneOf(&backend, {
+                          {"auto", ALPHA_COMP_BACKEND_AUTO},
+                          {"npp", ALPHA_COMP_BACKEND_NPP},
+                          {"host", ALPHA_COMP_BACKEND_HOST}
+                      }));
+        app.addOption('p', "pipeline", "Blur and alpha composition pipeline", nvxio::OptionHandler::oneOf(&pipeline, {
+                          {"staged", ALPHA_COMP_PIPELINE_STAGED},
+                          {"fused", ALPHA_COMP_PIPELINE_FUSED}
+                      }));
         app.init(argc, argv);
 
+        if (pipeline == ALPHA_COMP_PIPELINE_FUSED && backend == ALPHA_COMP_BACKEND_NPP)
+        {
+            std::cerr << "Error: The fused pipeline runs on the host only, it can't be used with the npp backend" << std::endl;
+            return nvxio::Application::APP_EXIT_CODE_INVALID_VALUE;
+        }
+
         //
         // Load input images
         //
@@ -173,8 +214,20 @@ int main(int argc, char* argv[])
         vxRegisterLogCallback(context, &myLogCallback, vx_false_e);
         vxDirective(context, VX_DIRECTIVE_ENABLE_PERFORMANCE);
 
+        //
+        // Window layout: src1, dst and src2 side by side
+        //
+
+        vx_uint32 width = static_cast<vx_uint32>(cv_src1.cols);
+        vx_uint32 height = static_cast<vx_uint32>(cv_src1.rows);
+
+        nvx::RenderLayout layout;
+        const vx_uint32 src1View = layout.addGrid(0, 0, 3, 1, width, height);
+        const vx_uint32 dstView = src1View + 1;
+        const vx_uint32 src2View = src1View + 2;
+
         std::unique_ptr<nvxio::Render> renderer(nvxio::createDefaultRender(context, "OpenCV NPP Interop Sample",
-                                                                           3 * cv_src1.cols, cv_src1.rows));
+                                                                           layout.getWidth(), layout.getHeight()));
 
         if (!renderer) {
             std::cerr << "Error: Can't create a renderer." << std::endl;
@@ -185,90 +238,27 @@ int main(int argc, char* argv[])
         renderer->setOnKeyboardEventCallback(eventCallback, &eventData);
 
         //
-        // Import input images into OpenVX context
+        // Create the images
         //
 
-        vx_rectangle_t rect = {
-            0u, 0u,
-            vx_uint32(cv_src1.cols), vx_uint32(cv_src1.rows)
-        };
-
-        vx_imagepatch_addressing_t src1_addr;
-        src1_addr.dim_x = cv_src1.cols;
-        src1_addr.dim_y = cv_src1.rows;
-        src1_addr.stride_x = sizeof(vx_uint8);
-        src1_addr.stride_y = static_cast<vx_int32>(cv_src1.step);
-
-        void *src1_ptrs[] = {
-            cv_src1.data
-        };
-
-        vx_image src1 = vxCreateImageFromHandle(context, VX_DF_IMAGE_U8, &src1_addr, src1_ptrs, VX_MEMORY_TYPE_HOST);
-        NVXIO_CHECK_REFERENCE(src1);
+        // The inputs and the output are views of the displayed mosaic: the graph reads the sources from it
+        // and writes the result into it, so nothing is copied into the mosaic every frame
 
-        vx_imagepatch_addressing_t src2_addr;
-        src2_addr.dim_x = cv_src2.cols;
-        src2_addr.dim_y = cv_src2.rows;
-        src2_addr.stride_x = sizeof(vx_uint8);
-        src2_addr.stride_y = static_cast<vx_int32>(cv_src2.step);
+        layout.create(context, VX_DF_IMAGE_U8);
 
-        void *src2_ptrs[] = {
-            cv_src2.data
-        };
+        vx_image src1 = layout.getViewImage(src1View);
+        vx_image src2 = layout.getViewImage(src2View);
+        vx_image dst = layout.getViewImage(dstView);
 
-        vx_image src2 = vxCreateImageFromHandle(context, VX_DF_IMAGE_U8, &src2_addr, src2_ptrs, VX_MEMORY_TYPE_HOST);
-        NVXIO_CHECK_REFERENCE(src2);
+        // The loaded images are copied into their views once
 
-        //
-        // Create output image
-        //
-
-        vx_uint32 width = 0, height = 0;
-        NVXIO_SAFE_CALL( vxQueryImage(src1, VX_IMAGE_ATTRIBUTE_WIDTH, &width, sizeof(width)) );
-        NVXIO_SAFE_CALL( vxQueryImage(src1, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height)) );
-
-        vx_image dst = vxCreateImage(context, width, height, VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(dst);
-
-        vx_image demoImg = vxCreateImage(context, 3 * width, height, VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(demoImg);
-
-        vx_rectangle_t leftRect;
-        NVXIO_SAFE_CALL( vxGetValidRegionImage(dst, &leftRect) );
-
-        vx_rectangle_t middleRect;
-        middleRect.start_x = leftRect.end_x;
-        middleRect.start_y = leftRect.start_y;
-        middleRect.end_x = 2 * leftRect.end_x;
-        middleRect.end_y = leftRect.end_y;
-
-        vx_rectangle_t rightRect;
-        rightRect.start_x = middleRect.end_x;
-        rightRect.start_y = leftRect.start_y;
-        rightRect.end_x = 3 * leftRect.end_x;
-        rightRect.end_y = leftRect.end_y;
-
-        vx_image leftRoi = vxCreateImageFromROI(demoImg, &leftRect);
-        NVXIO_CHECK_REFERENCE(leftRoi);
-        vx_image middleRoi = vxCreateImageFromROI(demoImg, &middleRect);
-        NVXIO_CHECK_REFERENCE(middleRoi);
-        vx_image rightRoi = vxCreateImageFromROI(demoImg, &rightRect);
-        NVXIO_CHECK_REFERENCE(rightRoi);
-
-        //
-        // Notify the framework that we are going to access imported images
-        //
-
-        vx_map_id src1_map_id;
-        void *src1_ptr;
-        NVXIO_SAFE_CALL( vxMapImagePatch(src1, &rect, 0, &src1_map_id, &src1_addr, &src1_ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
-
-        vx_map_id src2_map_id;
-        void *src2_ptr;
-        NVXIO_SAFE_CALL( vxMapImagePatch(src2, &rect, 0, &src2_map_id, &src2_addr, &src2_ptr, VX_READ_ONLY, VX_MEMORY_TYPE_HOST, 0) );
+        {
+            VxImageMatView view1(src1, VX_WRITE_ONLY);
+            cv_src1.copyTo(view1.mat());
 
-        NVXIO_SAFE_CALL( vxUnmapImagePatch(src1, src1_map_id) );
-        NVXIO_SAFE_CALL( vxUnmapImagePatch(src2, src2_map_id) );
+            VxImageMatView view2(src2, VX_WRITE_ONLY);
+            cv_src2.copyTo(view2.mat());
+        }
 
         //
         // Create scalars
@@ -276,7 +266,8 @@ int main(int argc, char* argv[])
 
         vx_uint8 alpha1 = 255;
         vx_uint8 alpha2 = 255 - alpha1;
-        vx_enum alphaOp = static_cast<vx_enum>(NPPI_OP_ALPHA_PLUS);
+        vx_enum alphaOp = static_cast<vx_enum>(op);
+        vx_enum alphaBackend = static_cast<vx_enum>(backend);
 
         vx_scalar s_alpha1 = vxCreateScalar(context, VX_TYPE_UINT8, &alpha1);
         NVXIO_CHECK_REFERENCE(s_alpha1);
@@ -287,11 +278,23 @@ int main(int argc, char* argv[])
         vx_scalar s_alphaOp = vxCreateScalar(context, VX_TYPE_ENUM, &alphaOp);
         NVXIO_CHECK_REFERENCE(s_alphaOp);
 
+        vx_scalar s_alphaBackend = vxCreateScalar(context, VX_TYPE_ENUM, &alphaBackend);
+        NVXIO_CHECK_REFERENCE(s_alphaBackend);
+
         //
         // Register user defined kernels
         //
 
-        registerAlphaCompKernel(context);
+        bool fusedPipeline = pipeline == ALPHA_COMP_PIPELINE_FUSED;
+
+        if (fusedPipeline)
+        {
+            registerBlurAlphaCompKernel(context);
+        }
+        else
+        {
+            registerAlphaCompKernel(context);
+        }
 
         //
         // Create a processing graph
@@ -300,32 +303,46 @@ int main(int argc, char* argv[])
         vx_graph graph = vxCreateGraph(context);
         NVXIO_CHECK_REFERENCE(graph);
 
-        //
-        // Virtual images for internal processing
-        //
+        vx_node blur1_node = nullptr, blur2_node = nullptr, alphaComp_node = nullptr, blurAlphaComp_node = nullptr;
 
-        vx_image src1_blurred = vxCreateVirtualImage(graph, width, height, VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(src1_blurred);
+        if (fusedPipeline)
+        {
+            //
+            // Fused blurring and alpha channel (semi-transparency) node, there are no intermediate images
+            //
 
-        vx_image src2_blurred = vxCreateVirtualImage(graph, width, height, VX_DF_IMAGE_U8);
-        NVXIO_CHECK_REFERENCE(src2_blurred);
+            blurAlphaComp_node = blurAlphaCompNode(graph, src1, s_alpha1, src2, s_alpha2, dst, s_alphaOp);
+            NVXIO_CHECK_REFERENCE(blurAlphaComp_node);
+        }
+        else
+        {
+            //
+            // Virtual images for internal processing
+            //
 
-        //
-        // Gaussian blurring nodes
-        //
+            vx_image src1_blurred = vxCreateVirtualImage(graph, width, height, VX_DF_IMAGE_U8);
+            NVXIO_CHECK_REFERENCE(src1_blurred);
 
-        vx_node blur1_node = vxGaussian3x3Node(graph, src1, src1_blurred);
-        NVXIO_CHECK_REFERENCE(blur1_node);
+            vx_image src2_blurred = vxCreateVirtualImage(graph, width, height, VX_DF_IMAGE_U8);
+            NVXIO_CHECK_REFERENCE(src2_blurred);
 
-        vx_node blur2_node = vxGaussian3x3Node(graph, src2, src2_blurred);
-        NVXIO_CHECK_REFERENCE(blur2_node);
+            //
+            // Gaussian blurring nodes
+            //
 
-        //
-        // Alpha channel (semi-transparency) node
-        //
+            blur1_node = vxGaussian3x3Node(graph, src1, src1_blurred);
+            NVXIO_CHECK_REFERENCE(blur1_node);
+
+            blur2_node = vxGaussian3x3Node(graph, src2, src2_blurred);
+            NVXIO_CHECK_REFERENCE(blur2_node);
 
-        vx_node alphaComp_node = alphaCompNode(graph, src1_blurred, s_alpha1, src2_blurred, s_alpha2, dst, s_alphaOp);
-        NVXIO_CHECK_REFERENCE(alphaComp_node);
+            //
+            // Alpha channel (semi-transparency) node
+            //
+
+            alphaComp_node = alphaCompNode(graph, src1_blurred, s_alpha1, src2_blurred, s_alpha2, dst, s_alphaOp, s_alphaBackend);
+            NVXIO_CHECK_REFERENCE(alphaComp_node);
+        }
 
         //
         // Ensure highest graph optimization level
@@ -404,14 +421,22 @@ int main(int argc, char* argv[])
                 {
                     std::cerr << "Graph processing failed (see LOG)" << std::endl;
 
-                    NVXIO_SAFE_CALL( vxQueryNode(blur1_node, VX_NODE_ATTRIBUTE_STATUS, &status, sizeof(status)) );
-                    std::cout << "\t Gaussian Blur 1 Status : " << (status == VX_SUCCESS ? "SUCCESS" : "FAILED") << std::endl;
+                    if (fusedPipeline)
+                    {
+                        NVXIO_SAFE_CALL( vxQueryNode(blurAlphaComp_node, VX_NODE_ATTRIBUTE_STATUS, &status, sizeof(status)) );
+                        std::cout << "\t Blur Alpha Comp Status : " << (status == VX_SUCCESS ? "SUCCESS" : "FAILED") << std::endl;
+                    }
+                    else
+                    {
+                        NVXIO_SAFE_CALL( vxQueryNode(blur1_node, VX_NODE_ATTRIBUTE_STATUS, &status, sizeof(status)) );
+                        std::cout << "\t Gaussian Blur 1 Status : " << (status == VX_SUCCESS ? "SUCCESS" : "FAILED") << std::endl;
 
-                    NVXIO_SAFE_CALL( vxQueryNode(blur2_node, VX_NODE_ATTRIBUTE_STATUS, &status, sizeof(status)) );
-                    std::cout << "\t Gaussian Blur 2 Status : " << (status == VX_SUCCESS ? "SUCCESS" : "FAILED") << std::endl;
+                        NVXIO_SAFE_CALL( vxQueryNode(blur2_node, VX_NODE_ATTRIBUTE_STATUS, &status, sizeof(status)) );
+                        std::cout << "\t Gaussian Blur 2 Status : " << (status == VX_SUCCESS ? "SUCCESS" : "FAILED") << std::endl;
 
-                    NVXIO_SAFE_CALL( vxQueryNode(alphaComp_node, VX_NODE_ATTRIBUTE_STATUS, &status, sizeof(status)) );
-                    std::cout << "\t Alpha Comp Status : " << (status == VX_SUCCESS ? "SUCCESS" : "FAILED") << std::endl;
+                        NVXIO_SAFE_CALL( vxQueryNode(alphaComp_node, VX_NODE_ATTRIBUTE_STATUS, &status, sizeof(status)) );
+                        std::cout << "\t Alpha Comp Status : " << (status == VX_SUCCESS ? "SUCCESS" : "FAILED") << std::endl;
+                    }
 
                     break;
                 }
@@ -425,25 +450,29 @@ int main(int argc, char* argv[])
                 NVXIO_SAFE_CALL( vxQueryGraph(graph, VX_GRAPH_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
                 std::cout << "Graph Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(blur1_node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Gaussian Blur 1 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
-
-                NVXIO_SAFE_CALL( vxQueryNode(blur2_node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Gaussian Blur 2 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                if (fusedPipeline)
+                {
+                    NVXIO_SAFE_CALL( vxQueryNode(blurAlphaComp_node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Blur Alpha Comp Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                }
+                else
+                {
+                    NVXIO_SAFE_CALL( vxQueryNode(blur1_node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Gaussian Blur 1 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( vxQueryNode(alphaComp_node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-                std::cout << "\t Alpha Comp Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                    NVXIO_SAFE_CALL( vxQueryNode(blur2_node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Gaussian Blur 2 Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-                NVXIO_SAFE_CALL( nvxuCopyImage(context, src1, leftRoi) );
-                NVXIO_SAFE_CALL( nvxuCopyImage(context, dst, middleRoi) );
-                NVXIO_SAFE_CALL( nvxuCopyImage(context, src2, rightRoi) );
+                    NVXIO_SAFE_CALL( vxQueryNode(alphaComp_node, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+                    std::cout << "\t Alpha Comp Time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+                }
             }
 
             //
             // Show results
             //
 
-            renderer->putImage(demoImg);
+            renderer->putImage(layout.getMosaic());
 
             double total_ms = totalTimer.toc();
 
@@ -468,10 +497,7 @@ int main(int argc, char* argv[])
         //
 
         renderer->close();
-        vxReleaseImage(&demoImg);
-        vxReleaseImage(&leftRoi);
-        vxReleaseImage(&middleRoi);
-        vxReleaseImage(&rightRoi);
+        layout.release();
     }
     catch (const std::exception& e)
     {
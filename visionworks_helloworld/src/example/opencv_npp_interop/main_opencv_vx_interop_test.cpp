@@ -0,0 +1,239 @@
+/*
+# Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <iostream>
+#include "NVXIO/Application.hpp"
+
+#ifndef USE_OPENCV
+
+int main(int, char**)
+{
+    std::cout << "NVXIO and samples were built without OpenCV support." << std::endl;
+    std::cout << "Install OpenCV for Tegra and rebuild the sample." << std::endl;
+
+    return nvxio::Application::APP_EXIT_CODE_ERROR;
+}
+
+#else
+
+#include <string>
+
+#include <NVX/nvx.h>
+
+#include <opencv2/core/core.hpp>
+
+#include "opencv_vx_interop.hpp"
+
+#include "NVXIO/Utility.hpp"
+
+//
+// Test of the cv::Mat / vx_image bridge: VxMatImage over ROIs of 1, 3 and 4-channel matrices,
+// read and written through VxImageMatView, a round trip of VxMatImage::swap() and create()
+// from the image's own matrix.
+//
+
+namespace {
+
+bool sameMats(const cv::Mat& a, const cv::Mat& b)
+{
+    return a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0;
+}
+
+bool check(bool condition, const std::string& name, const char* what)
+{
+    if (!condition)
+        std::cerr << name << ": " << what << std::endl;
+    return condition;
+}
+
+// An ROI which starts inside a row and doesn't span the whole step of its matrix
+cv::Mat makeRoi(int type, cv::Mat& parent)
+{
+    parent.create(48, 67, type);
+    cv::randu(parent, cv::Scalar::all(0), cv::Scalar::all(256));
+    return parent(cv::Rect(5, 3, 41, 29));
+}
+
+bool testFormat(vx_context context, int type, const std::string& name)
+{
+    cv::Mat parent;
+    cv::Mat roi = makeRoi(type, parent);
+
+    bool ok = true;
+
+    {
+        VxMatImage image(context, roi);
+
+        vx_df_image format = 0;
+        vx_uint32 width = 0, height = 0;
+        NVXIO_SAFE_CALL( vxQueryImage(image, VX_IMAGE_ATTRIBUTE_FORMAT, &format, sizeof(format)) );
+        NVXIO_SAFE_CALL( vxQueryImage(image, VX_IMAGE_ATTRIBUTE_WIDTH, &width, sizeof(width)) );
+        NVXIO_SAFE_CALL( vxQueryImage(image, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height)) );
+
+        ok &= check(format == getVxImageFormat(type) && getCvMatType(format) == type, name, "wrong format");
+        ok &= check(width == static_cast<vx_uint32>(roi.cols) && height == static_cast<vx_uint32>(roi.rows), name, "wrong size");
+        ok &= check(image.mat().data == roi.data && image.mat().step == roi.step, name, "the matrix was copied");
+
+        {
+            VxImageMatView view(image, VX_READ_ONLY);
+            ok &= check(sameMats(view.mat(), roi), name, "the image differs from the ROI");
+        }
+
+        // A region of the image is mapped at the same pixels of the ROI
+        {
+            vx_rectangle_t rect = { 7u, 2u, 30u, 21u };
+            VxImageMatView view(image, rect, VX_READ_ONLY);
+            ok &= check(sameMats(view.mat(), roi(cv::Rect(7, 2, 23, 19))), name, "the region differs from the ROI");
+        }
+    }
+
+    // The image keeps a temporary matrix alive, and the writes through a view land in it
+    {
+        VxMatImage image(context, roi.clone());
+
+        {
+            VxImageMatView view(image, VX_WRITE_ONLY);
+            view.mat().setTo(cv::Scalar::all(17));
+        }
+
+        ok &= check(sameMats(image.mat(), cv::Mat(roi.size(), type, cv::Scalar::all(17))), name,
+                    "the written pixels didn't reach the matrix");
+    }
+
+    if (ok)
+        std::cout << name << ": OK" << std::endl;
+    return ok;
+}
+
+// Ping-pong buffering: writes go to the matrix the image refers to, swap() hands it back
+bool testSwap(vx_context context)
+{
+    const std::string name = "swap";
+
+    cv::Mat parentA, parentB;
+    cv::Mat a = makeRoi(CV_8UC4, parentA);
+    cv::Mat b = makeRoi(CV_8UC4, parentB);
+
+    cv::Mat originalB = b.clone();
+
+    bool ok = true;
+
+    VxMatImage image(context, a);
+
+    {
+        VxImageMatView view(image, VX_WRITE_ONLY);
+        view.mat().setTo(cv::Scalar(1, 2, 3, 4));
+    }
+
+    cv::Mat prev = image.swap(b);
+
+    ok &= check(prev.data == a.data, name, "swap() returned another matrix");
+    ok &= check(image.mat().data == b.data, name, "the image doesn't refer to the new matrix");
+    ok &= check(sameMats(a, cv::Mat(a.size(), a.type(), cv::Scalar(1, 2, 3, 4))), name, "the written pixels didn't reach the matrix");
+
+    {
+        VxImageMatView view(image, VX_READ_ONLY);
+        ok &= check(sameMats(view.mat(), originalB), name, "the image doesn't read the new matrix");
+    }
+
+    // And back
+    prev = image.swap(a);
+
+    ok &= check(prev.data == b.data && sameMats(b, originalB), name, "the second matrix was modified");
+
+    {
+        VxImageMatView view(image, VX_READ_ONLY);
+        ok &= check(sameMats(view.mat(), a), name, "the image doesn't read the first matrix again");
+    }
+
+    if (ok)
+        std::cout << name << ": OK" << std::endl;
+    return ok;
+}
+
+// create() from the matrix the image already refers to, which release() clears on the way
+bool testRecreate(vx_context context)
+{
+    const std::string name = "recreate";
+
+    cv::Mat parent;
+    cv::Mat roi = makeRoi(CV_8UC3, parent);
+
+    bool ok = true;
+
+    VxMatImage image(context, roi);
+    image.create(context, image.mat());
+
+    ok &= check(image.mat().data == roi.data && image.mat().step == roi.step, name, "the image lost its matrix");
+
+    {
+        VxImageMatView view(image, VX_READ_ONLY);
+        ok &= check(sameMats(view.mat(), roi), name, "the image differs from the ROI");
+    }
+
+    if (ok)
+        std::cout << name << ": OK" << std::endl;
+    return ok;
+}
+
+}
+
+//
+// main - Application entry point
+//
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        nvxio::Application &app = nvxio::Application::get();
+
+        app.setDescription("This sample checks the zero-copy bridge between cv::Mat and vx_image");
+        app.init(argc, argv);
+
+        nvxio::ContextGuard context;
+
+        bool ok = true;
+
+        ok &= testFormat(context, CV_8UC1, "CV_8UC1");
+        ok &= testFormat(context, CV_8UC3, "CV_8UC3");
+        ok &= testFormat(context, CV_8UC4, "CV_8UC4");
+        ok &= testSwap(context);
+        ok &= testRecreate(context);
+
+        return ok ? nvxio::Application::APP_EXIT_CODE_SUCCESS : nvxio::Application::APP_EXIT_CODE_ERROR;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return nvxio::Application::APP_EXIT_CODE_ERROR;
+    }
+}
+
+#endif // USE_OPENCV
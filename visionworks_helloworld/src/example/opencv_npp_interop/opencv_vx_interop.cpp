@@ -0,0 +1,169 @@
+#ifdef USE_OPENCV
+
+#include "opencv_vx_interop.hpp"
+
+#include "NVXIO/Utility.hpp"
+
+vx_df_image getVxImageFormat(int cvType)
+{
+    switch (cvType)
+    {
+    case CV_8UC1:
+        return VX_DF_IMAGE_U8;
+    case CV_8UC3:
+        return VX_DF_IMAGE_RGB;
+    case CV_8UC4:
+        return VX_DF_IMAGE_RGBX;
+    case CV_16UC1:
+        return VX_DF_IMAGE_U16;
+    case CV_16SC1:
+        return VX_DF_IMAGE_S16;
+    case CV_32SC1:
+        return VX_DF_IMAGE_S32;
+    }
+
+    return 0;
+}
+
+int getCvMatType(vx_df_image format)
+{
+    switch (format)
+    {
+    case VX_DF_IMAGE_U8:
+        return CV_8UC1;
+    case VX_DF_IMAGE_RGB:
+        return CV_8UC3;
+    case VX_DF_IMAGE_RGBX:
+        return CV_8UC4;
+    case VX_DF_IMAGE_U16:
+        return CV_16UC1;
+    case VX_DF_IMAGE_S16:
+        return CV_16SC1;
+    case VX_DF_IMAGE_S32:
+        return CV_32SC1;
+    }
+
+    return -1;
+}
+
+//
+// VxMatImage
+//
+
+VxMatImage::VxMatImage() : image_(NULL)
+{
+}
+
+VxMatImage::VxMatImage(vx_context context, const cv::Mat& mat) : image_(NULL)
+{
+    create(context, mat);
+}
+
+VxMatImage::~VxMatImage()
+{
+    release();
+}
+
+void VxMatImage::create(vx_context context, const cv::Mat& mat)
+{
+    // mat may be mat_ itself (img.create(context, img.mat())), which release() clears,
+    // so a header of its own keeps the matrix and its memory alive
+    cv::Mat source = mat;
+
+    vx_df_image format = getVxImageFormat(source.type());
+    NVXIO_ASSERT(format != 0 && !source.empty());
+
+    release();
+
+    vx_imagepatch_addressing_t addr;
+    addr.dim_x = source.cols;
+    addr.dim_y = source.rows;
+    addr.stride_x = static_cast<vx_int32>(source.elemSize());
+    addr.stride_y = static_cast<vx_int32>(source.step);
+
+    void *ptrs[] = {
+        source.data
+    };
+
+    image_ = vxCreateImageFromHandle(context, format, &addr, ptrs, VX_MEMORY_TYPE_HOST);
+    NVXIO_CHECK_REFERENCE(image_);
+
+    mat_ = source;
+}
+
+void VxMatImage::release()
+{
+    // The image goes first, it may still refer to the memory of the matrix
+    if (image_)
+        vxReleaseImage(&image_);
+
+    mat_.release();
+}
+
+cv::Mat VxMatImage::swap(const cv::Mat& mat)
+{
+    NVXIO_ASSERT(image_ != NULL);
+    NVXIO_ASSERT(mat.size() == mat_.size() && mat.type() == mat_.type() && mat.step == mat_.step);
+
+    void *newPtrs[] = {
+        mat.data
+    };
+    void *prevPtrs[] = {
+        NULL
+    };
+
+    NVXIO_SAFE_CALL( vxSwapImageHandle(image_, newPtrs, prevPtrs, 1) );
+
+    cv::Mat prev = mat_;
+    mat_ = mat;
+
+    return prev;
+}
+
+//
+// VxImageMatView
+//
+
+VxImageMatView::VxImageMatView(vx_image image, vx_enum usage, bool validRegion) : image_(image), mapId_(0)
+{
+    vx_rectangle_t rect = {};
+
+    if (validRegion)
+    {
+        NVXIO_SAFE_CALL( vxGetValidRegionImage(image, &rect) );
+    }
+    else
+    {
+        NVXIO_SAFE_CALL( vxQueryImage(image, VX_IMAGE_ATTRIBUTE_WIDTH, &rect.end_x, sizeof(rect.end_x)) );
+        NVXIO_SAFE_CALL( vxQueryImage(image, VX_IMAGE_ATTRIBUTE_HEIGHT, &rect.end_y, sizeof(rect.end_y)) );
+    }
+
+    map(rect, usage);
+}
+
+VxImageMatView::VxImageMatView(vx_image image, const vx_rectangle_t& rect, vx_enum usage) : image_(image), mapId_(0)
+{
+    map(rect, usage);
+}
+
+VxImageMatView::~VxImageMatView()
+{
+    vxUnmapImagePatch(image_, mapId_);
+}
+
+void VxImageMatView::map(const vx_rectangle_t& rect, vx_enum usage)
+{
+    vx_df_image format = 0;
+    NVXIO_SAFE_CALL( vxQueryImage(image_, VX_IMAGE_ATTRIBUTE_FORMAT, &format, sizeof(format)) );
+
+    int type = getCvMatType(format);
+    NVXIO_ASSERT(type >= 0);
+
+    vx_imagepatch_addressing_t addr;
+    void *ptr = NULL;
+    NVXIO_SAFE_CALL( vxMapImagePatch(image_, &rect, 0, &mapId_, &addr, &ptr, usage, VX_MEMORY_TYPE_HOST, 0) );
+
+    mat_ = cv::Mat(addr.dim_y, addr.dim_x, type, ptr, addr.stride_y);
+}
+
+#endif // USE_OPENCV
@@ -0,0 +1,84 @@
+#ifndef OPENCV_VX_INTEROP_HPP
+#define OPENCV_VX_INTEROP_HPP
+
+#ifdef USE_OPENCV
+
+#include <opencv2/core/core.hpp>
+
+#include <NVX/nvx.h>
+
+//
+// Zero-copy bridge between cv::Mat and vx_image.
+//
+// Only single-plane formats are supported:
+//   CV_8UC1 - VX_DF_IMAGE_U8, CV_8UC3 - VX_DF_IMAGE_RGB, CV_8UC4 - VX_DF_IMAGE_RGBX,
+//   CV_16UC1 - VX_DF_IMAGE_U16, CV_16SC1 - VX_DF_IMAGE_S16, CV_32SC1 - VX_DF_IMAGE_S32.
+// The channel order is not converted: a BGR cv::Mat becomes an "RGB" image with swapped channels.
+//
+
+// 0 if the type of the matrix has no vx_df_image counterpart
+vx_df_image getVxImageFormat(int cvType);
+// -1 if the format has no single-plane cv::Mat counterpart
+int getCvMatType(vx_df_image format);
+
+//
+// vx_image created from the memory of a cv::Mat (ROIs included, the step is kept).
+// The image holds a reference to the matrix, so the memory stays valid as long as the image exists,
+// whatever happens to the cv::Mat the image was created from.
+//
+class VxMatImage
+{
+public:
+    VxMatImage();
+    VxMatImage(vx_context context, const cv::Mat& mat);
+    ~VxMatImage();
+
+    void create(vx_context context, const cv::Mat& mat);
+    void release();
+
+    vx_image get() const { return image_; }
+    operator vx_image() const { return image_; }
+
+    // The matrix the image currently refers to. Access it only while the image isn't used by a graph.
+    const cv::Mat& mat() const { return mat_; }
+
+    // Makes the image refer to another matrix of the same size, type and step (ping-pong buffering)
+    // and returns the previous one. Nothing is copied, and the framework gives up any cached copy.
+    cv::Mat swap(const cv::Mat& mat);
+
+private:
+    VxMatImage(const VxMatImage&);
+    VxMatImage& operator=(const VxMatImage&);
+
+    vx_image image_;
+    cv::Mat mat_;
+};
+
+//
+// cv::Mat view of a vx_image, valid while the object exists (scoped vxMapImagePatch).
+//
+class VxImageMatView
+{
+public:
+    // The whole image, or its valid region when validRegion is set
+    VxImageMatView(vx_image image, vx_enum usage, bool validRegion = false);
+    VxImageMatView(vx_image image, const vx_rectangle_t& rect, vx_enum usage);
+    ~VxImageMatView();
+
+    cv::Mat& mat() { return mat_; }
+    const cv::Mat& mat() const { return mat_; }
+
+private:
+    VxImageMatView(const VxImageMatView&);
+    VxImageMatView& operator=(const VxImageMatView&);
+
+    void map(const vx_rectangle_t& rect, vx_enum usage);
+
+    vx_image image_;
+    vx_map_id mapId_;
+    cv::Mat mat_;
+};
+
+#endif // USE_OPENCV
+
+#endif
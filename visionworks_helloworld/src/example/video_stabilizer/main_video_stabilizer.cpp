@@ -32,6 +32,7 @@
 #include <string>
 #include <memory>
 
+#include <VX/vxu.h>
 #include <NVX/nvx.h>
 #include <NVX/nvx_timer.hpp>
 
@@ -42,6 +43,7 @@
 #include <NVXIO/Utility.hpp>
 
 #include "stabilizer.hpp"
+#include "offline_stabilizer.hpp"
 
 struct EventData
 {
@@ -125,6 +127,9 @@ int main(int argc, char* argv[])
 
         unsigned numOfSmoothingFrames = 5;
         float cropMargin = 0.07f;
+        nvx::VideoStabilizer::FrameStorage frameStorage = nvx::VideoStabilizer::FRAME_STORAGE_RGBX;
+        std::string offlineOutputPath;
+        nvx::OfflineVideoStabilizer::OfflineStabilizerParams offlineParams;
 
         app.setDescription("This demo demonstrates Video Stabilization algorithm");
         app.addOption('s', "source", "Input URI", nvxio::OptionHandler::string(&videoFilePath));
@@ -132,6 +137,19 @@ int main(int argc, char* argv[])
                       nvxio::OptionHandler::unsignedInteger(&numOfSmoothingFrames, nvxio::ranges::atLeast(1u) & nvxio::ranges::atMost(6u)));
         app.addOption(0, "crop", "Crop margin for stabilized frames. If it is negative then the frame cropping is turned off",
                       nvxio::OptionHandler::real(&cropMargin, nvxio::ranges::lessThan(0.5f)));
+        app.addOption(0, "storage", "Storage format of the delayed frames",
+                      nvxio::OptionHandler::oneOf(&frameStorage, {
+                          {"rgbx", nvx::VideoStabilizer::FRAME_STORAGE_RGBX},
+                          {"nv12", nvx::VideoStabilizer::FRAME_STORAGE_NV12},
+                      }));
+        app.addOption(0, "offline", "Stabilize the whole source offline and write the result to the given video file",
+                      nvxio::OptionHandler::string(&offlineOutputPath));
+        app.addOption(0, "threads", "Number of worker threads for the offline mode (0 - all cores)",
+                      nvxio::OptionHandler::unsignedInteger(&offlineParams.numThreads_));
+        app.addOption(0, "smoothing", "Strength of the trajectory smoothing of the offline mode, in frames",
+                      nvxio::OptionHandler::real(&offlineParams.smoothingRadius_, nvxio::ranges::moreThan(0.0f)));
+        app.addOption(0, "chunk", "Number of frames estimated by a worker of the offline mode at a time",
+                      nvxio::OptionHandler::unsignedInteger(&offlineParams.chunkSize_, nvxio::ranges::atLeast(2u)));
         app.init(argc, argv);
 
         //
@@ -142,6 +160,23 @@ int main(int argc, char* argv[])
         vxRegisterLogCallback(context, &nvxio::stdoutLogCallback, vx_false_e);
         vxDirective(context, VX_DIRECTIVE_ENABLE_PERFORMANCE);
 
+        //
+        // Offline mode: no rendering, the result is written to a file
+        //
+
+        if (!offlineOutputPath.empty())
+        {
+            offlineParams.cropMargin_ = cropMargin;
+
+            nvx::OfflineVideoStabilizer offlineStabilizer(context, offlineParams);
+            if (!offlineStabilizer.run(videoFilePath, offlineOutputPath))
+                return nvxio::Application::APP_EXIT_CODE_NO_RESOURCE;
+
+            offlineStabilizer.printPerfs();
+
+            return nvxio::Application::APP_EXIT_CODE_SUCCESS;
+        }
+
         //
         // Create FrameSource and Render
         //
@@ -186,17 +221,10 @@ int main(int argc, char* argv[])
                                        demoImgHeight, VX_DF_IMAGE_RGBX);
         NVXIO_CHECK_REFERENCE(demoImg);
 
-        vx_image frameExemplar = vxCreateImage(context,
-                                               sourceParams.frameWidth, sourceParams.frameHeight, VX_DF_IMAGE_RGBX);
-        vx_size orig_frame_delay_size = numOfSmoothingFrames + 2; //must have such size to be synchronized with the stabilized frames
-        vx_delay orig_frame_delay = vxCreateDelay(context, (vx_reference)frameExemplar, orig_frame_delay_size);
-        NVXIO_CHECK_REFERENCE(orig_frame_delay);
-        NVXIO_SAFE_CALL( nvx::initDelayOfImages(context, orig_frame_delay) );
-        NVXIO_SAFE_CALL(vxReleaseImage(&frameExemplar));
-
-        vx_image frame = (vx_image)vxGetReferenceFromDelay(orig_frame_delay, 0);
-        vx_image lastFrame = (vx_image)vxGetReferenceFromDelay(orig_frame_delay,
-                                                               1 - static_cast<vx_int32>(orig_frame_delay_size));
+        // The first frame is the only one fetched outside of the stabilizer's frame ring
+        vx_image firstFrame = vxCreateImage(context,
+                                            sourceParams.frameWidth, sourceParams.frameHeight, VX_DF_IMAGE_RGBX);
+        NVXIO_CHECK_REFERENCE(firstFrame);
 
         //
         // Create VideoStabilizer instance
@@ -205,13 +233,14 @@ int main(int argc, char* argv[])
         nvx::VideoStabilizer::VideoStabilizerParams params;
         params.numOfSmoothingFrames_ = numOfSmoothingFrames;
         params.cropMargin_ = cropMargin;
+        params.frameStorage_ = frameStorage;
         std::unique_ptr<nvx::VideoStabilizer> stabilizer(nvx::VideoStabilizer::createImageBasedVStab(context, params));
 
         nvxio::FrameSource::FrameStatus frameStatus;
 
         do
         {
-            frameStatus = source->fetch(frame);
+            frameStatus = source->fetch(firstFrame);
         } while (frameStatus == nvxio::FrameSource::TIMEOUT);
 
         if (frameStatus == nvxio::FrameSource::CLOSED)
@@ -220,10 +249,15 @@ int main(int argc, char* argv[])
             return nvxio::Application::APP_EXIT_CODE_NO_FRAMESOURCE;
         }
 
-        stabilizer->init(frame);
+        stabilizer->init(firstFrame);
 
         vx_rectangle_t leftRect;
-        NVXIO_SAFE_CALL( vxGetValidRegionImage(frame, &leftRect) );
+        NVXIO_SAFE_CALL( vxGetValidRegionImage(firstFrame, &leftRect) );
+        NVXIO_SAFE_CALL( vxReleaseImage(&firstFrame) );
+
+        // Subsequent frames are fetched directly into the stabilizer's frame ring
+        vx_image frame = stabilizer->getInputFrame();
+        frameStatus = source->fetch(frame);
 
         vx_rectangle_t rightRect;
         rightRect.start_x = leftRect.end_x;
@@ -257,14 +291,22 @@ int main(int argc, char* argv[])
 
                 nvx::Timer procTimer;
                 procTimer.tic();
-                stabilizer->process(frame);
+                if (frameStatus == nvxio::FrameSource::OK)
+                    stabilizer->process(frame);
                 proc_ms = procTimer.toc();
 
-                NVXIO_SAFE_CALL( vxAgeDelay(orig_frame_delay) );
-
                 vx_image stabImg = stabilizer->getStabilizedFrame();
                 NVXIO_SAFE_CALL( nvxuCopyImage(context, stabImg, rightRoi) );
-                NVXIO_SAFE_CALL( nvxuCopyImage(context, lastFrame, leftRoi) );
+
+                vx_image origImg = stabilizer->getOriginalFrame();
+                if (frameStorage == nvx::VideoStabilizer::FRAME_STORAGE_NV12)
+                {
+                    NVXIO_SAFE_CALL( vxuColorConvert(context, origImg, leftRoi) );
+                }
+                else
+                {
+                    NVXIO_SAFE_CALL( nvxuCopyImage(context, origImg, leftRoi) );
+                }
 
                 //
                 // Print performance results
@@ -276,6 +318,7 @@ int main(int argc, char* argv[])
                 // Read frame
                 //
 
+                frame = stabilizer->getInputFrame();
                 frameStatus = source->fetch(frame);
 
                 if (frameStatus == nvxio::FrameSource::TIMEOUT)
@@ -318,7 +361,6 @@ int main(int argc, char* argv[])
         vxReleaseImage(&demoImg);
         vxReleaseImage(&leftRoi);
         vxReleaseImage(&rightRoi);
-        vxReleaseDelay(&orig_frame_delay);
     }
     catch (const std::exception& e)
     {
@@ -0,0 +1,770 @@
+#include "offline_stabilizer.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <VX/vxu.h>
+#include <NVX/nvx.h>
+#include <NVX/nvx_timer.hpp>
+
+#include <NVXIO/FrameSource.hpp>
+#include <NVXIO/Render.hpp>
+#include <NVXIO/Utility.hpp>
+
+#include "vstab_nodes.hpp"
+
+namespace
+{
+    // Same tracker configuration as the real-time stabilizer
+    const vx_size PYR_LEVELS = 6;
+    const vx_float32 HARRIS_K = 0.04f;
+    const vx_float32 HARRIS_THRESH = 100.0f;
+    const vx_uint32 HARRIS_CELL_SIZE = 18;
+    const vx_uint32 LK_NUM_ITERS = 5;
+    const vx_size LK_WIN_SIZE = 10;
+    const vx_size MAX_POINTS = 1000;
+
+    template <typename T>
+    class BlockingQueue
+    {
+    public:
+        void push(T item)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                items_.push_back(item);
+            }
+            cond_.notify_one();
+        }
+
+        T pop()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return !items_.empty(); });
+
+            T item = items_.front();
+            items_.pop_front();
+            return item;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::deque<T> items_;
+    };
+
+    // First exception thrown by the threads of a pass, rethrown once they are joined.
+    // An exception must not leave a std::thread, it would call std::terminate.
+    class WorkerErrors
+    {
+    public:
+        void capture()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+                error_ = std::current_exception();
+        }
+
+        bool failed()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return error_ != nullptr;
+        }
+
+        void rethrow()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error_)
+                std::rethrow_exception(error_);
+        }
+
+    private:
+        std::mutex mutex_;
+        std::exception_ptr error_;
+    };
+
+    vx_image fetchFrame(nvxio::FrameSource& source, vx_image frame)
+    {
+        nvxio::FrameSource::FrameStatus status;
+
+        do
+        {
+            status = source.fetch(frame);
+        } while (status == nvxio::FrameSource::TIMEOUT);
+
+        return status == nvxio::FrameSource::OK ? frame : 0;
+    }
+
+    //
+    // Pass 1: motion estimation
+    //
+
+    // Gray frames [first_; first_ + count_). The last frame of a chunk is repeated
+    // as the first frame of the next one, so every inter-frame motion is estimated once.
+    struct FrameChunk
+    {
+        std::vector<vx_image> gray_;
+        vx_size first_;
+        vx_size count_;
+    };
+
+    class MotionWorker
+    {
+    public:
+        MotionWorker(vx_context context, vx_uint32 width, vx_uint32 height);
+        ~MotionWorker();
+
+        // Appends the filtered homographies between the consecutive frames of the chunk
+        void estimate(const FrameChunk& chunk, std::vector<Matrix3x3f_rm>& motions);
+
+    private:
+        vx_context context_;
+        vx_graph graph_;
+
+        vx_delay pyr_delay_;
+        vx_delay pts_delay_;
+
+        vx_image gray_;
+        vx_matrix filtered_;
+
+        vx_scalar s_lk_epsilon_;
+        vx_scalar s_lk_num_iters_;
+        vx_scalar s_lk_use_init_est_;
+
+        vx_node pyr_node_;
+        vx_node feature_track_node_;
+    };
+
+    MotionWorker::MotionWorker(vx_context context, vx_uint32 width, vx_uint32 height):
+        context_(context)
+    {
+        vx_pyramid pyr_exemplar = vxCreatePyramid(context_, PYR_LEVELS, VX_SCALE_PYRAMID_HALF, width, height, VX_DF_IMAGE_U8);
+        NVXIO_CHECK_REFERENCE(pyr_exemplar);
+        vx_array pts_exemplar = vxCreateArray(context_, NVX_TYPE_POINT2F, MAX_POINTS);
+        NVXIO_CHECK_REFERENCE(pts_exemplar);
+
+        pyr_delay_ = vxCreateDelay(context_, (vx_reference)pyr_exemplar, 2);
+        NVXIO_CHECK_REFERENCE(pyr_delay_);
+        pts_delay_ = vxCreateDelay(context_, (vx_reference)pts_exemplar, 2);
+        NVXIO_CHECK_REFERENCE(pts_delay_);
+
+        vxReleasePyramid(&pyr_exemplar);
+        vxReleaseArray(&pts_exemplar);
+
+        gray_ = vxCreateImage(context_, width, height, VX_DF_IMAGE_U8);
+        NVXIO_CHECK_REFERENCE(gray_);
+        filtered_ = vxCreateMatrix(context_, VX_TYPE_FLOAT32, 3, 3);
+        NVXIO_CHECK_REFERENCE(filtered_);
+
+        vx_float32 lk_epsilon = 0.01f;
+        s_lk_epsilon_ = vxCreateScalar(context_, VX_TYPE_FLOAT32, &lk_epsilon);
+        NVXIO_CHECK_REFERENCE(s_lk_epsilon_);
+        s_lk_num_iters_ = vxCreateScalar(context_, VX_TYPE_UINT32, &LK_NUM_ITERS);
+        NVXIO_CHECK_REFERENCE(s_lk_num_iters_);
+        vx_bool lk_use_init_est = vx_false_e;
+        s_lk_use_init_est_ = vxCreateScalar(context_, VX_TYPE_BOOL, &lk_use_init_est);
+        NVXIO_CHECK_REFERENCE(s_lk_use_init_est_);
+
+        graph_ = vxCreateGraph(context_);
+        NVXIO_CHECK_REFERENCE(graph_);
+
+        //vxGaussianPyramidNode
+        pyr_node_ = vxGaussianPyramidNode(graph_, gray_, (vx_pyramid)vxGetReferenceFromDelay(pyr_delay_, 0));
+        NVXIO_CHECK_REFERENCE(pyr_node_);
+
+        vx_array kp_curr_list = vxCreateVirtualArray(graph_, NVX_TYPE_POINT2F, MAX_POINTS);
+        NVXIO_CHECK_REFERENCE(kp_curr_list);
+
+        //vxOpticalFlowPyrLKNode
+        vx_node opt_flow_node = vxOpticalFlowPyrLKNode(graph_,
+            (vx_pyramid)vxGetReferenceFromDelay(pyr_delay_, -1), (vx_pyramid)vxGetReferenceFromDelay(pyr_delay_, 0),
+            (vx_array)vxGetReferenceFromDelay(pts_delay_, -1), (vx_array)vxGetReferenceFromDelay(pts_delay_, -1),
+            kp_curr_list, VX_TERM_CRITERIA_BOTH, s_lk_epsilon_, s_lk_num_iters_, s_lk_use_init_est_, LK_WIN_SIZE);
+        NVXIO_CHECK_REFERENCE(opt_flow_node);
+
+        //nvxFindHomographyNode
+        vx_matrix homography = vxCreateMatrix(context_, VX_TYPE_FLOAT32, 3, 3);
+        vx_array mask = vxCreateVirtualArray(graph_, VX_TYPE_UINT8, MAX_POINTS);
+        vx_node find_homography_node = nvxFindHomographyNode(graph_, (vx_array)vxGetReferenceFromDelay(pts_delay_, -1),
+                                                             kp_curr_list,
+                                                             homography,
+                                                             NVX_FIND_HOMOGRAPHY_METHOD_RANSAC, 3.0f,
+                                                             2000, 10,
+                                                             0.995f, 0.45f,
+                                                             mask);
+        NVXIO_CHECK_REFERENCE(find_homography_node);
+
+        //homographyFilterNode
+        vx_node homography_filter_node = homographyFilterNode(graph_, homography, filtered_, gray_, mask);
+        NVXIO_CHECK_REFERENCE(homography_filter_node);
+
+        //nvxHarrisTrackNode
+        feature_track_node_ = nvxHarrisTrackNode(graph_, gray_,
+                                                 (vx_array)vxGetReferenceFromDelay(pts_delay_, 0), NULL,
+                                                 kp_curr_list, HARRIS_K, HARRIS_THRESH, HARRIS_CELL_SIZE, NULL);
+        NVXIO_CHECK_REFERENCE(feature_track_node_);
+
+        NVXIO_SAFE_CALL( vxVerifyGraph(graph_) );
+
+        vxReleaseNode(&opt_flow_node);
+        vxReleaseNode(&find_homography_node);
+        vxReleaseNode(&homography_filter_node);
+        vxReleaseMatrix(&homography);
+        vxReleaseArray(&kp_curr_list);
+        vxReleaseArray(&mask);
+    }
+
+    MotionWorker::~MotionWorker()
+    {
+        vxReleaseNode(&pyr_node_);
+        vxReleaseNode(&feature_track_node_);
+        vxReleaseGraph(&graph_);
+
+        vxReleaseDelay(&pyr_delay_);
+        vxReleaseDelay(&pts_delay_);
+        vxReleaseImage(&gray_);
+        vxReleaseMatrix(&filtered_);
+
+        vxReleaseScalar(&s_lk_epsilon_);
+        vxReleaseScalar(&s_lk_num_iters_);
+        vxReleaseScalar(&s_lk_use_init_est_);
+    }
+
+    void MotionWorker::estimate(const FrameChunk& chunk, std::vector<Matrix3x3f_rm>& motions)
+    {
+        NVXIO_SAFE_CALL( vxuGaussianPyramid(context_, chunk.gray_[0],
+                                            (vx_pyramid)vxGetReferenceFromDelay(pyr_delay_, 0)) );
+        NVXIO_SAFE_CALL( nvxuHarrisTrack(context_, chunk.gray_[0],
+                                         (vx_array)vxGetReferenceFromDelay(pts_delay_, 0), NULL, 0,
+                                         HARRIS_K, HARRIS_THRESH, HARRIS_CELL_SIZE, NULL) );
+
+        vx_float32 data[9];
+        for (vx_size i = 1; i < chunk.count_; ++i)
+        {
+            NVXIO_SAFE_CALL( vxAgeDelay(pyr_delay_) );
+            NVXIO_SAFE_CALL( vxAgeDelay(pts_delay_) );
+
+            NVXIO_SAFE_CALL( vxSetParameterByIndex(pyr_node_, 0, (vx_reference)chunk.gray_[i]) );
+            NVXIO_SAFE_CALL( vxSetParameterByIndex(feature_track_node_, 0, (vx_reference)chunk.gray_[i]) );
+
+            NVXIO_SAFE_CALL( vxProcessGraph(graph_) );
+
+            NVXIO_SAFE_CALL( vxCopyMatrix(filtered_, data, VX_READ_ONLY, VX_MEMORY_TYPE_HOST) );
+            motions.push_back( Matrix3x3f_rm::Map(data, 3, 3) );
+        }
+    }
+
+    //
+    // Global trajectory smoothing
+    //
+
+    // The camera path is the accumulated motion P_i = H_1 * ... * H_i. The smoothed path Q minimizes
+    //     sum |Q_i - P_i|^2 + lambda * sum |Q_{i+1} - Q_i|^2
+    // over the whole video, which is a tridiagonal system solved with the Thomas algorithm.
+    // The compensating transformation of the frame i is P_i^-1 * Q_i, the same quantity
+    // the real-time matrixSmoother computes from a limited window.
+    void smoothTrajectory(const std::vector<Matrix3x3f_rm>& motions, double lambda,
+                          std::vector<Matrix3x3f_rm>& compensations)
+    {
+        vx_size n = motions.size();
+        compensations.assign(n, Matrix3x3f_rm::Identity());
+        if (n < 2)
+            return;
+
+        std::vector<Eigen::Matrix3d> path(n);
+        path[0] = Eigen::Matrix3d::Identity();
+        for (vx_size i = 1; i < n; ++i)
+            path[i] = path[i - 1] * motions[i].cast<double>();
+
+        std::vector<double> c(n);
+        std::vector<Eigen::Matrix3d> d(n);
+
+        double offDiag = -lambda;
+        double m = 1.0 + lambda;
+        c[0] = offDiag / m;
+        d[0] = path[0] / m;
+        for (vx_size i = 1; i < n; ++i)
+        {
+            double diag = 1.0 + lambda * (i + 1 < n ? 2.0 : 1.0);
+            m = diag - offDiag * c[i - 1];
+            c[i] = offDiag / m;
+            d[i] = (path[i] - offDiag * d[i - 1]) / m;
+        }
+
+        Eigen::Matrix3d smoothed = d[n - 1];
+        compensations[n - 1] = (path[n - 1].inverse() * smoothed).cast<vx_float32>();
+        for (vx_size i = n - 1; i-- > 0; )
+        {
+            smoothed = d[i] - c[i] * smoothed;
+            compensations[i] = (path[i].inverse() * smoothed).cast<vx_float32>();
+        }
+    }
+
+    //
+    // Pass 2: warping
+    //
+
+    struct FrameSlot
+    {
+        vx_image input_;
+        vx_image output_;
+        vx_size index_;
+    };
+
+    class WarpWorker
+    {
+    public:
+        WarpWorker(vx_context context, vx_image exemplar, vx_float32 cropMargin);
+        ~WarpWorker();
+
+        void warp(const FrameSlot& slot, const Matrix3x3f_rm& compensation);
+
+    private:
+        vx_graph graph_;
+
+        vx_matrix stab_transform_;
+        vx_matrix truncated_;
+        vx_scalar s_crop_margin_;
+
+        vx_node truncate_stab_transform_node_;
+        vx_node warp_perspective_node_;
+    };
+
+    WarpWorker::WarpWorker(vx_context context, vx_image exemplar, vx_float32 cropMargin)
+    {
+        stab_transform_ = vxCreateMatrix(context, VX_TYPE_FLOAT32, 3, 3);
+        NVXIO_CHECK_REFERENCE(stab_transform_);
+        truncated_ = vxCreateMatrix(context, VX_TYPE_FLOAT32, 3, 3);
+        NVXIO_CHECK_REFERENCE(truncated_);
+        s_crop_margin_ = vxCreateScalar(context, VX_TYPE_FLOAT32, &cropMargin);
+        NVXIO_CHECK_REFERENCE(s_crop_margin_);
+
+        graph_ = vxCreateGraph(context);
+        NVXIO_CHECK_REFERENCE(graph_);
+
+        //truncateStabTransformNode
+        truncate_stab_transform_node_ = truncateStabTransformNode(graph_, stab_transform_, truncated_, exemplar, s_crop_margin_);
+        NVXIO_CHECK_REFERENCE(truncate_stab_transform_node_);
+
+        //vxWarpPerspectiveNode
+        vx_uint32 width = 0, height = 0;
+        NVXIO_SAFE_CALL( vxQueryImage(exemplar, VX_IMAGE_ATTRIBUTE_WIDTH, &width, sizeof(width)) );
+        NVXIO_SAFE_CALL( vxQueryImage(exemplar, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height)) );
+        vx_image output = vxCreateImage(context, width, height, VX_DF_IMAGE_RGBX);
+        NVXIO_CHECK_REFERENCE(output);
+
+        warp_perspective_node_ = vxWarpPerspectiveNode(graph_, exemplar, truncated_,
+                                                       VX_INTERPOLATION_TYPE_BILINEAR, output);
+        NVXIO_CHECK_REFERENCE(warp_perspective_node_);
+
+        NVXIO_SAFE_CALL( vxVerifyGraph(graph_) );
+
+        vxReleaseImage(&output);
+    }
+
+    WarpWorker::~WarpWorker()
+    {
+        vxReleaseNode(&truncate_stab_transform_node_);
+        vxReleaseNode(&warp_perspective_node_);
+        vxReleaseGraph(&graph_);
+
+        vxReleaseMatrix(&stab_transform_);
+        vxReleaseMatrix(&truncated_);
+        vxReleaseScalar(&s_crop_margin_);
+    }
+
+    void WarpWorker::warp(const FrameSlot& slot, const Matrix3x3f_rm& compensation)
+    {
+        vx_float32 data[9];
+        Matrix3x3f_rm::Map(data, 3, 3) = compensation;
+
+        NVXIO_SAFE_CALL( vxCopyMatrix(stab_transform_, data, VX_WRITE_ONLY, VX_MEMORY_TYPE_HOST) );
+        NVXIO_SAFE_CALL( vxSetParameterByIndex(warp_perspective_node_, 0, (vx_reference)slot.input_) );
+        NVXIO_SAFE_CALL( vxSetParameterByIndex(warp_perspective_node_, 3, (vx_reference)slot.output_) );
+
+        NVXIO_SAFE_CALL( vxProcessGraph(graph_) );
+    }
+}
+
+nvx::OfflineVideoStabilizer::OfflineStabilizerParams::OfflineStabilizerParams()
+{
+    smoothingRadius_ = 15.0f;
+    cropMargin_ = 0.05f;
+    numThreads_ = 0;
+    chunkSize_ = 64;
+}
+
+nvx::OfflineVideoStabilizer::OfflineVideoStabilizer(vx_context context, const OfflineStabilizerParams& params):
+    context_(context), params_(params)
+{
+    stats_.numOfFrames_ = 0;
+    stats_.numThreads_ = 0;
+    stats_.motionEstimationMs_ = 0;
+    stats_.smoothingMs_ = 0;
+    stats_.warpingMs_ = 0;
+}
+
+bool nvx::OfflineVideoStabilizer::run(const std::string& sourceUri, const std::string& outputUri)
+{
+    vx_uint32 numThreads = params_.numThreads_;
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    vx_size chunkSize = std::max<vx_size>(2, params_.chunkSize_);
+
+    stats_.numThreads_ = numThreads;
+    stats_.numOfFrames_ = 0;
+
+    std::unique_ptr<nvxio::FrameSource> source(nvxio::createDefaultFrameSource(context_, sourceUri));
+    if (!source || !source->open())
+    {
+        std::cerr << "Error: Can't open source file: " << sourceUri << std::endl;
+        return false;
+    }
+
+    nvxio::FrameSource::Parameters sourceParams = source->getConfiguration();
+    vx_uint32 width = sourceParams.frameWidth;
+    vx_uint32 height = sourceParams.frameHeight;
+
+    NVXIO_SAFE_CALL( registerHomographyFilterKernel(context_) );
+    NVXIO_SAFE_CALL( registerTruncateStabTransformKernel(context_) );
+
+    vx_image frame = vxCreateImage(context_, width, height, VX_DF_IMAGE_RGBX);
+    NVXIO_CHECK_REFERENCE(frame);
+
+    //
+    // Pass 1: motion estimation over chunks of frames
+    //
+
+    nvx::Timer timer;
+    timer.tic();
+
+    // motions[i] is the homography between the frames i - 1 and i
+    std::vector<Matrix3x3f_rm> motions(1, Matrix3x3f_rm::Identity());
+    {
+        // Two chunks per worker: one being processed, one being filled by the decoder
+        std::vector<FrameChunk> chunks(2 * numThreads);
+        BlockingQueue<FrameChunk*> freeChunks;
+        BlockingQueue<FrameChunk*> jobs;
+        for (FrameChunk& chunk : chunks)
+        {
+            chunk.gray_.resize(chunkSize + 1);
+            for (vx_image& gray : chunk.gray_)
+            {
+                gray = vxCreateImage(context_, width, height, VX_DF_IMAGE_U8);
+                NVXIO_CHECK_REFERENCE(gray);
+            }
+            freeChunks.push(&chunk);
+        }
+
+        WorkerErrors errors;
+        std::mutex motionsMutex;
+        std::vector<std::thread> workers;
+        for (vx_uint32 t = 0; t < numThreads; ++t)
+        {
+            workers.emplace_back([&]
+            {
+                // A failed worker keeps taking the chunks, so the decoder never waits for it
+                std::unique_ptr<MotionWorker> worker;
+                try
+                {
+                    worker.reset(new MotionWorker(context_, width, height));
+                }
+                catch (...)
+                {
+                    errors.capture();
+                }
+
+                std::vector<Matrix3x3f_rm> local;
+
+                while (FrameChunk* chunk = jobs.pop())
+                {
+                    if (worker && !errors.failed())
+                    {
+                        try
+                        {
+                            local.clear();
+                            worker->estimate(*chunk, local);
+
+                            std::lock_guard<std::mutex> lock(motionsMutex);
+                            vx_size end = chunk->first_ + chunk->count_;
+                            if (motions.size() < end)
+                                motions.resize(end, Matrix3x3f_rm::Identity());
+                            std::copy(local.begin(), local.end(), motions.begin() + chunk->first_ + 1);
+                        }
+                        catch (...)
+                        {
+                            errors.capture();
+                        }
+                    }
+
+                    freeChunks.push(chunk);
+                }
+            });
+        }
+
+        try
+        {
+            FrameChunk* chunk = freeChunks.pop();
+            chunk->first_ = 0;
+            chunk->count_ = 0;
+
+            while (!errors.failed() && fetchFrame(*source, frame))
+            {
+                NVXIO_SAFE_CALL( vxuColorConvert(context_, frame, chunk->gray_[chunk->count_]) );
+                ++chunk->count_;
+                ++stats_.numOfFrames_;
+
+                if (chunk->count_ == chunk->gray_.size())
+                {
+                    FrameChunk* next = freeChunks.pop();
+                    next->first_ = chunk->first_ + chunk->count_ - 1;
+                    next->count_ = 1;
+                    NVXIO_SAFE_CALL( nvxuCopyImage(context_, chunk->gray_[chunk->count_ - 1], next->gray_[0]) );
+
+                    jobs.push(chunk);
+                    chunk = next;
+                }
+            }
+
+            if (chunk->count_ > 1)
+                jobs.push(chunk);
+        }
+        catch (...)
+        {
+            errors.capture();
+        }
+
+        for (vx_uint32 t = 0; t < numThreads; ++t)
+            jobs.push(0);
+        for (std::thread& worker : workers)
+            worker.join();
+
+        for (FrameChunk& c : chunks)
+            for (vx_image& gray : c.gray_)
+                vxReleaseImage(&gray);
+
+        if (errors.failed())
+        {
+            vxReleaseImage(&frame);
+            errors.rethrow();
+        }
+    }
+
+    stats_.motionEstimationMs_ = timer.toc();
+
+    if (stats_.numOfFrames_ == 0)
+    {
+        std::cerr << "Error: Source has no frames" << std::endl;
+        vxReleaseImage(&frame);
+        return false;
+    }
+    motions.resize(stats_.numOfFrames_, Matrix3x3f_rm::Identity());
+
+    //
+    // Global smoothing of the whole trajectory
+    //
+
+    timer.tic();
+
+    std::vector<Matrix3x3f_rm> compensations;
+    double lambda = static_cast<double>(params_.smoothingRadius_) * params_.smoothingRadius_;
+    smoothTrajectory(motions, lambda, compensations);
+
+    stats_.smoothingMs_ = timer.toc();
+
+    //
+    // Pass 2: warping, frames are written in the original order
+    //
+
+    timer.tic();
+
+    source.reset(nvxio::createDefaultFrameSource(context_, sourceUri));
+    if (!source || !source->open())
+    {
+        std::cerr << "Error: Failed to reopen the source" << std::endl;
+        vxReleaseImage(&frame);
+        return false;
+    }
+
+    std::unique_ptr<nvxio::Render> writer(nvxio::createVideoRender(context_, outputUri, width, height));
+    if (!writer)
+    {
+        std::cerr << "Error: Can't create a video writer for " << outputUri << std::endl;
+        vxReleaseImage(&frame);
+        return false;
+    }
+
+    {
+        std::vector<FrameSlot> slots(2 * numThreads);
+        BlockingQueue<FrameSlot*> freeSlots;
+        BlockingQueue<FrameSlot*> jobs;
+        for (FrameSlot& slot : slots)
+        {
+            slot.input_ = vxCreateImage(context_, width, height, VX_DF_IMAGE_RGBX);
+            NVXIO_CHECK_REFERENCE(slot.input_);
+            slot.output_ = vxCreateImage(context_, width, height, VX_DF_IMAGE_RGBX);
+            NVXIO_CHECK_REFERENCE(slot.output_);
+            slot.index_ = 0;
+            freeSlots.push(&slot);
+        }
+
+        WorkerErrors errors;
+        std::mutex doneMutex;
+        std::condition_variable doneCond;
+        std::map<vx_size, FrameSlot*> done;
+        vx_size numOfSent = 0;
+        bool finished = false;
+
+        std::vector<std::thread> workers;
+        for (vx_uint32 t = 0; t < numThreads; ++t)
+        {
+            workers.emplace_back([&]
+            {
+                // As in the first pass, and a frame is handed to the writer even if it
+                // failed, the writer skips the frames once an error occurred
+                std::unique_ptr<WarpWorker> worker;
+                try
+                {
+                    worker.reset(new WarpWorker(context_, frame, params_.cropMargin_));
+                }
+                catch (...)
+                {
+                    errors.capture();
+                }
+
+                while (FrameSlot* slot = jobs.pop())
+                {
+                    if (worker && !errors.failed())
+                    {
+                        try
+                        {
+                            worker->warp(*slot, compensations[slot->index_]);
+                        }
+                        catch (...)
+                        {
+                            errors.capture();
+                        }
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(doneMutex);
+                        done[slot->index_] = slot;
+                    }
+                    doneCond.notify_all();
+                }
+            });
+        }
+
+        std::thread writerThread([&]
+        {
+            for (vx_size next = 0; ; ++next)
+            {
+                FrameSlot* slot = 0;
+                {
+                    std::unique_lock<std::mutex> lock(doneMutex);
+                    doneCond.wait(lock, [&] { return done.count(next) != 0 || (finished && next >= numOfSent); });
+
+                    if (done.count(next) == 0)
+                        break;
+
+                    slot = done[next];
+                    done.erase(next);
+                }
+
+                if (!errors.failed())
+                {
+                    try
+                    {
+                        writer->putImage(slot->output_);
+                        writer->flush();
+                    }
+                    catch (...)
+                    {
+                        errors.capture();
+                    }
+                }
+
+                freeSlots.push(slot);
+            }
+        });
+
+        try
+        {
+            for (vx_size i = 0; i < stats_.numOfFrames_ && !errors.failed(); ++i)
+            {
+                FrameSlot* slot = freeSlots.pop();
+                if (!fetchFrame(*source, slot->input_))
+                {
+                    freeSlots.push(slot);
+                    break;
+                }
+
+                slot->index_ = i;
+                jobs.push(slot);
+
+                std::lock_guard<std::mutex> lock(doneMutex);
+                ++numOfSent;
+            }
+        }
+        catch (...)
+        {
+            errors.capture();
+        }
+
+        for (vx_uint32 t = 0; t < numThreads; ++t)
+            jobs.push(0);
+        for (std::thread& worker : workers)
+            worker.join();
+
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            finished = true;
+        }
+        doneCond.notify_all();
+        writerThread.join();
+
+        for (FrameSlot& slot : slots)
+        {
+            vxReleaseImage(&slot.input_);
+            vxReleaseImage(&slot.output_);
+        }
+
+        if (errors.failed())
+        {
+            vxReleaseImage(&frame);
+            errors.rethrow();
+        }
+    }
+
+    stats_.warpingMs_ = timer.toc();
+
+    writer->close();
+    vxReleaseImage(&frame);
+
+    return true;
+}
+
+const nvx::OfflineVideoStabilizer::Statistics& nvx::OfflineVideoStabilizer::getStatistics() const
+{
+    return stats_;
+}
+
+void nvx::OfflineVideoStabilizer::printPerfs() const
+{
+    std::cout << "Frames : " << stats_.numOfFrames_ << ", threads : " << stats_.numThreads_ << std::endl;
+    std::cout << "\t Motion estimation time : " << stats_.motionEstimationMs_ << " ms" << std::endl;
+    std::cout << "\t Trajectory smoothing time : " << stats_.smoothingMs_ << " ms" << std::endl;
+    std::cout << "\t Warping time : " << stats_.warpingMs_ << " ms" << std::endl;
+
+    double total_ms = stats_.motionEstimationMs_ + stats_.smoothingMs_ + stats_.warpingMs_;
+    if (total_ms > 0)
+        std::cout << "\t Throughput : " << 1000.0 * stats_.numOfFrames_ / total_ms << " FPS" << std::endl;
+}
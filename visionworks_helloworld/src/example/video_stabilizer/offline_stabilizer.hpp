@@ -0,0 +1,63 @@
+#ifndef NVX_OFFLINE_STABILIZER_HPP
+#define NVX_OFFLINE_STABILIZER_HPP
+
+#include <string>
+
+#include <VX/vx.h>
+
+namespace nvx
+{
+    // Two-pass stabilization of a recorded video.
+    //
+    // Pass 1 splits the source into chunks of consecutive frames and estimates the
+    // inter-frame homographies of every chunk on its own worker thread.
+    // The whole camera trajectory is then smoothed at once.
+    // Pass 2 reads the source again, warps the frames on the worker threads and
+    // writes them to the output in the original order.
+    class OfflineVideoStabilizer
+    {
+    public:
+
+        struct OfflineStabilizerParams
+        {
+            // strength of the trajectory smoothing, roughly the number of frames a shake is spread over
+            vx_float32 smoothingRadius_;
+            // proportion of the width/height of the frame that is allowed to be cropped for stabilizing of the frames
+            vx_float32 cropMargin_;
+            // number of worker threads, 0 - use all available cores
+            vx_uint32 numThreads_;
+            // number of frames processed by one worker of the first pass at a time
+            vx_uint32 chunkSize_;
+
+            OfflineStabilizerParams();
+        };
+
+        struct Statistics
+        {
+            vx_size numOfFrames_;
+            vx_uint32 numThreads_;
+            double motionEstimationMs_;
+            double smoothingMs_;
+            double warpingMs_;
+        };
+
+        OfflineVideoStabilizer(vx_context context, const OfflineStabilizerParams& params = OfflineStabilizerParams());
+
+        // Stabilizes 'sourceUri' and writes the result to 'outputUri'.
+        // Returns false if the source can't be opened or has no frames.
+        // A failed OpenVX call throws, also when it failed on a worker thread.
+        bool run(const std::string& sourceUri, const std::string& outputUri);
+
+        const Statistics& getStatistics() const;
+
+        void printPerfs() const;
+
+    private:
+
+        vx_context context_;
+        OfflineStabilizerParams params_;
+        Statistics stats_;
+    };
+}
+
+#endif
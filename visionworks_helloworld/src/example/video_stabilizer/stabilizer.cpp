@@ -52,7 +52,9 @@ namespace
         void init(vx_image firstFrame);
         void process(vx_image newFrame);
 
+        vx_image getInputFrame() const;
         vx_image getStabilizedFrame() const;
+        vx_image getOriginalFrame() const;
 
         void printPerfs() const;
 
@@ -91,7 +93,8 @@ namespace
 
         // Node from main graph (used to print performance results)
         vx_node convert_to_gray_node_;
-        vx_node copy_node_;
+        vx_node convert_to_nv12_node_;
+        vx_node convert_from_nv12_node_;
         vx_node pyr_node_;
         vx_node opt_flow_node_;
         vx_node feature_track_node_;
@@ -104,10 +107,14 @@ namespace
         vx_delay pyr_delay_;
         vx_delay pts_delay_;
         vx_delay matrices_delay_;
-        vx_delay frames_RGBX_delay_;
+        // Ring of source frames. In RGBX mode the source fetches directly into the oldest slot
+        // and the stabilizer only rotates references, so no frame is ever copied.
+        vx_delay frames_delay_;
 
         vx_matrix smoothed_;
 
+        // Staging frame for the NV12 storage mode
+        vx_image input_RGBX_frame_;
         vx_image stabilized_RGBX_frame_;
 
         vx_scalar s_lk_epsilon_;
@@ -117,6 +124,8 @@ namespace
 
         vx_size matrices_delay_size_;
         vx_size frames_delay_size_;
+        // Slot of 'frames_delay_' that is warped to produce the current stabilized frame
+        vx_int32 warped_frame_slot_;
     };
 
     ImageBasedVideoStabilizer::ImageBasedVideoStabilizer(vx_context context, const VideoStabilizerParams &params):
@@ -130,7 +139,8 @@ namespace
         height_ = 0;
 
         convert_to_gray_node_ = 0;
-        copy_node_ = 0;
+        convert_to_nv12_node_ = 0;
+        convert_from_nv12_node_ = 0;
         pyr_node_ = 0;
         opt_flow_node_ = 0;
         feature_track_node_ = 0;
@@ -143,9 +153,10 @@ namespace
         pyr_delay_ = 0;
         pts_delay_ = 0;
         matrices_delay_ = 0;
-        frames_RGBX_delay_ = 0;
+        frames_delay_ = 0;
 
         smoothed_ = 0;
+        input_RGBX_frame_ = 0;
         stabilized_RGBX_frame_ = 0;
 
         s_lk_epsilon_ = 0;
@@ -155,6 +166,7 @@ namespace
 
         matrices_delay_size_ = 0;
         frames_delay_size_ = 0;
+        warped_frame_slot_ = 0;
     }
 
     void ImageBasedVideoStabilizer::init(vx_image firstFrame)
@@ -168,6 +180,8 @@ namespace
         NVXIO_SAFE_CALL( vxQueryImage(firstFrame, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height)) );
 
         NVXIO_ASSERT(format == VX_DF_IMAGE_RGBX);
+        // NV12 chroma planes are subsampled by 2 in both directions
+        NVXIO_ASSERT(vstabParams_.frameStorage_ != FRAME_STORAGE_NV12 || (width % 2 == 0 && height % 2 == 0));
 
         release();
 
@@ -187,7 +201,16 @@ namespace
         NVXIO_CHECK_REFERENCE(gray);
 
         NVXIO_SAFE_CALL( vxuColorConvert(context_, frame, gray) );
-        NVXIO_SAFE_CALL( nvxuCopyImage(context_, frame, (vx_image)vxGetReferenceFromDelay(frames_RGBX_delay_, 0)) );
+
+        vx_image newest = (vx_image)vxGetReferenceFromDelay(frames_delay_, 0);
+        if (vstabParams_.frameStorage_ == FRAME_STORAGE_NV12)
+        {
+            NVXIO_SAFE_CALL( vxuColorConvert(context_, frame, newest) );
+        }
+        else
+        {
+            NVXIO_SAFE_CALL( nvxuCopyImage(context_, frame, newest) );
+        }
 
         NVXIO_SAFE_CALL( vxuGaussianPyramid(context_, gray,
                                         (vx_pyramid)vxGetReferenceFromDelay(pyr_delay_, 0)) );
@@ -213,16 +236,28 @@ namespace
         NVXIO_ASSERT(width == width_);
         NVXIO_ASSERT(height == height_);
 
+        if (vstabParams_.frameStorage_ == FRAME_STORAGE_NV12)
+        {
+            NVXIO_SAFE_CALL( vxSetParameterByIndex(convert_to_nv12_node_, 0, (vx_reference)newFrame) );
+        }
+        else
+        {
+            // The oldest slot of the ring becomes the newest one after aging.
+            // Frames fetched somewhere else have to be brought into the ring.
+            vx_image input = getInputFrame();
+            if (newFrame != input)
+            {
+                NVXIO_SAFE_CALL( nvxuCopyImage(context_, newFrame, input) );
+            }
+        }
+
         // Update frame queue
         NVXIO_SAFE_CALL( vxAgeDelay(pyr_delay_) );
         NVXIO_SAFE_CALL( vxAgeDelay(pts_delay_) );
         NVXIO_SAFE_CALL( vxAgeDelay(matrices_delay_) );
-        NVXIO_SAFE_CALL( vxAgeDelay(frames_RGBX_delay_) );
+        NVXIO_SAFE_CALL( vxAgeDelay(frames_delay_) );
 
         // Process graph
-        NVXIO_SAFE_CALL( vxSetParameterByIndex(convert_to_gray_node_, 0, (vx_reference)newFrame) );
-        NVXIO_SAFE_CALL( vxSetParameterByIndex(copy_node_, 0, (vx_reference)newFrame) );
-
         NVXIO_SAFE_CALL( vxProcessGraph(graph_) );
     }
 
@@ -238,13 +273,33 @@ namespace
         vx_image gray = vxCreateVirtualImage(graph_, 0, 0, VX_DF_IMAGE_U8);
         NVXIO_CHECK_REFERENCE(gray);
 
-        //vxColorConvertNode
-        convert_to_gray_node_ = vxColorConvertNode(graph_, frame, gray);
-        NVXIO_CHECK_REFERENCE(convert_to_gray_node_);
+        vx_image newest = (vx_image)vxGetReferenceFromDelay(frames_delay_, 0);
+        vx_image warped = (vx_image)vxGetReferenceFromDelay(frames_delay_, warped_frame_slot_);
 
-        //nvxCopyImageNode
-        copy_node_ = nvxCopyImageNode(graph_, frame, (vx_image)vxGetReferenceFromDelay(frames_RGBX_delay_, 0));
-        NVXIO_CHECK_REFERENCE(copy_node_);
+        if (vstabParams_.frameStorage_ == FRAME_STORAGE_NV12)
+        {
+            //vxColorConvertNode (RGBX -> NV12)
+            convert_to_nv12_node_ = vxColorConvertNode(graph_, frame, newest);
+            NVXIO_CHECK_REFERENCE(convert_to_nv12_node_);
+
+            //vxChannelExtractNode
+            convert_to_gray_node_ = vxChannelExtractNode(graph_, newest, VX_CHANNEL_Y, gray);
+            NVXIO_CHECK_REFERENCE(convert_to_gray_node_);
+
+            //vxColorConvertNode (NV12 -> RGBX)
+            vx_image warped_RGBX = vxCreateVirtualImage(graph_, width_, height_, VX_DF_IMAGE_RGBX);
+            NVXIO_CHECK_REFERENCE(warped_RGBX);
+            convert_from_nv12_node_ = vxColorConvertNode(graph_, warped, warped_RGBX);
+            NVXIO_CHECK_REFERENCE(convert_from_nv12_node_);
+
+            warped = warped_RGBX;
+        }
+        else
+        {
+            //vxColorConvertNode
+            convert_to_gray_node_ = vxColorConvertNode(graph_, newest, gray);
+            NVXIO_CHECK_REFERENCE(convert_to_gray_node_);
+        }
 
         //vxGaussianPyramidNode
         pyr_node_ = vxGaussianPyramidNode(graph_, gray,
@@ -277,7 +332,7 @@ namespace
 
         homography_filter_node_ = homographyFilterNode(graph_, homography,
                                                        (vx_matrix)vxGetReferenceFromDelay(matrices_delay_, 0),
-                                                       frame, mask);
+                                                       newest, mask);
         NVXIO_CHECK_REFERENCE(homography_filter_node_);
 
         //matrixSmootherNode
@@ -286,12 +341,12 @@ namespace
 
         //truncateStabTransformNode
         vx_matrix truncated = vxCreateMatrix(context_, VX_TYPE_FLOAT32, 3, 3);
-        truncate_stab_transform_node_ = truncateStabTransformNode(graph_, smoothed_, truncated, frame, s_crop_margin_);
+        truncate_stab_transform_node_ = truncateStabTransformNode(graph_, smoothed_, truncated, newest, s_crop_margin_);
         NVXIO_CHECK_REFERENCE(truncate_stab_transform_node_);
 
         //vxWarpPerspectiveNode
         warp_perspective_node_ = vxWarpPerspectiveNode(graph_,
-                (vx_image)vxGetReferenceFromDelay(frames_RGBX_delay_, 1 - static_cast<vx_int32>(frames_delay_size_)),
+                warped,
                 truncated,
                 VX_INTERPOLATION_TYPE_BILINEAR, stabilized_RGBX_frame_);
         NVXIO_CHECK_REFERENCE(warp_perspective_node_);
@@ -314,6 +369,9 @@ namespace
         vxReleaseArray(&kp_curr_list);
         vxReleaseArray(&mask);
         vxReleaseImage(&gray);
+
+        if (vstabParams_.frameStorage_ == FRAME_STORAGE_NV12)
+            vxReleaseImage(&warped);
     }
 }
 
@@ -327,8 +385,14 @@ void ImageBasedVideoStabilizer::printPerfs() const
     NVXIO_SAFE_CALL( vxQueryNode(convert_to_gray_node_, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
     std::cout << "\t RGB to gray time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
 
-    NVXIO_SAFE_CALL( vxQueryNode(copy_node_, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
-    std::cout << "\t Copy time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+    if (convert_to_nv12_node_)
+    {
+        NVXIO_SAFE_CALL( vxQueryNode(convert_to_nv12_node_, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+        std::cout << "\t RGB to NV12 time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+
+        NVXIO_SAFE_CALL( vxQueryNode(convert_from_nv12_node_, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
+        std::cout << "\t NV12 to RGB time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
+    }
 
     NVXIO_SAFE_CALL( vxQueryNode(pyr_node_, VX_NODE_ATTRIBUTE_PERFORMANCE, &perf, sizeof(perf)) );
     std::cout << "\t Pyramid time : " << perf.tmp / 1000000.0 << " ms" << std::endl;
@@ -395,13 +459,22 @@ vx_status nvx::initDelayOfImages(vx_context context, vx_delay delayOfImages)
         status |= vxQueryImage(img0, VX_IMAGE_ATTRIBUTE_WIDTH, &width, sizeof(width));
         status |= vxQueryImage(img0, VX_IMAGE_ATTRIBUTE_HEIGHT, &height, sizeof(height));
 
-        NVXIO_ASSERT(format == VX_DF_IMAGE_RGBX);
+        NVXIO_ASSERT(format == VX_DF_IMAGE_RGBX || format == VX_DF_IMAGE_NV12);
 
         vx_pixel_value_t initVal;
-        initVal.RGBX[0] = 0;
-        initVal.RGBX[1] = 0;
-        initVal.RGBX[2] = 0;
-        initVal.RGBX[3] = 0;
+        if (format == VX_DF_IMAGE_NV12)
+        {
+            initVal.YUV[0] = 0;
+            initVal.YUV[1] = 128;
+            initVal.YUV[2] = 128;
+        }
+        else
+        {
+            initVal.RGBX[0] = 0;
+            initVal.RGBX[1] = 0;
+            initVal.RGBX[2] = 0;
+            initVal.RGBX[3] = 0;
+        }
         vx_image blackImg = vxCreateUniformImage(context, width, height, format, &initVal);
         NVXIO_CHECK_REFERENCE(blackImg);
 
@@ -440,16 +513,32 @@ void ImageBasedVideoStabilizer::createDataObjects(vx_image frame)
     NVXIO_CHECK_REFERENCE(matrices_delay_);
     NVXIO_SAFE_CALL( initDelayOfMatrices(matrices_delay_) );
 
-    vx_image image_exemplar = vxCreateImage(context_, width_, height_, VX_DF_IMAGE_U8);
-
     // 'frames_delay_' must have such size to be synchronized with the 'matrices_delay_'
     frames_delay_size_ = vstabParams_.numOfSmoothingFrames_ + 2;
+    warped_frame_slot_ = 1 - static_cast<vx_int32>(frames_delay_size_);
 
-    frames_RGBX_delay_ = vxCreateDelay(context_, (vx_reference)frame, frames_delay_size_);
-    NVXIO_CHECK_REFERENCE(frames_RGBX_delay_);
-    NVXIO_SAFE_CALL( nvx::initDelayOfImages(context_, frames_RGBX_delay_) );
+    vx_image frame_exemplar = 0;
+    if (vstabParams_.frameStorage_ == FRAME_STORAGE_NV12)
+    {
+        frame_exemplar = vxCreateImage(context_, width_, height_, VX_DF_IMAGE_NV12);
 
-    vxReleaseImage(&image_exemplar);
+        input_RGBX_frame_ = vxCreateImage(context_, width_, height_, VX_DF_IMAGE_RGBX);
+        NVXIO_CHECK_REFERENCE(input_RGBX_frame_);
+    }
+    else
+    {
+        frame_exemplar = vxCreateImage(context_, width_, height_, VX_DF_IMAGE_RGBX);
+
+        // one more slot, which is not referenced by the graph, receives the next frame
+        ++frames_delay_size_;
+    }
+    NVXIO_CHECK_REFERENCE(frame_exemplar);
+
+    frames_delay_ = vxCreateDelay(context_, (vx_reference)frame_exemplar, frames_delay_size_);
+    NVXIO_CHECK_REFERENCE(frames_delay_);
+    NVXIO_SAFE_CALL( nvx::initDelayOfImages(context_, frames_delay_) );
+
+    vxReleaseImage(&frame_exemplar);
 
     stabilized_RGBX_frame_ = vxCreateImage(context_, width_, height_, VX_DF_IMAGE_RGBX);
     NVXIO_CHECK_REFERENCE(stabilized_RGBX_frame_);
@@ -488,12 +577,14 @@ void ImageBasedVideoStabilizer::release()
     vxReleaseNode(&warp_perspective_node_);
 
     vxReleaseDelay(&matrices_delay_);
-    vxReleaseDelay(&frames_RGBX_delay_);
+    vxReleaseDelay(&frames_delay_);
     vxReleaseMatrix(&smoothed_);
 
     vxReleaseNode(&convert_to_gray_node_);
-    vxReleaseNode(&copy_node_);
+    vxReleaseNode(&convert_to_nv12_node_);
+    vxReleaseNode(&convert_from_nv12_node_);
 
+    vxReleaseImage(&input_RGBX_frame_);
     vxReleaseImage(&stabilized_RGBX_frame_);
     vxReleaseScalar(&s_lk_epsilon_);
     vxReleaseScalar(&s_lk_num_iters_);
@@ -507,6 +598,7 @@ nvx::VideoStabilizer::VideoStabilizerParams::VideoStabilizerParams()
 {
     numOfSmoothingFrames_ = 5;
     cropMargin_ = 0.05f;
+    frameStorage_ = FRAME_STORAGE_RGBX;
 }
 
 ImageBasedVideoStabilizer::HarrisPyrLKParams::HarrisPyrLKParams()
@@ -526,11 +618,24 @@ nvx::VideoStabilizer* nvx::VideoStabilizer::createImageBasedVStab(vx_context con
     return new ImageBasedVideoStabilizer(context, params);
 }
 
+vx_image ImageBasedVideoStabilizer::getInputFrame() const
+{
+    if (vstabParams_.frameStorage_ == FRAME_STORAGE_NV12)
+        return input_RGBX_frame_;
+
+    return (vx_image)vxGetReferenceFromDelay(frames_delay_, 1 - static_cast<vx_int32>(frames_delay_size_));
+}
+
 vx_image ImageBasedVideoStabilizer::getStabilizedFrame() const
 {
     return stabilized_RGBX_frame_;
 }
 
+vx_image ImageBasedVideoStabilizer::getOriginalFrame() const
+{
+    return (vx_image)vxGetReferenceFromDelay(frames_delay_, warped_frame_slot_);
+}
+
 ImageBasedVideoStabilizer::~ImageBasedVideoStabilizer()
 {
     release();
@@ -37,12 +37,23 @@ namespace nvx
     {
     public:
 
+        // Storage format of the frames kept in the stabilizer's frame ring
+        enum FrameStorage
+        {
+            // frames are kept as is, the source fetches directly into the ring (no per-frame copy)
+            FRAME_STORAGE_RGBX,
+            // frames are converted to NV12 on entry (1.5 bytes per pixel instead of 4)
+            FRAME_STORAGE_NV12
+        };
+
         struct VideoStabilizerParams
         {
             // frames for smoothing are taken from the interval [-numOfSmoothingFrames_; numOfSmoothingFrames_] in the current frame's vicinity
             vx_size numOfSmoothingFrames_;
             // proportion of the width/height of the frame that is allowed to be cropped for stabilizing of the frames
             vx_float32 cropMargin_;
+            // format of the delayed frames
+            FrameStorage frameStorage_;
 
             VideoStabilizerParams();
         };
@@ -54,8 +65,16 @@ namespace nvx
         virtual void init(vx_image firstFrame) = 0;
         virtual void process(vx_image newFrame) = 0;
 
+        // Image the next frame should be fetched into. Passing it to process() avoids any copy.
+        // It is valid after init() and changes after every call to process().
+        virtual vx_image getInputFrame() const = 0;
+
         virtual vx_image getStabilizedFrame() const = 0;
 
+        // Source frame corresponding to the current stabilized frame (RGBX or NV12, see FrameStorage).
+        // It stays valid until the next call to process().
+        virtual vx_image getOriginalFrame() const = 0;
+
         virtual void printPerfs() const = 0;
     };
 
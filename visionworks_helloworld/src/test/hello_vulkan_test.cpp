@@ -15,70 +15,66 @@ HelloVulkanTest::~HelloVulkanTest()
 
 bool HelloVulkanTest::init()
 {
-	dispatcher()->listen_any([this](const se::any_event& ev) {
-		static auto startTime = std::chrono::high_resolution_clock::now();
-		auto currentTime = std::chrono::high_resolution_clock::now();
-		float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-
+	// Below the priority of the GUI overlay, so the inputs captured by the GUI don't move the camera.
+	// The events only record the inputs, update() moves the camera.
+	d_inputSubscription = dispatcher()->subscribe<SDL_Event>([this](const SDL_Event& real_ev) {
 		static bool mouse_on = false;
 		static bool firstMouse = true;
 
-		if (se::is<SDL_Event>(ev))
+		switch (real_ev.type)
+		{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
 		{
-			auto real_ev = se::into<SDL_Event>(ev);
+			bool down = real_ev.type == SDL_KEYDOWN;
 
-			if (real_ev.type == SDL_KEYDOWN)
+			switch (real_ev.key.keysym.sym)
+			{
+			case SDLK_ESCAPE:
+			case SDLK_q:
+				if (down) quitApp();
+				break;
+			case SDLK_w:
+				d_input.forward = down;
+				break;
+			case SDLK_s:
+				d_input.backward = down;
+				break;
+			case SDLK_a:
+				d_input.left = down;
+				break;
+			case SDLK_d:
+				d_input.right = down;
+				break;
+			}
+			break;
+		}
+		case SDL_MOUSEMOTION:
+			if (mouse_on) cameraMotion((float)real_ev.motion.x, (float)real_ev.motion.y, firstMouse);
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+			switch (real_ev.button.button)
 			{
-				switch (real_ev.key.keysym.sym)
-				{
-				case SDLK_ESCAPE:
-				case SDLK_q:
-					quitApp();
-					break;
-				case SDLK_w:
-					d_freeCam->translateForward(-0.05f * time);
-					break;
-				case SDLK_s:
-					d_freeCam->translateForward(0.05f * time);
-					break;
-				case SDLK_a:
-					d_freeCam->translateRight(-0.05f * time);
-					break;
-				case SDLK_d:
-					d_freeCam->translateRight(0.05f * time);
-					break;
-				}
+			case SDL_BUTTON_RIGHT:
+				mouse_on = true;
+				SDL_SetRelativeMouseMode(SDL_TRUE);
+				break;
 			}
-			else
+			break;
+		case SDL_MOUSEBUTTONUP:
+			switch (real_ev.button.button)
 			{
-				switch (real_ev.type) {
-
-				case SDL_MOUSEMOTION:
-					if (mouse_on) cameraMotion((float)real_ev.motion.x, (float)real_ev.motion.y, firstMouse);
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					switch (real_ev.button.button)
-					{
-					case SDL_BUTTON_RIGHT:
-						mouse_on = true;
-						SDL_SetRelativeMouseMode(SDL_TRUE);
-						break;
-					}
-					break;
-				case SDL_MOUSEBUTTONUP:
-					switch (real_ev.button.button)
-					{
-					case SDL_BUTTON_RIGHT:
-						SDL_SetRelativeMouseMode(SDL_FALSE);
-						firstMouse = true;
-						mouse_on = false;
-						break;
-					}
-					break;
-				}
+			case SDL_BUTTON_RIGHT:
+				SDL_SetRelativeMouseMode(SDL_FALSE);
+				firstMouse = true;
+				mouse_on = false;
+				break;
 			}
+			break;
 		}
-	});
+
+		return se::propagation::proceed;
+	}, 0);
 
 
 	d_mesh.vertices =
@@ -189,6 +185,7 @@ bool HelloVulkanTest::init()
 	d_freeCam = std::make_shared<cam::FreeCamera>(vulkanContext()->swapChain->actualExtent.width,
 												  vulkanContext()->swapChain->actualExtent.height,
 												  cam::CameraType::Orthogonal);
+	d_previousPose = d_currentPose = cameraPose();
 
 	d_commands = vk::Device(*vulkanContext()->device).allocateCommandBuffers(vk::CommandBufferAllocateInfo(
 		vulkanContext()->device->graphicsCmdPool,
@@ -200,12 +197,20 @@ bool HelloVulkanTest::init()
 
 	vulkanContext()->defaultRenderPass->clearAll(1.0, 0.0, 0.0, 0.0);
 
+	// one query pool per command buffer, the frames in flight
+	d_gpuTimer = std::make_shared<profiling::GpuTimer>(vulkanContext()->device, (uint32_t)d_commands.size());
+	d_scenePass = d_gpuTimer->addPass("scene");
+
 	for (int i = 0; i < d_commands.size(); ++i)
 	{
 		auto& command = d_commands[i];
 
 		command.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eSimultaneousUse));
 		{
+			// submitted first in the frame
+			d_gpuTimer->reset(command, i);
+			d_gpuTimer->begin(command, i, d_scenePass);
+
 			command.beginRenderPass(vk::RenderPassBeginInfo(vulkanContext()->defaultRenderPass->renderpass, vulkanContext()->defaultRenderPass->frameBuffers[i], vk::Rect2D({}, res),
 				(uint32_t)vulkanContext()->defaultRenderPass->clearValues.size(), vulkanContext()->defaultRenderPass->clearValues.data()),
 									vk::SubpassContents::eInline);
@@ -220,6 +225,8 @@ bool HelloVulkanTest::init()
 				command.drawIndexed((uint32_t)d_mesh.indices.size(), 1, 0, 0, 0);
 			}
 			command.endRenderPass();
+
+			d_gpuTimer->end(command, i, d_scenePass);
 		}
 		command.end();
 	}
@@ -236,34 +243,76 @@ bool HelloVulkanTest::init()
 
 	d_ui = std::shared_ptr<renderer::GuiOverlay>(new renderer::GuiOverlay(dispatcher(), vulkanContext()));
 	d_ui->initData();
+	d_ui->setGpuTimer(d_gpuTimer);
 
 	return true;
 }
 
-void HelloVulkanTest::update()
+void HelloVulkanTest::update(double dt)
 {
+	d_previousPose = d_currentPose;
+
+	float distance = CAMERA_SPEED * (float)dt;
+
+	if (d_input.forward) d_freeCam->translateForward(-distance);
+	if (d_input.backward) d_freeCam->translateForward(distance);
+	if (d_input.left) d_freeCam->translateRight(-distance);
+	if (d_input.right) d_freeCam->translateRight(distance);
+
+	// The mouse moved since the last step
+	if (d_input.lookX != 0.0f || d_input.lookY != 0.0f)
+	{
+		d_freeCam->pitch(-d_input.lookY * 0.008f);
+		d_freeCam->yaw(d_input.lookX * 0.008f);
+		d_input.lookX = d_input.lookY = 0.0f;
+	}
+
+	d_currentPose = cameraPose();
 }
 
-void HelloVulkanTest::render()
+void HelloVulkanTest::render(double alpha)
 {
 	// TODO: adding present
 	static uint32_t index = 0;
 
-	d_ui->startFrame();
+	// The camera between the last two steps, so its motion is as smooth as the frame rate
+	CameraPose pose;
+	pose.position = glm::mix(d_previousPose.position, d_currentPose.position, (float)alpha);
+	pose.orientation = glm::slerp(d_previousPose.orientation, d_currentPose.orientation, (float)alpha);
+
 	{
-		ImGui::Begin("transform data.");
-		ImGui::Text("fps average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
-		ImGui::Separator();
-		ImGui::End();
+		PROFILE_SCOPE(profiler(), "gui");
+
+		d_ui->startFrame();
+		{
+			ImGui::Begin("transform data.");
+			ImGui::Text("fps average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+			ImGui::Text("frame time p50 %.2f ms, p99 %.2f ms, max %.2f ms", 1000.0 * frameTimes().percentile(0.5),
+				1000.0 * frameTimes().percentile(0.99), 1000.0 * frameTimes().max());
+			ImGui::Text("camera (%.2f, %.2f, %.2f)", pose.position.x, pose.position.y, pose.position.z);
+			ImGui::Separator();
+			ImGui::End();
+
+			d_ui->profilerPanel(*profiler());
+		}
+		d_ui->endFrame();
 	}
-	d_ui->endFrame();
 
-	index = vulkanContext()->swapChain->acquireNewFrame(d_imageAcquiringSemaphore[index]);
+	{
+		PROFILE_SCOPE(profiler(), "acquire");
+		index = vulkanContext()->swapChain->acquireNewFrame(d_imageAcquiringSemaphore[index]);
+	}
 
 	vk::PipelineStageFlags flags = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eAllGraphics;
 
-	vk::Device(*vulkanContext()->device).waitForFences(1, &d_fence[index], VK_TRUE, UINT64_MAX);
-	vk::Device(*vulkanContext()->device).resetFences(1, &d_fence[index]);
+	{
+		PROFILE_SCOPE(profiler(), "wait frame");
+		vk::Device(*vulkanContext()->device).waitForFences(1, &d_fence[index], VK_TRUE, UINT64_MAX);
+		vk::Device(*vulkanContext()->device).resetFences(1, &d_fence[index]);
+	}
+
+	// the frame which used these queries is done
+	d_gpuTimer->collect(index, *profiler());
 
 	static std::vector<vk::CommandBuffer> commands(10);
 	commands.clear();
@@ -280,15 +329,24 @@ void HelloVulkanTest::render()
 	submitinfo.setSignalSemaphoreCount(1);
 	submitinfo.setPSignalSemaphores(&d_imageRenderingSemaphore[index]);
 
-	d_dawQueue.submit(submitinfo, d_fence[index]);
+	{
+		PROFILE_SCOPE(profiler(), "submit");
+		d_dawQueue.submit(submitinfo, d_fence[index]);
+		d_gpuTimer->submitted(index, profiler()->frameNumber());
+	}
 
-	vulkanContext()->swapChain->queuePresent(d_dawQueue, index, d_imageRenderingSemaphore[index]);
+	{
+		PROFILE_SCOPE(profiler(), "present");
+		vulkanContext()->swapChain->queuePresent(d_dawQueue, index, d_imageRenderingSemaphore[index]);
+	}
 
 	index = ((index + 1) % d_commands.size());
 }
 
 void HelloVulkanTest::cleanup()
 {
+	d_inputSubscription.reset();
+
 	//if (!d_commands.empty())
 	//{
 	//	for(const auto& cmd : d_commands)
@@ -326,8 +384,17 @@ void HelloVulkanTest::cameraMotion(float xpos, float ypos, bool & firstMouse)
 	lastX = xpos;
 	lastY = ypos;
 
-	d_freeCam->pitch(-yoffset * 0.008f);
-	d_freeCam->yaw(xoffset * 0.008f);
+	d_input.lookX += xoffset;
+	d_input.lookY += yoffset;
+}
+
+HelloVulkanTest::CameraPose HelloVulkanTest::cameraPose() const
+{
+	// view = rotation * translate(-position)
+	CameraPose pose;
+	pose.position = glm::vec3(d_freeCam->postion());
+	pose.orientation = glm::quat_cast(glm::mat3(d_freeCam->viewMatrix()));
+	return pose;
 }
 
 
@@ -7,6 +7,7 @@
 #include "../engine/graphics/vulkan_pipeline.h"
 #include "../engine/camera/free_camera.h"
 #include "../engine/renderer/gui_overlay.h"
+#include "../engine/profiling/gpu_timer.h"
 
 
 #include <glm/glm.hpp>
@@ -23,9 +24,9 @@ public:
 
 	bool init() override;
 
-	void update() override;
+	void update(double dt) override;
 
-	void render() override;
+	void render(double alpha) override;
 
 	void cleanup() override;
 
@@ -54,6 +55,30 @@ private:
 
 	std::shared_ptr<cam::FreeCamera> d_freeCam;
 
+	// Keys held and mouse motion since the last update
+	struct CameraInput
+	{
+		bool forward = false;
+		bool backward = false;
+		bool left = false;
+		bool right = false;
+		float lookX = 0.0f;
+		float lookY = 0.0f;
+	}d_input;
+
+	struct CameraPose
+	{
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	};
+
+	// The camera after the previous and the last update, render() interpolates between them
+	CameraPose d_previousPose;
+	CameraPose d_currentPose;
+
+	// Units per second
+	static constexpr float CAMERA_SPEED = 2.0f;
+
 	std::shared_ptr<graphics::VulkanGraphicsPipeline> d_pipeline;
 
 	std::vector<vk::CommandBuffer> d_commands;
@@ -66,7 +91,14 @@ private:
 
 	std::shared_ptr<renderer::GuiOverlay> d_ui;
 
+	// Camera and quit keys, after the GUI overlay
+	se::subscription d_inputSubscription;
+
+	std::shared_ptr<profiling::GpuTimer> d_gpuTimer;
+	uint32_t d_scenePass = 0;
+
 	void cameraMotion(float xpos, float ypos, bool& firstMouse);
+	CameraPose cameraPose() const;
 };
 
 